@@ -149,7 +149,7 @@ namespace
 
 			//----------------------------------------------------------------------
 
-			else if (message.isType ("CommoditiesItemTypeListResponse"))
+			else if (message.isType(CRC_CONSTANT("CommoditiesItemTypeListResponse")))
 			{
 				Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 				const GenericValueTypeMessage<std::pair<std::string, AuctionManagerClient::ItemTypeListServer> > msg (ri);
@@ -158,7 +158,7 @@ namespace
 
 			//----------------------------------------------------------------------
 
-			else if (message.isType ("CommoditiesResourceTypeListResponse"))
+			else if (message.isType(CRC_CONSTANT("CommoditiesResourceTypeListResponse")))
 			{
 				Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 				const GenericValueTypeMessage<std::pair<std::string, AuctionManagerClient::ResourceTypeListServer> > msg (ri);
@@ -408,6 +408,8 @@ bool ClientWorld::TangibleNotification::positionChanged (Object& object, const b
 	{
 		ms_tangibleSphereTree.removeObject (object.getSpatialSubdivisionHandle ());
 		object.setSpatialSubdivisionHandle (ms_tangibleSphereTree.addObject (&object));
+
+		World::moveObject(&object, WOL_Tangible);
 	}
 
 	return true;
@@ -428,6 +430,8 @@ void ClientWorld::TangibleNotification::extentChanged (Object& object) const
 	{
 		ms_tangibleSphereTree.removeObject (object.getSpatialSubdivisionHandle ());
 		object.setSpatialSubdivisionHandle (ms_tangibleSphereTree.addObject (&object));
+
+		World::moveObject(&object, WOL_Tangible);
 	}
 }
 
@@ -486,6 +490,8 @@ bool ClientWorld::TangibleNotTargetableNotification::positionChanged (Object& ob
 	{
 		ms_tangibleNotTargetableSphereTree.removeObject (object.getSpatialSubdivisionHandle ());
 		object.setSpatialSubdivisionHandle (ms_tangibleNotTargetableSphereTree.addObject (&object));
+
+		World::moveObject(&object, WOL_TangibleNotTargetable);
 	}
 
 	return true;
@@ -506,6 +512,8 @@ void ClientWorld::TangibleNotTargetableNotification::extentChanged (Object& obje
 	{
 		ms_tangibleNotTargetableSphereTree.removeObject (object.getSpatialSubdivisionHandle ());
 		object.setSpatialSubdivisionHandle (ms_tangibleNotTargetableSphereTree.addObject (&object));
+
+		World::moveObject(&object, WOL_TangibleNotTargetable);
 	}
 }
 
@@ -580,6 +588,9 @@ void ClientWorld::TangibleFloraNotification::extentChanged (Object& object) cons
 {
 	ms_tangibleFloraSphereTree.removeObject (object.getSpatialSubdivisionHandle ());
 	object.setSpatialSubdivisionHandle (ms_tangibleFloraSphereTree.addObject (&object));
+
+	if (!object.isChildObject())
+		World::moveObject(&object, WOL_TangibleFlora);
 }
 
 // ======================================================================
@@ -618,6 +629,23 @@ void ClientWorld::IntangibleNotification::removeFromWorld(Object &object) const
 		World::removeObject(&object, WOL_Intangible);
 }
 
+// ----------------------------------------------------------------------
+
+bool ClientWorld::IntangibleNotification::positionChanged (Object& object, const bool /*dueToParentChange*/, const Vector& /*oldPosition*/) const
+{
+	if (!object.isChildObject())
+		World::moveObject(&object, WOL_Intangible);
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+bool ClientWorld::IntangibleNotification::positionAndRotationChanged (Object& object, const bool dueToParentChange, const Vector& oldPosition) const
+{
+	return positionChanged (object, dueToParentChange, oldPosition);
+}
+
 // ======================================================================
 // PUBLIC ClientWorld
 // ======================================================================
@@ -151,6 +151,9 @@ public:
 		virtual void addToWorld(Object &object) const;
 		virtual void removeFromWorld(Object &object) const;
 
+		virtual bool positionChanged (Object& object, bool dueToParentChange, const Vector& oldPosition) const;
+		virtual bool positionAndRotationChanged (Object& object, bool dueToParentChange, const Vector& oldPosition) const;
+
 	private:
 
 		IntangibleNotification(const IntangibleNotification &);
@@ -168,6 +171,8 @@ public:
 	using World::getConstObject;
 	using World::findClosestObjectTo;
 	using World::findClosestConstObjectTo;
+	using World::findClosestObjects;
+	using World::findObjectsInRange;
 	using World::isInstalled;
 	using World::getLotManager;
 	using World::queueObject;
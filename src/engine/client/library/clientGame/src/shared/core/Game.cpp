@@ -1123,6 +1123,9 @@ void Game::runGameLoopOnce(bool presentToWindow, HWND hwnd, int width, int heigh
 			AsynchronousLoader::processCallbacks();
 		}
 
+		NP_PROFILER_NAMED_AUTO_BLOCK_TRANSFER(profilerMainLoop, "MessageDispatch::dispatchPostedMessages");
+		MessageDispatch::dispatchPostedMessages();
+
 		// ----------------------------------------------------------------------------------------------------
 		// service the video manager - this has to be done several times per frame for Bink to work correctly.
 		VideoPlaybackManager::service();
@@ -1154,7 +1157,15 @@ void Game::runGameLoopOnce(bool presentToWindow, HWND hwnd, int width, int heigh
 
 		if (ms_networkTimer.updateZero(elapsedTime) || isSceneLoading())
 		{
+			// objects created by the same network update load together, in tree file order
+			bool const batchLoads = AsynchronousLoader::isEnabled();
+			if (batchLoads)
+				AsynchronousLoader::beginBatch();
+
 			GameNetwork::update();
+
+			if (batchLoads)
+				AsynchronousLoader::endBatch();
 		}
 
 		// ----------------------------------------------------------------------------------------------------
@@ -129,7 +129,7 @@ namespace PlanetMapManagerClientNamespace
 			{
 				PlanetMapManagerClient::clear();
 			}
-			else if(message.isType("GetSpecificMapLocationsResponseMessage"))
+			else if(message.isType(CRC_CONSTANT("GetSpecificMapLocationsResponseMessage")))
 			{
 				Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream ().begin ();
 				const GenericValueTypeMessage<std::vector<std::pair<std::string, MapLocation> > > msg(ri);
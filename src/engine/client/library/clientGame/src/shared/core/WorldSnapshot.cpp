@@ -1103,7 +1103,7 @@ Object* WorldSnapshot::addObject(
 		ms_reader.addObject(
 			networkIdInt+i+1,
 			networkIdInt,
-			ConstCharCrcString("object/cell/shared_cell.iff"),
+			CONST_CHAR_CRC_STRING("object/cell/shared_cell.iff"),
 			i+1,
 			Transform::identity,
 			0,
@@ -54,14 +54,14 @@ namespace
 		void receiveMessage(const MessageDispatch::Emitter & source, const MessageDispatch::MessageBase & message)
 		{
 			UNREF(source);
-			if (message.isType ("PlayClientEventObjectMessage"))
+			if (message.isType(CRC_CONSTANT("PlayClientEventObjectMessage")))
 			{
 				Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 
 				PlayClientEventObjectMessage pceom(ri);
 				ClientEventManager::playEvent(CrcLowerString(pceom.getEventName().c_str()), NetworkIdManager::getObjectById(pceom.getObjectId()), CrcLowerString(pceom.getHardpoint().c_str()));
 			}
-			else if (message.isType ("PlayClientEventLocMessage"))
+			else if (message.isType(CRC_CONSTANT("PlayClientEventLocMessage")))
 			{
 				Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 				PlayClientEventLocMessage pcelm(ri);
@@ -116,19 +116,19 @@ void ConnectionServerConnection::_onReceive(const Archive::ByteStream & message)
 	GameNetworkMessage m(ri);
 	ri = message.begin();
 
-	if(m.isType("ConnectionServerLagResponse"))
+	if(m.isType(CRC_CONSTANT("ConnectionServerLagResponse")))
 	{
 		m_pendingConnectionServerLagResponse = false;
 		m_connectionServerLag = Clock::timeMs() - m_lagRequestTime;
 		sendLagReport();
 	}
-	else if(m.isType("GameServerLagResponse"))
+	else if(m.isType(CRC_CONSTANT("GameServerLagResponse")))
 	{
 		m_pendingGameServerLagResponse = false;
 		m_gameServerLag = Clock::timeMs() - m_lagRequestTime;
 		sendLagReport();
 	}
-	else if(m.isType("LagRequest"))
+	else if(m.isType(CRC_CONSTANT("LagRequest")))
 	{
 		if(ConfigClientGame::getLagRequestDelay() == 0)
 		{
@@ -126,57 +126,57 @@ MessageDispatch::Receiver ()
 void GameNetwork::Listener::receiveMessage(const MessageDispatch::Emitter & , const MessageDispatch::MessageBase & message)
 {
 	NOT_NULL (s_instance);
-	if(message.isType("LoginConnectionOpened"))
+	if(message.isType(CRC_CONSTANT("LoginConnectionOpened")))
 	{
 		DEBUG_REPORT_LOG(true, ("Connection with Login Server established\n"));
 		Transceivers::loginServerConnectionChanged.emitMessage (true);
 	}
-	else if(message.isType("LoginConnectionClosed"))
+	else if(message.isType(CRC_CONSTANT("LoginConnectionClosed")))
 	{
 		s_instance->receiveLoginServerClosed ();
 	}
-	else if(message.isType("ConnectionServerConnectionOpened"))
+	else if(message.isType(CRC_CONSTANT("ConnectionServerConnectionOpened")))
 	{
 		s_instance->receiveConnectionServerConnectionOpened ();
 	}
-	else if(message.isType("ConnectionServerConnectionClosed"))
+	else if(message.isType(CRC_CONSTANT("ConnectionServerConnectionClosed")))
 	{
 		s_instance->receiveConnectionServerConnectionClosed ();
 	}
-	else if(message.isType("LoginClientToken"))
+	else if(message.isType(CRC_CONSTANT("LoginClientToken")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const LoginClientToken t(ri);
 		s_instance->receiveLoginClientToken (t);
 	}
-	else if(message.isType("SetSessionKey"))
+	else if(message.isType(CRC_CONSTANT("SetSessionKey")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const GenericValueTypeMessage<std::string> m(ri);
 		CuiLoginManager::setOverrideSessionIdKey(m.getValue());
 	}
-	else if(message.isType("LoginIncorrectClientId"))
+	else if(message.isType(CRC_CONSTANT("LoginIncorrectClientId")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const LoginIncorrectClientId msg(ri);
 		DEBUG_REPORT_LOG(true,("Client / server network version mismatch, client: %s server: %s\n", (GameNetworkMessage::NetworkVersionId).c_str(), msg.getServerId().c_str()));
 		s_instance->disconnectLoginServer ();
 	}
-	else if(message.isType("CmdStartScene"))
+	else if(message.isType(CRC_CONSTANT("CmdStartScene")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const CmdStartScene s(ri);
 		setServerEpochTimeDifference(static_cast<time_t>(s.getServerEpoch()));
 		s_instance->receiveCmdStartScene (s);
 	}
-	else if(message.isType("PlayCutSceneMessage"))
+	else if(message.isType(CRC_CONSTANT("PlayCutSceneMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const PlayCutSceneMessage s(ri);
 		const std::string &cutScene = s.getCutSceneName();
 		Game::playCutScene(cutScene.c_str(), true);
 	}
-	else if(message.isType("ObjControllerMessage"))
+	else if(message.isType(CRC_CONSTANT("ObjControllerMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		ObjControllerMessage c(ri);
@@ -184,64 +184,64 @@ void GameNetwork::Listener::receiveMessage(const MessageDispatch::Emitter & , co
 		s_instance->receiveObjControllerMessage (c);
 	}
 
-	else if (message.isType("ErrorMessage"))
+	else if (message.isType(CRC_CONSTANT("ErrorMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const ErrorMessage e(ri);
 		FATAL(e.getFatal(), ("Server Forced Fatal: %s : %s", e.getErrorName().c_str(), e.getDescription().c_str()));
 		DEBUG_REPORT_LOG(true,("%s: %s\n", e.getErrorName().c_str(), e.getDescription().c_str()));
 	}
-	else if (message.isType("ParametersMessage"))
+	else if (message.isType(CRC_CONSTANT("ParametersMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const ParametersMessage msg(ri);
 
 		s_instance->receiveParametersMessage (msg);
 	}
-	else if (message.isType("ServerNowEpochTime"))
+	else if (message.isType(CRC_CONSTANT("ServerNowEpochTime")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const GenericValueTypeMessage<int32> serverNowEpochTime(ri);
 
 		setServerEpochTimeDifference(static_cast<time_t>(serverNowEpochTime.getValue()));
 	}
-	else if (message.isType("CollectionServerFirstListResponse"))
+	else if (message.isType(CRC_CONSTANT("CollectionServerFirstListResponse")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const GenericValueTypeMessage<std::pair<std::string, std::set<std::pair<std::pair<int32, std::string>, std::pair<NetworkId, Unicode::String> > > > > collectionServerFirst(ri);
 		Game::responseCollectionServerFirstList(collectionServerFirst.getValue().first, collectionServerFirst.getValue().second);
 	}
-	else if (message.isType("CharacterChangedUnlocked"))
+	else if (message.isType(CRC_CONSTANT("CharacterChangedUnlocked")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		GenericValueTypeMessage<std::pair<std::string, NetworkId> > const characterChangedUnlocked(ri);
 		CuiLoginManager::characterChangedUnlocked(characterChangedUnlocked.getValue().first, characterChangedUnlocked.getValue().second);
 	}
-	else if (message.isType("CharacterChangedNormal"))
+	else if (message.isType(CRC_CONSTANT("CharacterChangedNormal")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		GenericValueTypeMessage<std::pair<std::string, NetworkId> > const characterChangedNormal(ri);
 		CuiLoginManager::characterChangedNormal(characterChangedNormal.getValue().first, characterChangedNormal.getValue().second);
 	}
-	else if (message.isType("CharacterNameChanged"))
+	else if (message.isType(CRC_CONSTANT("CharacterNameChanged")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		GenericValueTypeMessage<std::pair<std::pair<std::string, NetworkId>, Unicode::String> > const characterNameChanged(ri);
 		CuiLoginManager::characterNameChanged(characterNameChanged.getValue().first.first, characterNameChanged.getValue().first.second, characterNameChanged.getValue().second);
 	}
-	else if (message.isType("GcwRegionsRsp"))
+	else if (message.isType(CRC_CONSTANT("GcwRegionsRsp")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		GenericValueTypeMessage<std::map<std::string, std::map<std::string, std::pair<std::pair<float, float>, float> > > > const gcwRegionsRsp(ri);
 		s_gcwScoreCategoryRegions = gcwRegionsRsp.getValue();
 	}
-	else if (message.isType("GcwGroupsRsp"))
+	else if (message.isType(CRC_CONSTANT("GcwGroupsRsp")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		GenericValueTypeMessage<std::map<std::string, std::map<std::string, int> > > const gcwGroupsRsp(ri);
 		s_gcwScoreCategoryGroups = gcwGroupsRsp.getValue();
 	}
-	else if (message.isType("OpenExamineWindow"))
+	else if (message.isType(CRC_CONSTANT("OpenExamineWindow")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		GenericValueTypeMessage<NetworkId> const openExamineWindowMsg(ri);
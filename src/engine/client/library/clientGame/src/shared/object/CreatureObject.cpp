@@ -183,20 +183,20 @@ namespace CreatureObjectNamespace
 	const ConstCharCrcLowerString  cs_moodAnimationVariableName("mood");
 	const ConstCharCrcLowerString  cs_humanoidSkeletonTemplateName("appearance/skeleton/all_b.skt");
 	const ConstCharCrcLowerString  cs_ithorianSkeletonTemplateName("appearance/skeleton/ithorian.skt");
-	const ConstCharCrcString       cs_targetPitchJointName("spine3");
-	const ConstCharCrcString       cs_lookAtMasterJointName("neck");
-	const ConstCharCrcString       cs_lookAtSlaveJointName("head");
+	const ConstCharCrcString       cs_targetPitchJointName(CONST_CHAR_CRC_STRING("spine3"));
+	const ConstCharCrcString       cs_lookAtMasterJointName(CONST_CHAR_CRC_STRING("neck"));
+	const ConstCharCrcString       cs_lookAtSlaveJointName(CONST_CHAR_CRC_STRING("head"));
 
-	const ConstCharCrcString       cs_riderHardpointName("player");
-	const ConstCharCrcString       cs_droidHardpointName("astromech");
+	const ConstCharCrcString       cs_riderHardpointName(CONST_CHAR_CRC_STRING("player"));
+	const ConstCharCrcString       cs_droidHardpointName(CONST_CHAR_CRC_STRING("astromech"));
 
-	const ConstCharCrcString       cs_riderSlotName("rider");
+	const ConstCharCrcString       cs_riderSlotName(CONST_CHAR_CRC_STRING("rider"));
 
-	const ConstCharCrcString       cs_rootJointName("root");
-	const ConstCharCrcString       cs_spineJointName("spine1");
+	const ConstCharCrcString       cs_rootJointName(CONST_CHAR_CRC_STRING("root"));
+	const ConstCharCrcString       cs_spineJointName(CONST_CHAR_CRC_STRING("spine1"));
 
-	const ConstCharCrcString	   cs_humanFaceBoneJointName("face_root__hum_m_face");
-	const ConstCharCrcString       cs_ithFaceBoneJointName("face_root__ith_face");
+	const ConstCharCrcString	   cs_humanFaceBoneJointName(CONST_CHAR_CRC_STRING("face_root__hum_m_face"));
+	const ConstCharCrcString       cs_ithFaceBoneJointName(CONST_CHAR_CRC_STRING("face_root__ith_face"));
 
 
 	const float           cs_minimumScaleFactor            = 0.001f;
@@ -129,9 +129,9 @@ void WeaponObject::endBaselines ()
 	//-- apply any child objects
 #if 0
 	std::vector<int> fakeComponents;
-	fakeComponents.push_back (Crc::calculate ("stock_1"));
-	fakeComponents.push_back (Crc::calculate ("scope_sm_2"));
-	fakeComponents.push_back (Crc::calculate ("muzzle_sm_2"));
+	fakeComponents.push_back (CRC_CONSTANT("stock_1"));
+	fakeComponents.push_back (CRC_CONSTANT("scope_sm_2"));
+	fakeComponents.push_back (CRC_CONSTANT("muzzle_sm_2"));
 	ClientTangibleObjectTemplate::applyComponents (this, fakeComponents);
 #else
 	ClientTangibleObjectTemplate::applyComponents (this, getComponents ());
@@ -38,10 +38,10 @@ namespace StartTrailsActionNamespace
 {
 	const ConstCharCrcString cs_trailHardpointNames[] =
 		{
-			ConstCharCrcString("lankle"),
-			ConstCharCrcString("rankle"),
-			ConstCharCrcString("hold_l"),
-			ConstCharCrcString("hold_r")
+			CONST_CHAR_CRC_STRING("lankle"),
+			CONST_CHAR_CRC_STRING("rankle"),
+			CONST_CHAR_CRC_STRING("hold_l"),
+			CONST_CHAR_CRC_STRING("hold_r")
 		};
 	const int cs_trailEntryCount = static_cast<int>(sizeof(cs_trailHardpointNames) / sizeof(cs_trailHardpointNames[0]));
 
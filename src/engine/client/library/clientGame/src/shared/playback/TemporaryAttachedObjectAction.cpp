@@ -29,8 +29,8 @@ namespace TemporaryAttachedObjectActionNamespace
 {
 	const Tag TAG_AWPN = TAG(A,W,P,N);
 
-	const ConstCharCrcString cs_holdLeftHardpointName("hold_l");
-	const ConstCharCrcString cs_holdRightHardpointName("hold_r");
+	const ConstCharCrcString cs_holdLeftHardpointName(CONST_CHAR_CRC_STRING("hold_l"));
+	const ConstCharCrcString cs_holdRightHardpointName(CONST_CHAR_CRC_STRING("hold_r"));
 
 	std::string  s_temporaryString;
 }
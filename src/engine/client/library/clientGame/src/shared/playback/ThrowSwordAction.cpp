@@ -492,7 +492,7 @@ bool ThrowSwordAction::initializeScriptData(PlaybackScript &script)
 	// Create a target hardpoint object that aims at "root" --- all skeletal-based appearances should have this joint.
 	// If it so happens that the target is not a skeletal appearance, the hardpoint object should act just like
 	// a pass through to the base of the defender.  This should be acceptable fallback behavior.
-	m_defenderChildWatcher = new HardpointObject(ConstCharCrcString("root"));
+	m_defenderChildWatcher = new HardpointObject(CONST_CHAR_CRC_STRING("root"));
 	NOT_NULL(m_defenderChildWatcher.getPointer());
 
 	defenderObject->addChildObject_o(m_defenderChildWatcher.getPointer());
@@ -2402,7 +2402,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 		++ms_receivedMessageMap[NON_NULL(gnm)->getType()];
 #endif
 
-	if(message.isType("SceneCreateObjectByName") || message.isType("SceneCreateObjectByCrc"))
+	if(message.isType(CRC_CONSTANT("SceneCreateObjectByName")) || message.isType(CRC_CONSTANT("SceneCreateObjectByCrc")))
 	{
 #if PRODUCTION == 0
 		++ms_createObjectCountPerFrame;
@@ -2415,7 +2415,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 		char          objectTemplateName[Os::MAX_PATH_LENGTH];
 		bool          hyperspace = false;
 
-		if (message.isType("SceneCreateObjectByName"))
+		if (message.isType(CRC_CONSTANT("SceneCreateObjectByName")))
 		{
 			const SceneCreateObjectByName o(ri);
 
@@ -2569,7 +2569,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("SceneDestroyObject"))
+	else if(message.isType(CRC_CONSTANT("SceneDestroyObject")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const SceneDestroyObject o(ri);
@@ -2682,7 +2682,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("UpdateContainmentMessage"))
+	else if(message.isType(CRC_CONSTANT("UpdateContainmentMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const UpdateContainmentMessage o(ri);
@@ -2772,7 +2772,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("CmdSceneReady"))
+	else if(message.isType(CRC_CONSTANT("CmdSceneReady")))
 	{
 		CreatureObject *player = dynamic_cast<CreatureObject *>(getPlayer());
 		NOT_NULL(player);
@@ -2790,7 +2790,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("UpdateCellPermissionMessage"))
+	else if(message.isType(CRC_CONSTANT("UpdateCellPermissionMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const UpdateCellPermissionMessage updateCellPermissionMessage(ri);
@@ -2801,7 +2801,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("SceneEndBaselines"))
+	else if(message.isType(CRC_CONSTANT("SceneEndBaselines")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const SceneEndBaselines o(ri);
@@ -2813,7 +2813,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("ServerTimeMessage"))
+	else if(message.isType(CRC_CONSTANT("ServerTimeMessage")))
 	{
 		//-- see if the terrain exists
 		TerrainObject* const terrainObject = TerrainObject::getInstance ();
@@ -2873,7 +2873,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("BaselinesMessage"))
+	else if(message.isType(CRC_CONSTANT("BaselinesMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const BaselinesMessage bm(ri);
@@ -2884,7 +2884,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("DeltasMessage"))
+	else if(message.isType(CRC_CONSTANT("DeltasMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const DeltasMessage dm(ri);
@@ -2898,7 +2898,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 		}
 	}
 
-	else if (message.isType("UpdateTransformMessage"))
+	else if (message.isType(CRC_CONSTANT("UpdateTransformMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const UpdateTransformMessage utm(ri);
@@ -2941,7 +2941,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 		}
 	}
 	//----------------------------------------------------------------------
-	else if (message.isType("UpdateTransformWithParentMessage"))
+	else if (message.isType(CRC_CONSTANT("UpdateTransformWithParentMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const UpdateTransformWithParentMessage utm(ri);
@@ -2977,7 +2977,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 	}
 	//----------------------------------------------------------------------
 
-	else if (message.isType("PlayMusicMessage"))
+	else if (message.isType(CRC_CONSTANT("PlayMusicMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		PlayMusicMessage const msg(ri);
@@ -2990,7 +2990,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if (message.isType("ClientOpenContainerMessage"))
+	else if (message.isType(CRC_CONSTANT("ClientOpenContainerMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		ClientOpenContainerMessage msg(ri);
@@ -3019,7 +3019,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if (message.isType("LogoutMessage"))
+	else if (message.isType(CRC_CONSTANT("LogoutMessage")))
 	{
 		// send to character select
 		CuiLoginManager::disconnectFromCluster();
@@ -3028,7 +3028,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	// ----------------------------------------------------------------------
 
-	else if (message.isType("DebugTransformMessage"))
+	else if (message.isType(CRC_CONSTANT("DebugTransformMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		DebugTransformMessage const debugTransformMessage(ri);
@@ -3109,7 +3109,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("CreateProjectileMessage"))
+	else if(message.isType(CRC_CONSTANT("CreateProjectileMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		CreateProjectileMessage const createProjectileMessage(ri);
@@ -3158,7 +3158,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("CreateMissileMessage"))
+	else if(message.isType(CRC_CONSTANT("CreateMissileMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		CreateMissileMessage cmm(ri);
@@ -3182,7 +3182,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if(message.isType("UpdateMissileMessage"))
+	else if(message.isType(CRC_CONSTANT("UpdateMissileMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		UpdateMissileMessage umm(ri);
@@ -3212,7 +3212,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if (message.isType("ShipUpdateTransformMessage"))
+	else if (message.isType(CRC_CONSTANT("ShipUpdateTransformMessage")))
 	{
 		Archive::ReadIterator readIterator = NON_NULL(gnm)->getByteStream().begin();
 		ShipUpdateTransformMessage const shipUpdateTransformMessage(readIterator);
@@ -3272,7 +3272,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if (message.isType("ShipUpdateTransformCollisionMessage"))
+	else if (message.isType(CRC_CONSTANT("ShipUpdateTransformCollisionMessage")))
 	{
 		Archive::ReadIterator readIterator = NON_NULL(gnm)->getByteStream().begin();
 		ShipUpdateTransformCollisionMessage const shipUpdateTransformCollisionMessage(readIterator);
@@ -3294,7 +3294,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	//----------------------------------------------------------------------
 
-	else if (message.isType("CommPlayerMessage"))
+	else if (message.isType(CRC_CONSTANT("CommPlayerMessage")))
 	{
 		Archive::ReadIterator readIterator = NON_NULL(gnm)->getByteStream().begin();
 		GenericValueTypeMessage<std::pair<bool, std::pair<NetworkId, std::pair<Unicode::String, std::pair<uint32, std::pair<std::string, float> > > > > > tauntMessage(readIterator);
@@ -3332,7 +3332,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 			IGNORE_RETURN(CuiActionManager::performAction(CuiActions::commPlayer, actionParams));
 	}
 
-	else if(message.isType("HyperspaceMessage"))
+	else if(message.isType(CRC_CONSTANT("HyperspaceMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		HyperspaceMessage const hyperspaceMessage(ri);
@@ -3346,7 +3346,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 
 	// ----------------------------------------------------------------------
 
-	else if (message.isType("IsFlattenedTheaterMessage"))
+	else if (message.isType(CRC_CONSTANT("IsFlattenedTheaterMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const GenericValueTypeMessage<std::pair<NetworkId, bool> > isFlattenedTheaterMessage(ri);
@@ -3358,7 +3358,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 	}
 	//----------------------------------------------------------------------
 
-	else if(message.isType("AiDebugString"))
+	else if(message.isType(CRC_CONSTANT("AiDebugString")))
 	{
 #ifdef _DEBUG
 		Archive::ReadIterator readIterator = NON_NULL (gnm)->getByteStream().begin();
@@ -3369,7 +3369,7 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 		AiDebugStringManager::add(genericMessage.getValue().first, genericMessage.getValue().second);
 #endif // _DEBUG
 	}
-	else if (message.isType("SaveTextOnClient"))
+	else if (message.isType(CRC_CONSTANT("SaveTextOnClient")))
 	{
 #if PRODUCTION == 0
 		Archive::ReadIterator readIterator = NON_NULL (gnm)->getByteStream().begin();
@@ -3428,19 +3428,19 @@ void GroundScene::receiveMessage(const MessageDispatch::Emitter &, const Message
 			}
 		}
 	}
-	else if (message.isType("LaunchBrowserMessage"))
+	else if (message.isType(CRC_CONSTANT("LaunchBrowserMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const GenericValueTypeMessage<std::string> message(ri);
 		Os::launchBrowser(message.getValue());
 	}
-	else if (message.isType("SetCommandCooldown"))
+	else if (message.isType(CRC_CONSTANT("SetCommandCooldown")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const GenericValueTypeMessage<std::pair<uint32, std::pair<uint32, uint32> > > message(ri);
 		ClientCommandQueue::setCommandCooldown(message.getValue().first, message.getValue().second.first, message.getValue().second.second);
 	}
-	else if (message.isType("fca11a62d23041008a4f0df36aa7dca6"))
+	else if (message.isType(CRC_CONSTANT("fca11a62d23041008a4f0df36aa7dca6")))
 	{
 		Archive::ReadIterator ri = NON_NULL (gnm)->getByteStream().begin();
 		const GenericValueTypeMessage<float> message(ri);
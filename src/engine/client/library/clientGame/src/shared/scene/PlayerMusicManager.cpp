@@ -400,7 +400,7 @@ void PlayerMusicManager::install()
 		dataTable.load(performanceIff);
 
 		int const rowCount = dataTable.getNumRows();
-		int const musicHash = static_cast<int>(Crc::calculate("music"));
+		int const musicHash = static_cast<int>(CRC_CONSTANT("music"));
 
 		for (int index = 0; index < rowCount; ++index)
 		{
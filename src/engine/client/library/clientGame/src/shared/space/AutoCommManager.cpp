@@ -29,7 +29,7 @@ namespace AutoCommManagerNamespace
 	bool s_inTrigger = false;
 	Timer s_checkTimer(1.0f);
 	float const cs_triggerRadius = 100.0f;
-	uint32 const s_commCommand = Crc::calculate("comm");
+	uint32 const s_commCommand = CRC_CONSTANT("comm");
 
 	//----------------------------------------------------------------------
 
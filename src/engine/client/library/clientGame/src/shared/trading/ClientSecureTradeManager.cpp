@@ -356,7 +356,7 @@ void ClientSecureTradeManager::abortTrade()
 void ClientSecureTradeManager::TestReceiver::receiveMessage(const MessageDispatch::Emitter &, const MessageDispatch::MessageBase & message)
 {
 //	DEBUG_REPORT_LOG(true, ("Secure Trade, received message %d\n", message.getType()));
-	if(message.isType("BeginTradeMessage"))
+	if(message.isType(CRC_CONSTANT("BeginTradeMessage")))
     {
 		//Upon receipt of this message, the client should uncheck all ok boxes if a trade is in progress
 		//or launch a new trade window if there is none in progress
@@ -365,12 +365,12 @@ void ClientSecureTradeManager::TestReceiver::receiveMessage(const MessageDispatc
 
 		onBeginTrade (msg.getPlayerId ());
 	}
-	else if (message.isType("AbortTradeMessage"))
+	else if (message.isType(CRC_CONSTANT("AbortTradeMessage")))
 	{
 		//Kill any trade in progress
 		onAbortTrade ();
 	}
-	else if (message.isType("AddItemMessage"))
+	else if (message.isType(CRC_CONSTANT("AddItemMessage")))
 	{
 		//Add object to the other player's window
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
@@ -379,7 +379,7 @@ void ClientSecureTradeManager::TestReceiver::receiveMessage(const MessageDispatc
 		onAddItem (msg.getNetworkId ());
 
 	}
-	else if (message.isType("RemoveItemMessage"))
+	else if (message.isType(CRC_CONSTANT("RemoveItemMessage")))
 	{
 		//Remove object from other player's window
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
@@ -387,7 +387,7 @@ void ClientSecureTradeManager::TestReceiver::receiveMessage(const MessageDispatc
 
 		onRemoveItem (msg.getNetworkId ());
 	}
-	else if (message.isType("GiveMoneyMessage"))
+	else if (message.isType(CRC_CONSTANT("GiveMoneyMessage")))
 	{
 		//Change money control to reflect other player giving you money
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
@@ -395,32 +395,32 @@ void ClientSecureTradeManager::TestReceiver::receiveMessage(const MessageDispatc
 
 		onGiveMoney (msg.getAmount ());
 	}
-	else if (message.isType("TradeCompleteMessage"))
+	else if (message.isType(CRC_CONSTANT("TradeCompleteMessage")))
 	{
 		//Trade is done, close the window
 		onTradeComplete ();
 	}
-	else if (message.isType("AcceptTransactionMessage"))
+	else if (message.isType(CRC_CONSTANT("AcceptTransactionMessage")))
 	{
 		//Check the other person's accepted box
 		onAcceptTrade (true);
 	}
-	else if (message.isType("UnAcceptTransactionMessage"))
+	else if (message.isType(CRC_CONSTANT("UnAcceptTransactionMessage")))
 	{
 		//Uncheck the other person's accepted box
 		onAcceptTrade (false);
 	}
-	else if (message.isType("VerifyTradeMessage"))
+	else if (message.isType(CRC_CONSTANT("VerifyTradeMessage")))
 	{
 		//Other person has ok'd the trade.  Do nothing?
 		onVerifyTrade ();
 	}
-	else if (message.isType("DenyTradeMessage"))
+	else if (message.isType(CRC_CONSTANT("DenyTradeMessage")))
 	{
 		//Other person has denied the trade.  Do nothing? (You will get begin trade message)
 		onDenyTrade ();
 	}
-	else if (message.isType("BeginVerificationMessage"))
+	else if (message.isType(CRC_CONSTANT("BeginVerificationMessage")))
 	{
 		//Let's you know both parties have checked the accept boxes.
 		onRequestVerification ();
@@ -149,7 +149,7 @@ const InteriorEnvironmentBlock* InteriorEnvironmentBlockManager::getEnvironmentB
 	}
 #endif
 
-	ConstCharCrcString name ("default_default");
+	ConstCharCrcString name(CONST_CHAR_CRC_STRING("default_default"));
 	EnvironmentBlockMap::iterator iter = ms_environmentBlockMap->find (&name);
 	if (iter != ms_environmentBlockMap->end ())
 		return iter->second;
@@ -26,15 +26,15 @@ void CuiCraftManagerSimulator::startCrafting ()
 {
 	MessageQueueDraftSchematics msg (CuiCraftManager::Ids::craftingToolPending, NetworkId::cms_invalid);
 	
-	msg.addSchematic (std::make_pair(Crc::calculate("type 1"), Crc::calculate("shared_type 1")), 1);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 2"), Crc::calculate("shared_type 2")), 1);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 3"), Crc::calculate("shared_type 3")), 1);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 10"), Crc::calculate("shared_type 10")), 2);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 20"), Crc::calculate("shared_type 20")), 2);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 30"), Crc::calculate("shared_type 30")), 2);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 100"), Crc::calculate("shared_type 100")), 3);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 200"), Crc::calculate("shared_type 200")), 3);
-	msg.addSchematic (std::make_pair(Crc::calculate("type 300"), Crc::calculate("shared_type 300")), 3);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 1"), CRC_CONSTANT("shared_type 1")), 1);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 2"), CRC_CONSTANT("shared_type 2")), 1);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 3"), CRC_CONSTANT("shared_type 3")), 1);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 10"), CRC_CONSTANT("shared_type 10")), 2);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 20"), CRC_CONSTANT("shared_type 20")), 2);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 30"), CRC_CONSTANT("shared_type 30")), 2);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 100"), CRC_CONSTANT("shared_type 100")), 3);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 200"), CRC_CONSTANT("shared_type 200")), 3);
+	msg.addSchematic (std::make_pair(CRC_CONSTANT("type 300"), CRC_CONSTANT("shared_type 300")), 3);
 	
 	CuiCraftManager::receiveDraftSchematics (msg);
 }
@@ -127,27 +127,27 @@ void CuiCraftManagerSimulator::onGetSchematics (CuiCraftManager::SchematicVector
 {
 	static const std::pair<uint32, uint32> test_schems [] =
 	{
-		std::make_pair(Crc::calculate("object/draft_schematic/armor/armor_module_heavy.iff"), Crc::calculate("object/draft_schematic/armor/shared_armor_module_heavy.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/armor/armor_module_light.iff"), Crc::calculate("object/draft_schematic/armor/shared_armor_module_light.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/chemistry/medpack_wound_stamina.iff"), Crc::calculate("object/draft_schematic/chemistry/shared_medpack_wound_stamina.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/chemistry/medpack_wound_strength.iff"), Crc::calculate("object/draft_schematic/chemistry/shared_medpack_wound_strength.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/chemistry/stimpack_sm_s1.iff"), Crc::calculate("object/draft_schematic/chemistry/shared_stimpack_sm_s1.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/clothing/clothing_armor_bone_bicep_l.iff"), Crc::calculate("object/draft_schematic/clothing/shared_clothing_armor_bone_bicep_l.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/clothing/clothing_armor_tantel_chest.iff"), Crc::calculate("object/draft_schematic/clothing/shared_clothing_armor_tantel_chest.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/clothing/clothing_armor_tantel_helmet.iff"), Crc::calculate("object/draft_schematic/clothing/shared_clothing_armor_tantel_helmet.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/clothing/clothing_vest_field.iff"), Crc::calculate("object/draft_schematic/clothing/shared_clothing_vest_field.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/clothing/clothing_vest_formal.iff"), Crc::calculate("object/draft_schematic/clothing/shared_clothing_vest_formal.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/axe.iff"), Crc::calculate("object/draft_schematic/weapon/shared_axe.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/axe_vibro.iff"), Crc::calculate("object/draft_schematic/weapon/shared_axe_vibro.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/blaster_cannon.iff"), Crc::calculate("object/draft_schematic/weapon/shared_blaster_cannon.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/pistol_blaster_short_range_combat.iff"), Crc::calculate("object/draft_schematic/weapon/shared_pistol_blaster_short_range_combat.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/pistol_disrupter_dx2.iff"), Crc::calculate("object/draft_schematic/weapon/shared_pistol_disrupter_dx2.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/pistol_flechette_fwg5.iff"), Crc::calculate("object/draft_schematic/weapon/shared_pistol_flechette_fwg5.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/rifle_spray_stick_stohli.iff"), Crc::calculate("object/draft_schematic/weapon/shared_rifle_spray_stick_stohli.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/rifle_tangle_gun7.iff"), Crc::calculate("object/draft_schematic/weapon/shared_rifle_tangle_gun7.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/staff.iff"), Crc::calculate("object/draft_schematic/weapon/shared_staff.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/sword.iff"), Crc::calculate("object/draft_schematic/weapon/shared_sword.iff")),
-		std::make_pair(Crc::calculate("object/draft_schematic/weapon/sword_ryyk_blade.iff"), Crc::calculate("object/draft_schematic/weapon/shared_sword_ryyk_blade.iff"))
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/armor/armor_module_heavy.iff"), CRC_CONSTANT("object/draft_schematic/armor/shared_armor_module_heavy.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/armor/armor_module_light.iff"), CRC_CONSTANT("object/draft_schematic/armor/shared_armor_module_light.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/chemistry/medpack_wound_stamina.iff"), CRC_CONSTANT("object/draft_schematic/chemistry/shared_medpack_wound_stamina.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/chemistry/medpack_wound_strength.iff"), CRC_CONSTANT("object/draft_schematic/chemistry/shared_medpack_wound_strength.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/chemistry/stimpack_sm_s1.iff"), CRC_CONSTANT("object/draft_schematic/chemistry/shared_stimpack_sm_s1.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/clothing/clothing_armor_bone_bicep_l.iff"), CRC_CONSTANT("object/draft_schematic/clothing/shared_clothing_armor_bone_bicep_l.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/clothing/clothing_armor_tantel_chest.iff"), CRC_CONSTANT("object/draft_schematic/clothing/shared_clothing_armor_tantel_chest.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/clothing/clothing_armor_tantel_helmet.iff"), CRC_CONSTANT("object/draft_schematic/clothing/shared_clothing_armor_tantel_helmet.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/clothing/clothing_vest_field.iff"), CRC_CONSTANT("object/draft_schematic/clothing/shared_clothing_vest_field.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/clothing/clothing_vest_formal.iff"), CRC_CONSTANT("object/draft_schematic/clothing/shared_clothing_vest_formal.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/axe.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_axe.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/axe_vibro.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_axe_vibro.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/blaster_cannon.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_blaster_cannon.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/pistol_blaster_short_range_combat.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_pistol_blaster_short_range_combat.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/pistol_disrupter_dx2.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_pistol_disrupter_dx2.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/pistol_flechette_fwg5.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_pistol_flechette_fwg5.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/rifle_spray_stick_stohli.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_rifle_spray_stick_stohli.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/rifle_tangle_gun7.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_rifle_tangle_gun7.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/staff.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_staff.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/sword.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_sword.iff")),
+		std::make_pair(CRC_CONSTANT("object/draft_schematic/weapon/sword_ryyk_blade.iff"), CRC_CONSTANT("object/draft_schematic/weapon/shared_sword_ryyk_blade.iff"))
 	};
 	
 	const int num_schems = sizeof (test_schems) / sizeof (test_schems [0]);
@@ -65,7 +65,7 @@ namespace CuiDataDrivenPageManagerNamespace
 				SuiCreatePageMessage scp(ri);
 				CuiDataDrivenPageManager::receiveCreatePageMessage(scp);
 			}
-			else if (message.isType ("SuiForceClosePage"))
+			else if (message.isType(CRC_CONSTANT("SuiForceClosePage")))
 			{
 				Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 				SuiForceClosePage sfcp(ri);
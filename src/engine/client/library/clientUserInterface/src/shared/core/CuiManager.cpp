@@ -250,7 +250,7 @@ namespace
 	//----------------------------------------------------------------------
 	void NetworkStatusManager::receiveMessage (const MessageDispatch::Emitter & , const MessageDispatch::MessageBase & message)
 	{
-		if (message.isType ("ErrorMessage"))
+		if (message.isType(CRC_CONSTANT("ErrorMessage")))
 		{
 			if (m_box)
 				m_box->closeMessageBox ();
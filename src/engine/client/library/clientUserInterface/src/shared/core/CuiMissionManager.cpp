@@ -165,7 +165,7 @@ namespace CuiMissionManagerNamespace
 
 			}
 
-			if (message.isType("PopulateMissionBrowserMessage"))
+			if (message.isType(CRC_CONSTANT("PopulateMissionBrowserMessage")))
 			{
 				Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();				
 				const PopulateMissionBrowserMessage msg (ri);
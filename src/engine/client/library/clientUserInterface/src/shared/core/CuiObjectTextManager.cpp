@@ -1152,7 +1152,7 @@ void CuiObjectTextManager::computeBestFitBoxExtent (const Object & foundObject,
 	if (skelApp)
 	{
 		const Skeleton * const skeleton = skelApp->getDisplayLodSkeleton ();
-		static const ConstCharCrcString s_head ("head");
+		static const ConstCharCrcString s_head(CONST_CHAR_CRC_STRING("head"));
 		const Transform * const headTransform = (skeleton ? skeleton->findTransform (s_head) : 0);
 		if (headTransform)
 		{
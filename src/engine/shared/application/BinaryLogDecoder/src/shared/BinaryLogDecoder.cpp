@@ -0,0 +1,305 @@
+// ======================================================================
+//
+// BinaryLogDecoder.cpp
+//
+// copyright 2002 Sony Online Entertainment
+//
+// ======================================================================
+
+#include "FirstBinaryLogDecoder.h"
+#include "BinaryLogDecoder.h"
+
+#include "sharedDebug/SetupSharedDebug.h"
+#include "sharedFoundation/SetupSharedFoundation.h"
+#include "sharedLog/BinaryLogObserver.h"
+#include "sharedLog/DeferredLogFormat.h"
+#include "sharedThread/SetupSharedThread.h"
+#include "UnicodeUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ======================================================================
+
+namespace BinaryLogDecoderNamespace
+{
+	typedef std::vector<std::string> StringList;
+
+	int        ms_argc;
+	char **    ms_argv;
+	StringList ms_channels;
+	StringList ms_procIds;
+
+	void usage();
+	bool isWanted(std::string const &procId, std::string const &channel);
+	bool getString(StringList const &strings, uint32 id, std::string const *&value);
+	bool decodeFile(char const *fileName);
+	void run();
+}
+
+using namespace BinaryLogDecoderNamespace;
+
+// ======================================================================
+
+void BinaryLogDecoderNamespace::usage()
+{
+	fprintf(stderr, "usage: BinaryLogDecoder [-c channel] [-p procId] file...\n");
+	fprintf(stderr, "  Writes the messages in binary log files to stdout in the text log format.\n");
+	fprintf(stderr, "  -c channel  only messages on this channel; may be repeated\n");
+	fprintf(stderr, "  -p procId   only messages from this process identifier; may be repeated\n");
+}
+
+// ----------------------------------------------------------------------
+
+bool BinaryLogDecoderNamespace::isWanted(std::string const &procId, std::string const &channel)
+{
+	bool channelWanted = ms_channels.empty();
+	for (StringList::const_iterator i = ms_channels.begin(); !channelWanted && i != ms_channels.end(); ++i)
+		channelWanted = (*i == channel);
+
+	bool procIdWanted = ms_procIds.empty();
+	for (StringList::const_iterator j = ms_procIds.begin(); !procIdWanted && j != ms_procIds.end(); ++j)
+		procIdWanted = (*j == procId);
+
+	return channelWanted && procIdWanted;
+}
+
+// ----------------------------------------------------------------------
+
+bool BinaryLogDecoderNamespace::getString(StringList const &strings, uint32 id, std::string const *&value)
+{
+	if (id == 0 || id >= strings.size())
+		return false;
+
+	value = &strings[id];
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+bool BinaryLogDecoderNamespace::decodeFile(char const *fileName)
+{
+	FILE * const file = fopen(fileName, "rb");
+	if (!file)
+	{
+		fprintf(stderr, "%s: could not open\n", fileName);
+		return false;
+	}
+
+	// record lengths are checked against what is left of the file before anything is allocated
+	long fileSize = 0;
+	if (fseek(file, 0, SEEK_END) == 0)
+		fileSize = ftell(file);
+	if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0)
+	{
+		fprintf(stderr, "%s: could not determine size\n", fileName);
+		IGNORE_RETURN(fclose(file));
+		return false;
+	}
+
+	bool result = true;
+	bool sawFileHeader = false;
+	int messages = 0;
+	int offset = 0;
+
+	StringList strings;
+	std::vector<char> payload;
+	std::string text;
+
+	BinaryLogObserver::RecordHeader header;
+	while (fread(&header, sizeof(header), 1, file) == 1)
+	{
+		long const remaining = fileSize - offset - static_cast<long>(sizeof(header));
+		if (static_cast<unsigned long>(header.length) > static_cast<unsigned long>(remaining))
+		{
+			fprintf(stderr, "%s: truncated record at offset %d\n", fileName, offset);
+			result = false;
+			break;
+		}
+
+		payload.resize(header.length);
+		if (header.length && fread(&payload[0], header.length, 1, file) != 1)
+		{
+			fprintf(stderr, "%s: truncated record at offset %d\n", fileName, offset);
+			result = false;
+			break;
+		}
+
+		char const * const data = header.length ? &payload[0] : 0;
+
+		if (!sawFileHeader && header.type != BinaryLogObserver::RT_fileHeader)
+		{
+			fprintf(stderr, "%s: not a binary log file\n", fileName);
+			result = false;
+			break;
+		}
+
+		switch (header.type)
+		{
+		case BinaryLogObserver::RT_fileHeader:
+			{
+				BinaryLogObserver::FileHeader fileHeader;
+				if (header.length < sizeof(fileHeader))
+				{
+					fprintf(stderr, "%s: bad file header at offset %d\n", fileName, offset);
+					result = false;
+					break;
+				}
+
+				memcpy(&fileHeader, data, sizeof(fileHeader));
+				if (memcmp(fileHeader.magic, BinaryLogObserver::getMagic(), sizeof(fileHeader.magic)) != 0 || fileHeader.version != BinaryLogObserver::cms_version)
+				{
+					fprintf(stderr, "%s: unsupported file header at offset %d\n", fileName, offset);
+					result = false;
+					break;
+				}
+
+				// ids start over with every writer that appended to the file
+				sawFileHeader = true;
+				strings.clear();
+				strings.push_back(std::string());
+			}
+			break;
+
+		case BinaryLogObserver::RT_string:
+			{
+				uint32 id = 0;
+				if (header.length < sizeof(id))
+				{
+					fprintf(stderr, "%s: bad string record at offset %d\n", fileName, offset);
+					result = false;
+					break;
+				}
+
+				memcpy(&id, data, sizeof(id));
+				if (id >= strings.size())
+					strings.resize(id + 1);
+				strings[id].assign(data + sizeof(id), header.length - sizeof(id));
+			}
+			break;
+
+		case BinaryLogObserver::RT_message:
+			{
+				BinaryLogObserver::MessageRecord record;
+				if (header.length < sizeof(record))
+				{
+					fprintf(stderr, "%s: bad message record at offset %d\n", fileName, offset);
+					result = false;
+					break;
+				}
+
+				memcpy(&record, data, sizeof(record));
+
+				std::string const *procId = 0;
+				std::string const *channel = 0;
+				std::string const *format = 0;
+				uint32 const unicodeAttachBytes = record.unicodeAttachLength * sizeof(Unicode::unicode_char_t);
+				if (!getString(strings, record.procIdId, procId) || !getString(strings, record.channelId, channel) || !getString(strings, record.formatId, format) || sizeof(record) + record.packedArgumentsLength + unicodeAttachBytes > header.length)
+				{
+					fprintf(stderr, "%s: bad message record at offset %d\n", fileName, offset);
+					result = false;
+					break;
+				}
+
+				++messages;
+				if (!isWanted(*procId, *channel))
+					break;
+
+				char const * const packedArguments = data + sizeof(record);
+				if (!DeferredLogFormat::format(format->c_str(), packedArguments, static_cast<int>(record.packedArgumentsLength), text))
+					fprintf(stderr, "%s: arguments don't match format \"%s\" at offset %d\n", fileName, format->c_str(), offset);
+
+				printf(UINT64_FORMAT_SPECIFIER ":%s:%s:%s", record.timestamp, procId->c_str(), channel->c_str(), text.c_str());
+				if (unicodeAttachBytes)
+				{
+					Unicode::String unicodeAttach(record.unicodeAttachLength, 0);
+					memcpy(&unicodeAttach[0], packedArguments + record.packedArgumentsLength, unicodeAttachBytes);
+					printf(":%s", Unicode::wideToNarrow(unicodeAttach).c_str());
+				}
+				printf("\n");
+			}
+			break;
+
+		default:
+			// newer record types are skipped
+			break;
+		}
+
+		if (!result)
+			break;
+
+		offset += static_cast<int>(sizeof(header) + header.length);
+	}
+
+	IGNORE_RETURN(fclose(file));
+
+	if (!sawFileHeader && result)
+	{
+		fprintf(stderr, "%s: empty\n", fileName);
+		result = false;
+	}
+
+	fprintf(stderr, "%s: %d messages\n", fileName, messages);
+	return result;
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogDecoderNamespace::run()
+{
+	std::vector<char const *> fileNames;
+
+	for (int i = 1; i < ms_argc; ++i)
+	{
+		if ((strcmp(ms_argv[i], "-c") == 0 || strcmp(ms_argv[i], "-p") == 0) && i + 1 < ms_argc)
+		{
+			StringList &list = (ms_argv[i][1] == 'c') ? ms_channels : ms_procIds;
+			list.push_back(ms_argv[++i]);
+		}
+		else if (ms_argv[i][0] == '-')
+		{
+			usage();
+			return;
+		}
+		else
+			fileNames.push_back(ms_argv[i]);
+	}
+
+	if (fileNames.empty())
+	{
+		usage();
+		return;
+	}
+
+	for (std::vector<char const *>::const_iterator f = fileNames.begin(); f != fileNames.end(); ++f)
+		IGNORE_RETURN(decodeFile(*f));
+}
+
+// ======================================================================
+
+int main(int argc, char **argv)
+{
+	//-- thread
+	SetupSharedThread::install();
+
+	//-- debug
+	SetupSharedDebug::install(4096);
+
+	{
+		SetupSharedFoundation::Data data(SetupSharedFoundation::Data::D_console);
+		SetupSharedFoundation::install(data);
+	}
+
+	ms_argc = argc;
+	ms_argv = argv;
+
+	SetupSharedFoundation::callbackWithExceptionHandling(run);
+	SetupSharedFoundation::remove();
+	SetupSharedThread::remove();
+
+	return 0;
+}
+
+// ======================================================================
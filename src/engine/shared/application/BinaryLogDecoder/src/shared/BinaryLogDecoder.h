@@ -0,0 +1,18 @@
+// ======================================================================
+//
+// BinaryLogDecoder.h
+//
+// copyright 2002 Sony Online Entertainment
+//
+// ======================================================================
+
+#ifndef INCLUDED_BinaryLogDecoder_H
+#define INCLUDED_BinaryLogDecoder_H
+
+// ======================================================================
+
+int main(int argc, char **argv);
+
+// ======================================================================
+
+#endif
@@ -0,0 +1 @@
+#include "FirstBinaryLogDecoder.h"
@@ -0,0 +1 @@
+#include "sharedFoundation/FirstSharedFoundation.h"
@@ -94,12 +94,12 @@ void LoginConnection::onReceive( const Archive::ByteStream &message )
 
 	m_clusterSelectionDlg->setStatusText( "" );
 
-	if ( m.isType( "LoginEnumCluster" ) )
+	if ( m.isType(CRC_CONSTANT("LoginEnumCluster")) )
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&m))->getByteStream ().begin ();
 		m_clusterSelectionDlg->onLoginMessage( LoginEnumCluster( ri ) );
 	}
-	else if ( m.isType( "LoginClusterStatus" ) )
+	else if ( m.isType(CRC_CONSTANT("LoginClusterStatus")) )
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&m))->getByteStream ().begin ();
 		m_clusterSelectionDlg->onLoginMessage( LoginClusterStatus( ri ) );
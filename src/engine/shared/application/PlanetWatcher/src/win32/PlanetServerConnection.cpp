@@ -55,7 +55,7 @@ void PlanetServerConnection::onReceive(const Archive::ByteStream &message)
 	GameNetworkMessage m(r);
 	r = message.begin();
 	
-	if(m.isType("PlanetObjectStatusMessage"))
+	if(m.isType(CRC_CONSTANT("PlanetObjectStatusMessage")))
 	{
 		//DEBUG_REPORT_LOG(true,("Got PlanetObjectStatusMessage.\n"));
 		PlanetObjectStatusMessage msg(r);
@@ -75,7 +75,7 @@ void PlanetServerConnection::onReceive(const Archive::ByteStream &message)
 		}
 		m_gotUpdates = true;
 	}
-	else if(m.isType("GameServerStatus"))
+	else if(m.isType(CRC_CONSTANT("GameServerStatus")))
 	{
 		GameServerStatus msg(r);
 		if(msg.isOnline())
@@ -89,7 +89,7 @@ void PlanetServerConnection::onReceive(const Archive::ByteStream &message)
 			m_watcher->removeGameServer(msg.getServerInfo().serverId);
 		}
 	}
-	else if(m.isType("PlanetNodeStatusMessage"))
+	else if(m.isType(CRC_CONSTANT("PlanetNodeStatusMessage")))
 	{
 		//DEBUG_REPORT_LOG(true,("Got PlanetNodeStatusMessage.\n"));
 		PlanetNodeStatusMessage msg(r);
@@ -112,7 +112,7 @@ void PlanetServerConnection::onReceive(const Archive::ByteStream &message)
 		}
 		m_gotUpdates = true;
 	}
-	else if(m.isType("GalaxyLoopTimesResponse"))
+	else if(m.isType(CRC_CONSTANT("GalaxyLoopTimesResponse")))
 	{
 		GalaxyLoopTimesResponse msg(r);
 		if(m_watcher)
@@ -120,7 +120,7 @@ void PlanetServerConnection::onReceive(const Archive::ByteStream &message)
 			m_watcher->setServerLoopTime(msg.getCurrentFrameMilliseconds(), msg.getLastFrameMilliseconds());
 		}
 	}
-	else if(m.isType("FrameEndMessage"))
+	else if(m.isType(CRC_CONSTANT("FrameEndMessage")))
 	{
 		FrameEndMessage msg(r);
 		m_watcher->setServerFrameInfo(msg.getProcessId(), msg.getFrameTime(), msg.getProfilerData());
@@ -11,7 +11,11 @@
 #include "sharedFoundation/Crc.h"
 #include "sharedFoundation/Os.h"
 #include "sharedFoundation/SetupSharedFoundation.h"
+#include "sharedSynchronization/ConditionVariable.h"
+#include "sharedSynchronization/Mutex.h"
+#include "sharedThread/RunThread.h"
 #include "sharedThread/SetupSharedThread.h"
+#include "sharedDebug/PerformanceTimer.h"
 #include "sharedDebug/SetupSharedDebug.h"
 #include "sharedIoWin/SetupSharedIoWin.h"
 #include "sharedFile/SetupSharedFile.h"
@@ -26,6 +30,8 @@
 #include <cstdlib>
 #include <string>
 #include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
 #if defined(_WIN32)
 #include <io.h>
 #else
@@ -130,6 +136,35 @@ namespace
 #endif
 		return std::fclose(file);
 	}
+
+	bool safeFileStat(char const *fileName, long &length, int64 &modificationTime)
+	{
+#if defined(_MSC_VER)
+		struct _stat64 statBuffer;
+		if (::_stat64(fileName, &statBuffer) != 0)
+			return false;
+#else
+		struct stat statBuffer;
+		if (::stat(fileName, &statBuffer) != 0)
+			return false;
+#endif
+		length = static_cast<long>(statBuffer.st_size);
+		modificationTime = static_cast<int64>(statBuffer.st_mtime);
+		return true;
+	}
+
+	bool parseMd5(char const *text, Md5::Value &value)
+	{
+		uint8 * const data = static_cast<uint8 *>(value.getData());
+		for (int i = 0; i < Md5::Value::cms_dataSize; ++i)
+		{
+			unsigned int byteValue = 0;
+			if (std::sscanf(text + i * 2, "%2x", &byteValue) != 1)
+				return false;
+			data[i] = static_cast<uint8>(byteValue);
+		}
+		return true;
+	}
 }
 
 const Tag TAG_TREE = TAG(T, R, E, E);
@@ -273,6 +308,8 @@ static const char * const LNAME_DECRYPT              = "decrypt";
 static const char * const LNAME_DECRYPT_OUTPUT       = "decryptOutput";
 static const char * const LNAME_DEBUG                = "debug";
 static const char * const LNAME_LIST_OPTIONS         = "listOptions";
+static const char * const LNAME_JOBS                 = "jobs";
+static const char * const LNAME_INCREMENTAL          = "incremental";
 static const char         SNAME_HELP                            = 'h';
 static const char         SNAME_RSP_FILE                        = 'r';
 static const char         SNAME_NO_TOC_COMPRESSION      = 't';
@@ -286,6 +323,8 @@ static const char         SNAME_DECRYPT                 = 'd';
 static const char         SNAME_DECRYPT_OUTPUT  = 'o';
 static const char         SNAME_DEBUG                   = 'g';
 static const char         SNAME_LIST_OPTIONS            = 'l';
+static const char         SNAME_JOBS                    = 'j';
+static const char         SNAME_INCREMENTAL             = 'i';
 
 static CommandLine::OptionSpec optionSpecArray[] =
 {
@@ -319,6 +358,12 @@ static CommandLine::OptionSpec optionSpecArray[] =
                                 OP_SINGLE_LIST_NODE(SNAME_DEBUG, LNAME_DEBUG, OP_ARG_NONE, OP_MULTIPLE_DENIED, OP_NODE_OPTIONAL),
                                 OP_SINGLE_LIST_NODE(SNAME_LIST_OPTIONS, LNAME_LIST_OPTIONS, OP_ARG_NONE, OP_MULTIPLE_DENIED, OP_NODE_OPTIONAL),
 
+                                // number of compression workers used to generate the tree file body
+                                OP_SINGLE_LIST_NODE(SNAME_JOBS, LNAME_JOBS, OP_ARG_REQUIRED, OP_MULTIPLE_DENIED, OP_NODE_OPTIONAL),
+
+                                // reuse unchanged payloads from the previous build of the tree file
+                                OP_SINGLE_LIST_NODE(SNAME_INCREMENTAL, LNAME_INCREMENTAL, OP_ARG_NONE, OP_MULTIPLE_DENIED, OP_NODE_OPTIONAL),
+
                                 // get the output tree file name
                                 OP_SINGLE_LIST_NODE(OP_SNAME_UNTAGGED, OP_LNAME_UNTAGGED, OP_ARG_REQUIRED, OP_MULTIPLE_DENIED, OP_NODE_OPTIONAL),
 
@@ -338,6 +383,8 @@ static bool      diagnosticsEnabled;
 static bool      listOptionsRequested;
 static bool      waitForUserExit;
 static bool      interactiveMode;
+static int       jobCount = 1;
+static bool      incrementalBuild;
 
 static std::vector<std::string> warnings;
 
@@ -452,6 +499,20 @@ static void run(void)
 
         quiet = CommandLine::getOccurrenceCount(SNAME_QUIET);
 
+        if (CommandLine::getOccurrenceCount(SNAME_INCREMENTAL))
+                incrementalBuild = true;
+
+        if (CommandLine::getOccurrenceCount(SNAME_JOBS))
+        {
+                jobCount = CommandLine::getOptionInt(SNAME_JOBS);
+                if (jobCount < 1)
+                {
+                        fprintf(stderr, "--%s requires a worker count of at least 1.\n", LNAME_JOBS);
+                        ++errors;
+                        return;
+                }
+        }
+
         const char *const decryptSource = CommandLine::getOptionString(SNAME_DECRYPT);
         const bool decryptMode = (decryptSource != NULL);
         const char *const decryptOutputOption = CommandLine::getOptionString(SNAME_DECRYPT_OUTPUT);
@@ -536,6 +597,10 @@ static void run(void)
 
         // a valid set of command line options has been specified
         TreeFileBuilder t(outputTreeFileName);
+        t.setJobCount(jobCount);
+
+        if (incrementalBuild)
+                t.enableIncremental();
 
         if (encryptionRequested)
                 t.enableEncryption(passphrase.c_str());
@@ -606,6 +671,8 @@ static void printOptionReference(void)
         printf("  -%c, --%s <text>       Override the encryption passphrase.\n", SNAME_PASSPHRASE, LNAME_PASSPHRASE);
         printf("  -%c, --%s <source>     Decrypt the specified tree file.\n", SNAME_DECRYPT, LNAME_DECRYPT);
         printf("  -%c, --%s <file>   Destination when decrypting (defaults to positional argument).\n", SNAME_DECRYPT_OUTPUT, LNAME_DECRYPT_OUTPUT);
+        printf("  -%c, --%s <count>      Compress file entries on <count> worker threads (output is identical).\n", SNAME_JOBS, LNAME_JOBS);
+        printf("  -%c, --%s       Reuse unchanged entries from the previous build using the .manifest sidecar.\n", SNAME_INCREMENTAL, LNAME_INCREMENTAL);
         printf("  -%c, --%s              Emit detailed diagnostics about the resolved configuration.\n", SNAME_DEBUG, LNAME_DEBUG);
         printf("  -%c, --%s              Print this option reference. Combine with --%s to continue execution.\n", SNAME_LIST_OPTIONS, LNAME_LIST_OPTIONS, LNAME_DEBUG);
         printf("  -%c, --%s              Display help/usage information.\n", SNAME_HELP, LNAME_HELP);
@@ -657,6 +724,8 @@ static void printConfigurationSummary(const char *outputTreeFileName, const char
         logDiagnostics("  TOC compression  : %s", disableTOCCompression ? "disabled" : "enabled");
         logDiagnostics("  File compression : %s", disableFileCompression ? "disabled" : "enabled");
         logDiagnostics("  Creation         : %s", disableCreation ? "disabled (scan only)" : "enabled");
+        logDiagnostics("  Jobs             : %d", jobCount);
+        logDiagnostics("  Incremental      : %s", incrementalBuild ? "enabled" : "disabled");
         logDiagnostics("  List options     : %s", listOptionsRequested ? "requested" : "not requested");
 }
 
@@ -823,6 +892,8 @@ static bool runInteractiveBuildWorkflow(void)
         diagnosticsEnabled = false;
         listOptionsRequested = false;
         quiet = 0;
+        jobCount = 1;
+        incrementalBuild = false;
 
         printf("\nTreeFileBuilder interactive build\n");
         printf("---------------------------------\n");
@@ -1074,7 +1145,14 @@ TreeFileBuilder::FileEntry::FileEntry(const char *diskFileName, const char *tree
 	compressor(0),
 	compressedLength(0),
 	deleted(false),
-	uncompressed(false)
+	uncompressed(false),
+	payload(NULL),
+	payloadLength(0),
+	prepareTime(0.0f),
+	prepared(false),
+	sourceMd5(),
+	modificationTime(0),
+	reused(false)
 {
 }
 
@@ -1082,6 +1160,7 @@ TreeFileBuilder::FileEntry::FileEntry(const char *diskFileName, const char *tree
 
 TreeFileBuilder::FileEntry::~FileEntry(void)
 {
+	delete [] payload;
 }
 
 // ======================================================================
@@ -1099,7 +1178,23 @@ TreeFileBuilder::TreeFileBuilder(const char *newTreeFileName)
 	uncompSizeOfNameBlock(0),
 	encryptContent(false),
 	encryptionKey(),
-	encryptionOffset(0)
+	encryptionOffset(0),
+	jobCount(1),
+	nextPrepareIndex(0),
+	nextWriteIndex(0),
+	workerMutex(NULL),
+	workerCondition(NULL),
+	totalBytesRead(0.0),
+	totalPrepareTime(0.0),
+	incremental(false),
+	previousTreeFileName(NULL),
+	previousTreeFileHandle(NULL),
+	previousTreeFileEncrypted(false),
+	previousTreeFileMutex(NULL),
+	previousManifest(),
+	previousEntries(),
+	reusedCount(0),
+	reusedBytes(0.0)
 {
 	DEBUG_FATAL(!treeFileName, ("treeFileName may not be NULL"));
 }
@@ -1121,6 +1216,9 @@ TreeFileBuilder::~TreeFileBuilder(void)
 			printf("Could not delete '%s'.\n", treeFileName);
 	}
 
+	// put the previous build back if this one failed
+	releasePreviousBuild(errors != 0);
+
 	delete [] treeFileName;
 
 	std::vector<FileEntry*>::iterator iter = tocOrder.begin();
@@ -1137,6 +1235,10 @@ TreeFileBuilder::~TreeFileBuilder(void)
 
 void TreeFileBuilder::createFile(void)
 {
+	// the previous build must be moved aside before the output is truncated
+	if (incremental)
+		loadPreviousBuild();
+
 	treeFileHandle = safeFileOpen(treeFileName, "wb+");
 
 	if (!treeFileHandle)
@@ -1449,18 +1551,37 @@ void TreeFileBuilder::write(const void *data, int length)
 
 // ----------------------------------------------------------------------
 
-void TreeFileBuilder::writeFile(FileEntry *fileEntry)
+void TreeFileBuilder::prepareFile(FileEntry *fileEntry) const
 {
+	// this may run on a compression worker, so it must only touch fileEntry
 	if (fileEntry->deleted)
-	{
-		if (quiet < 2)
-			printf("  storing deleted file %s\n", fileEntry->treeFileEntry.getString());
-
 		return;
-	}
+
+	PerformanceTimer timer;
+	timer.start();
 
 	const char *fileName = fileEntry->diskFileEntry;
 
+	// variable determining whether file compression is disabled or not
+	bool disableCompression = (disableFileCompression || fileEntry->uncompressed);
+
+	// an entry whose size and timestamp match the manifest is reused without reading the source
+	if (incremental)
+	{
+		long  statLength = 0;
+		int64 modificationTime = 0;
+		if (safeFileStat(fileName, statLength, modificationTime))
+		{
+			fileEntry->modificationTime = modificationTime;
+			if (reusePreviousPayload(fileEntry, static_cast<int>(statLength), disableCompression, false))
+			{
+				timer.stop();
+				fileEntry->prepareTime = timer.getElapsedTime();
+				return;
+			}
+		}
+	}
+
 	FILE *handle = safeFileOpen(fileName, "rb");
 	FATAL(!handle, ("could not open file %s\n", fileName));
 
@@ -1492,17 +1613,213 @@ void TreeFileBuilder::writeFile(FileEntry *fileEntry)
 	const int closeResult = safeFileClose(handle);
 	FATAL(closeResult != 0, ("could not close file %s\n", fileName));
 
-	// store the info about this file
+	// a touched but unchanged source can still reuse the previous payload
+	if (incremental)
+	{
+		fileEntry->sourceMd5 = Md5::calculate(uncompressed, fileLength);
+		if (reusePreviousPayload(fileEntry, fileLength, disableCompression, true))
+		{
+			delete [] uncompressed;
+
+			timer.stop();
+			fileEntry->prepareTime = timer.getElapsedTime();
+			return;
+		}
+	}
+
+	byte *compressed = NULL;
+	int   compressedSize = 0;
+	int const compressor = compressBuffer(uncompressed, fileLength, disableCompression, compressed, compressedSize);
+
 	fileEntry->length     = fileLength;
+	fileEntry->compressor = compressor;
+
+	if (TreeFile::SearchTree::isCompressed(compressor))
+	{
+		fileEntry->compressedLength = compressedSize;
+		fileEntry->payload          = compressed;
+		fileEntry->payloadLength    = compressedSize;
+		delete [] uncompressed;
+	}
+	else
+	{
+		fileEntry->compressedLength = 0;
+		fileEntry->payload          = uncompressed;
+		fileEntry->payloadLength    = fileLength;
+	}
+
+	fileEntry->md5 = Md5::calculate(fileEntry->payload, fileEntry->payloadLength);
+
+	timer.stop();
+	fileEntry->prepareTime = timer.getElapsedTime();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Write a prepared entry to the tree file.
+ *
+ * Entries must be committed in response file order so that the output is
+ * identical no matter how many workers prepared them.
+ */
+
+void TreeFileBuilder::commitFile(FileEntry *fileEntry)
+{
+	if (fileEntry->deleted)
+	{
+		if (quiet < 2)
+			printf("  storing deleted file %s\n", fileEntry->treeFileEntry.getString());
+
+		return;
+	}
+
 	long const currentOffset = safeFileTell(treeFileHandle);
 	FATAL(currentOffset < 0 || currentOffset > static_cast<long>(INT_MAX), ("tree file offset out of range"));
-	fileEntry->offset     = static_cast<int>(currentOffset);
+	fileEntry->offset = static_cast<int>(currentOffset);
 
-	// variable determining whether file compression is disabled or not
-	bool disableCompression = (disableFileCompression || fileEntry->uncompressed);
+	if (quiet < 2)
+	{
+		if (fileEntry->reused)
+			printf("  reusing previous        - size: %6d\n", fileEntry->payloadLength);
+		else if (TreeFile::SearchTree::isCompressed(fileEntry->compressor))
+			printf("  storing compressed(%d)   - OrigSize: %6d  CmpSize: %6d  Ratio: %3d%%\n", fileEntry->compressor, fileEntry->length, fileEntry->payloadLength, 100 - ((fileEntry->payloadLength * 100) / fileEntry->length));
+		else
+			printf("  storing uncompressed    - size: %6d\n", fileEntry->length);
+	}
 
-	compressAndWrite(uncompressed, fileEntry->compressedLength, fileLength, fileEntry->compressor, true, disableCompression, &fileEntry->md5);
-	delete [] uncompressed;
+	if (fileEntry->reused)
+	{
+		++reusedCount;
+		reusedBytes += fileEntry->payloadLength;
+	}
+
+	write(fileEntry->payload, fileEntry->payloadLength);
+
+	totalFileSize     += fileEntry->length;
+	totalSmallestSize += fileEntry->payloadLength;
+	totalBytesRead    += fileEntry->length;
+	totalPrepareTime  += fileEntry->prepareTime;
+
+	delete [] fileEntry->payload;
+	fileEntry->payload = NULL;
+	fileEntry->payloadLength = 0;
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::writeBodySerial()
+{
+	const int total = static_cast<int>(responseFileOrder.size());
+	for (int current = 0; current < total; ++current)
+	{
+		if (quiet < 2)
+			printf("[%4i/%4i] ", current + 1, total);
+
+		FileEntry * const fileEntry = responseFileOrder[static_cast<size_t>(current)];
+		prepareFile(fileEntry);
+		commitFile(fileEntry);
+	}
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::compressionWorker()
+{
+	// don't let the workers get too far ahead of the writer or every payload ends up in memory
+	const int total = static_cast<int>(responseFileOrder.size());
+	const int maximumPreparedAhead = jobCount * 4;
+
+	workerMutex->enter();
+
+		for (;;)
+		{
+			while (nextPrepareIndex < total && nextPrepareIndex - nextWriteIndex >= maximumPreparedAhead)
+				workerCondition->wait();
+
+			if (nextPrepareIndex >= total)
+				break;
+
+			FileEntry * const fileEntry = responseFileOrder[static_cast<size_t>(nextPrepareIndex++)];
+
+			workerMutex->leave();
+				prepareFile(fileEntry);
+			workerMutex->enter();
+
+			fileEntry->prepared = true;
+			workerCondition->broadcast();
+		}
+
+	workerMutex->leave();
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::writeBodyParallel()
+{
+	Mutex mutex;
+	ConditionVariable condition(mutex);
+
+	workerMutex      = &mutex;
+	workerCondition  = &condition;
+	nextPrepareIndex = 0;
+	nextWriteIndex   = 0;
+
+	std::vector<ThreadHandle> workers;
+	for (int i = 0; i < jobCount; ++i)
+	{
+		ThreadHandle worker;
+		worker = runNamedThread("TreeFileBuilderWorker", *this, &TreeFileBuilder::compressionWorker);
+		workers.push_back(worker);
+	}
+
+	const int total = static_cast<int>(responseFileOrder.size());
+	for (int current = 0; current < total; ++current)
+	{
+		FileEntry * const fileEntry = responseFileOrder[static_cast<size_t>(current)];
+
+		mutex.enter();
+			while (!fileEntry->prepared)
+				condition.wait();
+		mutex.leave();
+
+		if (quiet < 2)
+			printf("[%4i/%4i] ", current + 1, total);
+
+		commitFile(fileEntry);
+
+		mutex.enter();
+			++nextWriteIndex;
+			condition.broadcast();
+		mutex.leave();
+	}
+
+	for (std::vector<ThreadHandle>::iterator i = workers.begin(); i != workers.end(); ++i)
+		(*i)->wait();
+
+	workerMutex     = NULL;
+	workerCondition = NULL;
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::writeBody()
+{
+	PerformanceTimer timer;
+	timer.start();
+
+	if (jobCount > 1)
+		writeBodyParallel();
+	else
+		writeBodySerial();
+
+	timer.stop();
+
+	float const elapsed = timer.getElapsedTime();
+	double const megaBytesRead = totalBytesRead / (1024.0 * 1024.0);
+	double const megaBytesWritten = static_cast<double>(totalSmallestSize) / (1024.0 * 1024.0);
+	printf("Body: %d file(s), %.1fMB read, %.1fMB written in %.2fs (%.1fMB/s) using %d job(s), %.2fs read+compress time\n", numberOfFiles, megaBytesRead, megaBytesWritten, elapsed, elapsed > 0.0f ? megaBytesRead / elapsed : 0.0, jobCount, totalPrepareTime);
+
+	if (incremental)
+		printf("Incremental: reused %d of %d file(s), %.1fMB copied from the previous build\n", reusedCount, numberOfFiles, reusedBytes / (1024.0 * 1024.0));
 }
 
 // ----------------------------------------------------------------------
@@ -1538,7 +1855,7 @@ void TreeFileBuilder::writeTableOfContents()
 		fileNameBlock.push_back((*iter)->treeFileEntry.getString());
 	}
 
-	compressAndWrite(uncompressed, sizeOfTOC, uncompSizeOfTOC, tocCompressorID, false, disableTOCCompression, NULL);
+	compressAndWrite(uncompressed, sizeOfTOC, uncompSizeOfTOC, tocCompressorID, disableTOCCompression);
 	delete [] uncompressed;
 }
 
@@ -1558,7 +1875,7 @@ void TreeFileBuilder::writeFileNameBlock()
 		uncompIter += nameLength;
 	}
 
-	compressAndWrite(uncompressed, sizeOfNameBlock, uncompSizeOfNameBlock, blockCompressorID, false, disableTOCCompression, NULL);
+	compressAndWrite(uncompressed, sizeOfNameBlock, uncompSizeOfNameBlock, blockCompressorID, disableTOCCompression);
 	delete [] uncompressed;
 }
 
@@ -1576,17 +1893,17 @@ void TreeFileBuilder::writeMd5Block()
 
 	int compressedSize = 0;
 	int compressor = 0;
-	compressAndWrite(md5Block, compressedSize, sizeOfMd5Block, compressor, false, true, NULL);
+	compressAndWrite(md5Block, compressedSize, sizeOfMd5Block, compressor, true);
 	delete [] md5Block;
 }
 
 // ----------------------------------------------------------------------
 
-void TreeFileBuilder::compressAndWrite(const byte *uncompressed, int &sizeOfData, const int uncompressedSize, int &compressor, const bool isFileData, const bool disableCompression, Md5::Value *md5)
+int TreeFileBuilder::compressBuffer(const byte *uncompressed, const int uncompressedSize, const bool disableCompression, byte *&smallestBuffer, int &smallestSize)
 {
     int smallest = TreeFile::SearchTree::CT_none;
-    int smallestSize = uncompressedSize;
-    byte *smallestBuffer = nullptr;
+    smallestSize = uncompressedSize;
+    smallestBuffer = nullptr;
 
     if (!disableCompression && uncompressedSize > 1024)
     {
@@ -1635,49 +1952,29 @@ void TreeFileBuilder::compressAndWrite(const byte *uncompressed, int &sizeOfData
 	}
     }
 
-    if (isFileData)
-    {
-	if (TreeFile::SearchTree::isCompressed(smallest))
-	{
-	    if (quiet < 2)
-		printf("  storing compressed(%d)   - OrigSize: %6d  CmpSize: %6d  Ratio: %3d%%\n", smallest, uncompressedSize, smallestSize, 100 - ((smallestSize * 100) / uncompressedSize));
-	    sizeOfData = smallestSize;
-	    write(smallestBuffer, smallestSize);
-	}
-	else
-	{
-	    sizeOfData = 0;
-	    if (quiet < 2)
-		printf("  storing uncompressed    - size: %6d\n", uncompressedSize);
-	    write(uncompressed, uncompressedSize);
-	}
+    return smallest;
+}
 
-	totalFileSize += uncompressedSize;
-    }
-    else
-    {
-	if (TreeFile::SearchTree::isCompressed(smallest))
-	{
-	    sizeOfData = smallestSize;
-	    write(smallestBuffer, smallestSize);
-	}
-	else
-	{
-	    sizeOfData = uncompressedSize;
-	    write(uncompressed, uncompressedSize);
-	}
+// ----------------------------------------------------------------------
 
-	totalFileSize += smallestSize;
-    }
+void TreeFileBuilder::compressAndWrite(const byte *uncompressed, int &sizeOfData, const int uncompressedSize, int &compressor, const bool disableCompression)
+{
+    byte *smallestBuffer = nullptr;
+    int smallestSize = 0;
+    int const smallest = compressBuffer(uncompressed, uncompressedSize, disableCompression, smallestBuffer, smallestSize);
 
-    if (md5)
+    if (TreeFile::SearchTree::isCompressed(smallest))
     {
-	if (TreeFile::SearchTree::isCompressed(smallest))
-	    *md5 = Md5::calculate(smallestBuffer, smallestSize);
-	else
-	    *md5 = Md5::calculate(uncompressed, uncompressedSize);
+	sizeOfData = smallestSize;
+	write(smallestBuffer, smallestSize);
+    }
+    else
+    {
+	sizeOfData = uncompressedSize;
+	write(uncompressed, uncompressedSize);
     }
 
+    totalFileSize += smallestSize;
     totalSmallestSize += smallestSize;
     compressor = smallest;
 
@@ -1698,22 +1995,17 @@ void TreeFileBuilder::write(void)
         if (encryptContent)
                 encryptionOffset = 0;
 
-	std::vector<FileEntry*>::iterator iter = responseFileOrder.begin();
-
 	printf("Generating tree file body\n");
 
 	// write all of the files
-	const uint total = responseFileOrder.size ();
-	for(int current = 1; iter != responseFileOrder.end(); ++iter, ++current)
-	{
-		if (quiet < 2)
-			printf("[%4i/%4i] ", current, total);
-		writeFile(*iter);
-	}
+	writeBody();
 
 	// calculate the tocOffset before writing the TOC
 	int tocOffset = totalSmallestSize + sizeof(header);
 
+	PerformanceTimer tocTimer;
+	tocTimer.start();
+
 	printf("Writing table of contents\n");
 	writeTableOfContents();
 	writeFileNameBlock();
@@ -1721,6 +2013,12 @@ void TreeFileBuilder::write(void)
 	printf("Writing md5sum block\n");
 	writeMd5Block();
 
+	tocTimer.stop();
+	printf("Table of contents: %d entries in %.2fs\n", numberOfFiles, tocTimer.getElapsedTime());
+
+	if (incremental)
+		writeManifest();
+
 	// now go back and update the header info with the correct data
 	DEBUG_FATAL(safeFileSeek(treeFileHandle, 0, SEEK_SET) != 0, ("failed to seek to beginning of tree file"));
 	header.tocOffset		     = tocOffset;
@@ -1753,6 +2051,345 @@ void TreeFileBuilder::write(void)
 
 // ======================================================================
 
+std::string TreeFileBuilder::getManifestFileName(const char *treeFileName)
+{
+	return std::string(treeFileName) + ".manifest";
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Move the previous build of the tree file aside and load its table of
+ * contents and manifest so unchanged entries can be copied instead of
+ * recompressed.  Failure here only means a full build is performed.
+ */
+
+void TreeFileBuilder::loadPreviousBuild()
+{
+	FILE * const existing = safeFileOpen(treeFileName, "rb");
+	if (!existing)
+	{
+		printf("Incremental: no previous build of '%s', performing a full build\n", treeFileName);
+		return;
+	}
+
+	safeFileClose(existing);
+
+	std::string const previousName = std::string(treeFileName) + ".previous";
+	IGNORE_RETURN(std::remove(previousName.c_str()));
+	if (std::rename(treeFileName, previousName.c_str()) != 0)
+	{
+		printf("Incremental: could not move '%s' aside (%s), performing a full build\n", treeFileName, std::strerror(errno));
+		return;
+	}
+
+	previousTreeFileName   = DuplicateString(previousName.c_str());
+	previousTreeFileHandle = safeFileOpen(previousTreeFileName, "rb");
+	previousTreeFileMutex  = new Mutex;
+
+	if (!previousTreeFileHandle || !loadPreviousTableOfContents())
+	{
+		printf("Incremental: previous build of '%s' is unusable, performing a full build\n", treeFileName);
+		previousEntries.clear();
+		return;
+	}
+
+	loadManifest();
+
+	printf("Incremental: %d entries in previous build, %d in manifest\n", static_cast<int>(previousEntries.size()), static_cast<int>(previousManifest.size()));
+}
+
+// ----------------------------------------------------------------------
+
+bool TreeFileBuilder::readPreviousBlock(int offset, int length, byte *destination) const
+{
+	if (length <= 0)
+		return length == 0;
+
+	previousTreeFileMutex->enter();
+
+		bool const result = safeFileSeek(previousTreeFileHandle, offset, SEEK_SET) == 0 && safeFileRead(destination, static_cast<size_t>(length), previousTreeFileHandle) == static_cast<size_t>(length);
+
+	previousTreeFileMutex->leave();
+
+	// the whole archive after the header is encrypted as one stream
+	if (result && previousTreeFileEncrypted)
+		TreeFileEncryption::transformBuffer(destination, length, encryptionKey, static_cast<uint32>(offset - static_cast<int>(sizeof(TreeFile::SearchTree::Header))));
+
+	return result;
+}
+
+// ----------------------------------------------------------------------
+
+bool TreeFileBuilder::loadPreviousTableOfContents()
+{
+	TreeFile::SearchTree::Header header;
+	if (safeFileRead(&header, sizeof(header), previousTreeFileHandle) != sizeof(header))
+		return false;
+
+	// only version 5 tree files carry the md5 block used to verify reused payloads
+	if ((header.token != TAG_TREE && header.token != TAG_TRES) || header.version != TAG_0005)
+		return false;
+
+	previousTreeFileEncrypted = (header.token == TAG_TRES);
+	if (previousTreeFileEncrypted && !encryptContent)
+	{
+		printf("Incremental: previous build is encrypted but this build is not\n");
+		return false;
+	}
+
+	int const numberOfEntries = static_cast<int>(header.numberOfFiles);
+	if (numberOfEntries <= 0)
+		return true;
+
+	int const uncompressedSizeOfTOC = numberOfEntries * static_cast<int>(sizeof(TreeFile::SearchTree::TableOfContentsEntry));
+
+	std::vector<TreeFile::SearchTree::TableOfContentsEntry> tableOfContents(static_cast<size_t>(numberOfEntries));
+	std::vector<char> fileNames(static_cast<size_t>(header.uncompSizeOfNameBlock) + 1, '\0');
+	std::vector<byte> md5Block(static_cast<size_t>(numberOfEntries * Md5::Value::cms_dataSize) + 1);
+
+	int readPosition = static_cast<int>(header.tocOffset);
+
+	// the header sizes are always the stored sizes, compressed or not
+	{
+		std::vector<byte> buffer(static_cast<size_t>(header.sizeOfTOC) + 1);
+		if (!readPreviousBlock(readPosition, static_cast<int>(header.sizeOfTOC), &buffer[0]))
+			return false;
+
+		if (TreeFile::SearchTree::isCompressed(static_cast<int>(header.tocCompressor)))
+		{
+			if (ZlibCompressor().expand(&buffer[0], static_cast<int>(header.sizeOfTOC), &tableOfContents[0], uncompressedSizeOfTOC) != uncompressedSizeOfTOC)
+				return false;
+		}
+		else if (static_cast<int>(header.sizeOfTOC) == uncompressedSizeOfTOC)
+			memcpy(&tableOfContents[0], &buffer[0], uncompressedSizeOfTOC);
+		else
+			return false;
+
+		readPosition += static_cast<int>(header.sizeOfTOC);
+	}
+
+	{
+		std::vector<byte> buffer(static_cast<size_t>(header.sizeOfNameBlock) + 1);
+		if (!readPreviousBlock(readPosition, static_cast<int>(header.sizeOfNameBlock), &buffer[0]))
+			return false;
+
+		if (header.blockCompressor)
+		{
+			if (ZlibCompressor().expand(&buffer[0], static_cast<int>(header.sizeOfNameBlock), &fileNames[0], static_cast<int>(header.uncompSizeOfNameBlock)) != static_cast<int>(header.uncompSizeOfNameBlock))
+				return false;
+		}
+		else if (header.sizeOfNameBlock == header.uncompSizeOfNameBlock)
+			memcpy(&fileNames[0], &buffer[0], header.uncompSizeOfNameBlock);
+		else
+			return false;
+
+		readPosition += static_cast<int>(header.sizeOfNameBlock);
+	}
+
+	if (!readPreviousBlock(readPosition, numberOfEntries * Md5::Value::cms_dataSize, &md5Block[0]))
+		return false;
+
+	for (int i = 0; i < numberOfEntries; ++i)
+	{
+		TreeFile::SearchTree::TableOfContentsEntry const &tocEntry = tableOfContents[static_cast<size_t>(i)];
+		if (tocEntry.length == 0 || tocEntry.fileNameOffset < 0 || tocEntry.fileNameOffset >= static_cast<int>(header.uncompSizeOfNameBlock))
+			continue;
+
+		PreviousEntry entry;
+		entry.offset           = tocEntry.offset;
+		entry.length           = tocEntry.length;
+		entry.compressor       = tocEntry.compressor;
+		entry.compressedLength = tocEntry.compressedLength;
+		memcpy(entry.md5.getData(), &md5Block[static_cast<size_t>(i * Md5::Value::cms_dataSize)], Md5::Value::cms_dataSize);
+
+		previousEntries[std::string(&fileNames[static_cast<size_t>(tocEntry.fileNameOffset)])] = entry;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Manifest lines are tab separated:
+ *   treeFileName diskFileName length modificationTime sourceMd5 compressionDisabled
+ */
+
+void TreeFileBuilder::loadManifest()
+{
+	std::string const manifestFileName = getManifestFileName(treeFileName);
+	FILE * const file = safeFileOpen(manifestFileName.c_str(), "rt");
+	if (!file)
+		return;
+
+	char buffer[10 * 1024];
+	while (fgets(buffer, sizeof(buffer), file))
+	{
+		if (buffer[0] == '#')
+			continue;
+
+		char *fields[6];
+		int   fieldCount = 0;
+		char *current = buffer;
+		for (; fieldCount < 6 && current; ++fieldCount)
+		{
+			fields[fieldCount] = current;
+			current = strchr(current, '\t');
+			if (current)
+				*current++ = '\0';
+		}
+
+		if (fieldCount != 6)
+			continue;
+
+		ManifestEntry entry;
+		entry.diskFileName        = fields[1];
+		entry.length              = atoi(fields[2]);
+		entry.modificationTime    = static_cast<int64>(strtod(fields[3], NULL));
+		entry.compressionDisabled = (fields[5][0] == '1');
+
+		if (!parseMd5(fields[4], entry.sourceMd5))
+			continue;
+
+		previousManifest[std::string(fields[0])] = entry;
+	}
+
+	safeFileClose(file);
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::writeManifest() const
+{
+	std::string const manifestFileName = getManifestFileName(treeFileName);
+	FILE * const file = safeFileOpen(manifestFileName.c_str(), "wt");
+	if (!file)
+	{
+		fprintf(stderr, "Unable to write manifest %s: %s\n", manifestFileName.c_str(), std::strerror(errno));
+		return;
+	}
+
+	fprintf(file, "# TreeFileBuilder manifest for %s\n", treeFileName);
+
+	for (std::vector<FileEntry*>::const_iterator iter = tocOrder.begin(); iter != tocOrder.end(); ++iter)
+	{
+		FileEntry const * const entry = *iter;
+		if (entry->deleted)
+			continue;
+
+		char md5Text[64];
+		entry->sourceMd5.format(md5Text, sizeof(md5Text));
+
+		bool const compressionDisabled = (disableFileCompression || entry->uncompressed);
+		fprintf(file, "%s\t%s\t%d\t%.0f\t%s\t%d\n", entry->treeFileEntry.getString(), entry->diskFileEntry, entry->length, static_cast<double>(entry->modificationTime), md5Text, compressionDisabled ? 1 : 0);
+	}
+
+	safeFileClose(file);
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::releasePreviousBuild(bool restore)
+{
+	if (previousTreeFileHandle)
+	{
+		safeFileClose(previousTreeFileHandle);
+		previousTreeFileHandle = NULL;
+	}
+
+	if (previousTreeFileName)
+	{
+		if (restore)
+		{
+			if (std::rename(previousTreeFileName, treeFileName) != 0)
+				printf("Could not restore '%s' from '%s'.\n", treeFileName, previousTreeFileName);
+		}
+		else
+			IGNORE_RETURN(std::remove(previousTreeFileName));
+
+		delete [] previousTreeFileName;
+		previousTreeFileName = NULL;
+	}
+
+	delete previousTreeFileMutex;
+	previousTreeFileMutex = NULL;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Fill in fileEntry from the previous build if the source is unchanged.
+ *
+ * When sourceMd5Known is false the source has not been read and the size
+ * and timestamp recorded in the manifest must match; otherwise the content
+ * hash of the source must match.  The copied payload is always checked
+ * against the md5 stored in the previous build before it is used.
+ */
+
+bool TreeFileBuilder::reusePreviousPayload(FileEntry *fileEntry, int length, bool disableCompression, bool sourceMd5Known) const
+{
+	std::string const name(fileEntry->treeFileEntry.getString());
+
+	Manifest::const_iterator const manifestIterator = previousManifest.find(name);
+	if (manifestIterator == previousManifest.end())
+		return false;
+
+	ManifestEntry const &manifestEntry = manifestIterator->second;
+	if (manifestEntry.length != length || manifestEntry.compressionDisabled != disableCompression)
+		return false;
+
+	if (sourceMd5Known)
+	{
+		if (manifestEntry.sourceMd5 != fileEntry->sourceMd5)
+			return false;
+	}
+	else
+	{
+		if (manifestEntry.modificationTime != fileEntry->modificationTime || manifestEntry.diskFileName != fileEntry->diskFileEntry)
+			return false;
+	}
+
+	PreviousEntries::const_iterator const previousIterator = previousEntries.find(name);
+	if (previousIterator == previousEntries.end() || previousIterator->second.length != length)
+		return false;
+
+	PreviousEntry const &previous = previousIterator->second;
+	bool const compressed = TreeFile::SearchTree::isCompressed(previous.compressor);
+	int const payloadLength = compressed ? previous.compressedLength : previous.length;
+
+	byte * const payload = new byte[payloadLength];
+	if (!readPreviousBlock(previous.offset, payloadLength, payload) || Md5::calculate(payload, payloadLength) != previous.md5)
+	{
+		delete [] payload;
+		return false;
+	}
+
+	fileEntry->length           = previous.length;
+	fileEntry->compressor       = previous.compressor;
+	fileEntry->compressedLength = compressed ? previous.compressedLength : 0;
+	fileEntry->md5              = previous.md5;
+	fileEntry->sourceMd5        = manifestEntry.sourceMd5;
+	fileEntry->payload          = payload;
+	fileEntry->payloadLength    = payloadLength;
+	fileEntry->reused           = true;
+
+	return true;
+}
+
+// ======================================================================
+
+void TreeFileBuilder::setJobCount(int jobs)
+{
+	jobCount = std::max(1, jobs);
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFileBuilder::enableIncremental()
+{
+	incremental = true;
+}
+
+// ----------------------------------------------------------------------
+
 void TreeFileBuilder::enableEncryption(const char *passphrase)
 {
         if (TreeFileEncryption::isPassphraseValid(passphrase))
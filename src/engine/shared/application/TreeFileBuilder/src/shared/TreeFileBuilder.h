@@ -16,12 +16,15 @@
 #include "sharedFoundation/CrcLowerString.h"
 #include "sharedFoundation/Md5.h"
 #include <cstdio>
+#include <map>
 #include <vector>
 #include <string>
 
 // ======================================================================
 
 class Compressor;
+class ConditionVariable;
+class Mutex;
 
 // ======================================================================
 
@@ -60,10 +63,45 @@ private:
 		Md5::Value     md5;
 		bool           deleted;
 		bool           uncompressed;
+
+		// filled in by prepareFile() and released by commitFile()
+		byte          *payload;
+		int            payloadLength;
+		float          prepareTime;
+		bool           prepared;
+
+		// incremental build information for the manifest
+		Md5::Value     sourceMd5;
+		int64          modificationTime;
+		bool           reused;
+
 		FileEntry(const char *newName, const char *newlyChangedName);
 		~FileEntry(void);
 	};
 
+	// one line of the sidecar manifest written next to the tree file
+	struct ManifestEntry
+	{
+		std::string diskFileName;
+		int         length;
+		int64       modificationTime;
+		Md5::Value  sourceMd5;
+		bool        compressionDisabled;
+	};
+
+	// location of an entry's payload within the previous build of the tree file
+	struct PreviousEntry
+	{
+		int         offset;
+		int         length;
+		int         compressor;
+		int         compressedLength;
+		Md5::Value  md5;
+	};
+
+	typedef std::map<std::string, ManifestEntry> Manifest;
+	typedef std::map<std::string, PreviousEntry> PreviousEntries;
+
 private:
 
 	char   *treeFileName;
@@ -84,6 +122,26 @@ private:
         Md5::Value encryptionKey;
         uint32 encryptionOffset;
 
+	// parallel body generation
+	int                 jobCount;
+	int                 nextPrepareIndex;
+	int                 nextWriteIndex;
+	Mutex              *workerMutex;
+	ConditionVariable  *workerCondition;
+	double              totalBytesRead;
+	double              totalPrepareTime;
+
+	// incremental builds
+	bool                incremental;
+	char               *previousTreeFileName;
+	FILE               *previousTreeFileHandle;
+	bool                previousTreeFileEncrypted;
+	Mutex              *previousTreeFileMutex;
+	Manifest            previousManifest;
+	PreviousEntries     previousEntries;
+	int                 reusedCount;
+	double              reusedBytes;
+
 private:
 
         void write(const void *data, int length);
@@ -91,8 +149,22 @@ private:
         void writeTableOfContents();
         void writeFileNameBlock();
         void writeMd5Block();
-        void writeFile(FileEntry *fileEntry);
-        void compressAndWrite(const byte * uncompressed, int &sizeOfData, const int uncompSize, int &compressor, const bool isFileData, const bool disableCompression, Md5::Value *md5sum);
+        void writeBody();
+        void writeBodySerial();
+        void writeBodyParallel();
+        void prepareFile(FileEntry *fileEntry) const;
+        void commitFile(FileEntry *fileEntry);
+        void compressionWorker();
+        void compressAndWrite(const byte * uncompressed, int &sizeOfData, const int uncompSize, int &compressor, const bool disableCompression);
+        static int compressBuffer(const byte *uncompressed, int uncompressedSize, bool disableCompression, byte *&smallestBuffer, int &smallestSize);
+        void loadPreviousBuild();
+        bool loadPreviousTableOfContents();
+        void loadManifest();
+        void writeManifest() const;
+        void releasePreviousBuild(bool restore);
+        bool readPreviousBlock(int offset, int length, byte *destination) const;
+        bool reusePreviousPayload(FileEntry *fileEntry, int length, bool disableCompression, bool sourceMd5Known) const;
+        static std::string getManifestFileName(const char *treeFileName);
         static bool transformTreeFile(const char *sourceFileName, const char *destinationFileName, Md5::Value const &key, TransformMode mode);
 
 public:
@@ -104,6 +176,8 @@ public:
         void addResponseFile(const char *responseFileEntry);
         void write(void);
         static bool LessFileEntryCrcNameCompare(const FileEntry* a, const FileEntry* b);
+        void setJobCount(int jobs);
+        void enableIncremental();
         void enableEncryption(const char *passphrase);
         void disableEncryption();
         bool isEncryptionEnabled() const;
@@ -12,6 +12,8 @@
 #include "sharedCollision/Containment3d.h"
 #include "sharedCollision/Distance3d.h"
 
+#include "sharedDebug/PerformanceTimer.h"
+
 #include "sharedFile/Iff.h"
 
 #include "sharedFoundation/ExitChain.h"
@@ -19,12 +21,20 @@
 #include "sharedMath/VectorArgb.h"
 #include "sharedMath/DebugShapeRenderer.h"
 #include "sharedMath/Line3d.h"
+#include "sharedMath/Ray3d.h"
+#include "sharedMath/Segment3d.h"
 
 #include "sharedFoundation/MemoryBlockManagerMacros.h"
 #include "sharedFoundation/MemoryBlockManager.h"
 
+#include <algorithm>
 #include <vector>
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define BOX_TREE_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
 const Tag TAG_BTRE = TAG(B,T,R,E);
 const Tag TAG_NODS = TAG(N,O,D,S);
 
@@ -407,6 +417,293 @@ bool BoxTreeNode::findClosest ( Vector const & V, float maxDistance, float & out
 	}
 }
 
+// ======================================================================
+// Up to four boxes from the binary tree side by side, with each axis in its
+// own array so a query can test all four boxes at once. Unused slots hold
+// an inside-out box and are past m_count.
+
+class BoxTreeWideNode
+{
+public:
+
+	enum { cms_width = 4 };
+
+	BoxTreeWideNode();
+
+	void    setSlot         ( int slot, AxialBox const & box, int userId, int child );
+
+	float           m_min[3][cms_width];
+	float           m_max[3][cms_width];
+
+	int             m_userId[cms_width];
+	int             m_child[cms_width];     // The wide node holding the slot's children, or -1
+	int             m_count;
+};
+
+// ----------------------------------------------------------------------
+
+BoxTreeWideNode::BoxTreeWideNode()
+: m_count(0)
+{
+	for(int slot = 0; slot < cms_width; slot++)
+	{
+		for(int axis = 0; axis < 3; axis++)
+		{
+			m_min[axis][slot] = REAL_MAX;
+			m_max[axis][slot] = -REAL_MAX;
+		}
+
+		m_userId[slot] = -1;
+		m_child[slot] = -1;
+	}
+}
+
+// ----------
+
+void BoxTreeWideNode::setSlot ( int slot, AxialBox const & box, int userId, int child )
+{
+	Vector const & min = box.getMin();
+	Vector const & max = box.getMax();
+
+	m_min[0][slot] = min.x;
+	m_min[1][slot] = min.y;
+	m_min[2][slot] = min.z;
+
+	m_max[0][slot] = max.x;
+	m_max[1][slot] = max.y;
+	m_max[2][slot] = max.z;
+
+	m_userId[slot] = userId;
+	m_child[slot] = child;
+}
+
+// ======================================================================
+
+namespace BoxTreeNamespace
+{
+	// A line, ray, or segment as P + V * t for t in [minTime,maxTime]
+
+	struct SlabQuery
+	{
+		explicit SlabQuery ( Line3d const & line );
+		explicit SlabQuery ( Ray3d const & ray );
+		explicit SlabQuery ( Segment3d const & segment );
+
+		void    set     ( Vector const & point, Vector const & delta, float minTime, float maxTime );
+
+		float   m_point[3];
+		float   m_delta[3];
+		float   m_minTime;
+		float   m_maxTime;
+	};
+
+	struct BoxQuery
+	{
+		explicit BoxQuery ( AxialBox const & box );
+
+		float   m_min[3];
+		float   m_max[3];
+	};
+
+	int     calcOverlapMask ( BoxTreeWideNode const & node, SlabQuery const & query );
+	int     calcOverlapMask ( BoxTreeWideNode const & node, BoxQuery const & query );
+}
+
+using namespace BoxTreeNamespace;
+
+// ----------------------------------------------------------------------
+// These use the same time ranges as Overlap3d's line, ray, and segment vs.
+// box tests.
+
+BoxTreeNamespace::SlabQuery::SlabQuery ( Line3d const & line )
+{
+	set(line.getPoint(),line.getNormal(),-REAL_MAX,REAL_MAX);
+}
+
+BoxTreeNamespace::SlabQuery::SlabQuery ( Ray3d const & ray )
+{
+	set(ray.getPoint(),ray.getNormal(),0.0f,REAL_MAX);
+}
+
+BoxTreeNamespace::SlabQuery::SlabQuery ( Segment3d const & segment )
+{
+	set(segment.getBegin(),segment.getDelta(),0.0f,1.0f);
+}
+
+void BoxTreeNamespace::SlabQuery::set ( Vector const & point, Vector const & delta, float minTime, float maxTime )
+{
+	m_point[0] = point.x;
+	m_point[1] = point.y;
+	m_point[2] = point.z;
+
+	m_delta[0] = delta.x;
+	m_delta[1] = delta.y;
+	m_delta[2] = delta.z;
+
+	m_minTime = minTime;
+	m_maxTime = maxTime;
+}
+
+// ----------
+
+BoxTreeNamespace::BoxQuery::BoxQuery ( AxialBox const & box )
+{
+	Vector const & min = box.getMin();
+	Vector const & max = box.getMax();
+
+	m_min[0] = min.x;
+	m_min[1] = min.y;
+	m_min[2] = min.z;
+
+	m_max[0] = max.x;
+	m_max[1] = max.y;
+	m_max[2] = max.z;
+}
+
+// ----------------------------------------------------------------------
+// Returns a bit for each slot of the node whose box the query overlaps.
+// The slab test divides rather than multiplying by 1/V so it agrees with
+// Overlap3d on boxes the query only touches.
+
+#ifdef BOX_TREE_USE_SSE
+
+int BoxTreeNamespace::calcOverlapMask ( BoxTreeWideNode const & node, SlabQuery const & query )
+{
+	__m128 nearTime = _mm_set1_ps(query.m_minTime);
+	__m128 farTime = _mm_set1_ps(query.m_maxTime);
+	__m128 inside = _mm_cmpeq_ps(nearTime,nearTime);
+
+	for(int axis = 0; axis < 3; axis++)
+	{
+		__m128 boxMin = _mm_loadu_ps(node.m_min[axis]);
+		__m128 boxMax = _mm_loadu_ps(node.m_max[axis]);
+		__m128 point = _mm_set1_ps(query.m_point[axis]);
+
+		float delta = query.m_delta[axis];
+
+		if(delta == 0.0f)
+		{
+			// Not moving along this axis, so the point has to be inside the slab
+
+			inside = _mm_and_ps(inside,_mm_and_ps(_mm_cmpgt_ps(point,boxMin),_mm_cmplt_ps(point,boxMax)));
+			continue;
+		}
+
+		__m128 V = _mm_set1_ps(delta);
+
+		__m128 timeMin = _mm_div_ps(_mm_sub_ps(boxMin,point),V);
+		__m128 timeMax = _mm_div_ps(_mm_sub_ps(boxMax,point),V);
+
+		if(delta > 0.0f)
+		{
+			nearTime = _mm_max_ps(nearTime,timeMin);
+			farTime = _mm_min_ps(farTime,timeMax);
+		}
+		else
+		{
+			nearTime = _mm_max_ps(nearTime,timeMax);
+			farTime = _mm_min_ps(farTime,timeMin);
+		}
+	}
+
+	return _mm_movemask_ps(_mm_and_ps(inside,_mm_cmple_ps(nearTime,farTime)));
+}
+
+// ----------
+
+int BoxTreeNamespace::calcOverlapMask ( BoxTreeWideNode const & node, BoxQuery const & query )
+{
+	__m128 overlap = _mm_cmpeq_ps(_mm_setzero_ps(),_mm_setzero_ps());
+
+	for(int axis = 0; axis < 3; axis++)
+	{
+		__m128 boxMin = _mm_loadu_ps(node.m_min[axis]);
+		__m128 boxMax = _mm_loadu_ps(node.m_max[axis]);
+
+		overlap = _mm_and_ps(overlap,_mm_cmple_ps(_mm_set1_ps(query.m_min[axis]),boxMax));
+		overlap = _mm_and_ps(overlap,_mm_cmple_ps(boxMin,_mm_set1_ps(query.m_max[axis])));
+	}
+
+	return _mm_movemask_ps(overlap);
+}
+
+#else
+
+int BoxTreeNamespace::calcOverlapMask ( BoxTreeWideNode const & node, SlabQuery const & query )
+{
+	int mask = 0;
+
+	for(int slot = 0; slot < node.m_count; slot++)
+	{
+		float nearTime = query.m_minTime;
+		float farTime = query.m_maxTime;
+
+		bool inside = true;
+
+		for(int axis = 0; inside && (axis < 3); axis++)
+		{
+			float boxMin = node.m_min[axis][slot];
+			float boxMax = node.m_max[axis][slot];
+			float point = query.m_point[axis];
+			float delta = query.m_delta[axis];
+
+			if(delta == 0.0f)
+			{
+				inside = (point > boxMin) && (point < boxMax);
+				continue;
+			}
+
+			float timeMin = (boxMin - point) / delta;
+			float timeMax = (boxMax - point) / delta;
+
+			if(delta > 0.0f)
+			{
+				nearTime = std::max(nearTime,timeMin);
+				farTime = std::min(farTime,timeMax);
+			}
+			else
+			{
+				nearTime = std::max(nearTime,timeMax);
+				farTime = std::min(farTime,timeMin);
+			}
+		}
+
+		if(inside && (nearTime <= farTime))
+		{
+			mask |= 1 << slot;
+		}
+	}
+
+	return mask;
+}
+
+// ----------
+
+int BoxTreeNamespace::calcOverlapMask ( BoxTreeWideNode const & node, BoxQuery const & query )
+{
+	int mask = 0;
+
+	for(int slot = 0; slot < node.m_count; slot++)
+	{
+		bool overlap = true;
+
+		for(int axis = 0; axis < 3; axis++)
+		{
+			if(query.m_min[axis] > node.m_max[axis][slot]) overlap = false;
+			if(node.m_min[axis][slot] > query.m_max[axis]) overlap = false;
+		}
+
+		if(overlap)
+		{
+			mask |= 1 << slot;
+		}
+	}
+
+	return mask;
+}
+
+#endif
+
 // ======================================================================
 
 void BoxTree::install()
@@ -418,6 +715,7 @@ void BoxTree::install()
 
 BoxTree::BoxTree()
 : m_flatNodes(NULL),
+  m_wideNodes(NULL),
   m_root(NULL),
   m_testCounter(0)
 {
@@ -478,6 +776,8 @@ void BoxTree::build ( BoxVec const & boxes )
 	m_root->deleteChildren();
 	delete m_root;
 	m_root = &m_flatNodes->front();
+
+	buildWideNodes();
 }
 
 // ----------------------------------------------------------------------
@@ -593,10 +893,50 @@ static inline bool templateTestOverlap2( BoxTree const & tree, TestShape const &
 
 // ----------
 
-bool BoxTree::testOverlap ( AxialBox const & box,      IdVec & outIds ) const   { return templateTestOverlap(*this,box,outIds); }
-bool BoxTree::testOverlap ( Line3d const & line,       IdVec & outIds ) const   { return templateTestOverlap(*this,line,outIds); }
-bool BoxTree::testOverlap ( Ray3d const & ray,         IdVec & outIds ) const   { return templateTestOverlap(*this,ray,outIds); }
-bool BoxTree::testOverlap ( Segment3d const & segment, IdVec & outIds ) const   { return templateTestOverlap(*this,segment,outIds); }
+// Same results in the same order as templateTestOverlapRecurse - a slot's
+// children are only looked at if its box is hit, and the slots of a wide
+// node are in the binary tree's depth-first order.
+
+template< class Query >
+static inline void templateTestWideOverlapRecurse( BoxTreeWideNode const * nodes, int nodeIndex, Query const & query, IdVec & outIds )
+{
+	BoxTreeWideNode const & node = nodes[nodeIndex];
+
+	int mask = calcOverlapMask(node,query);
+
+	for(int slot = 0; slot < node.m_count; slot++)
+	{
+		if((mask & (1 << slot)) == 0) continue;
+
+		if(node.m_userId[slot] != -1)
+		{
+			outIds.push_back(node.m_userId[slot]);
+		}
+
+		if(node.m_child[slot] != -1) templateTestWideOverlapRecurse(nodes,node.m_child[slot],query,outIds);
+	}
+}
+
+template< class Query, class TestShape >
+static inline bool templateTestWideOverlap( BoxTree const & tree, BoxTreeWideNodeVec const * wideNodes, TestShape const & testShape, IdVec & outIds )
+{
+	if((wideNodes == NULL) || wideNodes->empty()) return templateTestOverlap(tree,testShape,outIds);
+
+	int oldSize = outIds.size();
+
+	Query query(testShape);
+
+	templateTestWideOverlapRecurse( &wideNodes->front(), 0, query, outIds );
+
+	return oldSize != static_cast<int>(outIds.size());
+}
+
+// ----------
+
+bool BoxTree::testOverlap ( AxialBox const & box,      IdVec & outIds ) const   { return templateTestWideOverlap<BoxQuery>(*this,m_wideNodes,box,outIds); }
+bool BoxTree::testOverlap ( Line3d const & line,       IdVec & outIds ) const   { return templateTestWideOverlap<SlabQuery>(*this,m_wideNodes,line,outIds); }
+bool BoxTree::testOverlap ( Ray3d const & ray,         IdVec & outIds ) const   { return templateTestWideOverlap<SlabQuery>(*this,m_wideNodes,ray,outIds); }
+bool BoxTree::testOverlap ( Segment3d const & segment, IdVec & outIds ) const   { return templateTestWideOverlap<SlabQuery>(*this,m_wideNodes,segment,outIds); }
 
 // ----------------------------------------------------------------------
 
@@ -659,6 +999,8 @@ void BoxTree::read ( Iff & iff )
 	if(m_flatNodes)
 	{
 		m_root = &m_flatNodes->front();
+
+		buildWideNodes();
 	}
 }
 
@@ -706,6 +1048,9 @@ void BoxTree::clear ( void )
 
 	delete m_flatNodes;
 	m_flatNodes = NULL;
+
+	delete m_wideNodes;
+	m_wideNodes = NULL;
 }
 
 // ----------------------------------------------------------------------
@@ -728,3 +1073,206 @@ void BoxTree::pack ( void )
 }
 
 // ----------------------------------------------------------------------
+// Collapse the packed tree into wide nodes. Each wide node starts with the
+// boxes it was given and keeps replacing its biggest box with that box's
+// children while they fit. Only boxes without a user id are replaced, so
+// no ids are lost, and the children go where the box was so the slots
+// stay in depth-first order.
+
+void BoxTree::buildWideNodes ( void )
+{
+	delete m_wideNodes;
+	m_wideNodes = NULL;
+
+	if(!m_root) return;
+
+	m_wideNodes = new BoxTreeWideNodeVec();
+	m_wideNodes->reserve( (getNodeCount() + 2) / 3 );
+
+	BoxTreeNode const * root = m_root;
+
+	IGNORE_RETURN( buildWideNode(&root,1) );
+}
+
+// ----------
+
+int BoxTree::buildWideNode ( BoxTreeNode const * const * nodes, int nodeCount )
+{
+	BoxTreeNode const * slots[BoxTreeWideNode::cms_width];
+
+	int slotCount = nodeCount;
+
+	int i;
+
+	for(i = 0; i < slotCount; i++)
+	{
+		slots[i] = nodes[i];
+	}
+
+	for(;;)
+	{
+		int best = -1;
+		float bestVolume = -1.0f;
+
+		for(i = 0; i < slotCount; i++)
+		{
+			BoxTreeNode const * node = slots[i];
+
+			if(node->m_userId != -1) continue;
+
+			int childCount = (node->m_childA ? 1 : 0) + (node->m_childB ? 1 : 0);
+
+			if(childCount == 0) continue;
+
+			if(slotCount - 1 + childCount > BoxTreeWideNode::cms_width) continue;
+
+			float volume = node->m_box.getVolume();
+
+			if(volume > bestVolume)
+			{
+				best = i;
+				bestVolume = volume;
+			}
+		}
+
+		if(best == -1) break;
+
+		BoxTreeNode const * node = slots[best];
+
+		BoxTreeNode const * children[2];
+		int childCount = 0;
+
+		if(node->m_childA) children[childCount++] = node->m_childA;
+		if(node->m_childB) children[childCount++] = node->m_childB;
+
+		for(i = slotCount - 1; i > best; i--)
+		{
+			slots[i + childCount - 1] = slots[i];
+		}
+
+		for(i = 0; i < childCount; i++)
+		{
+			slots[best + i] = children[i];
+		}
+
+		slotCount += childCount - 1;
+	}
+
+	// ----------
+	// The children's wide nodes are added after this one, so look this one
+	// up again each time in case the vector moved.
+
+	int wideIndex = m_wideNodes->size();
+
+	m_wideNodes->push_back(BoxTreeWideNode());
+
+	for(i = 0; i < slotCount; i++)
+	{
+		BoxTreeNode const * node = slots[i];
+
+		BoxTreeNode const * children[2];
+		int childCount = 0;
+
+		if(node->m_childA) children[childCount++] = node->m_childA;
+		if(node->m_childB) children[childCount++] = node->m_childB;
+
+		int childIndex = childCount ? buildWideNode(children,childCount) : -1;
+
+		m_wideNodes->at(wideIndex).setSlot(i,node->m_box,node->m_userId,childIndex);
+	}
+
+	m_wideNodes->at(wideIndex).m_count = slotCount;
+
+	return wideIndex;
+}
+
+// ----------------------------------------------------------------------
+// Time gathering candidates for pseudo-random segments through the tree's
+// bounds with the binary and the wide traversal.
+
+void BoxTree::benchmark ( int segmentCount ) const
+{
+	if(m_root == NULL) return;
+	if(segmentCount <= 0) return;
+
+	AxialBox const & bounds = m_root->m_box;
+
+	Vector const & min = bounds.getMin();
+	Vector const & max = bounds.getMax();
+
+	std::vector<Segment3d> segments;
+	segments.reserve(segmentCount);
+
+	uint32 seed = 12345;
+
+	for(int i = 0; i < segmentCount; i++)
+	{
+		float values[6];
+
+		for(int j = 0; j < 6; j++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			values[j] = static_cast<float>(seed >> 8) / static_cast<float>(1 << 24);
+		}
+
+		Vector begin( min.x + (max.x - min.x) * values[0], min.y + (max.y - min.y) * values[1], min.z + (max.z - min.z) * values[2] );
+		Vector end( min.x + (max.x - min.x) * values[3], min.y + (max.y - min.y) * values[4], min.z + (max.z - min.z) * values[5] );
+
+		segments.push_back( Segment3d(begin,end) );
+	}
+
+	IdVec ids;
+	ids.reserve(256);
+
+	PerformanceTimer timer;
+
+	// ----------
+
+	int binaryCount = 0;
+
+	timer.start();
+
+	for(int i = 0; i < segmentCount; i++)
+	{
+		ids.clear();
+
+		IGNORE_RETURN( templateTestOverlap(*this,segments[i],ids) );
+
+		binaryCount += ids.size();
+	}
+
+	timer.stop();
+
+	float binaryTime = timer.getElapsedTime();
+
+	// ----------
+
+	int wideCount = 0;
+
+	timer.start();
+
+	for(int i = 0; i < segmentCount; i++)
+	{
+		ids.clear();
+
+		IGNORE_RETURN( templateTestWideOverlap<SlabQuery>(*this,m_wideNodes,segments[i],ids) );
+
+		wideCount += ids.size();
+	}
+
+	timer.stop();
+
+	float wideTime = timer.getElapsedTime();
+
+	// ----------
+
+	DEBUG_WARNING(binaryCount != wideCount,("BoxTree::benchmark - the wide traversal found %d candidates, the binary one found %d\n",wideCount,binaryCount));
+
+	int wideNodeCount = m_wideNodes ? static_cast<int>(m_wideNodes->size()) : 0;
+
+	REPORT_LOG(true, ("BoxTree benchmark: %d segments, %d nodes, %d wide nodes\n", segmentCount, getNodeCount(), wideNodeCount));
+	REPORT_LOG(true, ("  binary: %.0f segments/sec, wide: %.0f segments/sec\n", segmentCount / std::max(binaryTime, 0.000001f), segmentCount / std::max(wideTime, 0.000001f)));
+	REPORT_LOG(true, ("  %.1f candidates/segment\n", static_cast<float>(wideCount) / segmentCount));
+}
+
+// ======================================================================
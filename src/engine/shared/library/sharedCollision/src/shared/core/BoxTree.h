@@ -15,6 +15,7 @@
 #include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/Tag.h"
 
 class BoxTreeNode;
+class BoxTreeWideNode;
 class DebugShapeRenderer;
 
 class Line3d;
@@ -25,6 +26,7 @@ class BoxTreeNode;
 class Iff;
 
 typedef stdvector<BoxTreeNode>::fwd BoxTreeNodeVec;
+typedef stdvector<BoxTreeWideNode>::fwd BoxTreeWideNodeVec;
 typedef stdvector<AxialBox>::fwd BoxVec;
 typedef stdvector<int>::fwd IdVec;
 
@@ -62,6 +64,8 @@ public:
 	
 	bool    findClosest     ( Vector const & V, float maxDistance, float & outDistance, int & outId ) const;
 
+	void    benchmark       ( int segmentCount ) const;
+
 	void    clearTestCounter( void );
 	int     getTestCounter  ( void ) const;
 	
@@ -78,9 +82,13 @@ protected:
 
 	bool    isFlat          ( void ) const;
 
+	void    buildWideNodes  ( void );
+	int     buildWideNode   ( BoxTreeNode const * const * nodes, int nodeCount );
+
 	// ----------
 
 	BoxTreeNodeVec *    m_flatNodes;
+	BoxTreeWideNodeVec * m_wideNodes;     // the flat nodes again, four boxes to a node, for the overlap tests
 	
 	BoxTreeNode *       m_root;
 	
@@ -9,6 +9,7 @@
 #include "sharedCollision/ConfigSharedCollision.h"
 
 #include "sharedCollision/CollisionWorld.h"
+#include "sharedCollision/FloorMesh.h"
 #include "sharedCollision/SpatialDatabase.h"
 
 #include "sharedFoundation/ConfigFile.h"
@@ -75,10 +76,33 @@ IsPlayerHouseHook ms_isPlayerHouseHook = NULL;
 
 	bool ms_spaceAiLoggingEnabled = false;
 	bool ms_useOriginalAvoidanceAlgorithm = false;
+
+	bool         ms_benchmarkRaycasts      = false;
+	char const * ms_benchmarkRaycastsFloor = "";
+	int          ms_benchmarkRaycastsCount = 100000;
+
+	void benchmarkRaycasts();
 }
 
 using namespace ConfigSharedCollisionNamespace;
 
+// ----------------------------------------------------------------------
+// Run once when the benchmarkRaycasts debug flag is set, over the floor
+// named by the benchmarkRaycastsFloor config option.
+
+void ConfigSharedCollisionNamespace::benchmarkRaycasts()
+{
+	ms_benchmarkRaycasts = false;
+
+	if (!ms_benchmarkRaycastsFloor || !*ms_benchmarkRaycastsFloor)
+	{
+		WARNING(true, ("FloorMesh::benchmarkRaycasts - set [SharedCollision] benchmarkRaycastsFloor to a .flr file to benchmark"));
+		return;
+	}
+
+	FloorMesh::benchmarkRaycasts(ms_benchmarkRaycastsFloor, ms_benchmarkRaycastsCount);
+}
+
 // ----------------------------------------------------------------------
 
 void ConfigSharedCollision::install ( void )
@@ -120,6 +144,10 @@ void ConfigSharedCollision::install ( void )
 	DebugFlags::registerFlag( ms_shoveEnabled,					"SharedCollision",    "0x4F474F67");  // hash of shoveEnabled
 	DebugFlags::registerFlag( ms_spaceAiLoggingEnabled,			"SharedCollision",    "spaceAiLoggingEnabled");
 	DebugFlags::registerFlag( ms_useOriginalAvoidanceAlgorithm,	"SharedCollision",    "useOriginalAvoidanceAlgorithm");
+	DebugFlags::registerFlag( ms_benchmarkRaycasts,				"SharedCollision",    "benchmarkRaycasts", benchmarkRaycasts);
+
+	ms_benchmarkRaycastsFloor = ConfigFile::getKeyString("SharedCollision", "benchmarkRaycastsFloor", ms_benchmarkRaycastsFloor);
+	ms_benchmarkRaycastsCount = ConfigFile::getKeyInt("SharedCollision", "benchmarkRaycastsCount", ms_benchmarkRaycastsCount);
 	
 	// ----------
 
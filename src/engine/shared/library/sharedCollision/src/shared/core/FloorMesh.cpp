@@ -30,6 +30,7 @@
 #include "sharedCollision/BoxExtent.h"
 
 #include "sharedDebug/DataLint.h"
+#include "sharedDebug/PerformanceTimer.h"
 
 #include "sharedMath/Triangle3d.h"
 #include "sharedMath/Line3d.h"
@@ -1542,6 +1543,78 @@ void FloorMesh::remove ( void )
 	FloorMeshList::remove();
 }
 
+// ----------------------------------------------------------------------
+// Time the box tree's candidate gathering, then full segment tests against
+// the mesh, for pseudo-random segments through the mesh's bounds.
+
+void FloorMesh::benchmarkRaycasts ( char const * fileName, int rayCount )
+{
+	if(rayCount <= 0) return;
+
+	FloorMesh * mesh = const_cast<FloorMesh *>(FloorMeshList::fetch(fileName));
+
+	if(!mesh)
+	{
+		WARNING(true, ("FloorMesh::benchmarkRaycasts - Could not find floor mesh %s", fileName));
+		return;
+	}
+
+	if(!mesh->hasBoxTree())
+	{
+		mesh->buildBoxTree();
+	}
+
+	BoxTree const * tree = mesh->getBoxTree();
+
+	if(tree)
+	{
+		tree->benchmark(rayCount);
+	}
+
+	// ----------
+
+	AxialBox bounds = mesh->getBoundingABox();
+
+	Vector const & min = bounds.getMin();
+	Vector const & max = bounds.getMax();
+
+	uint32 seed = 54321;
+
+	int hitCount = 0;
+
+	PerformanceTimer timer;
+
+	timer.start();
+
+	for(int i = 0; i < rayCount; i++)
+	{
+		float values[6];
+
+		for(int j = 0; j < 6; j++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			values[j] = static_cast<float>(seed >> 8) / static_cast<float>(1 << 24);
+		}
+
+		Vector begin( min.x + (max.x - min.x) * values[0], min.y + (max.y - min.y) * values[1], min.z + (max.z - min.z) * values[2] );
+		Vector end( min.x + (max.x - min.x) * values[3], min.y + (max.y - min.y) * values[4], min.z + (max.z - min.z) * values[5] );
+
+		if(mesh->testIntersect(Segment3d(begin,end)))
+		{
+			hitCount++;
+		}
+	}
+
+	timer.stop();
+
+	float elapsedTime = timer.getElapsedTime();
+
+	REPORT_LOG(true, ("FloorMesh raycast benchmark: %s, %d tris, %d rays\n", fileName, mesh->getTriCount(), rayCount));
+	REPORT_LOG(true, ("  %.0f rays/sec, %.3f msec total, %d of %d hit\n", rayCount / std::max(elapsedTime, 0.000001f), elapsedTime * 1000.0f, hitCount, rayCount));
+
+	mesh->releaseReference();
+}
+
 // ----------------------------------------------------------------------
 
 bool FloorMesh::findFloorTri ( FloorLocator const & testLoc,
@@ -69,6 +69,8 @@ public:
 
 	static FloorMesh *          create          ( const std::string & filename );
 
+	static void                 benchmarkRaycasts ( char const * fileName, int rayCount );
+
 	virtual void                calcBounds      ( void ) const;
 
 	// ----------
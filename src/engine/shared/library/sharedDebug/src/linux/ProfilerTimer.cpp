@@ -8,6 +8,8 @@
 #include "sharedDebug/FirstSharedDebug.h"
 #include "sharedDebug/ProfilerTimer.h"
 
+#include <time.h>
+
 // ======================================================================
 
 void ProfilerTimer::install()
@@ -36,4 +38,23 @@ void ProfilerTimer::getFrequency(Type &frequency)
 	frequency = 1000000;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Trace timestamps are in nanoseconds from the monotonic clock.
+ */
+
+void ProfilerTimer::getTraceTime(Type &time)
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	time = static_cast<Type>(ts.tv_sec)*static_cast<Type>(1000000000)+static_cast<Type>(ts.tv_nsec);
+}
+
+// ----------------------------------------------------------------------
+
+void ProfilerTimer::getTraceFrequency(Type &frequency)
+{
+	frequency = 1000000000;
+}
+
 // ======================================================================
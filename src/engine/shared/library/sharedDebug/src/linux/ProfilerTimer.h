@@ -22,6 +22,8 @@ public:
 	static void getTime(Type &type);
 	static void getCalibratedTime(Type &time, Type &frequency);
 	static void getFrequency(Type &frequency);
+	static void getTraceTime(Type &time);
+	static void getTraceFrequency(Type &frequency);
 };
 
 // ======================================================================
@@ -17,7 +17,16 @@
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/MemoryBlockManager.h"
 #include "sharedFoundation/MemoryBlockManagerMacros.h"
+#include "sharedFoundation/Os.h"
 
+#if defined(PLATFORM_WIN32)
+#include "sharedFoundation/WindowsWrapper.h"
+#else
+#include <pthread.h>
+#endif
+
+#include <cstdio>
+#include <string>
 #include <vector>
 #include <algorithm>
 
@@ -122,6 +131,82 @@ namespace ProfilerNamespace
 	int                           ms_stackDepth;
 	SortedProfilerEntries         ms_sortedProfilerEntries;
 
+	// ----------------------------------------------------------------------
+	// Trace capture.  While a capture is running every thread that enters a
+	// block records its complete blocks into a buffer of its own.  Only the
+	// owning thread writes to a buffer and it publishes each event by bumping
+	// the event count after a memory barrier, so recording never takes a
+	// lock; the main thread reads up to the published count when it writes
+	// the trace at the end of the captured frames.
+
+	struct TraceEvent
+	{
+		char const *         name;
+		ProfilerTimer::Type  start;
+		ProfilerTimer::Type  end;
+	};
+
+	struct TraceOpenBlock
+	{
+		char const *         name;
+		ProfilerTimer::Type  start;
+	};
+
+	int const cs_traceMaxOpenBlocks      = 64;
+	int const cs_traceThreadNameLength   = 32;
+
+	struct TraceThreadBuffer
+	{
+		TraceThreadBuffer *  next;
+		int                  threadIndex;
+		bool                 mainThread;
+		char                 name[cs_traceThreadNameLength];
+		long volatile        released;       // set when the owning thread exits so another thread can take the buffer
+		int volatile         generation;     // capture the events belong to
+		int volatile         eventCount;
+		int volatile         droppedEvents;
+		TraceEvent *         events;
+		int                  openBlockCount;
+		TraceOpenBlock       openBlocks[cs_traceMaxOpenBlocks];
+	};
+
+	void                memoryBarrier();
+	TraceThreadBuffer * compareExchangeTraceThreadBuffers(TraceThreadBuffer *exchange, TraceThreadBuffer *compare);
+	bool                claimTraceThreadBuffer(TraceThreadBuffer &buffer);
+	int                 getNextTraceThreadIndex();
+	TraceThreadBuffer * getTraceThreadData();
+	void                setTraceThreadData(TraceThreadBuffer *buffer);
+	TraceThreadBuffer * getTraceThreadBuffer();
+	void                prepareTraceThreadBuffer(TraceThreadBuffer &buffer);
+	void                recordTraceEnter(char const *name);
+	void                recordTraceLeave(char const *name);
+	void                beginTraceFrame();
+	void                endTraceFrame();
+	void                writeJsonString(FILE *file, char const *text);
+	void                writeTrace();
+
+#if defined(PLATFORM_WIN32)
+	DWORD                         ms_traceThreadSlot = TLS_OUT_OF_INDEXES;
+#else
+	bool                          ms_traceThreadKeyCreated;
+	pthread_key_t                 ms_traceThreadKey;
+#endif
+
+	TraceThreadBuffer * volatile  ms_traceThreadBuffers;
+	int volatile                  ms_traceGeneration;
+	long volatile                 ms_traceNextThreadIndex;
+	bool volatile                 ms_traceCapturing;
+	bool                          ms_traceCaptureRequested;
+	bool                          ms_debugCaptureTraceFlag;
+	int                           ms_traceRequestedFrames;
+	std::string                   ms_traceRequestedFileName;
+	int                           ms_traceFramesRemaining;
+	std::string                   ms_traceFileName;
+	ProfilerTimer::Type           ms_traceStartTime;
+	int                           ms_traceMainThreadDepth;
+	int                           ms_traceEventsPerThread = 65536;
+	int                           ms_traceCaptureFrames = 30;
+	std::string                   ms_traceCaptureFileName = "profile_trace.json";
 }
 using namespace ProfilerNamespace;
 
@@ -239,6 +324,12 @@ void Profiler::install()
 	ms_rootVisibleExpandableEntry = new VisibleExpandableEntry(NULL);
 	ms_rootVisibleExpandableEntry->setExpanded(true);
 	ms_selectedVisibleExpandableEntry = ms_rootVisibleExpandableEntry;
+
+#if defined(PLATFORM_WIN32)
+	ms_traceThreadSlot = TlsAlloc();
+#else
+	ms_traceThreadKeyCreated = (pthread_key_create(&ms_traceThreadKey, 0) == 0);
+#endif
 }
 
 // ----------------------------------------------------------------------
@@ -253,6 +344,30 @@ void Profiler::remove()
 	ms_previousVisibleExpandableEntry = NULL;
 	ms_profilerEntriesCurrent = NULL;
 	ms_profilerEntriesLast = NULL;
+
+	//-- other threads have been shut down by now, so their trace buffers can go
+	ms_traceCapturing = false;
+	while (ms_traceThreadBuffers)
+	{
+		TraceThreadBuffer * const buffer = ms_traceThreadBuffers;
+		ms_traceThreadBuffers = buffer->next;
+		delete [] buffer->events;
+		delete buffer;
+	}
+
+#if defined(PLATFORM_WIN32)
+	if (ms_traceThreadSlot != TLS_OUT_OF_INDEXES)
+	{
+		IGNORE_RETURN(TlsFree(ms_traceThreadSlot));
+		ms_traceThreadSlot = TLS_OUT_OF_INDEXES;
+	}
+#else
+	if (ms_traceThreadKeyCreated)
+	{
+		IGNORE_RETURN(pthread_key_delete(ms_traceThreadKey));
+		ms_traceThreadKeyCreated = false;
+	}
+#endif
 }
 
 // ----------------------------------------------------------------------
@@ -264,7 +379,11 @@ void Profiler::registerDebugFlags()
 	DebugFlags::registerFlag(ms_desiredEnabled,     "SharedDebug/Profiler", "enabled");
 	DebugFlags::registerFlag(ms_debugReportLogFlag, "SharedDebug/Profiler", "logNextReport");
 	DebugFlags::registerFlag(ms_temporaryExpandAll, "SharedDebug/Profiler", "temporaryExpandAll");
+	DebugFlags::registerFlag(ms_debugCaptureTraceFlag, "SharedDebug/Profiler", "captureTrace");
 	ms_displayPercentageMinimum = ConfigFile::getKeyInt("SharedDebug/Profiler", "displayPercentageMinimum", 0);
+	ms_traceCaptureFrames = ConfigFile::getKeyInt("SharedDebug/Profiler", "traceCaptureFrames", ms_traceCaptureFrames);
+	ms_traceCaptureFileName = ConfigFile::getKeyString("SharedDebug/Profiler", "traceFileName", ms_traceCaptureFileName.c_str());
+	ms_traceEventsPerThread = std::max(1024, ConfigFile::getKeyInt("SharedDebug/Profiler", "traceEventsPerThread", ms_traceEventsPerThread));
 }
 
 // ----------------------------------------------------------------------
@@ -697,6 +816,11 @@ void Profiler::handleOperation(char const *operation)
 		if (result)
 			ms_displayPercentageMinimum = atoi(result+1);
 	}
+	else if (myCompare("captureTrace", operation))
+	{
+		const char *result = strchr(operation, ' ');
+		startTraceCapture(result ? atoi(result+1) : ms_traceCaptureFrames, ms_traceCaptureFileName.c_str());
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -812,24 +936,60 @@ void ProfilerNamespace::leaveWithTime(char const *name, ProfilerTimer::Type time
 
 void Profiler::enter(char const *name)
 {
+	//-- the profile stack belongs to the main thread, other threads only record into a trace capture
+	if (!Os::isMainThread())
+	{
+		if (ms_traceCapturing)
+			recordTraceEnter(name);
+		return;
+	}
+
+	if (ms_traceMainThreadDepth++ == 0)
+		beginTraceFrame();
+
 	ProfilerTimer::Type time;
 	ProfilerTimer::getTime(time);
 	enterWithTime(name, time);
+
+	if (ms_traceCapturing)
+		recordTraceEnter(name);
 }
 
 // ----------------------------------------------------------------------
 
 void Profiler::leave(char const *name)
 {
+	if (!Os::isMainThread())
+	{
+		if (ms_traceCapturing)
+			recordTraceLeave(name);
+		return;
+	}
+
+	if (ms_traceCapturing)
+		recordTraceLeave(name);
+
 	ProfilerTimer::Type time;
 	ProfilerTimer::getTime(time);
 	leaveWithTime(name, time);
+
+	if (ms_traceMainThreadDepth > 0 && --ms_traceMainThreadDepth == 0)
+		endTraceFrame();
 }
 
 // ----------------------------------------------------------------------
 
 void Profiler::transfer(char const *leaveName, char const *enterName)
 {
+	if (ms_traceCapturing)
+	{
+		recordTraceLeave(leaveName);
+		recordTraceEnter(enterName);
+	}
+
+	if (!Os::isMainThread())
+		return;
+
 	ProfilerTimer::Type time;
 	ProfilerTimer::getTime(time);
 	leaveWithTime(leaveName, time);
@@ -840,6 +1000,9 @@ void Profiler::transfer(char const *leaveName, char const *enterName)
 
 void Profiler::adjustForLostBlocks(char const *expectingName)
 {
+	if (!Os::isMainThread())
+		return;
+
 	// This deals with cases where we've either missed closing a block or closed a block that wasn't open.
 	// We prefer to guess that we've failed to close a block, since that is the more common mistake, before
 	// trying to deal with it as though a block was closed but not opened.
@@ -872,3 +1035,408 @@ void Profiler::adjustForLostBlocks(char const *expectingName)
 }
 
 // ======================================================================
+// ======================================================================
+
+void ProfilerNamespace::memoryBarrier()
+{
+#if defined(PLATFORM_WIN32)
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+// ----------------------------------------------------------------------
+
+TraceThreadBuffer * ProfilerNamespace::compareExchangeTraceThreadBuffers(TraceThreadBuffer *exchange, TraceThreadBuffer *compare)
+{
+#if defined(PLATFORM_WIN32)
+	return static_cast<TraceThreadBuffer *>(InterlockedCompareExchangePointer(reinterpret_cast<void * volatile *>(&ms_traceThreadBuffers), exchange, compare));
+#else
+	return __sync_val_compare_and_swap(&ms_traceThreadBuffers, compare, exchange);
+#endif
+}
+
+// ----------------------------------------------------------------------
+
+bool ProfilerNamespace::claimTraceThreadBuffer(TraceThreadBuffer &buffer)
+{
+#if defined(PLATFORM_WIN32)
+	return InterlockedCompareExchange(&buffer.released, 0, 1) == 1;
+#else
+	return __sync_val_compare_and_swap(&buffer.released, 1, 0) == 1;
+#endif
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Each thread that takes a buffer gets an index of its own, which is the
+ * thread id in the trace, so a reused buffer never shows up as the thread
+ * that had it before.
+ */
+
+int ProfilerNamespace::getNextTraceThreadIndex()
+{
+#if defined(PLATFORM_WIN32)
+	return static_cast<int>(InterlockedIncrement(&ms_traceNextThreadIndex));
+#else
+	return static_cast<int>(__sync_add_and_fetch(&ms_traceNextThreadIndex, 1));
+#endif
+}
+
+// ----------------------------------------------------------------------
+
+TraceThreadBuffer * ProfilerNamespace::getTraceThreadData()
+{
+#if defined(PLATFORM_WIN32)
+	if (ms_traceThreadSlot == TLS_OUT_OF_INDEXES)
+		return 0;
+	return static_cast<TraceThreadBuffer *>(TlsGetValue(ms_traceThreadSlot));
+#else
+	if (!ms_traceThreadKeyCreated)
+		return 0;
+	return static_cast<TraceThreadBuffer *>(pthread_getspecific(ms_traceThreadKey));
+#endif
+}
+
+// ----------------------------------------------------------------------
+
+void ProfilerNamespace::setTraceThreadData(TraceThreadBuffer *buffer)
+{
+#if defined(PLATFORM_WIN32)
+	IGNORE_RETURN(TlsSetValue(ms_traceThreadSlot, buffer));
+#else
+	IGNORE_RETURN(pthread_setspecific(ms_traceThreadKey, buffer));
+#endif
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get the trace buffer for the calling thread, taking one left behind by
+ * a thread that has exited or adding a new one the first time through.
+ *
+ * @return NULL if the profiler has not been installed.
+ */
+
+TraceThreadBuffer * ProfilerNamespace::getTraceThreadBuffer()
+{
+	TraceThreadBuffer *buffer = getTraceThreadData();
+	if (buffer)
+		return buffer;
+
+#if defined(PLATFORM_WIN32)
+	if (ms_traceThreadSlot == TLS_OUT_OF_INDEXES)
+		return 0;
+#else
+	if (!ms_traceThreadKeyCreated)
+		return 0;
+#endif
+
+	// a buffer holding events of the capture that is running still has to be written
+	// out under the thread that recorded them, so it is left alone until the next one
+	for (TraceThreadBuffer *check = ms_traceThreadBuffers; check && !buffer; check = check->next)
+		if (check->released && (check->generation != ms_traceGeneration || check->eventCount == 0) && claimTraceThreadBuffer(*check))
+			buffer = check;
+
+	if (!buffer)
+	{
+		buffer = new TraceThreadBuffer;
+		buffer->released = 0;
+		buffer->generation = 0;
+		buffer->eventCount = 0;
+		buffer->droppedEvents = 0;
+		buffer->events = 0;
+		buffer->openBlockCount = 0;
+
+		// buffers are only added at the head and never removed while threads are running
+		TraceThreadBuffer *head;
+		do
+		{
+			head = ms_traceThreadBuffers;
+			buffer->next = head;
+		} while (compareExchangeTraceThreadBuffers(buffer, head) != head);
+	}
+
+	buffer->threadIndex = getNextTraceThreadIndex();
+	buffer->mainThread = Os::isMainThread();
+	buffer->name[0] = '\0';
+	setTraceThreadData(buffer);
+	return buffer;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Start the buffer over if it still holds the events of an earlier capture.
+ * Only the owning thread calls this.
+ */
+
+inline void ProfilerNamespace::prepareTraceThreadBuffer(TraceThreadBuffer &buffer)
+{
+	int const generation = ms_traceGeneration;
+	if (buffer.generation == generation)
+		return;
+
+	if (!buffer.events)
+		buffer.events = new TraceEvent[static_cast<size_t>(ms_traceEventsPerThread)];
+
+	buffer.openBlockCount = 0;
+	buffer.droppedEvents = 0;
+	buffer.eventCount = 0;
+
+	// the reset count has to be visible before the generation that says it is current
+	memoryBarrier();
+	buffer.generation = generation;
+}
+
+// ----------------------------------------------------------------------
+
+void ProfilerNamespace::recordTraceEnter(char const *name)
+{
+	TraceThreadBuffer * const buffer = getTraceThreadBuffer();
+	if (!buffer)
+		return;
+
+	prepareTraceThreadBuffer(*buffer);
+
+	// blocks nested too deeply are counted so the leaves still match up, but aren't recorded
+	if (buffer->openBlockCount < cs_traceMaxOpenBlocks)
+	{
+		TraceOpenBlock &block = buffer->openBlocks[buffer->openBlockCount];
+		block.name = name;
+		ProfilerTimer::getTraceTime(block.start);
+	}
+	++buffer->openBlockCount;
+}
+
+// ----------------------------------------------------------------------
+
+void ProfilerNamespace::recordTraceLeave(char const *name)
+{
+	ProfilerTimer::Type time;
+	ProfilerTimer::getTraceTime(time);
+
+	TraceThreadBuffer * const buffer = getTraceThreadBuffer();
+	if (!buffer)
+		return;
+
+	prepareTraceThreadBuffer(*buffer);
+
+	// the block was entered before the capture started
+	if (buffer->openBlockCount == 0)
+		return;
+
+	--buffer->openBlockCount;
+	if (buffer->openBlockCount >= cs_traceMaxOpenBlocks)
+		return;
+
+	TraceOpenBlock const &block = buffer->openBlocks[buffer->openBlockCount];
+	DEBUG_WARNING(block.name != name, ("Profiler trace leaving '%s' but expected '%s'", name, block.name));
+
+	int const index = buffer->eventCount;
+	if (index >= ms_traceEventsPerThread)
+	{
+		++buffer->droppedEvents;
+		return;
+	}
+
+	TraceEvent &event = buffer->events[index];
+	event.name = block.name;
+	event.start = block.start;
+	event.end = time;
+
+	// publish the event only once it has been completely written
+	memoryBarrier();
+	buffer->eventCount = index + 1;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Called on the main thread as it enters its outermost block.
+ */
+
+void ProfilerNamespace::beginTraceFrame()
+{
+	if (ms_debugCaptureTraceFlag)
+	{
+		ms_debugCaptureTraceFlag = false;
+		Profiler::startTraceCapture(ms_traceCaptureFrames, ms_traceCaptureFileName.c_str());
+	}
+
+	if (!ms_traceCaptureRequested || ms_traceCapturing)
+		return;
+
+	ms_traceCaptureRequested = false;
+	ms_traceFramesRemaining = ms_traceRequestedFrames;
+	ms_traceFileName = ms_traceRequestedFileName;
+	ProfilerTimer::getTraceTime(ms_traceStartTime);
+
+	// a new generation makes every thread start its buffer over on its next block
+	ms_traceGeneration = ms_traceGeneration + 1;
+	memoryBarrier();
+	ms_traceCapturing = true;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Called on the main thread as it leaves its outermost block.
+ */
+
+void ProfilerNamespace::endTraceFrame()
+{
+	if (!ms_traceCapturing || --ms_traceFramesRemaining > 0)
+		return;
+
+	ms_traceCapturing = false;
+	memoryBarrier();
+	writeTrace();
+}
+
+// ----------------------------------------------------------------------
+
+void ProfilerNamespace::writeJsonString(FILE *file, char const *text)
+{
+	IGNORE_RETURN(fputc('"', file));
+	for ( ; *text; ++text)
+	{
+		unsigned char const c = static_cast<unsigned char>(*text);
+		if (c == '"' || c == '\\')
+		{
+			IGNORE_RETURN(fputc('\\', file));
+			IGNORE_RETURN(fputc(c, file));
+		}
+		else if (c < 0x20)
+			IGNORE_RETURN(fprintf(file, "\\u%04x", static_cast<unsigned int>(c)));
+		else
+			IGNORE_RETURN(fputc(c, file));
+	}
+	IGNORE_RETURN(fputc('"', file));
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Write the captured events in the Chrome trace event format, which both
+ * chrome://tracing and Perfetto load.  Timestamps are microseconds from the
+ * start of the capture with nanosecond fractions.
+ */
+
+void ProfilerNamespace::writeTrace()
+{
+	FILE * const file = fopen(ms_traceFileName.c_str(), "w");
+	if (!file)
+	{
+		WARNING(true, ("Profiler could not open %s to write the trace", ms_traceFileName.c_str()));
+		return;
+	}
+
+	ProfilerTimer::Type frequency;
+	ProfilerTimer::getTraceFrequency(frequency);
+	double const microsecondsPerTick = 1000000.0 / static_cast<double>(frequency);
+
+	int const generation = ms_traceGeneration;
+	int threads = 0;
+	int events = 0;
+	int droppedEvents = 0;
+	char const * separator = "";
+
+	IGNORE_RETURN(fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file));
+
+	for (TraceThreadBuffer const *buffer = ms_traceThreadBuffers; buffer; buffer = buffer->next)
+	{
+		if (buffer->generation != generation)
+			continue;
+
+		memoryBarrier();
+		int const eventCount = buffer->eventCount;
+		memoryBarrier();
+
+		++threads;
+		events += eventCount;
+		droppedEvents += buffer->droppedEvents;
+
+		char defaultName[cs_traceThreadNameLength];
+		char const *threadName = buffer->name;
+		if (!*threadName)
+		{
+			IGNORE_RETURN(snprintf(defaultName, sizeof(defaultName), buffer->mainThread ? "Main" : "Thread %d", buffer->threadIndex));
+			threadName = defaultName;
+		}
+
+		IGNORE_RETURN(fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", separator, buffer->threadIndex));
+		writeJsonString(file, threadName);
+		IGNORE_RETURN(fputs("}}", file));
+		separator = ",\n";
+
+		for (int i = 0; i < eventCount; ++i)
+		{
+			TraceEvent const &event = buffer->events[i];
+			double const start = static_cast<double>(static_cast<int64>(event.start - ms_traceStartTime)) * microsecondsPerTick;
+			double const duration = static_cast<double>(static_cast<int64>(event.end - event.start)) * microsecondsPerTick;
+
+			IGNORE_RETURN(fputs(",\n{\"name\":", file));
+			writeJsonString(file, event.name);
+			IGNORE_RETURN(fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->threadIndex, start, duration));
+		}
+	}
+
+	IGNORE_RETURN(fputs("\n]}\n", file));
+	IGNORE_RETURN(fclose(file));
+
+	REPORT_LOG(true, ("Profiler wrote %d trace events from %d threads to %s, %d events dropped\n", events, threads, ms_traceFileName.c_str(), droppedEvents));
+}
+
+// ======================================================================
+/**
+ * Capture every profiler block on every thread for a number of main thread
+ * frames, starting with the next one, and write them to a trace file.
+ */
+
+void Profiler::startTraceCapture(int frames, char const *fileName)
+{
+	NOT_NULL(fileName);
+
+	ms_traceRequestedFrames = std::max(1, frames);
+	ms_traceRequestedFileName = fileName;
+	ms_traceCaptureRequested = true;
+}
+
+// ----------------------------------------------------------------------
+
+bool Profiler::isTraceCapturing()
+{
+	return ms_traceCapturing || ms_traceCaptureRequested;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Name the calling thread in trace captures.
+ */
+
+void Profiler::setThreadName(char const *name)
+{
+	NOT_NULL(name);
+
+	TraceThreadBuffer * const buffer = getTraceThreadBuffer();
+	if (!buffer)
+		return;
+
+	IGNORE_RETURN(strncpy(buffer->name, name, sizeof(buffer->name) - 1));
+	buffer->name[sizeof(buffer->name) - 1] = '\0';
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Called as a thread exits so a later thread can reuse its trace buffer.
+ */
+
+void Profiler::removeThread()
+{
+	TraceThreadBuffer * const buffer = getTraceThreadData();
+	if (!buffer)
+		return;
+
+	setTraceThreadData(0);
+	memoryBarrier();
+	buffer->released = 1;
+}
+
+// ======================================================================
@@ -113,6 +113,11 @@ public:
 	static void setDisplayPercentageMinimum(int percentage);
 	static void handleOperation(char const *operation);
 
+	static void           startTraceCapture(int frames, char const *fileName);
+	static bool           isTraceCapturing();
+	static void DLLEXPORT setThreadName(char const *name);
+	static void DLLEXPORT removeThread();
+
 private:
 
 	static void DLLEXPORT enter(char const *name);
@@ -87,4 +87,22 @@ void ProfilerTimer::getFrequency(Type &frequency)
 	frequency = ms_qpcFrequency;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Trace timestamps are compared across threads, so they always come from
+ * the performance counter rather than the per-core time stamp counter.
+ */
+
+void ProfilerTimer::getTraceTime(Type &time)
+{
+	IGNORE_RETURN(QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER *>(&time)));
+}
+
+// ----------------------------------------------------------------------
+
+void ProfilerTimer::getTraceFrequency(Type &frequency)
+{
+	frequency = ms_qpcFrequency;
+}
+
 // ======================================================================
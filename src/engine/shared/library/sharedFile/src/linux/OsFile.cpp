@@ -10,9 +10,11 @@
 #include "sharedFile/OsFile.h"
 
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <climits>
 
 // ======================================================================
 
@@ -64,6 +66,48 @@ OsFile *OsFile::open(const char *fileName, bool randomAccess)
 	return new OsFile(handle, DuplicateString(fileName));
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Map an entire file read-only into the address space of the process.
+ *
+ * The descriptor is closed before returning; the mapping keeps the file
+ * alive until it is released with unmap().
+ */
+
+void const *OsFile::map(const char *fileName, int &length)
+{
+	length = 0;
+
+	const int handle = ::open(fileName, O_RDONLY);
+	if (handle < 0)
+		return 0;
+
+	// lengths are ints, so files of 2GB or more are left to the streamed path
+	struct stat statBuffer;
+	if (fstat(handle, &statBuffer) != 0 || statBuffer.st_size <= 0 || statBuffer.st_size > INT_MAX)
+	{
+		close(handle);
+		return 0;
+	}
+
+	void * const data = mmap(0, static_cast<size_t>(statBuffer.st_size), PROT_READ, MAP_SHARED, handle, 0);
+	close(handle);
+
+	if (data == MAP_FAILED)
+		return 0;
+
+	length = static_cast<int>(statBuffer.st_size);
+	return data;
+}
+
+// ----------------------------------------------------------------------
+
+void OsFile::unmap(void const *data, int length)
+{
+	if (data)
+		IGNORE_RETURN(munmap(const_cast<void *>(data), static_cast<size_t>(length)));
+}
+
 // ----------------------------------------------------------------------
 
 OsFile::OsFile(int handle, char *fileName)
@@ -120,4 +164,23 @@ int OsFile::read(void *destinationBuffer, int numberOfBytes)
 	return result;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Read from an absolute offset without going through the file pointer.
+ *
+ * This may be called from several threads at once on the same file.
+ */
+
+int OsFile::read(int offset, void *destinationBuffer, int numberOfBytes)
+{
+	ssize_t result = 0;
+	do
+	{
+		result = ::pread(m_handle, destinationBuffer, static_cast<size_t>(numberOfBytes), static_cast<off_t>(offset));
+		DEBUG_FATAL((result < 0 && errno != EAGAIN && errno != EINTR), ("Read failed for %s: %d %d %s", m_fileName, static_cast<int>(result), errno, strerror(errno)));
+	} while (result < 0);
+
+	return static_cast<int>(result);
+}
+
 // ======================================================================
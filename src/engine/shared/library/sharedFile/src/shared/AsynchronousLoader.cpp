@@ -9,6 +9,8 @@
 #include "sharedFile/AsynchronousLoader.h"
 
 #include "sharedDebug/DebugFlags.h"
+#include "sharedDebug/PerformanceTimer.h"
+#include "sharedDebug/Profiler.h"
 #include "sharedFile/ConfigSharedFile.h"
 #include "sharedFile/Iff.h"
 #include "sharedFile/MemoryFile.h"
@@ -23,15 +25,13 @@
 #include "sharedThread/RunThread.h"
 #include "sharedThread/ThreadHandle.h"
 
+#include <algorithm>
+#include <climits>
 #include <deque>
 #include <string>
 #include <vector>
 #include <map>
 
-#ifdef _DEBUG
-#include <algorithm>
-#endif
-
 // ======================================================================
 
 const Tag TAG_ASYN = TAG(A,S,Y,N);
@@ -80,19 +80,67 @@ namespace AsynchronousLoaderNamespace
 	typedef stdvector<CachedFile>::fwd   CachedFiles;
 	typedef stdvector<CachedFiles*>::fwd CachedFilesPool;
 
+	struct FileLocation
+	{
+		int searchNode;
+		int archive;
+		int offset;
+	};
+
+	struct PrefetchedFile
+	{
+		FileRecord   *fileRecord;
+		FileLocation  location;
+		const void   *resource;
+		byte         *data;
+		int           length;
+	};
+	typedef stdvector<PrefetchedFile>::fwd PrefetchedFiles;
+
+	// requests submitted together by endBatch().  the shared dependencies of the requests are
+	// prefetched once, in tree file order, by the loader thread when it reaches the first request.
+	struct Batch
+	{
+		int               numberOfRequests;
+		int               numberOfOutstandingRequests;
+		bool              prefetched;
+		PrefetchedFiles  *prefetchedFiles;
+		int               numberOfPrefetchedBytes;
+		PerformanceTimer  timer;
+	};
+
 	struct Request
 	{
 		FileRecordList                 *fileRecordList;
 		AsynchronousLoader::Callback    callback;
 		void                           *data;
 		CachedFiles                    *cachedFiles;
+		Batch                          *batch;
 	};
 	typedef stddeque<Request *>::fwd  Requests;
 
+	struct BatchEntry
+	{
+		Request      *request;
+		FileLocation  location;
+		int           order;
+	};
+	typedef stdvector<BatchEntry>::fwd BatchEntries;
+
 	void remove();
 	void submitRequest(Request *request);
 	void threadRoutine();
 
+	void          getFileLocation(const char *fileName, FileLocation &location);
+	bool          fileLocationOrder(const FileLocation &lhs, const FileLocation &rhs);
+	bool          batchEntryOrder(const BatchEntry &lhs, const BatchEntry &rhs);
+	bool          prefetchedFileLocationOrder(const PrefetchedFile &lhs, const PrefetchedFile &rhs);
+	bool          prefetchedFileRecordOrder(const PrefetchedFile &lhs, const PrefetchedFile &rhs);
+	Batch        *createBatch(const BatchEntries &batchEntries);
+	void          prefetchBatch(Batch *batch);
+	AbstractFile *openPrefetchedFile(const Batch *batch, FileRecord *fileRecord);
+	void          retireBatchRequest(Batch *batch);
+
 #ifdef _DEBUG
 	static void debugReport();
 #endif
@@ -115,6 +163,17 @@ namespace AsynchronousLoaderNamespace
 	int                                         ms_numberOfCachedBytes;
 	int                                         ms_numberOfPostponedRequests;
 	int const                                   cms_postponeThreshold = 8 * 1024 * 1024;
+	int const                                   cms_prefetchLimit = 4 * 1024 * 1024;
+	int                                         ms_batchDepth;
+	BatchEntries                                ms_batchEntries;
+	int                                         ms_numberOfBatchesCompleted;
+	float                                       ms_lastBatchTimeToIdle;
+	float                                       ms_maximumBatchTimeToIdle;
+#ifdef _DEBUG
+	bool                                        ms_debugReportBatches;
+	int                                         ms_numberOfPrefetchedFiles;
+	int                                         ms_numberOfPrefetchedFileHits;
+#endif
 	int                                         ms_enabled;
 	ThreadHandle                                ms_threadHandle;
 	Semaphore                                   ms_eventsPending;
@@ -136,6 +195,59 @@ bool AsynchronousLoaderNamespace::FileMapComparison::operator()(const char *lhs,
 	return strcmp(lhs, rhs) < 0;
 }
 
+// ----------------------------------------------------------------------
+
+void AsynchronousLoaderNamespace::getFileLocation(const char *fileName, FileLocation &location)
+{
+	// files that can't be found sort after everything else
+	if (!TreeFile::getFileLocation(fileName, location.searchNode, location.archive, location.offset))
+	{
+		location.searchNode = INT_MAX;
+		location.archive = 0;
+		location.offset = 0;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+bool AsynchronousLoaderNamespace::fileLocationOrder(const FileLocation &lhs, const FileLocation &rhs)
+{
+	if (lhs.searchNode != rhs.searchNode)
+		return lhs.searchNode < rhs.searchNode;
+
+	if (lhs.archive != rhs.archive)
+		return lhs.archive < rhs.archive;
+
+	return lhs.offset < rhs.offset;
+}
+
+// ----------------------------------------------------------------------
+
+bool AsynchronousLoaderNamespace::batchEntryOrder(const BatchEntry &lhs, const BatchEntry &rhs)
+{
+	if (fileLocationOrder(lhs.location, rhs.location))
+		return true;
+
+	if (fileLocationOrder(rhs.location, lhs.location))
+		return false;
+
+	return lhs.order < rhs.order;
+}
+
+// ----------------------------------------------------------------------
+
+bool AsynchronousLoaderNamespace::prefetchedFileLocationOrder(const PrefetchedFile &lhs, const PrefetchedFile &rhs)
+{
+	return fileLocationOrder(lhs.location, rhs.location);
+}
+
+// ----------------------------------------------------------------------
+
+bool AsynchronousLoaderNamespace::prefetchedFileRecordOrder(const PrefetchedFile &lhs, const PrefetchedFile &rhs)
+{
+	return lhs.fileRecord < rhs.fileRecord;
+}
+
 // ======================================================================
 
 void AsynchronousLoader::install(const char *fileName)
@@ -221,6 +333,7 @@ void AsynchronousLoader::install(const char *fileName)
 #ifdef _DEBUG
 	DebugFlags::registerFlag(ms_debugDisable,     "SharedFile", "runtimeDisableAsynchronousLoader");
 	DebugFlags::registerFlag(ms_debugReport,      "SharedFile", "reportAsynchronousLoader", &debugReport);
+	DebugFlags::registerFlag(ms_debugReportBatches, "SharedFile", "reportAsynchronousLoaderBatches");
 	DebugFlags::registerFlag(ms_suspendCallbacks, "SharedFile", "suspendAsynchronousLoaderCallbacks");
 	DebugFlags::registerFlag(ms_suspendThread,    "SharedFile", "suspendAsynchronousLoaderThread");
 #endif
@@ -234,11 +347,14 @@ void AsynchronousLoader::install(const char *fileName)
 void AsynchronousLoaderNamespace::remove()
 {
 	DEBUG_FATAL(!ms_installed, ("not installed"));
+	DEBUG_FATAL(ms_batchDepth != 0, ("AsynchronousLoader removed during a batch"));
+
 	Request *request = reinterpret_cast<Request*>(ms_requestMemoryBlockManager->allocate());
 	request->fileRecordList = NULL;
 	request->callback = NULL;
 	request->data = NULL;
 	request->cachedFiles = NULL;
+	request->batch = NULL;
 
 	submitRequest(request);
 
@@ -271,6 +387,8 @@ void AsynchronousLoaderNamespace::remove()
 
 	delete ms_requestMemoryBlockManager;
 	ms_requestMemoryBlockManager = NULL;
+
+	BatchEntries().swap(ms_batchEntries);
 }
 
 // ----------------------------------------------------------------------
@@ -296,6 +414,9 @@ bool AsynchronousLoader::isEnabled()
 
 bool AsynchronousLoader::isIdle()
 {
+	if (!ms_batchEntries.empty())
+		return false;
+
 	ms_mutex.enter();
 		bool const idle = ms_pendingRequests.empty() && ms_completedRequests.empty();
 	ms_mutex.leave();
@@ -325,9 +446,12 @@ void AsynchronousLoader::enable()
 void AsynchronousLoaderNamespace::debugReport()
 {
 	DEBUG_REPORT_LOG_PRINT(true, ("%5.2f=fps %3d=sub %3d=pend %3d=comp %3d=ret %3d=pst %5d=kb\n", Clock::framesPerSecond(), ms_numberOfSubmittedRequests, ms_numberOfPendingRequests, ms_numberOfCompletedRequests, ms_numberOfRetiredRequests, ms_numberOfPostponedRequests, ms_numberOfCachedBytes / 1024));
+	DEBUG_REPORT_LOG_PRINT(true, ("%3d=batches %6.3f=lastIdle %6.3f=maxIdle %4d=prefetched %4d=prefetchHits\n", ms_numberOfBatchesCompleted, ms_lastBatchTimeToIdle, ms_maximumBatchTimeToIdle, ms_numberOfPrefetchedFiles, ms_numberOfPrefetchedFileHits));
 	ms_numberOfSubmittedRequests = 0;
 	ms_numberOfRetiredRequests = 0;
 	ms_numberOfFetchedResources = 0;
+	ms_numberOfPrefetchedFiles = 0;
+	ms_numberOfPrefetchedFileHits = 0;
 }
 
 #endif
@@ -370,7 +494,19 @@ void AsynchronousLoader::add(const char *fileName, Callback callback, void *data
 		request->callback = callback;
 		request->data = data;
 		request->cachedFiles = NULL;
-		submitRequest(request);
+		request->batch = NULL;
+
+		if (ms_batchDepth > 0)
+		{
+			// hold on to the request until the batch is closed so it can be sorted with the others
+			BatchEntry batchEntry;
+			batchEntry.request = request;
+			batchEntry.order = static_cast<int>(ms_batchEntries.size());
+			getFileLocation(request->fileRecordList->front()->fileName, batchEntry.location);
+			ms_batchEntries.push_back(batchEntry);
+		}
+		else
+			submitRequest(request);
 	}
 	else
 	{
@@ -383,6 +519,16 @@ void AsynchronousLoader::add(const char *fileName, Callback callback, void *data
 
 void AsynchronousLoader::remove(Callback callback, void *data)
 {
+	{
+		BatchEntries::iterator iEnd = ms_batchEntries.end();
+		for (BatchEntries::iterator i = ms_batchEntries.begin(); i != iEnd; ++i)
+			if (i->request->callback == callback && i->request->data == data)
+			{
+				i->request->callback = NULL;
+				i->request->data = NULL;
+			}
+	}
+
 	ms_mutex.enter();
 
 		{
@@ -434,6 +580,8 @@ void AsynchronousLoaderNamespace::threadRoutine()
 		// wait until there is a request to processs
 		ms_eventsPending.wait();
 
+		PROFILER_AUTO_BLOCK_DEFINE("AsynchronousLoader::processRequest");
+
 		bool postpone = false;
 
 		// get the request to service
@@ -453,6 +601,9 @@ void AsynchronousLoaderNamespace::threadRoutine()
 		if (postpone)
 			continue;
 
+		if (request->batch && !request->batch->prefetched)
+			prefetchBatch(request->batch);
+
 		int bytes = 0;
 
 		// make sure the request is still pending
@@ -482,8 +633,26 @@ void AsynchronousLoaderNamespace::threadRoutine()
 #endif
 					}
 
-					// othersize, try to open the file
+					// then see if the batch already read the file
 					if (!cachedFile.resource)
+					{
+						cachedFile.file = openPrefetchedFile(request->batch, fileRecord);
+						if (cachedFile.file)
+						{
+							bytes += cachedFile.file->length();
+
+							// mark the file as already loaded
+							if (extensionFunctions.fetchFunction)
+							{
+								ms_mutex.enter();
+									fileRecord->alreadyCached = true;
+								ms_mutex.leave();
+							}
+						}
+					}
+
+					// othersize, try to open the file
+					if (!cachedFile.resource && !cachedFile.file)
 					{
 						AbstractFile *file = TreeFile::open(fileRecord->fileName, AbstractFile::PriorityLow, true);
 						if (file)
@@ -680,6 +849,9 @@ void AsynchronousLoader::processCallbacks()
 				ms_numberOfCachedBytes -= bytes;
 			ms_mutex.leave();
 
+			if (request->batch)
+				retireBatchRequest(request->batch);
+
 			// free the request
 			ms_requestMemoryBlockManager->free(request);
 
@@ -702,4 +874,276 @@ void AsynchronousLoader::processCallbacks()
 	}
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Start collecting requests into a batch.
+ *
+ * Requests added until the matching endBatch() call are held back and then
+ * submitted together, ordered by where their files live in the tree files.
+ * Batches may be nested, the outermost endBatch() submits the requests.
+ */
+
+void AsynchronousLoader::beginBatch()
+{
+	++ms_batchDepth;
+}
+
+// ----------------------------------------------------------------------
+
+void AsynchronousLoader::endBatch()
+{
+	DEBUG_FATAL(ms_batchDepth <= 0, ("AsynchronousLoader::endBatch called without beginBatch"));
+
+	if (--ms_batchDepth > 0 || ms_batchEntries.empty())
+		return;
+
+	std::sort(ms_batchEntries.begin(), ms_batchEntries.end(), batchEntryOrder);
+
+	Batch * const batch = createBatch(ms_batchEntries);
+
+	const BatchEntries::iterator iEnd = ms_batchEntries.end();
+	for (BatchEntries::iterator i = ms_batchEntries.begin(); i != iEnd; ++i)
+	{
+		i->request->batch = batch;
+		submitRequest(i->request);
+	}
+
+	ms_batchEntries.clear();
+}
+
+// ----------------------------------------------------------------------
+
+bool AsynchronousLoader::isBatching()
+{
+	return ms_batchDepth > 0;
+}
+
+// ----------------------------------------------------------------------
+
+int AsynchronousLoader::getNumberOfBatchesCompleted()
+{
+	return ms_numberOfBatchesCompleted;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get the time from submitting the most recently completed batch until its last callback was made.
+ */
+
+float AsynchronousLoader::getLastBatchTimeToIdle()
+{
+	return ms_lastBatchTimeToIdle;
+}
+
+// ----------------------------------------------------------------------
+
+float AsynchronousLoader::getMaximumBatchTimeToIdle()
+{
+	return ms_maximumBatchTimeToIdle;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Create a batch for a set of requests and gather the dependencies they share.
+ *
+ * Every file of a request other than the first is a dependency.  Each
+ * dependency is listed once no matter how many requests need it.
+ */
+
+Batch *AsynchronousLoaderNamespace::createBatch(const BatchEntries &batchEntries)
+{
+	Batch * const batch = new Batch;
+	batch->numberOfRequests = static_cast<int>(batchEntries.size());
+	batch->numberOfOutstandingRequests = batch->numberOfRequests;
+	batch->prefetched = false;
+	batch->prefetchedFiles = new PrefetchedFiles;
+	batch->numberOfPrefetchedBytes = 0;
+
+	PrefetchedFiles &prefetchedFiles = *batch->prefetchedFiles;
+
+	PrefetchedFile prefetchedFile;
+	prefetchedFile.fileRecord = NULL;
+	prefetchedFile.location.searchNode = 0;
+	prefetchedFile.location.archive = 0;
+	prefetchedFile.location.offset = 0;
+	prefetchedFile.resource = NULL;
+	prefetchedFile.data = NULL;
+	prefetchedFile.length = 0;
+
+	const BatchEntries::const_iterator iEnd = batchEntries.end();
+	for (BatchEntries::const_iterator i = batchEntries.begin(); i != iEnd; ++i)
+	{
+		const FileRecordList &fileRecordList = *i->request->fileRecordList;
+		const FileRecordList::const_iterator jEnd = fileRecordList.end();
+		for (FileRecordList::const_iterator j = fileRecordList.begin() + 1; j != jEnd; ++j)
+		{
+			prefetchedFile.fileRecord = *j;
+			prefetchedFiles.push_back(prefetchedFile);
+		}
+	}
+
+	// remove the duplicates
+	std::sort(prefetchedFiles.begin(), prefetchedFiles.end(), prefetchedFileRecordOrder);
+	PrefetchedFiles::iterator k = prefetchedFiles.begin();
+	const PrefetchedFiles::iterator lEnd = prefetchedFiles.end();
+	for (PrefetchedFiles::iterator l = prefetchedFiles.begin(); l != lEnd; ++l)
+		if (k == prefetchedFiles.begin() || (k - 1)->fileRecord != l->fileRecord)
+			*k++ = *l;
+	IGNORE_RETURN(prefetchedFiles.erase(k, prefetchedFiles.end()));
+
+	batch->timer.start();
+	return batch;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Prefetch the dependencies of a batch.
+ *
+ * This is run by the loader thread before it services the first request of
+ * the batch.  Resources that are already loaded are held until the batch
+ * completes so they can't be unloaded part way through it.  Otherwise the
+ * uncompressed files are read in tree file order so the requests that need
+ * them don't have to seek back to them one at a time.
+ */
+
+void AsynchronousLoaderNamespace::prefetchBatch(Batch *batch)
+{
+	NOT_NULL(batch);
+	batch->prefetched = true;
+
+	PrefetchedFiles &prefetchedFiles = *batch->prefetchedFiles;
+
+	{
+		const PrefetchedFiles::iterator iEnd = prefetchedFiles.end();
+		for (PrefetchedFiles::iterator i = prefetchedFiles.begin(); i != iEnd; ++i)
+			getFileLocation(i->fileRecord->fileName, i->location);
+	}
+
+	std::sort(prefetchedFiles.begin(), prefetchedFiles.end(), prefetchedFileLocationOrder);
+
+	int bytes = 0;
+
+	{
+		const PrefetchedFiles::iterator iEnd = prefetchedFiles.end();
+		for (PrefetchedFiles::iterator i = prefetchedFiles.begin(); i != iEnd; ++i)
+		{
+			PrefetchedFile &prefetchedFile = *i;
+			FileRecord * const fileRecord = prefetchedFile.fileRecord;
+
+			// the cache writers set and clear this under the mutex
+			ms_mutex.enter();
+				bool const alreadyCached = fileRecord->alreadyCached != 0;
+			ms_mutex.leave();
+
+			if (alreadyCached)
+				continue;
+
+			const ExtensionFunctions &extensionFunctions = ms_extensionFunctionsList[fileRecord->extensionFunctionsIndex];
+			if (extensionFunctions.fetchFunction)
+			{
+				prefetchedFile.resource = extensionFunctions.fetchFunction(fileRecord->fileName);
+				if (prefetchedFile.resource)
+					continue;
+			}
+
+			if (bytes >= cms_prefetchLimit)
+				continue;
+
+			AbstractFile *file = TreeFile::open(fileRecord->fileName, AbstractFile::PriorityLow, true);
+			if (file)
+			{
+				// compressed files stay with the request that needs them
+				if (!file->isZlibCompressed())
+				{
+					prefetchedFile.length = file->length();
+					prefetchedFile.data = file->readEntireFileAndClose();
+					bytes += prefetchedFile.length;
+#ifdef _DEBUG
+					++ms_numberOfPrefetchedFiles;
+#endif
+				}
+
+				delete file;
+			}
+		}
+	}
+
+	// sort them back for openPrefetchedFile()
+	std::sort(prefetchedFiles.begin(), prefetchedFiles.end(), prefetchedFileRecordOrder);
+	batch->numberOfPrefetchedBytes = bytes;
+
+	ms_mutex.enter();
+		ms_numberOfCachedBytes += bytes;
+	ms_mutex.leave();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get a copy of a file the batch prefetched.
+ *
+ * @return A new file that the caller owns, or NULL if the batch didn't prefetch the file
+ */
+
+AbstractFile *AsynchronousLoaderNamespace::openPrefetchedFile(const Batch *batch, FileRecord *fileRecord)
+{
+	if (!batch)
+		return NULL;
+
+	PrefetchedFile key;
+	key.fileRecord = fileRecord;
+
+	const PrefetchedFiles &prefetchedFiles = *batch->prefetchedFiles;
+	const PrefetchedFiles::const_iterator i = std::lower_bound(prefetchedFiles.begin(), prefetchedFiles.end(), key, prefetchedFileRecordOrder);
+	if (i == prefetchedFiles.end() || i->fileRecord != fileRecord || !i->data)
+		return NULL;
+
+	byte * const data = new byte[static_cast<size_t>(i->length)];
+	memcpy(data, i->data, static_cast<size_t>(i->length));
+
+#ifdef _DEBUG
+	++ms_numberOfPrefetchedFileHits;
+#endif
+
+	return new MemoryFile(data, i->length);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Note that a request in a batch has made its callback.
+ *
+ * When the last one has, record how long the batch took and free what it prefetched.
+ */
+
+void AsynchronousLoaderNamespace::retireBatchRequest(Batch *batch)
+{
+	NOT_NULL(batch);
+
+	if (--batch->numberOfOutstandingRequests > 0)
+		return;
+
+	float const timeToIdle = batch->timer.getSplitTime();
+	ms_lastBatchTimeToIdle = timeToIdle;
+	if (timeToIdle > ms_maximumBatchTimeToIdle)
+		ms_maximumBatchTimeToIdle = timeToIdle;
+	++ms_numberOfBatchesCompleted;
+
+	DEBUG_REPORT_LOG(ms_debugReportBatches, ("AsynchronousLoader batch of %d requests with %d dependencies idle after %.3f seconds\n", batch->numberOfRequests, static_cast<int>(batch->prefetchedFiles->size()), timeToIdle));
+
+	const PrefetchedFiles::iterator iEnd = batch->prefetchedFiles->end();
+	for (PrefetchedFiles::iterator i = batch->prefetchedFiles->begin(); i != iEnd; ++i)
+	{
+		if (i->resource)
+			ms_extensionFunctionsList[i->fileRecord->extensionFunctionsIndex].releaseFunction(i->resource);
+
+		delete [] i->data;
+	}
+
+	ms_mutex.enter();
+		ms_numberOfCachedBytes -= batch->numberOfPrefetchedBytes;
+	ms_mutex.leave();
+
+	delete batch->prefetchedFiles;
+	delete batch;
+}
+
 // ======================================================================
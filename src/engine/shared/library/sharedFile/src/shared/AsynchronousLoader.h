@@ -34,6 +34,14 @@ public:
 	static void add(const char *fileName, Callback callback, void *data);
 	static void remove(Callback callback, void *data);
 	static void processCallbacks();
+
+	static void beginBatch();
+	static void endBatch();
+	static bool isBatching();
+
+	static int   getNumberOfBatchesCompleted();
+	static float getLastBatchTimeToIdle();
+	static float getMaximumBatchTimeToIdle();
 };
 
 // ======================================================================
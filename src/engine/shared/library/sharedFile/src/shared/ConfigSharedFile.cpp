@@ -31,6 +31,10 @@ namespace ConfigSharedFileNamespace
 	bool		   ms_validateIff;
 	StringPtrArray ms_preloads; // ConfigFile owns the pointer
 	char const *   ms_treeFileEncryptionPassphrase;
+	bool           ms_mapTreeFiles;
+	int            ms_fileStreamerThreads;
+	bool           ms_coalesceFileStreamerReads;
+	bool           ms_indexSearchNodes;
 }
 
 using namespace ConfigSharedFileNamespace;
@@ -43,6 +47,10 @@ void ConfigSharedFile::install()
 	KEY_INT(asynchronousLoaderPriority, 0);
 	KEY_INT(asynchronousLoaderCallbacksPerFrame, 0);
 	KEY_BOOL(validateIff, false);
+	KEY_BOOL(mapTreeFiles, false);
+	KEY_INT(fileStreamerThreads, 1);
+	KEY_BOOL(coalesceFileStreamerReads, false);
+	KEY_BOOL(indexSearchNodes, true);
 	ms_treeFileEncryptionPassphrase = ConfigFile::getKeyString("SharedFile", "treeFileEncryptionPassphrase", "");
 
 	int index = 0;
@@ -106,5 +114,33 @@ char const * ConfigSharedFile::getTreeFileEncryptionPassphrase()
 	return ms_treeFileEncryptionPassphrase;
 }
 
+// ----------------------------------------------------------------------
+
+bool ConfigSharedFile::getMapTreeFiles()
+{
+	return ms_mapTreeFiles;
+}
+
+// ----------------------------------------------------------------------
+
+int ConfigSharedFile::getFileStreamerThreads()
+{
+	return ms_fileStreamerThreads;
+}
+
+// ----------------------------------------------------------------------
+
+bool ConfigSharedFile::getCoalesceFileStreamerReads()
+{
+	return ms_coalesceFileStreamerReads;
+}
+
+// ----------------------------------------------------------------------
+
+bool ConfigSharedFile::getIndexSearchNodes()
+{
+	return ms_indexSearchNodes;
+}
+
 // ======================================================================
 
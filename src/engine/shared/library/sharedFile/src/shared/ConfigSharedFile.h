@@ -23,6 +23,10 @@ public:
         static int         getNumberOfTreeFilePreloads();
         static char const * getTreeFilePreload(int index);
         static char const * getTreeFileEncryptionPassphrase();
+	static bool        getMapTreeFiles();
+	static int         getFileStreamerThreads();
+	static bool        getCoalesceFileStreamerReads();
+	static bool        getIndexSearchNodes();
 };
 
 // ======================================================================
@@ -131,6 +131,83 @@ FileStreamer::File *FileStreamer::open(const char *fileName, bool randomAccess)
 	return new FileStreamer::File(osFile);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Map a file read-only into memory.
+ *
+ * Reads from the mapping bypass the streamer thread entirely, so they may
+ * be performed from any thread without synchronization.
+ *
+ * @param fileName  [In]  File name to map
+ * @param length    [Out] Number of bytes in the mapping
+ * @return Pointer to the mapped bytes, or NULL if the file could not be mapped.
+ */
+
+void const *FileStreamer::map(const char *fileName, int &length)
+{
+	DEBUG_FATAL(!ms_installed, ("not installed"));
+	DEBUG_FATAL(!fileName, ("file name null"));
+
+	return OsFile::map(fileName, length);
+}
+
+// ----------------------------------------------------------------------
+
+void FileStreamer::unmap(void const *data, int length)
+{
+	OsFile::unmap(data, length);
+}
+
+// ======================================================================
+/**
+ * Map a file and return the mapping with one reference held.
+ *
+ * @return The mapping, or NULL if the file could not be mapped.
+ */
+
+FileMapping *FileMapping::create(const char *fileName)
+{
+	int length = 0;
+	void const * const data = FileStreamer::map(fileName, length);
+	if (!data)
+		return NULL;
+
+	return new FileMapping(data, length);
+}
+
+// ----------------------------------------------------------------------
+
+FileMapping::FileMapping(void const *data, int length)
+:
+	m_data(static_cast<byte const *>(data)),
+	m_length(length),
+	m_referenceCount(1)
+{
+}
+
+// ----------------------------------------------------------------------
+
+FileMapping::~FileMapping()
+{
+	FileStreamer::unmap(m_data, m_length);
+	m_data = NULL;
+}
+
+// ----------------------------------------------------------------------
+
+void FileMapping::fetch() const
+{
+	++m_referenceCount;
+}
+
+// ----------------------------------------------------------------------
+
+void FileMapping::release() const
+{
+	if (--m_referenceCount == 0)
+		delete const_cast<FileMapping *>(this);
+}
+
 // ======================================================================
 
 MemoryBlockManager  *FileStreamer::File::ms_memoryBlockManager;
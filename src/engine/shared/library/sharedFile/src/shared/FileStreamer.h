@@ -17,6 +17,7 @@ class MemoryBlockManager;
 class OsFile;
 
 #include "fileInterface/AbstractFile.h"
+#include "sharedSynchronization/InterlockedInteger.h"
 
 // ======================================================================
 /**
@@ -48,6 +49,9 @@ public:
 	static int     getFileSize(const char *fileName);
 	static File   *open(const char *fileName, bool randomAccess=false);
 
+	static void const *map(const char *fileName, int &length);
+	static void    unmap(void const *data, int length);
+
 private:
 
 	static bool  ms_installed;
@@ -100,6 +104,58 @@ private:
 	int     m_offset;
 };
 
+// ======================================================================
+/**
+ * A read-only mapping of a whole file, shared by everything reading from it.
+ *
+ * Each holder of a pointer into the mapping keeps a reference, and the
+ * file is unmapped when the last one is released.
+ */
+
+class FileMapping
+{
+public:
+
+	static FileMapping *create(const char *fileName);
+
+public:
+
+	void        fetch() const;
+	void        release() const;
+
+	byte const *getData() const;
+	int         getLength() const;
+
+private:
+
+	FileMapping(void const *data, int length);
+	~FileMapping();
+
+	FileMapping();
+	FileMapping(const FileMapping &);
+	FileMapping &operator =(const FileMapping &);
+
+private:
+
+	byte const                 *m_data;
+	int                         m_length;
+	mutable InterlockedInteger  m_referenceCount;
+};
+
+// ----------------------------------------------------------------------
+
+inline byte const *FileMapping::getData() const
+{
+	return m_data;
+}
+
+// ----------------------------------------------------------------------
+
+inline int FileMapping::getLength() const
+{
+	return m_length;
+}
+
 // ======================================================================
 
 #endif
@@ -11,13 +11,15 @@
 #include "sharedFile/FileStreamerThread.h"
 
 #include "fileInterface/AbstractFile.h"
+#include "sharedDebug/DebugFlags.h"
+#include "sharedDebug/Profiler.h"
+#include "sharedFile/ConfigSharedFile.h"
 #include "sharedFile/FileStreamer.h"
 #include "sharedFile/FileStreamerFile.h"
 #include "sharedFile/OsFile.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/PerThreadData.h"
 #include "sharedFoundation/MemoryBlockManager.h"
-#include "sharedFoundation/MemoryBlockManager.h"
 #include "sharedSynchronization/Gate.h"
 #include "sharedSynchronization/Semaphore.h"
 #include "sharedSynchronization/Mutex.h"
@@ -29,24 +31,56 @@
 // ======================================================================
 
 bool                                  FileStreamerThread::ms_installed;
-ThreadHandle                          FileStreamerThread::ms_threadHandle;
+int                                   FileStreamerThread::ms_numberOfThreads;
+ThreadHandle                          FileStreamerThread::ms_threadHandles[FileStreamerThread::cms_maximumNumberOfThreads];
 Semaphore                             FileStreamerThread::ms_eventsPending;
 Mutex                                 FileStreamerThread::ms_queueCriticalSection;
-volatile FileStreamerThread::Request *FileStreamerThread::ms_firstAudioVideoRequest;
-volatile FileStreamerThread::Request *FileStreamerThread::ms_lastAudioVideoRequest;
-volatile FileStreamerThread::Request *FileStreamerThread::ms_firstDataRequest;
-volatile FileStreamerThread::Request *FileStreamerThread::ms_lastDataRequest;
-volatile FileStreamerThread::Request *FileStreamerThread::ms_firstLowRequest;
-volatile FileStreamerThread::Request *FileStreamerThread::ms_lastLowRequest;
+volatile FileStreamerThread::Request *FileStreamerThread::ms_firstRequest[FileStreamerThread::cms_numberOfQueues];
+volatile FileStreamerThread::Request *FileStreamerThread::ms_lastRequest[FileStreamerThread::cms_numberOfQueues];
+FileStreamerThread::QueueStatistics   FileStreamerThread::ms_queueStatistics[FileStreamerThread::cms_numberOfQueues];
 
 namespace FileStreamerThreadNamespace
 {
 	int const cms_maxReadSize = 128 * 1024;
+
+	// reads at most this big will pick up adjacent requests in the same file, up to cms_maxReadSize in total
+	int const cms_maxCoalesceSize          = 32 * 1024;
+	int const cms_maxCoalescedRequests     = 16;
+
+	// seconds a request may wait before it is serviced ahead of higher priority queues, indexed by AbstractFile::PriorityType
+	float const cms_queueDeadline[] =
+	{
+		0.5f,  // PriorityLow
+		0.1f,  // PriorityData
+		0.0f   // PriorityAudioVideo
+	};
+
+	char const * const cms_queueName[] =
+	{
+		"low",
+		"data",
+		"audioVideo"
+	};
+
+	bool ms_coalesceReads;
+
+#if PRODUCTION == 0
+	bool ms_debugReport;
+#endif
+
+	float getAge(volatile FileStreamerThread::Request const *request);
 };
 using namespace FileStreamerThreadNamespace;
 
 // ======================================================================
 
+float FileStreamerThreadNamespace::getAge(volatile FileStreamerThread::Request const *request)
+{
+	return const_cast<FileStreamerThread::Request const *>(request)->timer.getSplitTime();
+}
+
+// ======================================================================
+
 void FileStreamerThread::install()
 {
 	DEBUG_FATAL(ms_installed, ("FileStreamerThread::install already installed"));
@@ -54,9 +88,25 @@ void FileStreamerThread::install()
 
 	Request::install();
 
-	// create the thread to handle the file access, will be triggered into action through the eventsPending semaphore
-	ms_threadHandle = runNamedThread("File", threadRoutine);
-	ms_threadHandle->setPriority(Thread::kHigh);
+	ms_numberOfThreads = clamp(1, ConfigSharedFile::getFileStreamerThreads(), static_cast<int>(cms_maximumNumberOfThreads));
+	ms_coalesceReads = ConfigSharedFile::getCoalesceFileStreamerReads();
+
+	// create the threads to handle the file access, they will be triggered into action through the eventsPending semaphore
+	for (int i = 0; i < ms_numberOfThreads; ++i)
+	{
+		char name[16];
+		if (i == 0)
+			strcpy(name, "File");
+		else
+			snprintf(name, sizeof(name), "File%d", i + 1);
+
+		ms_threadHandles[i] = runNamedThread(name, threadRoutine);
+		ms_threadHandles[i]->setPriority(Thread::kHigh);
+	}
+
+#if PRODUCTION == 0
+	DebugFlags::registerFlag(ms_debugReport, "SharedFile", "reportFileStreamer", debugReport);
+#endif
 
 	ExitChain::add(&remove, "FileStreamerThread::remove");
 }
@@ -67,14 +117,32 @@ void FileStreamerThread::remove()
 {
 	DEBUG_FATAL(!ms_installed, ("FileStreamerThread::remove not installed"));
 
-	//sumbit a quit request
-	Request *newRequest = new Request;
-	newRequest->type = Request::Quit;
-	newRequest->priority  = AbstractFile::PriorityData;
-	newRequest->gate = PerThreadData::getFileStreamerReadGate();
-	submitRequest(newRequest);
+#if PRODUCTION == 0
+	DebugFlags::unregisterFlag(ms_debugReport);
+#endif
+
+	// submit one quit request per thread.  each thread exits after servicing one, and waiting
+	// for each to be serviced keeps the threads from running the exit chain at the same time.
+	Gate * const gate = PerThreadData::getFileStreamerReadGate();
+	for (int i = 0; i < ms_numberOfThreads; ++i)
+	{
+		Request *newRequest = new Request;
+		newRequest->type = Request::Quit;
+		newRequest->priority  = AbstractFile::PriorityData;
+		newRequest->gate = gate;
+		submitRequest(newRequest);
+
+		gate->wait();
+		gate->close();
+	}
 
-	ms_threadHandle->wait();
+	for (int j = 0; j < ms_numberOfThreads; ++j)
+	{
+		ms_threadHandles[j]->wait();
+		ms_threadHandles[j] = ThreadHandle();
+	}
+
+	ms_numberOfThreads = 0;
 	ms_installed = false;
 }
 
@@ -90,48 +158,208 @@ void FileStreamerThread::submitRequest(Request *request)
 {
 	NOT_NULL(request);
 
-	if (request->priority == AbstractFile::PriorityAudioVideo)
+	int const queue = static_cast<int>(request->priority);
+	DEBUG_FATAL(queue < 0 || queue >= cms_numberOfQueues, ("request has unknown priority type"));
+
+	request->timer.start();
+	request->waitTime = -1.0f;
+
+	ms_queueCriticalSection.enter();
+		// add it to the linked list of requests
+		if (ms_lastRequest[queue])
+			ms_lastRequest[queue]->next = request;
+		else
+			ms_firstRequest[queue] = request;
+		ms_lastRequest[queue] = request;
+	ms_queueCriticalSection.leave();
+
+	// signal the threads that a new event is waiting
+	ms_eventsPending.signal();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Put a partially serviced request back on the head of its queue.
+ */
+
+void FileStreamerThread::requeueRequest(volatile Request *request)
+{
+	NOT_NULL(request);
+
+	int const queue = static_cast<int>(request->priority);
+	DEBUG_FATAL(queue < 0 || queue >= cms_numberOfQueues, ("FileStreamerThread::requeueRequest request has unknown priority type"));
+
+	ms_queueCriticalSection.enter();
+		request->next = ms_firstRequest[queue];
+		ms_firstRequest[queue] = request;
+		if (!ms_lastRequest[queue])
+			ms_lastRequest[queue] = request;
+	ms_queueCriticalSection.leave();
+
+	// signal the file threads that a new request is waiting
+	ms_eventsPending.signal();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Remove a request from a queue.
+ *
+ * The queue critical section must be held.
+ *
+ * @param queue     The queue to remove the request from
+ * @param previous  The request before the one to remove, or NULL to remove the head
+ */
+
+volatile FileStreamerThread::Request *FileStreamerThread::unlinkRequest(int queue, volatile Request *previous)
+{
+	volatile Request * const request = previous ? previous->next : ms_firstRequest[queue];
+	NOT_NULL(request);
+
+	if (previous)
+		previous->next = request->next;
+	else
+		ms_firstRequest[queue] = request->next;
+
+	if (ms_lastRequest[queue] == request)
+		ms_lastRequest[queue] = previous;
+
+	request->next = NULL;
+	return request;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Pick the next request to service.
+ *
+ * Audio/video requests always go first.  Otherwise the request that is
+ * furthest past its queue's deadline goes next, and if nothing is overdue
+ * the highest priority request does.
+ *
+ * The queue critical section must be held.
+ */
+
+volatile FileStreamerThread::Request *FileStreamerThread::dequeueRequest()
+{
+	int queue = -1;
+
+	if (ms_firstRequest[AbstractFile::PriorityAudioVideo])
+		queue = AbstractFile::PriorityAudioVideo;
+	else
 	{
-		ms_queueCriticalSection.enter();
-			// add it to the linked list of requests
-			if (ms_lastAudioVideoRequest)
-				ms_lastAudioVideoRequest->next = request;
-			else
-				ms_firstAudioVideoRequest = request;
-			ms_lastAudioVideoRequest = request;
-		ms_queueCriticalSection.leave();
+		float mostOverdue = 0.0f;
+		for (int i = AbstractFile::PriorityData; i >= AbstractFile::PriorityLow; --i)
+			if (ms_firstRequest[i])
+			{
+				if (queue < 0)
+					queue = i;
+
+				float const overdue = getAge(ms_firstRequest[i]) - cms_queueDeadline[i];
+				if (overdue > mostOverdue)
+				{
+					mostOverdue = overdue;
+					if (queue != i)
+					{
+						queue = i;
+						++ms_queueStatistics[i].deadlinePromotions;
+					}
+				}
+			}
 	}
-	else
-		if (request->priority == AbstractFile::PriorityData)
+
+	if (queue < 0)
+		return NULL;
+
+	volatile Request * const request = unlinkRequest(queue, NULL);
+	if (request->waitTime < 0.0f)
+		request->waitTime = getAge(request);
+
+	return request;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Gather queued reads that directly follow a small read in the same file.
+ *
+ * The gathered requests are chained off of request->next, in file order.
+ * Requests are taken from any queue.  The semaphore is not taken for them:
+ * their submitters may not have signaled it yet, and it must never be waited
+ * on under the queue critical section.  Their wakeups are left to find the
+ * queues empty instead.
+ *
+ * The queue critical section must be held.
+ */
+
+void FileStreamerThread::coalesceRequests(volatile Request *request)
+{
+	NOT_NULL(request);
+
+	if (request->type != Request::Read || request->bytesToBeRead > cms_maxCoalesceSize || request->bytesRead != 0)
+		return;
+
+	volatile Request *last = request;
+	int totalBytes = request->bytesToBeRead;
+	int numberOfRequests = 1;
+
+	bool found = true;
+	while (found && numberOfRequests < cms_maxCoalescedRequests)
+	{
+		found = false;
+
+		int const nextOffset = last->offset + last->bytesToBeRead;
+		for (int queue = cms_numberOfQueues - 1; !found && queue >= 0; --queue)
 		{
-			ms_queueCriticalSection.enter();
-				// add it to the linked list of requests
-				if (ms_lastDataRequest)
-					ms_lastDataRequest->next = request;
-				else
-					ms_firstDataRequest = request;
-				ms_lastDataRequest = request;
-			ms_queueCriticalSection.leave();
+			volatile Request *previous = NULL;
+			for (volatile Request *candidate = ms_firstRequest[queue]; candidate; previous = candidate, candidate = candidate->next)
+				if (candidate->type == Request::Read && candidate->osFile == request->osFile && candidate->offset == nextOffset && candidate->bytesRead == 0 && totalBytes + candidate->bytesToBeRead <= cms_maxReadSize)
+				{
+					volatile Request * const next = unlinkRequest(queue, previous);
+					next->waitTime = getAge(next);
+					++ms_queueStatistics[queue].coalescedRequests;
+
+					last->next = next;
+					last = next;
+					totalBytes += next->bytesToBeRead;
+					++numberOfRequests;
+
+					found = true;
+					break;
+				}
 		}
-		else
-			if (request->priority == AbstractFile::PriorityLow)
-			{
-				ms_queueCriticalSection.enter();
-					// add it to the linked list of requests
-					if (ms_lastLowRequest)
-						ms_lastLowRequest->next = request;
-					else
-						ms_firstLowRequest = request;
-					ms_lastLowRequest = request;
-				ms_queueCriticalSection.leave();
-			}
-			else
-			{
-				DEBUG_FATAL(true,	("request has unknown priority type"));
-			}
+	}
+}
 
-	// signal the thread that a new event is waiting
-	ms_eventsPending.signal();
+// ----------------------------------------------------------------------
+/**
+ * Finish a read request and wake up the thread that is waiting on it.
+ */
+
+void FileStreamerThread::completeRequest(volatile Request *request, int amountRead)
+{
+	NOT_NULL(request);
+
+	request->bytesRead += amountRead;
+	request->bytesToBeRead -= amountRead;
+
+	float const latency = getAge(request);
+
+	ms_queueCriticalSection.enter();
+		QueueStatistics &statistics = ms_queueStatistics[request->priority];
+		++statistics.requests;
+		statistics.bytes += request->bytesRead;
+		statistics.totalWaitTime += request->waitTime;
+		statistics.totalLatency += latency;
+		if (latency > statistics.maximumLatency)
+			statistics.maximumLatency = latency;
+	ms_queueCriticalSection.leave();
+
+	// store final number of bytes read in storage accessible to main thread
+	*request->returnValue = static_cast<int>(request->bytesRead);
+
+	Gate *gate = request->gate;
+	delete request;
+
+	//set event so other main thread continues
+	gate->open();
 }
 
 // ----------------------------------------------------------------------
@@ -160,129 +388,101 @@ void FileStreamerThread::processQuit(volatile Request *request)
  * on the head of the queue and resignaling the semaphore.  When the read is complete
  * it stores the number of bytes read into the game-held request->returnVal field and
  * triggers and event to tell the game that we're finished.
+ *
+ * Reads go to an absolute file offset so several threads may read the same file at once.
  */
 
-void FileStreamerThread::processRead(volatile Request *request)
+void FileStreamerThread::processRead(volatile Request *request, byte *coalesceBuffer)
 {
 	NOT_NULL(request);
 
+	if (request->next)
+	{
+		processCoalescedRead(request, coalesceBuffer);
+		return;
+	}
+
 	// shortcut to the file
 	OsFile *osFile = request->osFile;
 
-	// seek to the requested offset
-	osFile->seek(request->offset);
-
 	// read the data
 	if (request->bytesToBeRead > cms_maxReadSize)
 	{
 		// only read up to FileStreamerThread::cms_maxReadSize, then resubmit smaller request
-		const int amountRead = osFile->read(request->buffer, cms_maxReadSize);
-
-		request->offset += amountRead;
-		request->bytesRead += amountRead;
-		request->bytesToBeRead -= amountRead;
-		request->buffer = reinterpret_cast<byte *>(request->buffer) + amountRead;
+		const int amountRead = osFile->read(request->offset, request->buffer, cms_maxReadSize);
 
 		// if we read less than we could have, we're done
 		if (amountRead < cms_maxReadSize)
-		{
-			// store final number of bytes read in storage accessible to main thread
-			*request->returnValue = static_cast<int>(request->bytesRead);
-
-			Gate *gate = request->gate;
-			delete request;
-
-			//set event so other main thread continues
-			gate->open();
-		}
+			completeRequest(request, amountRead);
 		else
 		{
-			// resubmit request (put it on the head so we get it back first)
-			if (request->priority == AbstractFile::PriorityAudioVideo)
-			{
-				ms_queueCriticalSection.enter();
-					if (ms_firstAudioVideoRequest)
-					{
-						request->next = ms_firstAudioVideoRequest;
-						ms_firstAudioVideoRequest = request;
-					}
-					else
-					{
-						ms_firstAudioVideoRequest = request;
-						ms_lastAudioVideoRequest = request;
-					}
-				ms_queueCriticalSection.leave();
-			}
-			else
-				if (request->priority == AbstractFile::PriorityData)
-				{
-					ms_queueCriticalSection.enter();
-						if (ms_firstDataRequest)
-						{
-							request->next = ms_firstDataRequest;
-							ms_firstDataRequest = request;
-						}
-						else
-						{
-							ms_firstDataRequest = request;
-							ms_lastDataRequest = request;
-						}
-					ms_queueCriticalSection.leave();
-				}
-				else
-					if (request->priority == AbstractFile::PriorityLow)
-					{
-						ms_queueCriticalSection.enter();
-							if (ms_firstLowRequest)
-							{
-								request->next = ms_firstLowRequest;
-								ms_firstLowRequest = request;
-							}
-							else
-							{
-								ms_firstLowRequest = request;
-								ms_lastLowRequest = request;
-							}
-						ms_queueCriticalSection.leave();
-					}
-					else
-						DEBUG_FATAL(true, ("FileStreamerThread::processRead request has unknown priority type"));
+			request->offset += amountRead;
+			request->bytesRead += amountRead;
+			request->bytesToBeRead -= amountRead;
+			request->buffer = reinterpret_cast<byte *>(request->buffer) + amountRead;
 
-			// signal the file thread that a new request is waiting
-			ms_eventsPending.signal();
+			// resubmit request (put it on the head so we get it back first)
+			requeueRequest(request);
 		}
 	}
 	else
 	{
 		// fulfill entire read request
-		const int amountRead = osFile->read(request->buffer, request->bytesToBeRead);
+		completeRequest(request, osFile->read(request->offset, request->buffer, request->bytesToBeRead));
+	}
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Service a chain of adjacent reads with a single read into the coalesce buffer.
+ */
+
+void FileStreamerThread::processCoalescedRead(volatile Request *request, byte *coalesceBuffer)
+{
+	NOT_NULL(request);
+	NOT_NULL(coalesceBuffer);
+
+	int totalBytes = 0;
+	{
+		for (volatile Request *r = request; r; r = r->next)
+			totalBytes += r->bytesToBeRead;
+	}
+	DEBUG_FATAL(totalBytes > cms_maxReadSize, ("coalesced read too large %d", totalBytes));
 
-		request->bytesRead += amountRead;
-		request->bytesToBeRead -= amountRead;
+	int const baseOffset = request->offset;
+	int const amountRead = request->osFile->read(baseOffset, coalesceBuffer, totalBytes);
 
-		// store final number of bytes read in storage accessible to main thread
-		*request->returnValue = static_cast<int>(request->bytesRead);
+	volatile Request *next = NULL;
+	for (volatile Request *r = request; r; r = next)
+	{
+		next = r->next;
+		r->next = NULL;
+
+		// handle short reads at the end of the file
+		int const start = r->offset - baseOffset;
+		int const available = clamp(0, amountRead - start, static_cast<int>(r->bytesToBeRead));
+		if (available > 0)
+			memcpy(r->buffer, coalesceBuffer + start, static_cast<size_t>(available));
 
-		Gate *gate = request->gate;
-		delete request;
-		gate->open();
+		completeRequest(r, available);
 	}
 }
 
 // ----------------------------------------------------------------------
 /**
- * Routine where the file thread runs.
+ * Routine where the file threads run.
  * 
- * The file thread waits at the WaitForSingleObject until the game thread
+ * Each file thread waits on the eventsPending semaphore until the game thread
  * triggers it by calling a submit-request function that involves the queues.
- * It then services the first AudioVideo request, and if there are no AudioVideo requests to
- * be serviced, a Data request instead.  All access to the queue is protected by
- * critical sections.
+ * It then services the next request picked by dequeueRequest().  All access
+ * to the queue is protected by critical sections.
  */
 
 void FileStreamerThread::threadRoutine()
 {
- 	bool quit = false;
+	bool quit = false;
+
+	byte * const coalesceBuffer = new byte[cms_maxReadSize];
 
 	//loop until a quit request is processed
 	while (!quit)
@@ -294,44 +494,20 @@ void FileStreamerThread::threadRoutine()
 
 		//get the request to service
 		ms_queueCriticalSection.enter();
-			request = NULL;
 
-			//if there is an AudioVideo request, service it first (interrupting any current data request)
-			if (ms_firstAudioVideoRequest)
-			{
-				request = ms_firstAudioVideoRequest;
-				ms_firstAudioVideoRequest = ms_firstAudioVideoRequest->next;
-				if (ms_firstAudioVideoRequest == NULL)
-					ms_lastAudioVideoRequest = NULL;
-				request->next = NULL;
-			}
-			else
-				if (ms_firstDataRequest)
-				{
-					request = ms_firstDataRequest;
-					ms_firstDataRequest = ms_firstDataRequest->next;
-					if (ms_firstDataRequest == NULL)
-						ms_lastDataRequest = NULL;
-					request->next = NULL;
-				}
-				else
-					if (ms_firstLowRequest)
-					{
-						request = ms_firstLowRequest;
-						ms_firstLowRequest = ms_firstLowRequest->next;
-						if (ms_firstLowRequest == NULL)
-							ms_lastLowRequest = NULL;
-						request->next = NULL;
-					}
-					else
-					{
-						DEBUG_FATAL(true, ("no request waiting"));
-					}
+			// with coalescing a wakeup may belong to a request that was already serviced
+			request = dequeueRequest();
+			DEBUG_FATAL(!request && !ms_coalesceReads, ("no request waiting"));
+
+			if (request && ms_coalesceReads)
+				coalesceRequests(request);
 
 		ms_queueCriticalSection.leave();
 
 		if (request)
 		{
+			PROFILER_AUTO_BLOCK_DEFINE("FileStreamerThread::processRequest");
+
 			switch (request->type)
 			{
 				case Request::Quit:
@@ -340,7 +516,7 @@ void FileStreamerThread::threadRoutine()
 					break;
 
 				case Request::Read:
-					processRead(request);
+					processRead(request, coalesceBuffer);
 					break;
 
 				case Request::Unknown:
@@ -350,6 +526,27 @@ void FileStreamerThread::threadRoutine()
 			}
 		}
 	}
+
+	delete [] coalesceBuffer;
+}
+
+// ----------------------------------------------------------------------
+
+void FileStreamerThread::debugReport()
+{
+	ms_queueCriticalSection.enter();
+		QueueStatistics statistics[cms_numberOfQueues];
+		memcpy(statistics, ms_queueStatistics, sizeof(statistics));
+	ms_queueCriticalSection.leave();
+
+	DEBUG_REPORT_PRINT(true, ("FileStreamer: %d threads\n", ms_numberOfThreads));
+	for (int i = cms_numberOfQueues - 1; i >= 0; --i)
+	{
+		QueueStatistics const &s = statistics[i];
+		float const averageWait = s.requests ? static_cast<float>(s.totalWaitTime / s.requests) : 0.0f;
+		float const averageLatency = s.requests ? static_cast<float>(s.totalLatency / s.requests) : 0.0f;
+		DEBUG_REPORT_PRINT(true, ("  %-10s %7d=reqs %7d=coalesced %5d=promoted %8.1f=kb %6.2f=avgWaitMs %6.2f=avgMs %7.2f=maxMs\n", cms_queueName[i], s.requests, s.coalescedRequests, s.deadlinePromotions, s.bytes / 1024.0, averageWait * 1000.0f, averageLatency * 1000.0f, s.maximumLatency * 1000.0f));
+	}
 }
 
 // ======================================================================
@@ -403,7 +600,9 @@ FileStreamerThread::Request::Request()
   bytesRead(0),
 	gate(NULL),
   priority(AbstractFile::PriorityData),
-	returnValue(NULL)
+	returnValue(NULL),
+	timer(),
+	waitTime(-1.0f)
 {
 }
 
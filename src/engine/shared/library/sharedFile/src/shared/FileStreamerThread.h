@@ -13,6 +13,7 @@
 // ======================================================================
 
 #include "fileInterface/AbstractFile.h"
+#include "sharedDebug/PerformanceTimer.h"
 #include "sharedFile/FileStreamer.h"
 
 class FileStreamerFile;
@@ -28,17 +29,22 @@ typedef TypedThreadHandle<Thread> ThreadHandle;
 
 // ======================================================================
 
-// Encapsulates thread for file access
+// Encapsulates threads for file access
 //
-// This class represents the file streaming thread.  It should only be accessed
+// This class represents the file streaming threads.  It should only be accessed
 // by the FileStreamer class.
 //
 // All requests, with the exceptions of reads and quits, and responded to immediately.
-// The "submit-request" paradigm is used to consistancy.  Read and quit requests are 
+// The "submit-request" paradigm is used to consistancy.  Read and quit requests are
 // put in multiple queues and serviced by priority (audio-visual before plain data before low, etc.)
 //
 // AV request will "interrupt" any current data request, and all reads are only serviced
-// 16K at a time.
+// 128K at a time.  Data and low requests that have waited longer than their queue's
+// deadline are serviced ahead of higher priority requests so they can not starve.
+//
+// A configurable number of worker threads service the queues.  A worker that picks
+// up a small read will also service other queued reads that directly follow it in
+// the same file with a single read.
 
 class FileStreamerThread
 {
@@ -52,18 +58,35 @@ public:
 
 	static void    install();
 
+private:
+
+	enum
+	{
+		cms_numberOfQueues        = AbstractFile::PriorityAudioVideo + 1,
+		cms_maximumNumberOfThreads = 8
+	};
+
+	struct QueueStatistics
+	{
+		int    requests;
+		int    coalescedRequests;
+		int    deadlinePromotions;
+		double bytes;
+		double totalWaitTime;
+		double totalLatency;
+		float  maximumLatency;
+	};
+
 private:
 
 	static bool                ms_installed;
-	static ThreadHandle        ms_threadHandle;
+	static int                 ms_numberOfThreads;
+	static ThreadHandle        ms_threadHandles[cms_maximumNumberOfThreads];
 	static Semaphore           ms_eventsPending;
 	static Mutex               ms_queueCriticalSection;
-	static volatile Request   *ms_firstAudioVideoRequest;
-	static volatile Request   *ms_lastAudioVideoRequest;
-	static volatile Request   *ms_firstDataRequest;
-	static volatile Request   *ms_lastDataRequest;
-	static volatile Request   *ms_firstLowRequest;
-	static volatile Request   *ms_lastLowRequest;
+	static volatile Request   *ms_firstRequest[cms_numberOfQueues];
+	static volatile Request   *ms_lastRequest[cms_numberOfQueues];
+	static QueueStatistics     ms_queueStatistics[cms_numberOfQueues];
 
 private:
 
@@ -72,9 +95,18 @@ private:
 	static void verifyOpen(const char *function, int handle);
 	static void threadRoutine();
 	static void submitRequest(Request *request);
+	static void requeueRequest(volatile Request *request);
+
+	static volatile Request *dequeueRequest();
+	static volatile Request *unlinkRequest(int queue, volatile Request *previous);
+	static void              coalesceRequests(volatile Request *request);
+	static void              completeRequest(volatile Request *request, int amountRead);
 
-	static void processRead(volatile Request *request);
+	static void processRead(volatile Request *request, byte *coalesceBuffer);
+	static void processCoalescedRead(volatile Request *request, byte *coalesceBuffer);
 	static void processQuit(volatile Request *request);
+
+	static void debugReport();
 };
 
 // ======================================================================
@@ -117,6 +149,12 @@ public:
 	// storage held by game thread used to pass back return value
 	int                        *returnValue;
 
+	// started when the request is submitted, used for deadlines and latency statistics
+	PerformanceTimer            timer;
+
+	// seconds spent in the queue before a worker first picked the request up, or negative if it hasn't been
+	float                       waitTime;
+
 public:
 
 	Request();
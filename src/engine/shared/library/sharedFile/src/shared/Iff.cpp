@@ -11,6 +11,8 @@
 #include "sharedFile/Iff.h"
 
 #include "sharedFile/ConfigSharedFile.h"
+#include "sharedFile/FileStreamer.h"
+#include "sharedFile/MemoryFile.h"
 #include "sharedFile/TreeFile.h"
 #include "sharedFoundation/ByteOrder.h"
 #include "sharedFoundation/ConfigFile.h"
@@ -29,6 +31,11 @@ namespace IffNamespace
 {
 	bool consumeUint32(byte const * & memory, int & length, uint32 & value);
 	bool isValid(byte const *memory, int length);
+
+	// when the math types are laid out exactly as the floats stored in the file, arrays of them can be read in one copy
+	bool const cms_vectorIsPacked     = sizeof(real) == sizeof(float) && sizeof(Vector) == 3 * sizeof(float);
+	bool const cms_quaternionIsPacked = sizeof(real) == sizeof(float) && sizeof(Quaternion) == 4 * sizeof(float);
+	bool const cms_transformIsPacked  = sizeof(real) == sizeof(float) && sizeof(Transform) == 12 * sizeof(float);
 }
 
 using namespace IffNamespace;
@@ -175,7 +182,9 @@ Iff::Iff(void)
 	inChunk(false),
 	growable(false),
 	nonlinear(false),
-	ownsData(true)
+	ownsData(true),
+	readOnly(false),
+	mapping(NULL)
 {
 	// clear out the stack data
 	memset(stack, 0, isizeof(*stack) * maxStackDepth);
@@ -215,7 +224,9 @@ Iff::Iff(int newDataSize, const byte *newData, bool iffOwnsData) :
 	inChunk(false),
 	growable(false),
 	nonlinear(false),
-	ownsData(iffOwnsData)
+	ownsData(iffOwnsData),
+	readOnly(false),
+	mapping(NULL)
 {
 	// clear out the stack data
 	memset(stack, 0, isizeof(*stack) * maxStackDepth);
@@ -250,7 +261,9 @@ Iff::Iff(const char *newFileName, bool optional)
 	inChunk(false),
 	growable(false),
 	nonlinear(false),
-	ownsData(true)
+	ownsData(true),
+	readOnly(false),
+	mapping(NULL)
 {
 	// clear out the stack data
 	memset(stack, 0, isizeof(*stack) * maxStackDepth);
@@ -278,7 +291,9 @@ Iff::Iff(int initialSize, bool isGrowable, bool clearDataBuffer)
 	inChunk(false),
 	growable(isGrowable),
 	nonlinear(false),
-	ownsData(true)
+	ownsData(true),
+	readOnly(false),
+	mapping(NULL)
 {
 	// clear out the stack data
 	memset(stack, 0, isizeof(Stack) * maxStackDepth);
@@ -382,6 +397,91 @@ void Iff::open(AbstractFile & file, char const * const newFileName)
 	// allocate storage for the data
 	DEBUG_FATAL(data, ("causing memory leak"));
 	data = file.readEntireFileAndClose();
+	ownsData = true;
+
+	FATAL(ConfigSharedFile::getValidateIff() && !IffNamespace::isValid(data, length), ("File corruption detected! Iff::isValid failed for %s (size=%d, crc=%08X). Please try a \"Full Scan\" from the LaunchPad.", newFileName ? newFileName : "null", length, Crc::calculate(data, length)));
+
+	// setup the stack data to know about the data
+	stack[0].start = 0;
+	stack[0].length = length;
+	stack[0].used   = 0;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Open an Iff for reading without copying its data when possible.
+ *
+ * Files that the TreeFile can hand out as views of a memory-mapped tree
+ * are parsed in place.  Other files are loaded just like open() would.
+ * Either way the Iff is read-only until it is closed.
+ *
+ * @param newFileName  Name of the file to load
+ * @param optional  Whether to allow clean failure
+ * @return True if the Iff was successfully opened, false otherwise.
+ * @see Iff::open()
+ */
+
+bool Iff::openReadOnly(const char *newFileName, bool optional)
+{
+	AbstractFile * const file = TreeFile::open(newFileName, AbstractFile::PriorityData, optional);
+	if (!file)
+	{
+		DEBUG_FATAL(!optional, ("could not open file '%s'", newFileName));
+		return false;
+	}
+
+	MemoryFile const * const memoryFile = dynamic_cast<MemoryFile const *>(file);
+	byte const * const sharedBuffer = memoryFile ? memoryFile->getSharedBuffer() : NULL;
+	if (sharedBuffer)
+	{
+		attach(file->length(), sharedBuffer, newFileName);
+
+		// keep the mapped tree file around until the Iff is closed
+		mapping = memoryFile->getMapping();
+		mapping->fetch();
+	}
+	else
+		open(*file, newFileName);
+
+	delete file;
+
+	readOnly = true;
+
+	// copy the file name
+	fileName = DuplicateString(newFileName);
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Parse Iff data held in a caller-owned buffer.
+ *
+ * The buffer is not copied and must not change or go away until the Iff
+ * is closed.  The Iff is read-only until it is closed.
+ *
+ * @param newDataSize  Length, in bytes, of the Iff data
+ * @param newData  The buffer containing the Iff data
+ */
+
+void Iff::openReadOnly(int newDataSize, const byte *newData)
+{
+	attach(newDataSize, newData, 0);
+}
+
+// ----------------------------------------------------------------------
+
+void Iff::attach(int newDataSize, const byte *newData, const char *newFileName)
+{
+	NOT_NULL(newData);
+
+	close();
+
+	length = newDataSize;
+	data = const_cast<byte *>(newData);
+	ownsData = false;
+	growable = false;
+	readOnly = true;
 
 	FATAL(ConfigSharedFile::getValidateIff() && !IffNamespace::isValid(data, length), ("File corruption detected! Iff::isValid failed for %s (size=%d, crc=%08X). Please try a \"Full Scan\" from the LaunchPad.", newFileName ? newFileName : "null", length, Crc::calculate(data, length)));
 
@@ -410,7 +510,14 @@ void Iff::close(void)
 	if (ownsData)
 		delete [] data;
 	data = NULL; //lint !e672 // possible memory leak in assignment to Iff::data // no, we only delete when we own it
+
+	if (mapping)
+	{
+		mapping->release();
+		mapping = NULL;
+	}
 	stackDepth = 0;
+	readOnly = false;
 }
 
 
@@ -578,6 +685,7 @@ void Iff::adjustDataAsNeeded(int size)
 	const int neededLength = stack[0].length + size;
 
 	NOT_NULL(data);
+	DEBUG_FATAL(readOnly, ("modifying read-only iff [%s]", getFileName()));
 	IFF_DEBUG_FATAL(neededLength < 0, ("data size underflow"));
 
 	// check if we need to expand the data array
@@ -1444,6 +1552,13 @@ void Iff::read_floatVector(int count, Vector *array)
 
 	NOT_NULL(array);
 
+	// the vectors are stored exactly as they are laid out in memory, so copy them all at once
+	if (cms_vectorIsPacked)
+	{
+		read_misc(array, count * isizeof(Vector));
+		return;
+	}
+
 	for (int i = 0; i < count; ++i)
 	{
 		read_misc(&f, isizeof(f));
@@ -1465,6 +1580,12 @@ void Iff::read_floatTransform(int count, Transform *array)
 
 	NOT_NULL(array);
 
+	if (cms_transformIsPacked)
+	{
+		read_misc(array, count * isizeof(Transform));
+		return;
+	}
+
 	for (int i = 0; i < count; ++i)
 		for (int y = 0; y < 3; ++y)
 			for (int x = 0; x < 4; ++x)
@@ -1480,6 +1601,12 @@ void Iff::read_floatQuaternion(int count, Quaternion *array)
 {
 	NOT_NULL(array);
 
+	if (cms_quaternionIsPacked)
+	{
+		read_misc(array, count * isizeof(Quaternion));
+		return;
+	}
+
 	for (int i = 0; i < count; ++i)
 	{
 		Quaternion &q = array[i];
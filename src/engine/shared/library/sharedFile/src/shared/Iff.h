@@ -15,6 +15,7 @@
 #include "sharedFoundation/Tag.h"
 
 class AbstractFile;
+class FileMapping;
 class Quaternion;
 class Transform;
 class Vector;
@@ -75,6 +76,9 @@ private:
 	bool   growable;
 	bool   nonlinear;
 	bool   ownsData;
+	bool   readOnly;
+
+	FileMapping const *mapping;
 
 private:
 
@@ -88,6 +92,7 @@ private:
 	void growStackAsNeeded(void);
 	void adjustDataAsNeeded(int size);
 	int  calculateRawDataSize(void) const;
+	void attach(int newDataSize, const byte *newData, const char *newFileName);
 
 	bool enterForm(Tag name, bool validateName, bool optional);
 	bool enterChunk(Tag name, bool validateName, bool optional);
@@ -115,6 +120,9 @@ public:
 	bool open(const char *filename, bool optional=false);
 	void open(AbstractFile & file);
 	void open(AbstractFile & file, char const * fileName);
+	bool openReadOnly(const char *filename, bool optional=false);
+	void openReadOnly(int newDataSize, const byte *newData);
+	bool isReadOnly(void) const;
 	void close(void);
 	bool write(const char *filename, bool optional=false);
 
@@ -199,6 +207,7 @@ public:
 	uint16      read_uint16(void);
 	uint32      read_uint32(void);
 	real        read_float(void);
+	const byte *read_view(int count);
 	Vector      read_floatVector(void);
 	VectorArgb  read_floatVectorArgb(void);
 	Transform   read_floatTransform(void);
@@ -212,6 +221,7 @@ public:
 	void    read_uint16(int count, uint16 *array);
 	void    read_uint32(int count, uint32 *array);
 	void    read_char  (int count, char   *array);
+	void    read_float (int count, float  *array);
 	void    read_floatVector(int count, Vector *array);
 	void    read_floatTransform(int count, Transform *array);
 	void    read_floatQuaternion(int count, Quaternion *array);
@@ -248,10 +258,6 @@ public:
 
 	void            read_string(Unicode::String &str);
 	Unicode::String read_unicodeString();
-
-#if 0
-	real *read_float (int count, real   *array=NULL);
-#endif
 };
 
 // ----------------------------------------------------------------------
@@ -304,6 +310,18 @@ inline const byte *Iff::getRawData(void) const
 	return data;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Check if the Iff is parsing data it doesn't own and may not modify.
+ *
+ * @see Iff::openReadOnly()
+ */
+
+inline bool Iff::isReadOnly(void) const
+{
+	return readOnly;
+}
+
 // ----------------------------------------------------------------------
 /**
  * Allow use of nonlinear functions.
@@ -655,6 +673,35 @@ inline real Iff::read_float(void)
 	return static_cast<real>(f);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Read bytes from the current chunk without copying them.
+ * 
+ * The returned pointer points into the Iff data and is only valid until
+ * the Iff is closed.  It has no particular alignment.
+ * 
+ * If this routine attempts to read beyond the end of the chunk, this routine
+ * will call Fatal in debug compiles, but its behavior is undefined in release
+ * compiles.
+ * 
+ * @param count  Number of bytes to read
+ * @return Pointer to the bytes within the Iff data
+ * @see Iff::read_*()
+ */
+
+inline const byte *Iff::read_view(int count)
+{
+	NOT_NULL(data);
+	DEBUG_FATAL(!inChunk, ("not in chunk"));
+
+	Stack &s = stack[stackDepth];
+	DEBUG_FATAL(count < 0 || s.used + count > s.length, ("overflow %d/%d in file [%s]", s.used + count, s.length, getFileName()));
+
+	const byte * const result = data + s.start + s.used;
+	s.used += count;
+	return result;
+}
+
 // ----------------------------------------------------------------------
 /**
  * Read an array of int8's from the current chunk into a specified array.
@@ -781,6 +828,24 @@ inline void Iff::read_char(int count, char *array)
 	read_misc(array, count * isizeof(*array));
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Read an array of floats from the current chunk into a specified array.
+ * 
+ * If this routine attempts to read beyond the end of the chunk, this routine
+ * will call Fatal in debug compiles, but its behavior is undefined in release
+ * compiles.
+ * 
+ * @param count  Number of elements to read
+ * @param array  Array to store the entries
+ * @see Iff::read_*()
+ */
+
+inline void Iff::read_float(int count, float *array)
+{
+	read_misc(array, count * isizeof(*array));
+}
+
 // ----------------------------------------------------------------------
 /**
  * Read an array of int8's from the current chunk into a dynamically allocated array.
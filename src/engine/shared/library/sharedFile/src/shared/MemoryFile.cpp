@@ -9,6 +9,7 @@
 #include "sharedFile/FirstSharedFile.h"
 #include "sharedFile/MemoryFile.h"
 
+#include "sharedFile/FileStreamer.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/MemoryBlockManager.h"
 
@@ -62,17 +63,38 @@ MemoryFile::MemoryFile(byte *buffer, int length)
 : AbstractFile(PriorityData),
 	m_buffer(buffer),
 	m_length(length),
-	m_offset(0)
+	m_offset(0),
+	m_mapping(NULL)
 {
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Construct a MemoryFile over part of a mapped file.
+ *
+ * The file holds a reference to the mapping until it is closed, and
+ * readEntireFileAndClose() will return a copy of the buffer.
+ */
+
+MemoryFile::MemoryFile(byte *buffer, int length, FileMapping const *mapping)
+: AbstractFile(PriorityData),
+	m_buffer(buffer),
+	m_length(length),
+	m_offset(0),
+	m_mapping(mapping)
+{
+	NOT_NULL(m_mapping);
+	m_mapping->fetch();
+}
+
 // ----------------------------------------------------------------------
 
 MemoryFile::MemoryFile(AbstractFile *file)
 : AbstractFile(PriorityData),
 	m_buffer(NULL),
 	m_length(file->length()),
-	m_offset(0)
+	m_offset(0),
+	m_mapping(NULL)
 {
 	m_buffer = file->readEntireFileAndClose();
 }
@@ -161,7 +183,13 @@ int MemoryFile::write(int, const void *)
 
 void MemoryFile::close()
 {
-	delete [] m_buffer;
+	if (m_mapping)
+	{
+		m_mapping->release();
+		m_mapping = NULL;
+	}
+	else
+		delete [] m_buffer;
 	m_buffer = NULL;
 }
 
@@ -169,9 +197,39 @@ void MemoryFile::close()
 
 byte *MemoryFile::readEntireFileAndClose()
 {
+	if (m_mapping && m_buffer)
+	{
+		byte * const result = new byte[m_length];
+		memcpy(result, m_buffer, m_length);
+		close();
+		return result;
+	}
+
 	byte *result = m_buffer;
 	m_buffer = NULL;
 	return result;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Get the buffer of a file that is a view of a mapped file.
+ *
+ * Readers that take a reference to the mapping with getMapping() may keep
+ * using the buffer after the file is deleted instead of copying it.
+ *
+ * @return The buffer, or NULL if the file owns its buffer
+ */
+
+const byte *MemoryFile::getSharedBuffer() const
+{
+	return m_mapping ? m_buffer : NULL;
+}
+
+// ----------------------------------------------------------------------
+
+FileMapping const *MemoryFile::getMapping() const
+{
+	return m_mapping;
+}
+
 // ======================================================================
@@ -11,6 +11,7 @@
 
 // ======================================================================
 
+class FileMapping;
 class MemoryBlockManager;
 
 #include "fileInterface/AbstractFile.h"
@@ -28,6 +29,7 @@ public:
 public:
 
 	MemoryFile(byte *buffer, int length);
+	MemoryFile(byte *buffer, int length, FileMapping const *mapping);
 	MemoryFile(AbstractFile *file);
 	virtual ~MemoryFile();
 
@@ -41,6 +43,9 @@ public:
 
 	virtual byte *readEntireFileAndClose();
 
+	const byte   *getSharedBuffer() const;
+	FileMapping const *getMapping() const;
+
 private:
 
 	MemoryFile();
@@ -58,6 +63,7 @@ private:
 	byte                 *m_buffer;
 	const int             m_length;
 	int                   m_offset;
+	FileMapping const    *m_mapping;
 };
 
 // ======================================================================
@@ -17,9 +17,11 @@
 #include "sharedFile/FileManifest.h"
 #include "sharedFile/FileStreamer.h"
 #include "sharedFoundation/ConfigFile.h"
+#include "sharedFoundation/Crc.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/Os.h"
 #include "sharedFoundation/Production.h"
+#include "sharedSynchronization/InterlockedInteger.h"
 #include "sharedSynchronization/Mutex.h"
 
 #include <cstdlib>
@@ -33,10 +35,13 @@
 // ======================================================================
 
 bool                   TreeFile::ms_installed;
-bool                   TreeFile::ms_haveCachedFiles;
+InterlockedInteger     TreeFile::ms_haveCachedFiles;
 Mutex                  TreeFile::ms_criticalSection;
 TreeFile::SearchNodes  TreeFile::ms_searchNodes;
 TreeFile::SearchCache * TreeFile::ms_searchCache;
+TreeFile::SearchIndex * TreeFile::ms_searchIndex;
+TreeFile::SearchIndexes TreeFile::ms_retiredSearchIndexes;
+volatile bool          TreeFile::ms_searchIndexDirty = true;
 
 int                    TreeFile::ms_numberOfFilesOpenedTotal;
 int                    TreeFile::ms_sizeOfFilesOpenedTotal;
@@ -109,6 +114,194 @@ namespace TreeFileNamespace
 }
 using namespace TreeFileNamespace;
 
+// ======================================================================
+/**
+ * Hash index over the files of every indexable search node.
+ *
+ * Each file name appears once, for the highest priority indexable node
+ * that has it, so a lookup is a single probe instead of a binary search
+ * in every node.  Nodes that can't be indexed (paths, the cache) are
+ * remembered so lookups can still check the ones searched ahead of the
+ * indexed node.
+ */
+
+class TreeFile::SearchIndex
+{
+public:
+
+	explicit SearchIndex(const SearchNodes &searchNodes);
+	~SearchIndex();
+
+	int  find(const char *fileName, int &entry, bool &deleted) const;
+
+	int  getNumberOfUnindexedSearchNodes() const;
+	int  getUnindexedSearchNode(int index) const;
+
+	int  getNumberOfEntries() const;
+	int  getCapacity() const;
+
+private:
+
+	struct Entry
+	{
+		uint32 crc;
+		int32  entry;
+		int16  searchNode;
+		bool   deleted;
+	};
+
+private:
+
+	// disabled
+	SearchIndex();
+	SearchIndex(const SearchIndex &);
+	SearchIndex &operator =(const SearchIndex &);
+
+private:
+
+	const SearchNodes   &m_searchNodes;
+	Entry               *m_entries;
+	uint32               m_mask;
+	int                  m_numberOfEntries;
+	stdvector<int>::fwd  m_unindexedSearchNodes;
+};
+
+// ----------------------------------------------------------------------
+
+TreeFile::SearchIndex::SearchIndex(const SearchNodes &searchNodes)
+:
+	m_searchNodes(searchNodes),
+	m_entries(NULL),
+	m_mask(0),
+	m_numberOfEntries(0),
+	m_unindexedSearchNodes()
+{
+	const int numberOfSearchNodes = static_cast<int>(searchNodes.size());
+	DEBUG_FATAL(numberOfSearchNodes > 32767, ("too many search nodes to index %d", numberOfSearchNodes));
+
+	int numberOfFiles = 0;
+	{
+		for (int i = 0; i < numberOfSearchNodes; ++i)
+			if (searchNodes[i]->isIndexable())
+				numberOfFiles += searchNodes[i]->getNumberOfIndexEntries();
+			else
+				m_unindexedSearchNodes.push_back(i);
+	}
+
+	// keep the table at most half full
+	uint32 capacity = 16;
+	while (capacity < static_cast<uint32>(numberOfFiles) * 2)
+		capacity <<= 1;
+
+	m_mask = capacity - 1;
+	m_entries = new Entry[capacity];
+	for (uint32 j = 0; j < capacity; ++j)
+		m_entries[j].searchNode = -1;
+
+	// the nodes are in priority order, so the first entry added for a file name is the one that wins
+	for (int i = 0; i < numberOfSearchNodes; ++i)
+	{
+		SearchNode const * const searchNode = searchNodes[i];
+		if (!searchNode->isIndexable())
+			continue;
+
+		const int numberOfEntries = searchNode->getNumberOfIndexEntries();
+		for (int entry = 0; entry < numberOfEntries; ++entry)
+		{
+			uint32 crc = 0;
+			bool deleted = false;
+			if (!searchNode->getIndexEntry(entry, crc, deleted))
+				continue;
+
+			const char * const fileName = searchNode->getIndexEntryFileName(entry);
+
+			uint32 slot = crc & m_mask;
+			bool present = false;
+			while (!present && m_entries[slot].searchNode >= 0)
+			{
+				Entry const &existing = m_entries[slot];
+				if (existing.crc == crc && _stricmp(searchNodes[existing.searchNode]->getIndexEntryFileName(existing.entry), fileName) == 0)
+					present = true;
+				else
+					slot = (slot + 1) & m_mask;
+			}
+
+			if (!present)
+			{
+				Entry &newEntry = m_entries[slot];
+				newEntry.crc = crc;
+				newEntry.entry = entry;
+				newEntry.searchNode = static_cast<int16>(i);
+				newEntry.deleted = deleted;
+				++m_numberOfEntries;
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+TreeFile::SearchIndex::~SearchIndex()
+{
+	delete [] m_entries;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Look up a file name.
+ *
+ * @param fileName  Fixed up file name to look for
+ * @param entry     Set to the entry within the node that has the file
+ * @param deleted   Set to true if the node deletes the file rather than providing it
+ * @return The position of the node in the search order, or -1 if no indexed node has the file
+ */
+
+int TreeFile::SearchIndex::find(const char *fileName, int &entry, bool &deleted) const
+{
+	const uint32 crc = Crc::calculate(fileName);
+
+	for (uint32 slot = crc & m_mask; m_entries[slot].searchNode >= 0; slot = (slot + 1) & m_mask)
+	{
+		Entry const &candidate = m_entries[slot];
+		if (candidate.crc == crc && _stricmp(m_searchNodes[candidate.searchNode]->getIndexEntryFileName(candidate.entry), fileName) == 0)
+		{
+			entry = candidate.entry;
+			deleted = candidate.deleted;
+			return candidate.searchNode;
+		}
+	}
+
+	return -1;
+}
+
+// ----------------------------------------------------------------------
+
+inline int TreeFile::SearchIndex::getNumberOfUnindexedSearchNodes() const
+{
+	return static_cast<int>(m_unindexedSearchNodes.size());
+}
+
+// ----------------------------------------------------------------------
+
+inline int TreeFile::SearchIndex::getUnindexedSearchNode(int index) const
+{
+	return m_unindexedSearchNodes[static_cast<size_t>(index)];
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchIndex::getNumberOfEntries() const
+{
+	return m_numberOfEntries;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchIndex::getCapacity() const
+{
+	return static_cast<int>(m_mask + 1);
+}
+
 // ======================================================================
 // Install the TreeFile system
 
@@ -243,6 +436,14 @@ void TreeFile::remove(void)
 
 		ms_searchCache = 0;
 
+		invalidateSearchIndex();
+
+		// nothing can be looking anything up any more, so the old indexes can finally go
+		const SearchIndexes::iterator jEnd = ms_retiredSearchIndexes.end();
+		for (SearchIndexes::iterator j = ms_retiredSearchIndexes.begin(); j != jEnd; ++j)
+			delete *j;
+		ms_retiredSearchIndexes.clear();
+
 	ms_criticalSection.leave();
 
 #if PRODUCTION == 0
@@ -335,6 +536,8 @@ void TreeFile::addSearchNode(SearchNode *newNode)
 		SearchNodes::iterator insertionPoint = std::lower_bound(ms_searchNodes.begin(), ms_searchNodes.end(), newNode, searchNodePriorityOrder);
 		IGNORE_RETURN(ms_searchNodes.insert(insertionPoint, newNode));
 
+		invalidateSearchIndex();
+
 	ms_criticalSection.leave();
 }
 
@@ -469,9 +672,117 @@ void TreeFile::removeAllSearches(void)
 			delete *i;
 		ms_searchNodes.clear();
 
+		invalidateSearchIndex();
+
 	ms_criticalSection.leave();
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Throw away the search index after the search nodes change.
+ *
+ * The index is rebuilt the next time it is needed so that adding all the
+ * search nodes at startup only builds it once.  Lookups use the index
+ * without holding the critical section, so the old one is retired rather
+ * than deleted and is only freed when the TreeFile system is removed.
+ * The critical section must be held.
+ */
+
+void TreeFile::invalidateSearchIndex()
+{
+	if (ms_searchIndex)
+	{
+		ms_retiredSearchIndexes.push_back(ms_searchIndex);
+		ms_searchIndex = NULL;
+	}
+
+	ms_searchIndexDirty = true;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get the search index, building it if the search nodes have changed.
+ *
+ * @return The search index, or NULL if indexing is turned off
+ */
+
+TreeFile::SearchIndex const *TreeFile::getSearchIndex()
+{
+	if (ms_searchIndexDirty)
+	{
+		ms_criticalSection.enter();
+
+			if (ms_searchIndexDirty)
+			{
+				if (ConfigSharedFile::getIndexSearchNodes())
+				{
+					ms_searchIndex = new SearchIndex(ms_searchNodes);
+					DEBUG_REPORT_LOG(true, ("TreeFile: indexed %d files in %d slots\n", ms_searchIndex->getNumberOfEntries(), ms_searchIndex->getCapacity()));
+				}
+
+				ms_searchIndexDirty = false;
+			}
+
+		ms_criticalSection.leave();
+	}
+
+	return ms_searchIndex;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Find the position of the node (if any) the requested file is in.
+ *
+ * Only the unindexed nodes searched ahead of the indexed match need to be
+ * checked one at a time.
+ *
+ * @param fileName  Fixed up file name to look for
+ * @param entry     Set to the index entry for the file, or -1 if the node isn't indexed
+ * @return The position of the highest priority node containing the file, or -1 if it was not found
+ */
+
+int TreeFile::locate(const char *fileName, int &entry)
+{
+	entry = -1;
+
+	SearchIndex const * const searchIndex = getSearchIndex();
+	if (!searchIndex)
+	{
+		bool deleted = false;
+		const int numberOfSearchNodes = static_cast<int>(ms_searchNodes.size());
+		for (int i = 0; !deleted && i < numberOfSearchNodes; ++i)
+			if (ms_searchNodes[i]->exists(fileName, deleted))
+				return i;
+
+		return -1;
+	}
+
+	int indexedEntry = -1;
+	bool indexedDeleted = false;
+	const int indexedSearchNode = searchIndex->find(fileName, indexedEntry, indexedDeleted);
+
+	const int numberOfUnindexedSearchNodes = searchIndex->getNumberOfUnindexedSearchNodes();
+	for (int i = 0; i < numberOfUnindexedSearchNodes; ++i)
+	{
+		const int searchNode = searchIndex->getUnindexedSearchNode(i);
+		if (indexedSearchNode >= 0 && searchNode > indexedSearchNode)
+			break;
+
+		bool deleted = false;
+		if (ms_searchNodes[searchNode]->exists(fileName, deleted))
+			return searchNode;
+
+		if (deleted)
+			return -1;
+	}
+
+	if (indexedSearchNode < 0 || indexedDeleted)
+		return -1;
+
+	entry = indexedEntry;
+	return indexedSearchNode;
+}
+
 // ----------------------------------------------------------------------
 /**
  * Find the node (if any) the requested file is in.
@@ -498,13 +809,9 @@ TreeFile::SearchNode *TreeFile::find(const char *fileName)
 	}
 
 	// search the list of nodes looking to see if the specified file exists
-	bool deleted = false;
-	const SearchNodes::iterator iEnd = ms_searchNodes.end();
-	for (SearchNodes::iterator i = ms_searchNodes.begin(); !deleted && i != iEnd; ++i)
-		if ((*i)->exists(fileName, deleted))
-			return *i;
-
-	return NULL;
+	int entry = -1;
+	const int searchNode = locate(fileName, entry);
+	return searchNode >= 0 ? ms_searchNodes[static_cast<size_t>(searchNode)] : NULL;
 }
 
 // ----------------------------------------------------------------------
@@ -537,16 +844,55 @@ int TreeFile::getFileSize(const char *fileName)
 	fixUpFileName(fixedFileName, fileName, true);
 
 	// search the list of nodes looking to see if the specified file exists
+	int entry = -1;
+	const int searchNode = locate(fixedFileName, entry);
+	if (searchNode < 0)
+		return -1;
+
+	SearchNode const * const node = ms_searchNodes[static_cast<size_t>(searchNode)];
+	if (entry >= 0)
+		return node->getIndexEntryFileSize(entry);
+
 	bool deleted = false;
-	const SearchNodes::iterator iEnd = ms_searchNodes.end();
-	for (SearchNodes::iterator i = ms_searchNodes.begin(); !deleted && i != iEnd; ++i)
+	return node->getFileSize(fixedFileName, deleted);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Find where a file's data lives.
+ *
+ * Files in the same search node and archive that are read in increasing
+ * offset order are read without seeking back and forth through the archive.
+ *
+ * @param fileName    File name to look for
+ * @param searchNode  Index of the search node the file was found in
+ * @param archive     Archive within the search node holding the file
+ * @param offset      Offset of the file's data within the archive, or 0 if the file is not in an archive
+ * @return True if the file exists, otherwise false
+ */
+
+bool TreeFile::getFileLocation(const char *fileName, int &searchNode, int &archive, int &offset)
+{
+	char fixedFileName[Os::MAX_PATH_LENGTH];
+	fixUpFileName(fixedFileName, fileName, true);
+
+	int entry = -1;
+	const int found = locate(fixedFileName, entry);
+	if (found < 0)
+		return false;
+
+	SearchNode const * const node = ms_searchNodes[static_cast<size_t>(found)];
+	if (entry >= 0)
+		node->getIndexEntryLocation(entry, archive, offset);
+	else
 	{
-		int size = (*i)->getFileSize(fixedFileName, deleted);
-		if (size >= 0)
-			return size;
+		bool deleted = false;
+		if (!node->getFileLocation(fixedFileName, archive, offset, deleted))
+			return false;
 	}
 
-	return -1;
+	searchNode = found;
+	return true;
 }
 
 // ----------------------------------------------------------------------
@@ -712,12 +1058,9 @@ AbstractFile* TreeFile::open(const char *fileName, AbstractFile::PriorityType pr
 	char fixedFileName[Os::MAX_PATH_LENGTH];
 	fixUpFileName(fixedFileName, fileName, true);
 
-	// check the cache to see if the file has been preloaded
-	ms_criticalSection.enter();
-		const bool haveCachedFiles = ms_haveCachedFiles;
-	ms_criticalSection.leave();
-
-	if (haveCachedFiles)
+	// check the cache to see if the file has been preloaded.  the flag is read without
+	// taking the lock so that opens from worker threads only contend when preloads exist
+	if (ms_haveCachedFiles != 0)
 	{
 		ms_criticalSection.enter();
 
@@ -751,39 +1094,34 @@ AbstractFile* TreeFile::open(const char *fileName, AbstractFile::PriorityType pr
 		}
 	}
 
-#if PRODUCTION == 0
-	bool first = true;
-#endif
-
 	bool deleted = false;
-	const SearchNodes::iterator iEnd = ms_searchNodes.end();
-	for (SearchNodes::iterator i = ms_searchNodes.begin(); !file && !deleted && i != iEnd; ++i)
+
+	SearchIndex const * const searchIndex = getSearchIndex();
+	if (searchIndex)
 	{
-		file = (*i)->open(fixedFileName, priority, deleted);
+		int entry = -1;
+		bool indexedDeleted = false;
+		const int indexedSearchNode = searchIndex->find(fixedFileName, entry, indexedDeleted);
 
-#if PRODUCTION == 0
-		if (file)
+		// only the unindexed nodes searched ahead of the indexed match need to be tried
+		const int numberOfUnindexedSearchNodes = searchIndex->getNumberOfUnindexedSearchNodes();
+		for (int i = 0; !file && !deleted && i < numberOfUnindexedSearchNodes; ++i)
 		{
-			if (PixCounter::connectedToPixProfiler())
-				ms_treeFilesOpened.append("%s\t%d\t%s\n", first ? "F" : cms_priorityStrings[priority], file->length(), fixedFileName);
-
-			if (ms_debugLogFlag || ms_warnTreeFileOpens)
-			{
-				char buffer[Os::MAX_PATH_LENGTH];
-				(*i)->getPathName(fixedFileName, buffer, sizeof(buffer));
+			const int searchNode = searchIndex->getUnindexedSearchNode(i);
+			if (indexedSearchNode >= 0 && searchNode > indexedSearchNode)
+				break;
 
-				if (ms_warnTreeFileOpens)
-					WARNING(true, ("TF::open(%s) %s @ %s, [size=%d]\n", cms_priorityStrings[priority], fixedFileName, buffer, file->length()));
-				else
-				{
-					REPORT_LOG(!ms_debugLogSynchronousOnly || (ms_debugLogSynchronousOnly && (priority == AbstractFile::PriorityData) && (*i != ms_searchCache)), ("TF::open(%s) %s @ %s, [size=%d]\n", cms_priorityStrings[priority], fixedFileName, buffer, file->length()));
-					DEBUG_OUTPUT_CHANNEL("Foundation\\Treefile", ("TF::open %s -- %s\n", fixedFileName, buffer));
-				}
-			}
+			file = openSearchNode(searchNode, -1, fixedFileName, priority, deleted);
 		}
 
-		first = false;
-#endif
+		if (!file && !deleted && indexedSearchNode >= 0 && !indexedDeleted)
+			file = openSearchNode(indexedSearchNode, entry, fixedFileName, priority, deleted);
+	}
+	else
+	{
+		const int numberOfSearchNodes = static_cast<int>(ms_searchNodes.size());
+		for (int i = 0; !file && !deleted && i < numberOfSearchNodes; ++i)
+			file = openSearchNode(i, -1, fixedFileName, priority, deleted);
 	}
 
 	if (!file)
@@ -811,6 +1149,44 @@ AbstractFile* TreeFile::open(const char *fileName, AbstractFile::PriorityType pr
 	return file;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Open a file from one search node.
+ *
+ * @param searchNode  Position of the node in the search order
+ * @param entry       Index entry of the file in the node, or -1 to look the file up by name
+ */
+
+AbstractFile *TreeFile::openSearchNode(int searchNode, int entry, const char *fileName, AbstractFile::PriorityType priority, bool &deleted)
+{
+	SearchNode * const node = ms_searchNodes[static_cast<size_t>(searchNode)];
+	AbstractFile * const file = entry >= 0 ? node->openIndexEntry(entry, fileName, priority) : node->open(fileName, priority, deleted);
+
+#if PRODUCTION == 0
+	if (file)
+	{
+		if (PixCounter::connectedToPixProfiler())
+			ms_treeFilesOpened.append("%s\t%d\t%s\n", searchNode == 0 ? "F" : cms_priorityStrings[priority], file->length(), fileName);
+
+		if (ms_debugLogFlag || ms_warnTreeFileOpens)
+		{
+			char buffer[Os::MAX_PATH_LENGTH];
+			node->getPathName(fileName, buffer, sizeof(buffer));
+
+			if (ms_warnTreeFileOpens)
+				WARNING(true, ("TF::open(%s) %s @ %s, [size=%d]\n", cms_priorityStrings[priority], fileName, buffer, file->length()));
+			else
+			{
+				REPORT_LOG(!ms_debugLogSynchronousOnly || (ms_debugLogSynchronousOnly && (priority == AbstractFile::PriorityData) && (node != ms_searchCache)), ("TF::open(%s) %s @ %s, [size=%d]\n", cms_priorityStrings[priority], fileName, buffer, file->length()));
+				DEBUG_OUTPUT_CHANNEL("Foundation\\Treefile", ("TF::open %s -- %s\n", fileName, buffer));
+			}
+		}
+	}
+#endif
+
+	return file;
+}
+
 // ----------------------------------------------------------------------
 
 int TreeFile::getNumberOfSearchPaths(void)
@@ -958,7 +1334,7 @@ void TreeFile::addCachedFile(const char *fileName, AbstractFile *file)
 		const bool result = cachedFilesMap.insert(CachedFilesMap::value_type(fileName, file)).second;
 		UNREF(result);
 		DEBUG_FATAL(!result, ("item was already present"));
-		ms_haveCachedFiles = true;
+		IGNORE_RETURN(ms_haveCachedFiles = 1);
 
 	ms_criticalSection.leave();
 }
@@ -979,7 +1355,7 @@ void TreeFile::clearCachedFiles()
 			}
 
 		cachedFilesMap.clear();
-		ms_haveCachedFiles = false;
+		IGNORE_RETURN(ms_haveCachedFiles = 0);
 
 	ms_criticalSection.leave();
 }
@@ -19,6 +19,7 @@
 class Compressor;
 
 // @todo codereorg remove dependency on mutex
+class InterlockedInteger;
 class Mutex;
 #include "fileInterface/AbstractFile.h"
 
@@ -49,6 +50,9 @@ private:
 	class SearchTOC;
 	class SearchCache;
 
+	// defined in TreeFile.cpp
+	class SearchIndex;
+
 	friend class SearchNode;
 	friend class TreeFileBuilder;
 	friend class TreeFileBuilderHelper;
@@ -86,6 +90,7 @@ public:
 
 	static bool                    exists(const char *fileName);
 	static int                     getFileSize(const char *fileName);
+	static bool                    getFileLocation(const char *fileName, int &searchNode, int &archive, int &offset);
 	static DLLEXPORT AbstractFile *open(const char *filename, AbstractFile::PriorityType, bool allowFail);
 
 	static void          fixUpFileName(const char *fileName, char *outName);
@@ -109,6 +114,7 @@ public:
 private:
 
 	typedef stdvector<SearchNode *>::fwd  SearchNodes;
+	typedef stdvector<SearchIndex *>::fwd SearchIndexes;
 
 private:
 
@@ -123,16 +129,24 @@ private:
 	static bool        searchNodePriorityOrder(const SearchNode *a, const SearchNode *b);
 	static void        addSearchNode(SearchNode *newNode);
 	static SearchNode *find(const char *fileName);
+	static int         locate(const char *fileName, int &entry);
+	static AbstractFile *openSearchNode(int searchNode, int entry, const char *fileName, AbstractFile::PriorityType priority, bool &deleted);
+
+	static SearchIndex const *getSearchIndex();
+	static void               invalidateSearchIndex();
 
 	static void        fixUpFileName(char *output, const char *filename, bool warning);
 
 private:
 
 	static bool          ms_installed;
-	static bool          ms_haveCachedFiles;
+	static InterlockedInteger ms_haveCachedFiles;
 	static Mutex         ms_criticalSection;
 	static SearchNodes   ms_searchNodes;
 	static SearchCache * ms_searchCache;
+	static SearchIndex * ms_searchIndex;
+	static SearchIndexes ms_retiredSearchIndexes;
+	static volatile bool ms_searchIndexDirty;
 
 	static bool          ms_debugReportFlagShowMetrics;
 	static bool          ms_debugReportFlagShowSearchPaths;
@@ -59,6 +59,88 @@ TreeFile::SearchNode::SearchNode(int priority)
 TreeFile::SearchNode::~SearchNode(void)
 {
 }
+
+// ----------------------------------------------------------------------
+/**
+ * Find where a file's data lives within this search node.
+ *
+ * Search nodes that don't pack files into archives report every file at offset 0.
+ */
+
+bool TreeFile::SearchNode::getFileLocation(const char *fileName, int &archive, int &offset, bool &deleted) const
+{
+	archive = 0;
+	offset = 0;
+	return exists(fileName, deleted);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Check if the node's files can be put in the search index.
+ *
+ * Only nodes whose set of files never changes can be indexed.  The entry
+ * functions are only called on nodes that return true.
+ */
+
+bool TreeFile::SearchNode::isIndexable() const
+{
+	return false;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchNode::getNumberOfIndexEntries() const
+{
+	return 0;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get the crc of an entry for the search index.
+ *
+ * @param deleted  Set to true if the entry hides the file in lower priority nodes
+ * @return False if the entry should be left out of the index
+ */
+
+bool TreeFile::SearchNode::getIndexEntry(int, uint32 &, bool &) const
+{
+	DEBUG_FATAL(true, ("TreeFile::SearchNode::getIndexEntry called on a node that isn't indexable"));
+	return false;
+}
+
+// ----------------------------------------------------------------------
+
+const char *TreeFile::SearchNode::getIndexEntryFileName(int) const
+{
+	DEBUG_FATAL(true, ("TreeFile::SearchNode::getIndexEntryFileName called on a node that isn't indexable"));
+	return NULL;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchNode::getIndexEntryFileSize(int) const
+{
+	DEBUG_FATAL(true, ("TreeFile::SearchNode::getIndexEntryFileSize called on a node that isn't indexable"));
+	return -1;
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFile::SearchNode::getIndexEntryLocation(int, int &archive, int &offset) const
+{
+	DEBUG_FATAL(true, ("TreeFile::SearchNode::getIndexEntryLocation called on a node that isn't indexable"));
+	archive = 0;
+	offset = 0;
+}
+
+// ----------------------------------------------------------------------
+
+AbstractFile *TreeFile::SearchNode::openIndexEntry(int, const char *, AbstractFile::PriorityType)
+{
+	DEBUG_FATAL(true, ("TreeFile::SearchNode::openIndexEntry called on a node that isn't indexable"));
+	return NULL;
+}
+
 // ======================================================================
 
 TreeFile::SearchPath::SearchPath(int priority, const char *path)
@@ -258,7 +340,19 @@ bool TreeFile::SearchTree::validate(const char *fileName)
 
 int TreeFile::SearchTree::readPayload(int offset, void *buffer, int length, AbstractFile::PriorityType priority) const
 {
-        const int bytesRead = m_treeFile->read(offset, buffer, length, priority);
+	int bytesRead = 0;
+
+	if (m_mappedData)
+	{
+		// mapped reads never touch the streamer thread, they are a plain copy out of the view
+		if (offset >= 0 && offset < m_mappedLength)
+		{
+			bytesRead = std::min(length, m_mappedLength - offset);
+			memcpy(buffer, m_mappedData + offset, bytesRead);
+		}
+	}
+	else
+		bytesRead = m_treeFile->read(offset, buffer, length, priority);
 
         if (m_isEncrypted && bytesRead > 0)
         {
@@ -270,6 +364,22 @@ int TreeFile::SearchTree::readPayload(int offset, void *buffer, int length, Abst
         return bytesRead;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Get a pointer directly into the mapped tree file.
+ *
+ * @return NULL if the tree file is not mapped or the range is out of bounds.
+ */
+
+byte *TreeFile::SearchTree::getMappedPayload(int offset, int length) const
+{
+	if (!m_mappedData || offset < 0 || length < 0 || offset > m_mappedLength - length)
+		return NULL;
+
+	// the view is read-only; MemoryFile and ZlibFile only read from non-owned buffers
+	return const_cast<byte *>(m_mappedData + offset);
+}
+
 // ----------------------------------------------------------------------
 
 TreeFile::SearchTree::SearchTree(int priority, const char *fileName)
@@ -281,7 +391,10 @@ TreeFile::SearchTree::SearchTree(int priority, const char *fileName)
         m_fileNames(NULL),
         m_tableOfContents(NULL),
         m_isEncrypted(false),
-        m_encryptionKey()
+        m_encryptionKey(),
+	m_mapping(NULL),
+	m_mappedData(NULL),
+	m_mappedLength(0)
 {
 	NOT_NULL(fileName);
 
@@ -305,6 +418,18 @@ TreeFile::SearchTree::SearchTree(int priority, const char *fileName)
                 m_encryptionKey = TreeFileEncryption::deriveKey(passphrase);
         }
 
+        // map the whole archive if requested so that table of contents and payload reads bypass the streamer thread
+        if (ConfigSharedFile::getMapTreeFiles())
+        {
+                m_mapping = FileMapping::create(m_treeFileName);
+                WARNING(!m_mapping, ("TreeFile::SearchTree - could not map [%s], falling back to streamed reads", m_treeFileName));
+                if (m_mapping)
+                {
+                        m_mappedData = m_mapping->getData();
+                        m_mappedLength = m_mapping->getLength();
+                }
+        }
+
         // set to the number of files that has been compressed within the tree file
         m_numberOfFiles = static_cast<int>(header.numberOfFiles);
 
@@ -452,14 +577,20 @@ TreeFile::SearchTree::~SearchTree(void)
 	delete [] m_tableOfContents;
 	delete [] m_fileNames;
 	delete m_treeFile;
+
+	// files handed out as views of the mapping hold their own references, so it may outlive the tree
+	if (m_mapping)
+		m_mapping->release();
+	m_mapping = NULL;
+	m_mappedData = NULL;
 }
 
 // ----------------------------------------------------------------------
 
 void TreeFile::SearchTree::debugPrint(void)
 {
-	DEBUG_REPORT_PRINT(true, ("  %d=priority %s=tree\n", getPriority(), m_treeFileName));
-	DEBUG_OUTPUT_STATIC_VIEW("Foundation\\Treefile", ("  %d=priority %s=tree\n", getPriority(), m_treeFileName));
+	DEBUG_REPORT_PRINT(true, ("  %d=priority %s=tree%s\n", getPriority(), m_treeFileName, m_mappedData ? " [mapped]" : ""));
+	DEBUG_OUTPUT_STATIC_VIEW("Foundation\\Treefile", ("  %d=priority %s=tree%s\n", getPriority(), m_treeFileName, m_mappedData ? " [mapped]" : ""));
 }
 
 // ----------------------------------------------------------------------
@@ -489,6 +620,68 @@ int TreeFile::SearchTree::getFileSize(const char *fileName, bool &deleted) const
 
 // ----------------------------------------------------------------------
 
+bool TreeFile::SearchTree::getFileLocation(const char *fileName, int &archive, int &offset, bool &deleted) const
+{
+	NOT_NULL(fileName);
+	int tableOfContentsIndex = 0;
+	if (!localExists(fileName, &tableOfContentsIndex, deleted))
+		return false;
+
+	archive = 0;
+	offset = m_tableOfContents[tableOfContentsIndex].offset;
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+bool TreeFile::SearchTree::isIndexable() const
+{
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchTree::getNumberOfIndexEntries() const
+{
+	return m_numberOfFiles;
+}
+
+// ----------------------------------------------------------------------
+
+bool TreeFile::SearchTree::getIndexEntry(int entry, uint32 &crc, bool &deleted) const
+{
+	DEBUG_FATAL(entry < 0 || entry >= m_numberOfFiles, ("entry out of range %d/%d", entry, m_numberOfFiles));
+
+	// zero length entries mark files deleted by this tree
+	crc = m_tableOfContents[entry].crc;
+	deleted = m_tableOfContents[entry].length == 0;
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+const char *TreeFile::SearchTree::getIndexEntryFileName(int entry) const
+{
+	return m_fileNames + m_tableOfContents[entry].fileNameOffset;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchTree::getIndexEntryFileSize(int entry) const
+{
+	return m_tableOfContents[entry].length;
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFile::SearchTree::getIndexEntryLocation(int entry, int &archive, int &offset) const
+{
+	archive = 0;
+	offset = m_tableOfContents[entry].offset;
+}
+
+// ----------------------------------------------------------------------
+
 void TreeFile::SearchTree::getPathName(const char *fileName, char *pathName, int pathNameLength)  const
 {
 	NOT_NULL(fileName);
@@ -519,36 +712,61 @@ AbstractFile *TreeFile::SearchTree::open(const char *fileName, AbstractFile::Pri
 
 	int tableOfContentsIndex = -1;
 	if (localExists(fileName, &tableOfContentsIndex, deleted))
+		return openIndexEntry(tableOfContentsIndex, fileName, priority);
+
+	return NULL;
+}
+
+// ----------------------------------------------------------------------
+
+AbstractFile *TreeFile::SearchTree::openIndexEntry(int tableOfContentsIndex, const char *fileName, AbstractFile::PriorityType priority)
+{
+	UNREF(fileName);
+	DEBUG_FATAL(tableOfContentsIndex < 0 || tableOfContentsIndex >= m_numberOfFiles, ("entry out of range %d/%d", tableOfContentsIndex, m_numberOfFiles));
+
+	const TableOfContentsEntry &entry = m_tableOfContents[tableOfContentsIndex];
+
+	// mapped, unencrypted archives hand out views over the mapping instead of copies
+	if (!m_isEncrypted)
 	{
-		const TableOfContentsEntry &entry = m_tableOfContents[tableOfContentsIndex];
+		if (!TreeFile::SearchTree::isCompressed(entry.compressor))
+		{
+			byte * const view = getMappedPayload(entry.offset, entry.length);
+			if (view)
+				return new MemoryFile(view, entry.length, m_mapping);
+		}
+		else
+		{
+			byte * const view = getMappedPayload(entry.offset, entry.compressedLength);
+			if (view)
+				return new ZlibFile(entry.length, view, entry.compressedLength, m_mapping);
+		}
+	}
 
-                if (!TreeFile::SearchTree::isCompressed(entry.compressor))
+        if (!TreeFile::SearchTree::isCompressed(entry.compressor))
+        {
+                if (!m_isEncrypted)
+                        return new FileStreamerFile(priority, *m_treeFile, entry.offset, entry.length);
+
+                byte * const buffer = new byte[entry.length];
+                const int bytesRead = readPayload(entry.offset, buffer, entry.length, priority);
+                if (bytesRead != entry.length)
                 {
-                        if (!m_isEncrypted)
-                                return new FileStreamerFile(priority, *m_treeFile, entry.offset, entry.length);
-
-                        byte * const buffer = new byte[entry.length];
-                        const int bytesRead = readPayload(entry.offset, buffer, entry.length, priority);
-                        if (bytesRead != entry.length)
-                        {
-                                DEBUG_WARNING(true, ("TreeFile::SearchTree::open - failed to read decrypted payload for %s", fileName));
-                                delete [] buffer;
-                                return NULL;
-                        }
-
-                        return new MemoryFile(buffer, entry.length);
+                        DEBUG_WARNING(true, ("TreeFile::SearchTree::open - failed to read decrypted payload for %s", fileName));
+                        delete [] buffer;
+                        return NULL;
                 }
 
-                byte * compressedBuffer = new byte[entry.compressedLength];
+                return new MemoryFile(buffer, entry.length);
+        }
 
-                const int bytesRead = readPayload(entry.offset, compressedBuffer, entry.compressedLength, priority);
-                DEBUG_FATAL(bytesRead != entry.compressedLength, ("error reading compressed data into buffer"));
-                UNREF(bytesRead);
+        byte * compressedBuffer = new byte[entry.compressedLength];
 
-                return new ZlibFile(entry.length, compressedBuffer, entry.compressedLength, true);
-        }
+        const int bytesRead = readPayload(entry.offset, compressedBuffer, entry.compressedLength, priority);
+        DEBUG_FATAL(bytesRead != entry.compressedLength, ("error reading compressed data into buffer"));
+        UNREF(bytesRead);
 
-        return NULL;
+        return new ZlibFile(entry.length, compressedBuffer, entry.compressedLength, true);
 }
 
 // ======================================================================
@@ -861,6 +1079,70 @@ int TreeFile::SearchTOC::getFileSize(const char *fileName, bool &deleted) const
 
 // ----------------------------------------------------------------------
 
+bool TreeFile::SearchTOC::getFileLocation(const char *fileName, int &archive, int &offset, bool &deleted) const
+{
+	NOT_NULL(fileName);
+	deleted = false;
+	int tableOfContentsIndex = 0;
+	if (!localExists(fileName, &tableOfContentsIndex))
+		return false;
+
+	archive = static_cast<int>(m_tableOfContents[tableOfContentsIndex].treeFileIndex);
+	offset = static_cast<int>(m_tableOfContents[tableOfContentsIndex].offset);
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+bool TreeFile::SearchTOC::isIndexable() const
+{
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchTOC::getNumberOfIndexEntries() const
+{
+	return static_cast<int>(m_numberOfFiles);
+}
+
+// ----------------------------------------------------------------------
+
+bool TreeFile::SearchTOC::getIndexEntry(int entry, uint32 &crc, bool &deleted) const
+{
+	DEBUG_FATAL(entry < 0 || entry >= static_cast<int>(m_numberOfFiles), ("entry out of range %d/%d", entry, m_numberOfFiles));
+
+	// leave out the same entries localExists() rejects
+	const TableOfContentsEntry &tableOfContentsEntry = m_tableOfContents[entry];
+	crc = tableOfContentsEntry.crc;
+	deleted = false;
+	return tableOfContentsEntry.length != 0 && tableOfContentsEntry.offset != 0;
+}
+
+// ----------------------------------------------------------------------
+
+const char *TreeFile::SearchTOC::getIndexEntryFileName(int entry) const
+{
+	return m_fileNames + m_tableOfContents[entry].fileNameOffset;
+}
+
+// ----------------------------------------------------------------------
+
+int TreeFile::SearchTOC::getIndexEntryFileSize(int entry) const
+{
+	return static_cast<int>(m_tableOfContents[entry].length);
+}
+
+// ----------------------------------------------------------------------
+
+void TreeFile::SearchTOC::getIndexEntryLocation(int entry, int &archive, int &offset) const
+{
+	archive = static_cast<int>(m_tableOfContents[entry].treeFileIndex);
+	offset = static_cast<int>(m_tableOfContents[entry].offset);
+}
+
+// ----------------------------------------------------------------------
+
 void TreeFile::SearchTOC::getPathName(const char *fileName, char *pathName, int pathNameLength)  const
 {
 	NOT_NULL(fileName);
@@ -898,22 +1180,30 @@ AbstractFile *TreeFile::SearchTOC::open(const char *fileName, AbstractFile::Prio
 
 	int tableOfContentsIndex = -1;
 	if (localExists(fileName, &tableOfContentsIndex))
-	{
-		const TableOfContentsEntry &entry = m_tableOfContents[tableOfContentsIndex];
+		return openIndexEntry(tableOfContentsIndex, fileName, priority);
 
-		if (!isCompressed(entry.compressor))
-			return new FileStreamerFile(priority, *m_treeFiles[entry.treeFileIndex], entry.offset, entry.length);
+	return NULL;
+}
 
-		byte * compressedBuffer = new byte[entry.compressedLength];
+// ----------------------------------------------------------------------
 
-		const uint32 bytesRead = m_treeFiles[entry.treeFileIndex]->read(entry.offset, compressedBuffer, entry.compressedLength, priority);
-		DEBUG_FATAL(bytesRead != entry.compressedLength, ("error reading compressed data into buffer"));
-		UNREF(bytesRead);
+AbstractFile *TreeFile::SearchTOC::openIndexEntry(int tableOfContentsIndex, const char *fileName, AbstractFile::PriorityType priority)
+{
+	UNREF(fileName);
+	DEBUG_FATAL(tableOfContentsIndex < 0 || tableOfContentsIndex >= static_cast<int>(m_numberOfFiles), ("entry out of range %d/%d", tableOfContentsIndex, m_numberOfFiles));
 
-		return new ZlibFile(entry.length, compressedBuffer, entry.compressedLength, true);
-	}
+	const TableOfContentsEntry &entry = m_tableOfContents[tableOfContentsIndex];
 
-	return NULL;
+	if (!isCompressed(entry.compressor))
+		return new FileStreamerFile(priority, *m_treeFiles[entry.treeFileIndex], entry.offset, entry.length);
+
+	byte * compressedBuffer = new byte[entry.compressedLength];
+
+	const uint32 bytesRead = m_treeFiles[entry.treeFileIndex]->read(entry.offset, compressedBuffer, entry.compressedLength, priority);
+	DEBUG_FATAL(bytesRead != entry.compressedLength, ("error reading compressed data into buffer"));
+	UNREF(bytesRead);
+
+	return new ZlibFile(entry.length, compressedBuffer, entry.compressedLength, true);
 }
 
 // ======================================================================
@@ -42,6 +42,16 @@ public:
 	virtual int           getFileSize(const char *fileName, bool &deleted) const = 0;
 	virtual void          getPathName(const char *fileName, char *pathName, int pathNameLength) const = 0;
 	virtual AbstractFile *open(const char *fileName, AbstractFile::PriorityType priority, bool &deleted) = 0;
+	virtual bool          getFileLocation(const char *fileName, int &archive, int &offset, bool &deleted) const;
+
+	// nodes with a fixed set of files can be added to the search index, and then accessed by entry
+	virtual bool          isIndexable() const;
+	virtual int           getNumberOfIndexEntries() const;
+	virtual bool          getIndexEntry(int entry, uint32 &crc, bool &deleted) const;
+	virtual const char   *getIndexEntryFileName(int entry) const;
+	virtual int           getIndexEntryFileSize(int entry) const;
+	virtual void          getIndexEntryLocation(int entry, int &archive, int &offset) const;
+	virtual AbstractFile *openIndexEntry(int entry, const char *fileName, AbstractFile::PriorityType priority);
 
 private:
 
@@ -146,6 +156,15 @@ public:
 	virtual int           getFileSize(const char *fileName, bool &deleted) const;
 	virtual void          getPathName(const char *fileName, char *pathName, int pathNameLength) const;
 	virtual AbstractFile *open(const char *fileName, AbstractFile::PriorityType priority, bool &deleted);
+	virtual bool          getFileLocation(const char *fileName, int &archive, int &offset, bool &deleted) const;
+
+	virtual bool          isIndexable() const;
+	virtual int           getNumberOfIndexEntries() const;
+	virtual bool          getIndexEntry(int entry, uint32 &crc, bool &deleted) const;
+	virtual const char   *getIndexEntryFileName(int entry) const;
+	virtual int           getIndexEntryFileSize(int entry) const;
+	virtual void          getIndexEntryLocation(int entry, int &archive, int &offset) const;
+	virtual AbstractFile *openIndexEntry(int entry, const char *fileName, AbstractFile::PriorityType priority);
 
 private:
 
@@ -162,6 +181,7 @@ private:
 
         bool localExists(const char *fileName, int *index, bool &deleted) const;
         int  readPayload(int offset, void *buffer, int length, AbstractFile::PriorityType priority) const;
+	byte *getMappedPayload(int offset, int length) const;
 
 private:
 
@@ -208,6 +228,9 @@ private:
         TableOfContentsEntry   *m_tableOfContents;
         bool                    m_isEncrypted;
         Md5::Value              m_encryptionKey;
+	FileMapping const      *m_mapping;
+	byte const             *m_mappedData;
+	int                     m_mappedLength;
 };
 
 // ======================================================================
@@ -237,6 +260,15 @@ public:
 	virtual int           getFileSize(const char *fileName, bool &deleted) const;
 	virtual void          getPathName(const char *fileName, char *pathName, int pathNameLength) const;
 	virtual AbstractFile *open(const char *fileName, AbstractFile::PriorityType priority, bool &deleted);
+	virtual bool          getFileLocation(const char *fileName, int &archive, int &offset, bool &deleted) const;
+
+	virtual bool          isIndexable() const;
+	virtual int           getNumberOfIndexEntries() const;
+	virtual bool          getIndexEntry(int entry, uint32 &crc, bool &deleted) const;
+	virtual const char   *getIndexEntryFileName(int entry) const;
+	virtual int           getIndexEntryFileSize(int entry) const;
+	virtual void          getIndexEntryLocation(int entry, int &archive, int &offset) const;
+	virtual AbstractFile *openIndexEntry(int entry, const char *fileName, AbstractFile::PriorityType priority);
 
 private:
 
@@ -12,6 +12,7 @@
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/MemoryBlockManager.h"
 #include "sharedCompression/ZlibCompressor.h"
+#include "sharedFile/FileStreamer.h"
 #include "sharedFile/MemoryFile.h"
 
 // ======================================================================
@@ -66,10 +67,31 @@ ZlibFile::ZlibFile(int uncompressedLength, byte *compressedBuffer, int compresse
 	m_compressedBuffer(compressedBuffer),
 	m_compressedBufferLength(compressedBufferLength),
 	m_ownsCompressedBuffer(ownsCompressedBuffer),
+	m_mapping(NULL),
 	m_decompressedMemoryFile(NULL)
 {
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Construct a ZlibFile over compressed data in a mapped file.
+ *
+ * The file holds a reference to the mapping until it is closed.
+ */
+
+ZlibFile::ZlibFile(int uncompressedLength, byte *compressedBuffer, int compressedBufferLength, FileMapping const *mapping)
+: AbstractFile(PriorityData),
+	m_uncompressedLength(uncompressedLength),
+	m_compressedBuffer(compressedBuffer),
+	m_compressedBufferLength(compressedBufferLength),
+	m_ownsCompressedBuffer(false),
+	m_mapping(mapping),
+	m_decompressedMemoryFile(NULL)
+{
+	NOT_NULL(m_mapping);
+	m_mapping->fetch();
+}
+
 // ----------------------------------------------------------------------
 
 ZlibFile::~ZlibFile()
@@ -139,6 +161,12 @@ void ZlibFile::close()
 		delete [] m_compressedBuffer;
 	m_compressedBuffer = NULL;
 
+	if (m_mapping)
+	{
+		m_mapping->release();
+		m_mapping = NULL;
+	}
+
 	delete m_decompressedMemoryFile;
 	m_decompressedMemoryFile = NULL;
 }
@@ -11,6 +11,7 @@
 
 // ======================================================================
 
+class FileMapping;
 class MemoryBlockManager;
 class MemoryFile;
 
@@ -29,6 +30,7 @@ public:
 public:
 
 	ZlibFile(int uncompressedLength, byte *compressedBuffer, int compressedLength, bool ownsCompressedBuffer);
+	ZlibFile(int uncompressedLength, byte *compressedBuffer, int compressedLength, FileMapping const *mapping);
 	virtual ~ZlibFile();
 
 	virtual bool  isOpen() const;
@@ -68,6 +70,7 @@ private:
 	byte *m_compressedBuffer;
 	const int m_compressedBufferLength;
 	bool m_ownsCompressedBuffer;
+	FileMapping const *m_mapping;
 	mutable MemoryFile *m_decompressedMemoryFile;
 };
 
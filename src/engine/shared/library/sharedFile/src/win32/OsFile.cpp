@@ -13,6 +13,8 @@
 #include "sharedDebug/PerformanceTimer.h"
 #endif
 
+#include <climits>
+
 namespace OsFileNamespace
 {
 	float ms_time;
@@ -97,6 +99,69 @@ OsFile *OsFile::open(const char *fileName, bool randomAccess)
 	return new OsFile(handle);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Map an entire file read-only into the address space of the process.
+ *
+ * The file and mapping handles are closed before returning; the view keeps
+ * the file alive until it is released with unmap().
+ *
+ * @param fileName  File name to map
+ * @param length    [Out] Length of the mapped view in bytes
+ * @return Pointer to the start of the view, or NULL if the file could not be mapped or is too large.
+ */
+
+void const *OsFile::map(const char *fileName, int &length)
+{
+	NOT_NULL(fileName);
+	length = 0;
+
+#ifdef _DEBUG
+	PerformanceTimer t;
+	t.start();
+#endif
+
+	HANDLE const handle = CreateFile(fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size))
+		size.QuadPart = 0;
+
+	// zero length files can not be mapped, and lengths are ints so files of 2GB or more
+	// are left to the streamed path
+	HANDLE const mapping = (size.QuadPart > 0 && size.QuadPart <= INT_MAX) ? CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	CloseHandle(handle);
+
+	if (!mapping)
+		return NULL;
+
+	void const * const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+
+#ifdef _DEBUG
+	t.stop();
+	ms_time += t.getElapsedTime();
+#endif
+
+	if (!data)
+		return NULL;
+
+	length = static_cast<int>(size.QuadPart);
+	return data;
+}
+
+// ----------------------------------------------------------------------
+
+void OsFile::unmap(void const *data, int length)
+{
+	UNREF(length);
+
+	if (data)
+		IGNORE_RETURN(UnmapViewOfFile(data));
+}
+
 // ----------------------------------------------------------------------
 
 OsFile::OsFile(HANDLE handle)
@@ -192,4 +257,51 @@ int OsFile::read(void *destinationBuffer, int numberOfBytes)
 	return static_cast<int>(amountReadDword);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Read from an absolute offset without going through the file pointer.
+ *
+ * This may be called from several threads at once on the same file.
+ */
+
+int OsFile::read(int offset, void *destinationBuffer, int numberOfBytes)
+{
+#ifdef _DEBUG
+	PerformanceTimer t;
+	t.start();
+#endif
+
+	OVERLAPPED overlapped;
+	memset(&overlapped, 0, sizeof(overlapped));
+	overlapped.Offset = static_cast<DWORD>(offset);
+
+	DWORD amountReadDword = 0;
+	BOOL const result = ReadFile(m_handle, destinationBuffer, static_cast<uint>(numberOfBytes), &amountReadDword, &overlapped);
+	if (!result)
+	{
+		DWORD const error = GetLastError();
+		if (error == ERROR_HANDLE_EOF)
+			amountReadDword = 0;
+		else
+			if (error == 998) // access violation - buffer coming from miles hosed
+			{
+				WARNING(true,("FileStreamerThread::processRead ReadFile failed to read '%d' bytes at '%d' with error '%d'", static_cast<uint>(numberOfBytes), offset, error));
+				return 0;
+			}
+			else
+			{
+				FATAL(true, ("FileStreamerThread::processRead ReadFile failed to read '%d' bytes at '%d' with error '%d'", static_cast<uint>(numberOfBytes), offset, error));
+			}
+	}
+
+#ifdef _DEBUG
+	t.stop();
+	ms_time += t.getElapsedTime();
+#endif
+
+	// the read moved the file pointer, so make sure the next seek goes to the OS
+	m_offset = -1;
+	return static_cast<int>(amountReadDword);
+}
+
 // ======================================================================
@@ -23,6 +23,9 @@ public:
 	static int     getFileSize(const char *fileName);
 	static OsFile *open(const char *fileName, bool randomAccess=false);
 
+	static void const *map(const char *fileName, int &length);
+	static void    unmap(void const *data, int length);
+
 public:
 
 	~OsFile();
@@ -31,6 +34,7 @@ public:
 	int  tell() const;
 	void seek(int newFilePosition);
 	int  read(void *destinationBuffer, int numberOfBytes);
+	int  read(int offset, void *destinationBuffer, int numberOfBytes);
 
 private:
 
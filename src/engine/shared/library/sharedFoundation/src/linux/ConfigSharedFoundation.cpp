@@ -40,6 +40,8 @@ namespace ConfigSharedFoundationNamespace
 
 	bool ms_memoryManagerReportAllocations;
 	bool ms_memoryManagerReportOnOutOfMemory;
+	int  ms_memoryManagerAllocationProfileSampleRate;
+	int  ms_memoryManagerAllocationProfileReportCount;
 
 	bool ms_useMemoryBlockManager;
 	bool ms_memoryBlockManagerDebugDumpOnRemove;
@@ -94,6 +96,8 @@ void ConfigSharedFoundation::install (const Defaults &defaults)
 	KEY_BOOL(profilerExpandAllBranches,       true);
 	KEY_BOOL(memoryManagerReportAllocations,  true);
 	KEY_BOOL(memoryManagerReportOnOutOfMemory, true);
+	KEY_INT(memoryManagerAllocationProfileSampleRate, 1);
+	KEY_INT(memoryManagerAllocationProfileReportCount, 32);
 
 	KEY_BOOL(useMemoryBlockManager,               true);
 	KEY_BOOL(memoryBlockManagerDebugDumpOnRemove, false);
@@ -260,6 +264,20 @@ bool ConfigSharedFoundation::getMemoryManagerReportOnOutOfMemory()
 
 // ----------------------------------------------------------------------
 
+int ConfigSharedFoundation::getMemoryManagerAllocationProfileSampleRate()
+{
+	return ms_memoryManagerAllocationProfileSampleRate;
+}
+
+// ----------------------------------------------------------------------
+
+int ConfigSharedFoundation::getMemoryManagerAllocationProfileReportCount()
+{
+	return ms_memoryManagerAllocationProfileReportCount;
+}
+
+// ----------------------------------------------------------------------
+
 bool ConfigSharedFoundation::getUseMemoryBlockManager()
 {
 	return ms_useMemoryBlockManager;
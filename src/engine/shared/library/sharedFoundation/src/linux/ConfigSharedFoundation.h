@@ -44,6 +44,8 @@ public:
 
 	static bool  getMemoryManagerReportAllocations();
 	static bool  getMemoryManagerReportOnOutOfMemory();
+	static int   getMemoryManagerAllocationProfileSampleRate();
+	static int   getMemoryManagerAllocationProfileReportCount();
 
 	static bool  getUseMemoryBlockManager();
 	static bool  getMemoryBlockManagerDebugDumpOnRemove();
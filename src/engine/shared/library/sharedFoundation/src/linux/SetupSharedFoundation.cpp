@@ -16,6 +16,7 @@
 #include "sharedFoundation/CommandLine.h"
 #include "sharedFoundation/ConfigFile.h"
 #include "sharedFoundation/ConfigSharedFoundation.h"
+#include "sharedFoundation/Crc.h"
 #include "sharedFoundation/CrcLowerString.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/Os.h"
@@ -76,6 +77,7 @@ void SetupSharedFoundation::install(const Data &data)
 	Report::install();
 	Clock::install(data.runInBackground, false);
 
+	Crc::install();
 	PersistentCrcString::install();
 	CrcLowerString::install();
 	StaticCallbackEntry::install();
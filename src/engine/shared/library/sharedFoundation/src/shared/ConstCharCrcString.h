@@ -12,6 +12,7 @@
 // ======================================================================
 
 #include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/CrcString.h"
+#include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/Crc.h"
 
 // ======================================================================
 
@@ -40,6 +41,14 @@ private:
 	char const * const m_buffer;
 };
 
+// ======================================================================
+/**
+ * A ConstCharCrcString over a string literal, with the crc computed by
+ * CRC_CONSTANT() instead of at construction.
+ */
+
+#define CONST_CHAR_CRC_STRING(string) ConstCharCrcString(string, CRC_CONSTANT(string))
+
 // ======================================================================
 
 #endif
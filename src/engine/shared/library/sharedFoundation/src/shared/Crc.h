@@ -15,6 +15,15 @@
 
 // Functions that return the CRC value of either strings or blocks of data.
 
+// compilers that support constexpr can hash string literals while compiling
+#if defined(__cpp_constexpr) || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define CRC_HAS_CONSTEXPR 1
+#define CRC_CONSTEXPR constexpr
+#else
+#define CRC_HAS_CONSTEXPR 0
+#define CRC_CONSTEXPR inline
+#endif
+
 class Crc
 {
 public:
@@ -25,11 +34,79 @@ public:
 
 public:
 
+	static void   install();
+
 	static uint32 calculate(const char *string);
 	static uint32 calculate(const void *data, int len, uint32 initCrc = crcInit);
 	static uint32 normalizeAndCalculate(const char *string);
+
+	static CRC_CONSTEXPR uint32 constant(const char *string);
+
+private:
+
+	static void   remove();
+
+	static CRC_CONSTEXPR uint32 constantTableEntry(uint32 value, int bits);
+	static CRC_CONSTEXPR uint32 constantUpdate(const char *string, uint32 crc);
+};
+
+// ----------------------------------------------------------------------
+/**
+ * Calculate the crc of a string the same way calculate() does.
+ *
+ * This is written so that it can be evaluated by the compiler, which makes
+ * it suitable for string literals.  It is much slower than calculate() at
+ * run time, so use it through CRC_CONSTANT().
+ */
+
+CRC_CONSTEXPR uint32 Crc::constant(const char *string)
+{
+	return string ? constantUpdate(string, 0xFFFFFFFF) ^ 0xFFFFFFFF : 0;
+}
+
+// ----------------------------------------------------------------------
+
+CRC_CONSTEXPR uint32 Crc::constantTableEntry(uint32 value, int bits)
+{
+	return bits ? constantTableEntry((value & 0x80000000) ? ((value << 1) ^ 0x04C11DB7) : (value << 1), bits - 1) : value;
+}
+
+// ----------------------------------------------------------------------
+
+CRC_CONSTEXPR uint32 Crc::constantUpdate(const char *string, uint32 crc)
+{
+	return *string ? constantUpdate(string + 1, constantTableEntry(((crc >> 24) ^ static_cast<unsigned char>(*string)) << 24, 8) ^ (crc << 8)) : crc;
+}
+
+// ======================================================================
+/**
+ * The crc of a string literal.
+ *
+ * Where the compiler supports constexpr the crc is computed while compiling;
+ * the template argument forces that even where the result feeds a run time
+ * expression.  Older compilers fall back to Crc::calculate(), which is the
+ * faster of the two at run time.
+ */
+
+#if CRC_HAS_CONSTEXPR
+
+template <uint32 crc>
+struct CrcConstant
+{
+	static const uint32 value = crc;
 };
 
+template <uint32 crc>
+const uint32 CrcConstant<crc>::value;
+
+#define CRC_CONSTANT(string) (CrcConstant<Crc::constant(string)>::value)
+
+#else
+
+#define CRC_CONSTANT(string) (Crc::calculate(string))
+
+#endif
+
 // ======================================================================
 
 #endif
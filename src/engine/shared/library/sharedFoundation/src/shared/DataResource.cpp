@@ -50,10 +50,25 @@ void DataResource::addReference() const
 void DataResource::releaseReference() const
 {
 	DEBUG_FATAL(m_referenceCount <= 0, ("DataResource::releaseReference - reference count is already 0\n"));
-	if (m_referenceCount > 0 && --m_referenceCount == 0)
+
+	// the list drops the reference under its lock, so a fetch on another thread
+	// can't find the resource between its count reaching 0 and it being deleted
+	if (m_referenceCount > 0)
 		release();
 }	
 
+// ----------------------------------------------------------------------
+/**
+ * Drop a reference.  Only called by DataResourceList with its lock held.
+ *
+ * @return True if that was the last reference
+ */
+
+bool DataResource::dropReference() const
+{
+	return --m_referenceCount == 0;
+}	
+
 // ----------------------------------------------------------------------
 
 void DataResource::preloadAssets () const
@@ -11,11 +11,14 @@
 // ======================================================================
 
 #include "PersistentCrcString.h"
+#include "sharedSynchronization/InterlockedInteger.h"
 
 // ======================================================================
 
 class DataResource
 {
+	template <typename T> friend class DataResourceList;
+
 public:
 
 	explicit DataResource(const char* filename);
@@ -41,13 +44,17 @@ private:
 	DataResource(const DataResource &source);
 	DataResource &operator =(const DataResource &source);
 
+	bool                  dropReference() const;
+
 private:
 	
 	// resource name
 	const PersistentCrcString m_name;            
 
-	// how many times this resource has been loaded
-	mutable int               m_referenceCount;  
+	// how many times this resource has been loaded.  DataResourceList may add
+	// references from loader threads, so it is changed atomically, and the
+	// last reference is dropped by the list with its lock held.
+	mutable InterlockedInteger m_referenceCount;
 };
 
 // ----------------------------------------------------------------------
@@ -11,7 +11,9 @@
 #define _INCLUDED_DataResourceList_H
 
 #include "sharedDebug/DataLint.h"
+#include "sharedDebug/PerformanceTimer.h"
 #include "sharedFile/Iff.h"
+#include "sharedSynchronization/Mutex.h"
 #include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/ConfigSharedFoundation.h"
 #include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/CrcString.h"
 #include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/ExitChain.h"
@@ -21,13 +23,32 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 //========================================================================
 
 // T should be derived from class DataResource
+//
+// Resources fetched by name are kept in a table keyed on the crc of their
+// name.  Fetching by name and releasing are safe from any thread, so loader
+// threads can warm resources while the main thread uses them.  The resources
+// themselves are loaded without holding the table lock.
 template <typename T>
 class DataResourceList
 {
+public:
+
+	struct Statistics
+	{
+		int    loaded;
+		int    hits;
+		int    misses;
+		int    failedLoads;
+		int    duplicateLoads;
+		double totalLoadTime;
+		float  maximumLoadTime;
+	};
+
 public:
 	// DataResource registration function
 	typedef T * (*CreateDataResourceFunc)(const std::string & filename);
@@ -56,6 +77,7 @@ public:
 	static void release(const T & dataResource);
 
 	static void logLoadedResources(char const * classType);
+	static Statistics getStatistics();
 
 	static void garbageCollect ();
 
@@ -64,7 +86,7 @@ private:
 	typedef std::map<Tag, CreateDataResourceFunc> CreateDataResourceMap;
 	static CreateDataResourceMap *ms_bindings;
 
-	typedef std::map<const CrcString*, const T*, LessPointerComparator> LoadedDataResourceMap;
+	class LoadedDataResourceMap;
 	static LoadedDataResourceMap *ms_loaded;
 
 private:
@@ -76,6 +98,190 @@ private:
 
 //----------------------------------------------------------------------
 
+/**
+ * Open addressing table of loaded resources keyed on the crc of their names.
+ *
+ * The table is probed linearly and entries are removed by shifting the
+ * following entries back, so there are no deleted markers.  Callers must
+ * hold the table's mutex.
+ */
+template <typename T>
+class DataResourceList<T>::LoadedDataResourceMap
+{
+public:
+
+	LoadedDataResourceMap();
+	~LoadedDataResourceMap();
+
+	const T *  find(const CrcString &name) const;
+	void       insert(const T &dataResource);
+	bool       erase(const T &dataResource);
+
+	bool       empty() const;
+	int        getCapacity() const;
+	const T *  getEntry(int index) const;
+
+public:
+
+	Mutex      m_mutex;
+	Statistics m_statistics;
+
+private:
+
+	struct Slot
+	{
+		uint32    crc;
+		const T * dataResource;
+	};
+
+private:
+
+	void grow();
+
+private:
+
+	Slot *     m_slots;
+	int        m_capacity;
+	int        m_count;
+
+private:
+
+	LoadedDataResourceMap(const LoadedDataResourceMap &);
+	LoadedDataResourceMap & operator =(const LoadedDataResourceMap &);
+};
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline DataResourceList<T>::LoadedDataResourceMap::LoadedDataResourceMap() :
+	m_mutex(),
+	m_statistics(),
+	m_slots(new Slot[64]),
+	m_capacity(64),
+	m_count(0)
+{
+	memset(&m_statistics, 0, sizeof(m_statistics));
+	memset(m_slots, 0, sizeof(Slot) * m_capacity);
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline DataResourceList<T>::LoadedDataResourceMap::~LoadedDataResourceMap()
+{
+	delete [] m_slots;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline const T * DataResourceList<T>::LoadedDataResourceMap::find(const CrcString &name) const
+{
+	uint32 const crc = name.getCrc();
+	int const mask = m_capacity - 1;
+	for (int i = static_cast<int>(crc) & mask; m_slots[i].dataResource; i = (i + 1) & mask)
+		if (m_slots[i].crc == crc && m_slots[i].dataResource->getCrcName() == name)
+			return m_slots[i].dataResource;
+
+	return NULL;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline void DataResourceList<T>::LoadedDataResourceMap::insert(const T &dataResource)
+{
+	// keep the table at most half full
+	if ((m_count + 1) * 2 > m_capacity)
+		grow();
+
+	uint32 const crc = dataResource.getCrcName().getCrc();
+	int const mask = m_capacity - 1;
+	int i = static_cast<int>(crc) & mask;
+	while (m_slots[i].dataResource)
+		i = (i + 1) & mask;
+
+	m_slots[i].crc = crc;
+	m_slots[i].dataResource = &dataResource;
+	++m_count;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline bool DataResourceList<T>::LoadedDataResourceMap::erase(const T &dataResource)
+{
+	uint32 const crc = dataResource.getCrcName().getCrc();
+	int const mask = m_capacity - 1;
+	int i = static_cast<int>(crc) & mask;
+	for ( ; m_slots[i].dataResource != &dataResource; i = (i + 1) & mask)
+		if (!m_slots[i].dataResource)
+			return false;
+
+	// shift back any following entries that would no longer be reachable through the hole
+	for (int j = (i + 1) & mask; m_slots[j].dataResource; j = (j + 1) & mask)
+	{
+		int const home = static_cast<int>(m_slots[j].crc) & mask;
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{
+			m_slots[i] = m_slots[j];
+			i = j;
+		}
+	}
+
+	m_slots[i].crc = 0;
+	m_slots[i].dataResource = NULL;
+	--m_count;
+
+	return true;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline bool DataResourceList<T>::LoadedDataResourceMap::empty() const
+{
+	return m_count == 0;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline int DataResourceList<T>::LoadedDataResourceMap::getCapacity() const
+{
+	return m_capacity;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline const T * DataResourceList<T>::LoadedDataResourceMap::getEntry(int index) const
+{
+	return m_slots[index].dataResource;
+}
+
+//----------------------------------------------------------------------
+
+template <typename T>
+inline void DataResourceList<T>::LoadedDataResourceMap::grow()
+{
+	Slot * const oldSlots = m_slots;
+	int const oldCapacity = m_capacity;
+
+	m_capacity *= 2;
+	m_slots = new Slot[m_capacity];
+	memset(m_slots, 0, sizeof(Slot) * m_capacity);
+	m_count = 0;
+
+	for (int i = 0; i < oldCapacity; ++i)
+		if (oldSlots[i].dataResource)
+			insert(*oldSlots[i].dataResource);
+
+	delete [] oldSlots;
+}
+
+//----------------------------------------------------------------------
+
 /**
  * Sets up the maps to keep track of resources.
  */
@@ -106,9 +312,12 @@ inline void DataResourceList<T>::remove(void)
 		if (!ms_loaded->empty())
 		{
 			DEBUG_REPORT_LOG (true, ("Data resources still allocated:\n"));
-			for (typename LoadedDataResourceMap::const_iterator i = ms_loaded->begin (); i != ms_loaded->end (); ++i)
+			for (int i = 0; i < ms_loaded->getCapacity(); ++i)
 			{
-				const T * const   dataResource = (*i).second;
+				const T * const   dataResource = ms_loaded->getEntry(i);
+				if (!dataResource)
+					continue;
+
 				const int         users        = dataResource->getReferenceCount ();
 				const char* const name         = dataResource->getName ();
 				DEBUG_REPORT_LOG (true, (" %3d %s\n", users, name));
@@ -300,35 +509,86 @@ inline const T * DataResourceList<T>::fetch(const CrcString &filename)
 	NOT_NULL(ms_loaded);
 
 	// see if we already have loaded the template
-	typename LoadedDataResourceMap::iterator iter = ms_loaded->find(&filename);
-	if (iter != ms_loaded->end())
+	ms_loaded->m_mutex.enter();
 	{
-		(*iter).second->addReference();
-		return (*iter).second;
+		const T * const dataResource = ms_loaded->find(filename);
+		if (dataResource != NULL)
+		{
+			dataResource->addReference();
+			++ms_loaded->m_statistics.hits;
+			ms_loaded->m_mutex.leave();
+			return dataResource;
+		}
+
+		++ms_loaded->m_statistics.misses;
 	}
+	ms_loaded->m_mutex.leave();
+
+	// load the template without holding the lock so other threads can keep fetching
+	PerformanceTimer timer;
+	timer.start();
 
-	// load the template
 	Iff iff;
 	if (!iff.open(filename.getString(), true))
+	{
+		ms_loaded->m_mutex.enter();
+			++ms_loaded->m_statistics.failedLoads;
+		ms_loaded->m_mutex.leave();
 		return NULL;
+	}
 
-	// put the template in the loaded list
-	const T * const newDataResource = fetch(iff);
-	if (newDataResource != NULL)
+	const T * newDataResource = fetch(iff);
+
+	// clean up
+	iff.close();
+
+	timer.stop();
+	float const loadTime = timer.getElapsedTime();
+
+	if (newDataResource == NULL)
+	{
+		ms_loaded->m_mutex.enter();
+			++ms_loaded->m_statistics.failedLoads;
+		ms_loaded->m_mutex.leave();
+		return NULL;
+	}
+
+	// put the template in the loaded list, unless another thread loaded it first
+	const T * duplicateDataResource = NULL;
+
+	ms_loaded->m_mutex.enter();
 	{
+		Statistics &statistics = ms_loaded->m_statistics;
+		statistics.totalLoadTime += loadTime;
+		if (loadTime > statistics.maximumLoadTime)
+			statistics.maximumLoadTime = loadTime;
+
+		const T * const existingDataResource = ms_loaded->find(newDataResource->getCrcName());
+		if (existingDataResource != NULL)
+		{
+			++statistics.duplicateLoads;
+			duplicateDataResource = newDataResource;
+			newDataResource = existingDataResource;
+		}
+		else
+		{
+			++statistics.loaded;
+			ms_loaded->insert(*newDataResource);
+		}
+
 		newDataResource->addReference();
-		ms_loaded->insert(std::make_pair(&newDataResource->getCrcName (), newDataResource));
 	}
+	ms_loaded->m_mutex.leave();
+
+	delete duplicateDataResource;
 
-	// clean up
-	iff.close();
 	return newDataResource;
 }
 
 //----------------------------------------------------------------------
 
 /**
- * Checks the reference count of a resource, if it is 0, deletes it.
+ * Drops a reference on a resource, and deletes it if that was the last one.
  *
  * @param dataResource		the data resource to release
  */
@@ -337,17 +597,20 @@ inline void DataResourceList<T>::release(const T & dataResource)
 {
 	NOT_NULL(ms_loaded);
 
-	if (ms_loaded != NULL && dataResource.getReferenceCount() == 0)
-	{
-		typename LoadedDataResourceMap::iterator iter = ms_loaded->find(&dataResource.getCrcName());
-		if (iter != ms_loaded->end())
-		{
-			const T * const temp = (*iter).second;
-			(*iter).second = NULL;
-			ms_loaded->erase(iter);
-			delete temp;
-		}
-	}
+	if (ms_loaded == NULL)
+		return;
+
+	// the count is dropped under the lock that fetch() takes, so once it reaches zero
+	// no other thread can find the resource and add a reference to it
+	bool deleteDataResource = false;
+
+	ms_loaded->m_mutex.enter();
+		if (dataResource.dropReference())
+			deleteDataResource = ms_loaded->erase(dataResource);
+	ms_loaded->m_mutex.leave();
+
+	if (deleteDataResource)
+		delete &dataResource;
 }	// DataResourceList<T>::release
 
 //----------------------------------------------------------------------
@@ -365,19 +628,19 @@ inline T * DataResourceList<T>::reload(Iff &source)
 	NOT_NULL(ms_loaded);
 
 	const TemporaryCrcString sourceCrcString (source.getFileName(), true);
-	typename LoadedDataResourceMap::iterator iter = ms_loaded->find(&sourceCrcString);
-	if (iter == ms_loaded->end())
+
+	ms_loaded->m_mutex.enter();
+		T * const dataResource = const_cast<T *>(ms_loaded->find(sourceCrcString));
+	ms_loaded->m_mutex.leave();
+
+	if (dataResource == NULL)
 	{
 		DEBUG_WARNING(true, ("DataResourceList::reload: trying to reload unloaded resource %s!", source.getFileName()));
 		return NULL;
 	}
 
-	T * const dataResource = const_cast<T *>((*iter).second);
-	if (dataResource != NULL)
-	{
-		// initialize the data resource
-		dataResource->loadFromIff(source);
-	}
+	// initialize the data resource
+	dataResource->loadFromIff(source);
 	return dataResource;
 }	// DataResourceList<T>::reload(Iff &)
 
@@ -388,8 +651,12 @@ inline const bool DataResourceList<T>::isLoaded(const std::string & source)
 {
 	NOT_NULL(ms_loaded);
 	const TemporaryCrcString sourceCrcString (source.c_str (), true);
-	typename LoadedDataResourceMap::iterator iter = ms_loaded->find(&sourceCrcString);
-	return (iter != ms_loaded->end());
+
+	ms_loaded->m_mutex.enter();
+		bool const loaded = ms_loaded->find(sourceCrcString) != NULL;
+	ms_loaded->m_mutex.leave();
+
+	return loaded;
 }
 
 //-----------------------------------------------------------------------
@@ -398,24 +665,68 @@ template<typename T>
 void DataResourceList<T>::logLoadedResources(char const * classType)
 {
 	UNREF(classType); //necessary for release build
-	typename LoadedDataResourceMap::iterator const iterEnd = ms_loaded->end();
 	DEBUG_REPORT_LOG_PRINT(true, ("Begin log of loaded %s\n", classType));
 
-	for (typename LoadedDataResourceMap::iterator iter = ms_loaded->begin(); iter != iterEnd; ++iter)
-		DEBUG_REPORT_LOG_PRINT(true, (" %d %s\n", iter->second->getReferenceCount(), iter->second->getName()));
+	ms_loaded->m_mutex.enter();
+	{
+		for (int i = 0; i < ms_loaded->getCapacity(); ++i)
+		{
+			const T * const dataResource = ms_loaded->getEntry(i);
+			if (dataResource)
+				DEBUG_REPORT_LOG_PRINT(true, (" %d %s\n", dataResource->getReferenceCount(), dataResource->getName()));
+		}
+
+		Statistics const &statistics = ms_loaded->m_statistics;
+		UNREF(statistics);
+		DEBUG_REPORT_LOG_PRINT(true, ("%s: %d loaded, %d hits, %d misses, %d failed, %d duplicate loads, %.3f total load secs, %.3f max load secs\n", classType, statistics.loaded, statistics.hits, statistics.misses, statistics.failedLoads, statistics.duplicateLoads, statistics.totalLoadTime, statistics.maximumLoadTime));
+	}
+	ms_loaded->m_mutex.leave();
 
 	DEBUG_REPORT_LOG_PRINT(true, ("End log of loaded %s\n", classType));
 }
 
 //----------------------------------------------------------------------
 
+/**
+ * Get the hit, miss and load time counts for resources fetched by name.
+ */
+template<typename T>
+typename DataResourceList<T>::Statistics DataResourceList<T>::getStatistics()
+{
+	NOT_NULL(ms_loaded);
+
+	ms_loaded->m_mutex.enter();
+		Statistics const statistics = ms_loaded->m_statistics;
+	ms_loaded->m_mutex.leave();
+
+	return statistics;
+}
+
+//----------------------------------------------------------------------
+
 template<typename T>
 void DataResourceList<T>::garbageCollect ()
 {
-	typename LoadedDataResourceMap::iterator end = ms_loaded->end ();
-	typename LoadedDataResourceMap::iterator iter = ms_loaded->begin ();
-	for (; iter != end; ++iter)
-		const_cast<T*> (iter->second)->garbageCollect ();
+	// hold a reference on each resource so garbage collecting can release resources without the lock held
+	std::vector<const T *> dataResources;
+
+	ms_loaded->m_mutex.enter();
+		for (int i = 0; i < ms_loaded->getCapacity(); ++i)
+		{
+			const T * const dataResource = ms_loaded->getEntry(i);
+			if (dataResource)
+			{
+				dataResource->addReference();
+				dataResources.push_back(dataResource);
+			}
+		}
+	ms_loaded->m_mutex.leave();
+
+	for (typename std::vector<const T *>::iterator iter = dataResources.begin(); iter != dataResources.end(); ++iter)
+	{
+		const_cast<T*> (*iter)->garbageCollect ();
+		(*iter)->releaseReference ();
+	}
 }
 
 //----------------------------------------------------------------------
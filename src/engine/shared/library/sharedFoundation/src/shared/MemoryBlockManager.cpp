@@ -12,6 +12,7 @@
 #include "sharedDebug/DebugFlags.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/ConfigSharedFoundation.h"
+#include "sharedFoundation/Os.h"
 #include "sharedSynchronization/Mutex.h"
 
 #include <map>
@@ -30,6 +31,8 @@ public:
 	~Allocator();
 
 	int    getElementSize();
+	int    getElementsPerBlock() const;
+	int    getMaximumNumberOfBlocks() const;
 
 	void   fetch();
 	bool   release();
@@ -37,6 +40,8 @@ public:
 
 	bool   isFull() const;
 	int    getNumberOfAllocatedElements();
+	int    getPeakNumberOfAllocatedElements() const;
+	int    getNumberOfBlocks() const;
 	void  *allocate();
 	void   free(void *pointer);
 
@@ -94,15 +99,66 @@ private:
 	// number of outstanding allocations
 	int          m_numberOfAllocatedElements;
 
+	// largest number of outstanding allocations
+	int          m_peakNumberOfAllocatedElements;
+
 #ifdef _DEBUG
 	int          m_lifetimeAllocatedElements;
 #endif
 };
 
+// ======================================================================
+// A per-thread allocator for a MemoryBlockManager.  The owning thread
+// allocates from it, and any thread may free back to it, so it has its
+// own lock instead of using the global one.
+
+class MemoryBlockManager::Shard
+{
+public:
+
+	Shard(Os::ThreadId threadId, int elementSize, int elementsPerBlock, int minimumNumberOfBlocks, int maximumNumberOfBlocks);
+
+	Os::ThreadId  getThreadId() const;
+	bool          isOwnedBy(Os::ThreadId threadId) const;
+	bool          isOwned() const;
+	void          setOwner(Os::ThreadId threadId);
+	void          release();
+
+public:
+
+	Mutex         m_criticalSection;
+	Allocator     m_allocator;
+	int           m_crossThreadFrees;
+
+private:
+
+	Shard();
+	Shard(Shard const &);
+	Shard &operator =(Shard const &);
+
+private:
+
+	Os::ThreadId  m_threadId;
+	bool volatile m_owned;
+};
+
 // ======================================================================
 
 namespace MemoryBlockManagerNamespace
 {
+	// elements whose size is a multiple of this start on a boundary of it, so that SSE types can live in them
+	int const cms_elementAlignment = 16;
+
+	// per-thread elements are prefixed with the shard that owns them.  this is padded out so the
+	// element behind it keeps the alignment of the element it was carved from.
+	union ShardHeader
+	{
+		MemoryBlockManager::Shard * shard;
+		byte                        alignment[cms_elementAlignment];
+	};
+
+	int const cms_shardHeaderSize = sizeof(ShardHeader);
+
 	bool ms_debugDumpOnRemove = false;
 	bool ms_forceAllNonShared = false;
 #ifdef _DEBUG
@@ -117,6 +173,9 @@ namespace MemoryBlockManagerNamespace
 	typedef std::map<int, MemoryBlockManager::Allocator *> Allocators;
 	Allocators ms_allocators;
 
+	typedef std::vector<MemoryBlockManager*> PerThreadMemoryBlockManagers;
+	PerThreadMemoryBlockManagers ms_perThreadMemoryBlockManagers;
+
 	Mutex ms_globalCriticalSection;
 
 #ifdef _DEBUG
@@ -143,7 +202,8 @@ MemoryBlockManager::Allocator::Allocator(const int elementSize)
 	m_elementsPerBlock(64),
 	m_currentNumberOfBlocks(0),
 	m_maximumNumberOfBlocks(0),
-	m_numberOfAllocatedElements(0)
+	m_numberOfAllocatedElements(0),
+	m_peakNumberOfAllocatedElements(0)
 #ifdef _DEBUG
 	,
 	m_lifetimeAllocatedElements(0)
@@ -162,7 +222,8 @@ MemoryBlockManager::Allocator::Allocator(int elementSize, int elementsPerBlock,
 	m_elementsPerBlock(elementsPerBlock),
 	m_currentNumberOfBlocks(0),
 	m_maximumNumberOfBlocks(maximumNumberOfBlocks),
-	m_numberOfAllocatedElements(0)
+	m_numberOfAllocatedElements(0),
+	m_peakNumberOfAllocatedElements(0)
 #ifdef _DEBUG
 	,
 	m_lifetimeAllocatedElements(0)
@@ -220,6 +281,20 @@ inline int MemoryBlockManager::Allocator::getElementSize()
 
 // ----------------------------------------------------------------------
 
+inline int MemoryBlockManager::Allocator::getElementsPerBlock() const
+{
+	return m_elementsPerBlock;
+}
+
+// ----------------------------------------------------------------------
+
+inline int MemoryBlockManager::Allocator::getMaximumNumberOfBlocks() const
+{
+	return m_maximumNumberOfBlocks;
+}
+
+// ----------------------------------------------------------------------
+
 int MemoryBlockManager::Allocator::getReferenceCount()
 {
 	return m_referenceCount;
@@ -241,6 +316,20 @@ int MemoryBlockManager::Allocator::getNumberOfAllocatedElements()
 
 // ----------------------------------------------------------------------
 
+int MemoryBlockManager::Allocator::getPeakNumberOfAllocatedElements() const
+{
+	return m_peakNumberOfAllocatedElements;
+}
+
+// ----------------------------------------------------------------------
+
+int MemoryBlockManager::Allocator::getNumberOfBlocks() const
+{
+	return m_currentNumberOfBlocks;
+}
+
+// ----------------------------------------------------------------------
+
 void *MemoryBlockManager::Allocator::allocate()
 {
 	void *result = 0;
@@ -251,7 +340,8 @@ void *MemoryBlockManager::Allocator::allocate()
 
 	result = m_firstFreeElement;
 	m_firstFreeElement = m_firstFreeElement->next;
-	++m_numberOfAllocatedElements;
+	if (++m_numberOfAllocatedElements > m_peakNumberOfAllocatedElements)
+		m_peakNumberOfAllocatedElements = m_numberOfAllocatedElements;
 
 #ifdef _DEBUG
 	m_lifetimeAllocatedElements += 1;
@@ -294,9 +384,12 @@ void MemoryBlockManager::Allocator::placeOnFreeList(Element *element)
 
 void MemoryBlockManager::Allocator::allocateNewBlock()
 {
+	// elements that are a multiple of the alignment in size get enough slack to start the first one aligned
+	int const slack = (m_elementSize % cms_elementAlignment) == 0 ? cms_elementAlignment - 1 : 0;
+
 	// allocate a new block
 	Block *block = new Block;
-	block->data  = new byte[static_cast<size_t>(m_elementSize *	m_elementsPerBlock)];
+	block->data  = new byte[static_cast<size_t>(m_elementSize *	m_elementsPerBlock + slack)];
 
 	// put the block on the block list
 	block->next  = m_firstBlock;
@@ -305,9 +398,12 @@ void MemoryBlockManager::Allocator::allocateNewBlock()
 	// put all the new block elements on the free list
 	{
 		int   i;
-		byte *data;
+		byte *data = block->data;
 
-		for (i = m_elementsPerBlock, data = block->data; i; --i, data += m_elementSize)
+		if (slack)
+			data = reinterpret_cast<byte *>((reinterpret_cast<size_t>(data) + slack) & ~static_cast<size_t>(slack));
+
+		for (i = m_elementsPerBlock; i; --i, data += m_elementSize)
 			placeOnFreeList(reinterpret_cast<Element *>(data));  //lint !e826  // suspicious pointer conversion (area too small)
 	}
 
@@ -323,12 +419,64 @@ void MemoryBlockManager::Allocator::debugDump() const
 	const int currentUsageInKilobytes = m_numberOfAllocatedElements * m_elementSize / 1024;
 	const int totalUsageInKilobytes = (m_currentNumberOfBlocks * m_elementsPerBlock * m_elementSize) / 1024;
 	const int percent = totalUsageInKilobytes ? ((currentUsageInKilobytes * 100) / totalUsageInKilobytes) : 0;
-	DEBUG_REPORT_LOG(true, ("MBMA elementSize=%d elements=%d elementsPerBlock=%d blocks=%d mem=%dk full=%d%%\n", m_elementSize, m_numberOfAllocatedElements, m_elementsPerBlock, m_currentNumberOfBlocks, totalUsageInKilobytes, percent));
+	DEBUG_REPORT_LOG(true, ("MBMA elementSize=%d elements=%d peak=%d elementsPerBlock=%d blocks=%d mem=%dk full=%d%%\n", m_elementSize, m_numberOfAllocatedElements, m_peakNumberOfAllocatedElements, m_elementsPerBlock, m_currentNumberOfBlocks, totalUsageInKilobytes, percent));
 }
 #endif
 
 // ======================================================================
 
+MemoryBlockManager::Shard::Shard(Os::ThreadId threadId, int elementSize, int elementsPerBlock, int minimumNumberOfBlocks, int maximumNumberOfBlocks)
+:
+	m_criticalSection(),
+	m_allocator(elementSize, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks),
+	m_crossThreadFrees(0),
+	m_threadId(threadId),
+	m_owned(true)
+{
+}
+
+// ----------------------------------------------------------------------
+
+inline Os::ThreadId MemoryBlockManager::Shard::getThreadId() const
+{
+	return m_threadId;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Called without any lock.  The owned flag is checked first, and an owner
+ * is only set before the flag, so a thread can't match a stale id.
+ */
+
+inline bool MemoryBlockManager::Shard::isOwnedBy(Os::ThreadId threadId) const
+{
+	return m_owned && m_threadId == threadId;
+}
+
+// ----------------------------------------------------------------------
+
+inline bool MemoryBlockManager::Shard::isOwned() const
+{
+	return m_owned;
+}
+
+// ----------------------------------------------------------------------
+
+inline void MemoryBlockManager::Shard::setOwner(Os::ThreadId threadId)
+{
+	m_threadId = threadId;
+	m_owned = true;
+}
+
+// ----------------------------------------------------------------------
+
+inline void MemoryBlockManager::Shard::release()
+{
+	m_owned = false;
+}
+
+// ======================================================================
+
 void MemoryBlockManager::install(bool debugDumpOnRemove)
 {
 	ms_debugDumpOnRemove = debugDumpOnRemove;
@@ -355,6 +503,34 @@ void MemoryBlockManager::install(bool debugDumpOnRemove)
 	ExitChain::add(MemoryBlockManagerNamespace::remove, "MemoryBlockManager::remove");
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Give up the calling thread's shards so the next new thread can take them
+ * over.  Threads call this as they exit.
+ *
+ * Elements still allocated from a shard stay with it and are freed back to
+ * it as usual.
+ */
+
+void MemoryBlockManager::releaseThreadShards()
+{
+	Os::ThreadId const threadId = Os::getThreadId();
+
+	ms_globalCriticalSection.enter();
+
+		PerThreadMemoryBlockManagers::iterator const iEnd = ms_perThreadMemoryBlockManagers.end();
+		for (PerThreadMemoryBlockManagers::iterator i = ms_perThreadMemoryBlockManagers.begin(); i != iEnd; ++i)
+		{
+			MemoryBlockManager * const memoryBlockManager = *i;
+			int const numberOfShards = memoryBlockManager->m_numberOfShards;
+			for (int j = 0; j < numberOfShards; ++j)
+				if (memoryBlockManager->m_shards[j]->isOwnedBy(threadId))
+					memoryBlockManager->m_shards[j]->release();
+		}
+
+	ms_globalCriticalSection.leave();
+}
+
 // ----------------------------------------------------------------------
 
 void MemoryBlockManagerNamespace::remove()
@@ -422,14 +598,20 @@ void MemoryBlockManagerNamespace::debugDumpAll ()
 
 // ======================================================================
 
-MemoryBlockManager::MemoryBlockManager(char const * name, bool shared, int elementSize, int elementsPerBlock, int minimumNumberOfBlocks, int maximumNumberOfBlocks)
+MemoryBlockManager::MemoryBlockManager(char const * name, bool shared, int elementSize, int elementsPerBlock, int minimumNumberOfBlocks, int maximumNumberOfBlocks, bool perThread)
 : m_name(name),
 	m_shared(shared),
 	m_currentNumberOfElements(0),
-	m_allocator(NULL)
+	m_allocator(NULL),
+	m_perThread(perThread),
+	m_firstShardMinimumNumberOfBlocks(0),
+	m_numberOfShards(0)
 {
-	//-- Handle config option where we force all MemoryBlockManagers to be non-shared.
-	if (shared && ms_forceAllNonShared)
+	for (int i = 0; i < cms_maximumNumberOfShards; ++i)
+		m_shards[i] = NULL;
+
+	//-- Handle config option where we force all MemoryBlockManagers to be non-shared.  Per-thread managers are never shared.
+	if (shared && (ms_forceAllNonShared || perThread))
 	{
 		m_shared = false;
 		shared   = false;
@@ -444,6 +626,10 @@ MemoryBlockManager::MemoryBlockManager(char const * name, bool shared, int eleme
 	if (elementSize < isizeof(void*))
 		elementSize = isizeof(void*);
 
+	//-- Per-thread elements need room to remember which shard they came from, and are kept aligned
+	if (m_perThread)
+		elementSize = (elementSize + cms_shardHeaderSize + cms_elementAlignment - 1) & ~(cms_elementAlignment - 1);
+
 	if (m_shared)
 	{
 		DEBUG_FATAL(elementsPerBlock,      ("elementsPerBlock must be 0 if shared"));
@@ -469,6 +655,14 @@ MemoryBlockManager::MemoryBlockManager(char const * name, bool shared, int eleme
 		ms_globalCriticalSection.enter();
 
 			DEBUG_FATAL(elementsPerBlock == 0, ("elementsPerBlock may not be 0 if shared"));
+
+			//-- Per-thread managers preallocate for the first thread to use them (usually the main thread) instead of the fallback allocator
+			if (m_perThread)
+			{
+				m_firstShardMinimumNumberOfBlocks = minimumNumberOfBlocks;
+				minimumNumberOfBlocks = 0;
+			}
+
 			m_allocator = new Allocator(elementSize, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks);
 			m_allocator->fetch();
 
@@ -484,12 +678,33 @@ MemoryBlockManager::MemoryBlockManager(char const * name, bool shared, int eleme
 		ms_globalCriticalSection.leave();
 	}
 #endif
+
+	if (m_perThread)
+	{
+		ms_globalCriticalSection.enter();
+
+			ms_perThreadMemoryBlockManagers.push_back(this);
+
+		ms_globalCriticalSection.leave();
+	}
 }
 
 // ----------------------------------------------------------------------
 
 MemoryBlockManager::~MemoryBlockManager()
 {
+	//-- Unregister even when fataling so an exiting thread never walks a deleted manager
+	if (m_perThread)
+	{
+		ms_globalCriticalSection.enter();
+
+			PerThreadMemoryBlockManagers::iterator iter = std::find(ms_perThreadMemoryBlockManagers.begin(), ms_perThreadMemoryBlockManagers.end(), this);
+			if (iter != ms_perThreadMemoryBlockManagers.end())
+				ms_perThreadMemoryBlockManagers.erase(iter);
+
+		ms_globalCriticalSection.leave();
+	}
+
 	if (ExitChain::isFataling())
 		return;
 
@@ -503,13 +718,21 @@ MemoryBlockManager::~MemoryBlockManager()
 		}
 #endif
 
-		if (m_currentNumberOfElements)
+		int const currentNumberOfElements = getCurrentNumberOfElements();
+		if (currentNumberOfElements)
 		{
-			DEBUG_WARNING(!ConfigSharedFoundation::getDemoMode(), ("MemoryBlockManager::~ %d elements still allocated in %s", m_currentNumberOfElements, m_name));
+			DEBUG_WARNING(!ConfigSharedFoundation::getDemoMode(), ("MemoryBlockManager::~ %d elements still allocated in %s", currentNumberOfElements, m_name));
 			ms_globalCriticalSection.leave();
 			return;
 		}
 
+		for (int i = 0; i < m_numberOfShards; ++i)
+		{
+			delete m_shards[i];
+			m_shards[i] = NULL;
+		}
+		IGNORE_RETURN(m_numberOfShards = 0);
+
 		if (m_allocator->release())
 		{
 			if (m_shared)
@@ -534,9 +757,21 @@ MemoryBlockManager::~MemoryBlockManager()
 #ifdef _DEBUG
 void MemoryBlockManager::debugDump() const
 {
-	DEBUG_REPORT_LOG(true, ("MBM %s: size=%d elements=%d\n", m_name ? m_name : "<unnamed>", m_allocator->getElementSize(), m_currentNumberOfElements));
-	if (!m_shared)
-		m_allocator->debugDump();
+	ms_globalCriticalSection.enter();
+
+		DEBUG_REPORT_LOG(true, ("MBM %s: size=%d elements=%d%s\n", m_name ? m_name : "<unnamed>", getElementSize(), getCurrentNumberOfElements(), m_perThread ? " perThread" : ""));
+		if (!m_shared)
+			m_allocator->debugDump();
+
+		for (int i = 0; i < m_numberOfShards; ++i)
+		{
+			Shard * const shard = m_shards[i];
+			shard->m_criticalSection.enter();
+				DEBUG_REPORT_LOG(true, ("  shard %d: thread=%lu%s elements=%d peak=%d blocks=%d crossThreadFrees=%d\n", i, static_cast<unsigned long>(shard->getThreadId()), shard->isOwned() ? "" : " (released)", shard->m_allocator.getNumberOfAllocatedElements(), shard->m_allocator.getPeakNumberOfAllocatedElements(), shard->m_allocator.getNumberOfBlocks(), shard->m_crossThreadFrees));
+			shard->m_criticalSection.leave();
+		}
+
+	ms_globalCriticalSection.leave();
 }
 #endif
 
@@ -544,7 +779,88 @@ void MemoryBlockManager::debugDump() const
 
 int MemoryBlockManager::getElementSize() const
 {
-	return m_allocator->getElementSize();
+	return m_allocator->getElementSize() - (m_perThread ? cms_shardHeaderSize : 0);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Count the outstanding elements across the shared allocator and all shards.
+ *
+ * The global critical section must be held.
+ */
+
+int MemoryBlockManager::getCurrentNumberOfElements() const
+{
+	int result = m_currentNumberOfElements;
+
+	for (int i = 0; i < m_numberOfShards; ++i)
+	{
+		Shard * const shard = m_shards[i];
+		shard->m_criticalSection.enter();
+			result += shard->m_allocator.getNumberOfAllocatedElements();
+		shard->m_criticalSection.leave();
+	}
+
+	return result;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Find the calling thread's shard without creating one.
+ */
+
+MemoryBlockManager::Shard * MemoryBlockManager::findShard() const
+{
+	Os::ThreadId const threadId = Os::getThreadId();
+
+	// shards are only ever appended, and the count is published after the shard is set
+	int const numberOfShards = m_numberOfShards;
+	for (int i = 0; i < numberOfShards; ++i)
+		if (m_shards[i]->isOwnedBy(threadId))
+			return m_shards[i];
+
+	return NULL;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get the calling thread's shard, creating it if needed.
+ *
+ * Returns NULL if all the shards are in use, in which case the thread
+ * should use the shared allocator.
+ */
+
+MemoryBlockManager::Shard * MemoryBlockManager::getShard()
+{
+	Shard * shard = findShard();
+	if (shard)
+		return shard;
+
+	ms_globalCriticalSection.enter();
+
+		// no other thread can create this thread's shard, so there is no need to search again.
+		// take over a shard left by a thread that has exited before adding another.
+		int const numberOfShards = m_numberOfShards;
+		for (int i = 0; i < numberOfShards && !shard; ++i)
+			if (!m_shards[i]->isOwned())
+			{
+				shard = m_shards[i];
+				shard->setOwner(Os::getThreadId());
+			}
+
+		if (!shard && numberOfShards < cms_maximumNumberOfShards)
+		{
+			int const minimumNumberOfBlocks = (numberOfShards == 0) ? m_firstShardMinimumNumberOfBlocks : 0;
+			shard = new Shard(Os::getThreadId(), m_allocator->getElementSize(), m_allocator->getElementsPerBlock(), minimumNumberOfBlocks, m_allocator->getMaximumNumberOfBlocks());
+			m_shards[numberOfShards] = shard;
+
+			// the interlocked store makes the shard visible before the count that covers it
+			IGNORE_RETURN(m_numberOfShards = numberOfShards + 1);
+		}
+
+	ms_globalCriticalSection.leave();
+
+	return shard;
 }
 
 // ----------------------------------------------------------------------
@@ -558,7 +874,7 @@ int MemoryBlockManager::getElementCount() const
 	}
 #endif
 	ms_globalCriticalSection.enter();
-		int const result = m_currentNumberOfElements;
+		int const result = getCurrentNumberOfElements();
 	ms_globalCriticalSection.leave();
 	return result;
 }
@@ -573,6 +889,18 @@ bool MemoryBlockManager::isFull() const
 		return false;
 	}
 #endif
+	if (m_perThread)
+	{
+		Shard * const shard = findShard();
+		if (shard)
+		{
+			shard->m_criticalSection.enter();
+				const bool result = shard->m_allocator.isFull();
+			shard->m_criticalSection.leave();
+			return result;
+		}
+	}
+
 	ms_globalCriticalSection.enter();
 		const bool result = m_allocator->isFull();
 	ms_globalCriticalSection.leave();
@@ -591,19 +919,48 @@ void *MemoryBlockManager::allocate(bool returnNullOnFailure)
 		return operator new(getElementSize());
 	}
 #endif
-	ms_globalCriticalSection.enter();
 
-		if (m_allocator->isFull())
-		{
-			ms_globalCriticalSection.leave();
-			DEBUG_FATAL(!returnNullOnFailure, ("MBM %s is full %d", m_name, m_currentNumberOfElements));
-			return NULL;
-		}
+	Shard * const shard = m_perThread ? getShard() : NULL;
+	void * result = NULL;
 
-		++m_currentNumberOfElements;
-		void * result = m_allocator->allocate();
+	if (shard)
+	{
+		shard->m_criticalSection.enter();
 
-	ms_globalCriticalSection.leave();
+			if (shard->m_allocator.isFull())
+			{
+				shard->m_criticalSection.leave();
+				DEBUG_FATAL(!returnNullOnFailure, ("MBM %s is full %d on this thread", m_name, shard->m_allocator.getNumberOfAllocatedElements()));
+				return NULL;
+			}
+
+			result = shard->m_allocator.allocate();
+
+		shard->m_criticalSection.leave();
+	}
+	else
+	{
+		ms_globalCriticalSection.enter();
+
+			if (m_allocator->isFull())
+			{
+				ms_globalCriticalSection.leave();
+				DEBUG_FATAL(!returnNullOnFailure, ("MBM %s is full %d", m_name, m_currentNumberOfElements));
+				return NULL;
+			}
+
+			++m_currentNumberOfElements;
+			result = m_allocator->allocate();
+
+		ms_globalCriticalSection.leave();
+	}
+
+	if (m_perThread)
+	{
+		reinterpret_cast<ShardHeader *>(result)->shard = shard;
+		result = reinterpret_cast<byte *>(result) + cms_shardHeaderSize;
+		DEBUG_FATAL(reinterpret_cast<size_t>(result) % cms_elementAlignment, ("MBM %s per-thread element %p is not aligned", m_name, result));
+	}
 
 	return result;
 
@@ -622,6 +979,28 @@ void MemoryBlockManager::free(void *pointer)
 			return;
 		}
 #endif
+
+	if (m_perThread)
+	{
+		pointer = reinterpret_cast<byte *>(pointer) - cms_shardHeaderSize;
+
+		Shard * const shard = reinterpret_cast<ShardHeader *>(pointer)->shard;
+		if (shard)
+		{
+			bool const crossThread = (shard->getThreadId() != Os::getThreadId());
+
+			shard->m_criticalSection.enter();
+
+				if (crossThread)
+					++shard->m_crossThreadFrees;
+				shard->m_allocator.free(pointer);
+
+			shard->m_criticalSection.leave();
+
+			return;
+		}
+	}
+
 	ms_globalCriticalSection.enter();
 
 		if (--m_currentNumberOfElements < 0)
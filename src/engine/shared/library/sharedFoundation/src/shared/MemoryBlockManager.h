@@ -12,18 +12,24 @@
 
 // ======================================================================
 
+#include "sharedSynchronization/InterlockedInteger.h"
+
+// ======================================================================
+
 class MemoryBlockManager
 {
 public:
 
 	static void  install(bool debugDumpOnRemove);
+	static void  releaseThreadShards();
 
 public:
 
-	DLLEXPORT  MemoryBlockManager(char const * name, bool shared, int elementSize, int elementsPerBlock, int minimumNumberOfBlocks, int maximumNumberOfBlocks);
+	DLLEXPORT  MemoryBlockManager(char const * name, bool shared, int elementSize, int elementsPerBlock, int minimumNumberOfBlocks, int maximumNumberOfBlocks, bool perThread = false);
 	DLLEXPORT ~MemoryBlockManager();
 
 	const char *     getName() const;
+	bool             isPerThread() const;
 
 	bool             isFull() const;
 	DLLEXPORT int    getElementSize() const;
@@ -48,6 +54,15 @@ protected:
 public:
 
 	class Allocator;
+	class Shard;
+
+private:
+
+	enum { cms_maximumNumberOfShards = 16 };
+
+	Shard *          findShard() const;
+	Shard *          getShard();
+	int              getCurrentNumberOfElements() const;
 
 private:
 
@@ -55,6 +70,13 @@ private:
 	bool         m_shared;
 	int          m_currentNumberOfElements;
 	Allocator *  m_allocator;
+
+	// per-thread allocators, only used if m_perThread is set.  threads beyond the maximum use m_allocator.
+	// shards are only ever appended, and a shard whose thread has exited is taken over by the next new thread.
+	bool               m_perThread;
+	int                m_firstShardMinimumNumberOfBlocks;
+	InterlockedInteger m_numberOfShards;
+	Shard *            m_shards[cms_maximumNumberOfShards];
 };
 
 // ======================================================================
@@ -64,6 +86,13 @@ inline char const * MemoryBlockManager::getName() const
 	return m_name;
 }
 
+// ----------------------------------------------------------------------
+
+inline bool MemoryBlockManager::isPerThread() const
+{
+	return m_perThread;
+}
+
 // ======================================================================
 
 #endif
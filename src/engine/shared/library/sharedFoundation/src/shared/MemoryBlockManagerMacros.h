@@ -28,9 +28,16 @@ class MemoryBlockManager;
 // ----------------------------------------------------------------------
 
 #define MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITH_INSTALL(className, shared, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks) \
+	MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITH_INSTALL_MODE(className, shared, false, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks)
+
+// Each thread that allocates gets its own pool, so objects created by background threads don't contend with the main thread.
+#define MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITH_INSTALL_PER_THREAD(className, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks) \
+	MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITH_INSTALL_MODE(className, false, true, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks)
+
+#define MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITH_INSTALL_MODE(className, shared, perThread, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks) \
 	void className::install() \
 	{ \
-		ms_memoryBlockManager = new MemoryBlockManager( #className " memoryBlockManager", shared, sizeof(className), elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks); \
+		ms_memoryBlockManager = new MemoryBlockManager( #className " memoryBlockManager", shared, sizeof(className), elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks, perThread); \
 		ExitChain::add(&remove, #className "::remove"); \
 	} \
 	void className::remove() \
@@ -73,9 +80,15 @@ class MemoryBlockManager;
 // ----------------------------------------------------------------------
 
 #define MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL(className, shared, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks) \
+	MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL_MODE(className, shared, false, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks)
+
+#define MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL_PER_THREAD(className, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks) \
+	MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL_MODE(className, false, true, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks)
+
+#define MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL_MODE(className, shared, perThread, elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks) \
 	void className::installMemoryBlockManager() \
 	{ \
-		ms_memoryBlockManager = new MemoryBlockManager( #className " memoryBlockManager", shared, sizeof(className), elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks); \
+		ms_memoryBlockManager = new MemoryBlockManager( #className " memoryBlockManager", shared, sizeof(className), elementsPerBlock, minimumNumberOfBlocks, maximumNumberOfBlocks, perThread); \
 	} \
 	void className::removeMemoryBlockManager() \
 	{ \
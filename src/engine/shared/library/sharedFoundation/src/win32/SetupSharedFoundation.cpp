@@ -19,6 +19,7 @@
 #include "sharedFoundation/ConfigFile.h"
 #include "sharedFoundation/ConfigSharedFoundation.h"
 #include "sharedFoundation/CrashReportInformation.h"
+#include "sharedFoundation/Crc.h"
 #include "sharedFoundation/CrcLowerString.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/Os.h"
@@ -308,6 +309,7 @@ void SetupSharedFoundation::install(const Data &data)
 	CrashReportInformation::install();
 	RegistryKey::install(data.productRegistryKey);
 
+	Crc::install();
 	PersistentCrcString::install();
 	CrcLowerString::install();
 
@@ -0,0 +1 @@
+#include "../../src/shared/BinaryLogObserver.h"
@@ -0,0 +1,287 @@
+// ======================================================================
+//
+// BinaryLogObserver.cpp
+//
+// Copyright 2002 Sony Online Entertainment
+//
+// ======================================================================
+
+#include "sharedLog/FirstSharedLog.h"
+#include "sharedFoundation/Clock.h"
+#include "sharedFoundation/NetworkIdArchive.h"
+#include "sharedLog/BinaryLogObserver.h"
+#include "sharedLog/DeferredLogFormat.h"
+#include "sharedLog/LogManager.h"
+#include "fileInterface/StdioFile.h"
+#include "sharedNetworkMessages/LogMessage.h"
+#include <cstdio>
+#include <cstring>
+
+// ======================================================================
+
+namespace BinaryLogObserverNamespace
+{
+	int const cs_fileSizeNext = 2000000000; // point at which we roll over to another log file
+	int const cs_bufferSize   = 256 * 1024;
+
+	// update() leaves records in the buffer until this much has built up or this long has passed
+	int const           cs_updateWriteSize     = 64 * 1024;
+	unsigned long const cs_updateFlushPeriodMs = 1000;
+}
+
+using namespace BinaryLogObserverNamespace;
+
+// ======================================================================
+
+void BinaryLogObserver::install()
+{
+	LogManager::registerObserverType("binary", create);
+}
+
+// ----------------------------------------------------------------------
+
+LogObserver *BinaryLogObserver::create(std::string const &spec)
+{
+	return new BinaryLogObserver(spec);
+}
+
+// ----------------------------------------------------------------------
+
+BinaryLogObserver::BinaryLogObserver(std::string const &filename) :
+	LogObserver(),
+	m_filename(filename),
+	m_file(0),
+	m_fileIndex(0),
+	m_fileSize(0),
+	m_buffer(cs_bufferSize),
+	m_bufferUsed(0),
+	m_lastFlushTime(Clock::timeMs()),
+	m_packedText(),
+	m_formatIds(),
+	m_stringIds(),
+	m_strings(),
+	m_lastProcId(),
+	m_lastProcIdId(0),
+	m_lastChannel(),
+	m_lastChannelId(0)
+{
+	prepareFile();
+}
+
+// ----------------------------------------------------------------------
+
+BinaryLogObserver::~BinaryLogObserver()
+{
+	writeBuffer();
+	delete m_file;
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogObserver::prepareFile()
+{
+	if (m_file && m_fileSize + m_bufferUsed < cs_fileSizeNext)
+		return;
+
+	writeBuffer();
+
+	while (!m_file || m_fileSize >= cs_fileSizeNext)
+	{
+		if (m_file)
+		{
+			++m_fileIndex;
+			delete m_file;
+			m_file = 0;
+		}
+		if (m_fileIndex == 0)
+			m_file = new StdioFile(m_filename.c_str(), "ab");
+		else
+		{
+			char buf[512];
+			IGNORE_RETURN( snprintf(buf, 512, "%s-%d", m_filename.c_str(), m_fileIndex+1) );
+			m_file = new StdioFile(buf, "ab");
+		}
+		NOT_NULL(m_file);
+		FATAL(!m_file->isOpen(), ("Could not open %s", m_filename.c_str()));
+		m_fileSize = m_file->length();
+	}
+
+	// every file, or append to one, starts a new set of string ids
+	m_formatIds.clear();
+	m_stringIds.clear();
+	m_strings.clear();
+	m_strings.push_back(std::string()); // ids start at 1
+	m_lastProcIdId = 0;
+	m_lastChannelId = 0;
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, getMagic(), sizeof(header.magic));
+	header.version = cms_version;
+	memcpy(reserve(RT_fileHeader, sizeof(header)), &header, sizeof(header));
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogObserver::writeBuffer()
+{
+	if (m_file && m_bufferUsed)
+	{
+		IGNORE_RETURN( m_file->write(m_bufferUsed, &m_buffer[0]) );
+		m_fileSize += m_bufferUsed;
+		m_bufferUsed = 0;
+	}
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Add a record header to the buffer and return where its payload goes.
+ */
+
+char *BinaryLogObserver::reserve(uint32 type, int length)
+{
+	int const recordLength = static_cast<int>(sizeof(RecordHeader)) + length;
+	if (m_bufferUsed + recordLength > static_cast<int>(m_buffer.size()))
+	{
+		writeBuffer();
+		if (recordLength > static_cast<int>(m_buffer.size()))
+			m_buffer.resize(static_cast<size_t>(recordLength));
+	}
+
+	RecordHeader header;
+	header.type = type;
+	header.length = static_cast<uint32>(length);
+
+	char * const record = &m_buffer[static_cast<size_t>(m_bufferUsed)];
+	memcpy(record, &header, sizeof(header));
+	m_bufferUsed += recordLength;
+	return record + sizeof(header);
+}
+
+// ----------------------------------------------------------------------
+
+uint32 BinaryLogObserver::getFormatId(char const *format)
+{
+	FormatIdMap::const_iterator const i = m_formatIds.find(format);
+	if (i != m_formatIds.end() && m_strings[i->second] == format)
+		return i->second;
+
+	uint32 const id = getStringId(std::string(format));
+	m_formatIds[format] = id;
+	return id;
+}
+
+// ----------------------------------------------------------------------
+
+uint32 BinaryLogObserver::getStringId(std::string const &value)
+{
+	StringIdMap::const_iterator const i = m_stringIds.find(value);
+	if (i != m_stringIds.end())
+		return i->second;
+
+	uint32 const id = static_cast<uint32>(m_strings.size());
+	m_strings.push_back(value);
+	m_stringIds[value] = id;
+
+	char * const payload = reserve(RT_string, static_cast<int>(sizeof(id) + value.length()));
+	memcpy(payload, &id, sizeof(id));
+	memcpy(payload + sizeof(id), value.data(), value.length());
+	return id;
+}
+
+// ----------------------------------------------------------------------
+
+uint32 BinaryLogObserver::getStringId(std::string const &value, std::string &lastValue, uint32 &lastId)
+{
+	// process ids and channels rarely change from one message to the next
+	if (lastId == 0 || value != lastValue)
+	{
+		lastId = getStringId(value);
+		lastValue = value;
+	}
+	return lastId;
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogObserver::writeMessage(DeferredLogMessage const &msg)
+{
+	prepareFile();
+
+	MessageRecord record;
+	record.timestamp = msg.timestamp;
+	record.procIdId = getStringId(*msg.procId, m_lastProcId, m_lastProcIdId);
+	record.channelId = getStringId(*msg.channel, m_lastChannel, m_lastChannelId);
+	record.formatId = getFormatId(msg.format);
+	record.packedArgumentsLength = static_cast<uint32>(msg.packedArgumentsLength);
+	record.unicodeAttachLength = static_cast<uint32>(msg.unicodeAttach->length());
+	record.reserved = 0;
+
+	int const unicodeAttachBytes = static_cast<int>(record.unicodeAttachLength * sizeof(Unicode::unicode_char_t));
+
+	char * const payload = reserve(RT_message, static_cast<int>(sizeof(record)) + msg.packedArgumentsLength + unicodeAttachBytes);
+	memcpy(payload, &record, sizeof(record));
+	if (msg.packedArgumentsLength)
+		memcpy(payload + sizeof(record), msg.packedArguments, static_cast<size_t>(msg.packedArgumentsLength));
+	if (unicodeAttachBytes)
+		memcpy(payload + sizeof(record) + msg.packedArgumentsLength, msg.unicodeAttach->data(), static_cast<size_t>(unicodeAttachBytes));
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogObserver::log(LogMessage const &msg)
+{
+	// already formatted elsewhere, so store the text as the argument to "%s"
+	m_packedText.clear();
+	DeferredLogFormat::packString(msg.getText().c_str(), m_packedText);
+
+	DeferredLogMessage deferred;
+	deferred.timestamp = msg.getTimestamp();
+	deferred.procId = &msg.getProcId();
+	deferred.channel = &msg.getChannel();
+	deferred.format = "%s";
+	deferred.packedArguments = &m_packedText[0];
+	deferred.packedArgumentsLength = static_cast<int>(m_packedText.size());
+	deferred.unicodeAttach = &msg.getUnicodeAttach();
+	writeMessage(deferred);
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogObserver::logDeferred(DeferredLogMessage const &msg)
+{
+	if (!isFiltered(*msg.procId, *msg.channel, msg.format))
+		writeMessage(msg);
+}
+
+// ----------------------------------------------------------------------
+
+bool BinaryLogObserver::supportsDeferredFormatting() const
+{
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+void BinaryLogObserver::flush()
+{
+	writeBuffer();
+	if (m_file)
+		m_file->flush();
+	m_lastFlushTime = Clock::timeMs();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Writing and flushing the file every frame would undo the buffering, so
+ * only do it once enough has built up or the last flush is getting stale.
+ * Fatals and removing the observer write everything out regardless.
+ */
+
+void BinaryLogObserver::update()
+{
+	if (m_bufferUsed >= cs_updateWriteSize || Clock::timeMs() - m_lastFlushTime >= cs_updateFlushPeriodMs)
+		flush();
+}
+
+// ======================================================================
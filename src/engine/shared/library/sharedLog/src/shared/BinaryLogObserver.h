@@ -0,0 +1,147 @@
+// ======================================================================
+//
+// BinaryLogObserver.h
+//
+// Copyright 2002 Sony Online Entertainment
+//
+// ======================================================================
+
+#ifndef INCLUDED_BinaryLogObserver_H
+#define INCLUDED_BinaryLogObserver_H
+
+// ======================================================================
+
+#include "sharedLog/LogObserver.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// ======================================================================
+
+class AbstractFile;
+
+// ======================================================================
+
+// A BinaryLogObserver saves log messages to a file without formatting
+// them.  Each message is written as ids for its process identifier,
+// channel and format string, followed by the packed arguments, and the
+// BinaryLogDecoder tool turns the file back into text.
+//
+// The file is a sequence of records, each a RecordHeader followed by
+// its payload, in the byte order of the process that wrote it:
+//
+//   RT_fileHeader  FileHeader.  Starts every file and every append to
+//                  one; string ids only hold until the next file header.
+//   RT_string      uint32 id, then the characters.  Written before the
+//                  first message that uses the id.
+//   RT_message     MessageRecord, then the packed arguments (see
+//                  DeferredLogFormat), then the unicode attachment.
+//
+// Records are built in memory and written out when the buffer fills,
+// on flush(), and on update() once enough has built up or a second has
+// passed since the last flush.
+
+class BinaryLogObserver: public LogObserver
+{
+public:
+
+	enum RecordType
+	{
+		RT_fileHeader = 1,
+		RT_string     = 2,
+		RT_message    = 3
+	};
+
+	enum
+	{
+		cms_version = 1
+	};
+
+	struct RecordHeader
+	{
+		uint32 type;
+		uint32 length; // of the payload that follows
+	};
+
+	struct FileHeader
+	{
+		char   magic[8];
+		uint32 version;
+		uint32 reserved;
+	};
+
+	struct MessageRecord
+	{
+		uint64 timestamp;
+		uint32 procIdId;
+		uint32 channelId;
+		uint32 formatId;
+		uint32 packedArgumentsLength;
+		uint32 unicodeAttachLength; // in characters
+		uint32 reserved;
+	};
+
+	static char const *getMagic();
+
+public:
+
+	static void install();
+	static LogObserver *create(std::string const &spec);
+
+	BinaryLogObserver(std::string const &filename);
+	virtual ~BinaryLogObserver();
+
+	virtual void log(LogMessage const &msg);
+	virtual void logDeferred(DeferredLogMessage const &msg);
+	virtual bool supportsDeferredFormatting() const;
+	virtual void flush();
+	virtual void update();
+
+private:
+	BinaryLogObserver(BinaryLogObserver const &);
+	BinaryLogObserver &operator=(BinaryLogObserver const &);
+
+	typedef std::map<char const *, uint32> FormatIdMap;
+	typedef std::map<std::string, uint32> StringIdMap;
+	typedef std::vector<std::string> StringList;
+
+	void prepareFile();
+	void writeMessage(DeferredLogMessage const &msg);
+	void writeBuffer();
+	char *reserve(uint32 type, int length);
+	uint32 getFormatId(char const *format);
+	uint32 getStringId(std::string const &value);
+	uint32 getStringId(std::string const &value, std::string &lastValue, uint32 &lastId);
+
+private:
+	std::string m_filename;
+	AbstractFile *m_file;
+	int m_fileIndex;
+	int m_fileSize;
+
+	std::vector<char> m_buffer;
+	int m_bufferUsed;
+	unsigned long m_lastFlushTime;
+	std::vector<char> m_packedText; // for messages that arrive already formatted
+
+	// string ids for the current file.  Formats are usually literals, so they're
+	// looked up by address first and checked against the string with that id.
+	FormatIdMap m_formatIds;
+	StringIdMap m_stringIds;
+	StringList m_strings;
+	std::string m_lastProcId;
+	uint32 m_lastProcIdId;
+	std::string m_lastChannel;
+	uint32 m_lastChannelId;
+};
+
+// ======================================================================
+
+inline char const *BinaryLogObserver::getMagic()
+{
+	return "SWGBLOG";
+}
+
+// ======================================================================
+
+#endif
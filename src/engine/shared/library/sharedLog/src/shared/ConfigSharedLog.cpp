@@ -24,6 +24,9 @@ namespace ConfigSharedLogNamespace
 	bool ms_logReportWarnings;
 	bool ms_logReportFatals;
 	bool ms_logStderr;
+	bool ms_logAsynchronous;
+	int ms_logAsynchronousBufferSize;
+	int ms_logBenchmarkMessages;
 	StringPtrArray ms_logTargets; // ConfigFile owns the pointer
 }
 using namespace ConfigSharedLogNamespace;
@@ -41,6 +44,9 @@ void ConfigSharedLog::install()
 	KEY_BOOL(logReportWarnings, true);
 	KEY_BOOL(logReportFatals,   true);
 	KEY_BOOL(logStderr,         false);
+	KEY_BOOL(logAsynchronous,   false);
+	KEY_INT (logAsynchronousBufferSize, 1024); // in KB
+	KEY_INT (logBenchmarkMessages, 100000);
 
 	int index = 0;
 	char const * result = 0;
@@ -97,6 +103,27 @@ bool ConfigSharedLog::getLogStderr()
 
 // ----------------------------------------------------------------------
 
+bool ConfigSharedLog::getLogAsynchronous()
+{
+	return ms_logAsynchronous;
+}
+
+// ----------------------------------------------------------------------
+
+int ConfigSharedLog::getLogAsynchronousBufferSize()
+{
+	return ms_logAsynchronousBufferSize;
+}
+
+// ----------------------------------------------------------------------
+
+int ConfigSharedLog::getLogBenchmarkMessages()
+{
+	return ms_logBenchmarkMessages;
+}
+
+// ----------------------------------------------------------------------
+
 int ConfigSharedLog::getNumberOfLogTargets()
 {
 	return static_cast<int>(ms_logTargets.size());
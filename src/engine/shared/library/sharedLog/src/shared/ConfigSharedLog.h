@@ -22,6 +22,9 @@ public:
 	static bool getLogReportWarnings();
 	static bool getLogReportFatals();
 	static bool getLogStderr();
+	static bool getLogAsynchronous();
+	static int getLogAsynchronousBufferSize();
+	static int getLogBenchmarkMessages();
 	static int getNumberOfLogTargets();
 	static char const * getLogTarget(int index);
 };
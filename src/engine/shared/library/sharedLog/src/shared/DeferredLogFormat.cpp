@@ -0,0 +1,405 @@
+// ======================================================================
+//
+// DeferredLogFormat.cpp
+//
+// Copyright 2002 Sony Online Entertainment
+//
+// ======================================================================
+
+#include "sharedLog/FirstSharedLog.h"
+#include "sharedLog/DeferredLogFormat.h"
+
+#include <cstdio>
+#include <cstring>
+
+// ======================================================================
+
+namespace DeferredLogFormatNamespace
+{
+	enum LengthModifier
+	{
+		LM_none,
+		LM_short,
+		LM_long,
+		LM_longLong,
+		LM_longDouble,
+		LM_size
+	};
+
+	struct Conversion
+	{
+		char const *   specBegin; // flags, width and precision, between the '%' and any length modifier
+		char const *   specEnd;
+		int            starCount;
+		LengthModifier length;
+		char           conversion;
+	};
+
+	char const *parseConversion(char const *format, Conversion &conversion);
+
+	void packValue(char type, void const *value, int size, std::vector<char> &packedArguments);
+	bool readValue(char type, char const *&packedArguments, char const *end, void *value, int size);
+	bool readString(char const *&packedArguments, char const *end, char const *&text, uint32 &length);
+}
+
+using namespace DeferredLogFormatNamespace;
+
+// ======================================================================
+/**
+ * Parse a conversion specification.
+ *
+ * @param format  the character after the '%'
+ * @return the character after the conversion, or 0 if the conversion is
+ * malformed or one that can't be deferred
+ */
+
+char const *DeferredLogFormatNamespace::parseConversion(char const *format, Conversion &conversion)
+{
+	conversion.specBegin = format;
+	conversion.starCount = 0;
+
+	char const *p = format;
+	while (*p && strchr("-+ #0", *p))
+		++p;
+	for (int part = 0; part < 2; ++part)
+	{
+		if (*p == '*')
+		{
+			++conversion.starCount;
+			++p;
+		}
+		else
+			while (*p >= '0' && *p <= '9')
+				++p;
+
+		if (part == 0 && *p == '.')
+			++p;
+		else
+			break;
+	}
+	conversion.specEnd = p;
+
+	conversion.length = LM_none;
+	if (*p == 'h')
+	{
+		conversion.length = LM_short;
+		p += (p[1] == 'h') ? 2 : 1;
+	}
+	else if (*p == 'l')
+	{
+		conversion.length = (p[1] == 'l') ? LM_longLong : LM_long;
+		p += (p[1] == 'l') ? 2 : 1;
+	}
+	else if (*p == 'q')
+	{
+		conversion.length = LM_longLong;
+		++p;
+	}
+	else if (*p == 'L')
+	{
+		conversion.length = LM_longDouble;
+		++p;
+	}
+	else if (*p == 'z')
+	{
+		conversion.length = LM_size;
+		++p;
+	}
+	else if (*p == 'I')
+	{
+		// msvc I, I32 and I64
+		if (p[1] == '6' && p[2] == '4')
+		{
+			conversion.length = LM_longLong;
+			p += 3;
+		}
+		else if (p[1] == '3' && p[2] == '2')
+			p += 3;
+		else
+		{
+			conversion.length = LM_size;
+			++p;
+		}
+	}
+
+	conversion.conversion = *p;
+	if (!*p || !strchr("diouxXceEfFgGaAsp", *p))
+		return 0;
+
+	// wide characters and strings are left to the formatted path
+	if ((*p == 's' || *p == 'c') && conversion.length == LM_long)
+		return 0;
+
+	return p + 1;
+}
+
+// ----------------------------------------------------------------------
+
+void DeferredLogFormatNamespace::packValue(char type, void const *value, int size, std::vector<char> &packedArguments)
+{
+	size_t const offset = packedArguments.size();
+	packedArguments.resize(offset + 1 + size);
+	packedArguments[offset] = type;
+	memcpy(&packedArguments[offset + 1], value, static_cast<size_t>(size));
+}
+
+// ----------------------------------------------------------------------
+
+bool DeferredLogFormatNamespace::readValue(char type, char const *&packedArguments, char const *end, void *value, int size)
+{
+	if (end - packedArguments < 1 + size || *packedArguments != type)
+		return false;
+
+	memcpy(value, packedArguments + 1, static_cast<size_t>(size));
+	packedArguments += 1 + size;
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+bool DeferredLogFormatNamespace::readString(char const *&packedArguments, char const *end, char const *&text, uint32 &length)
+{
+	if (!readValue(DeferredLogFormat::AT_string, packedArguments, end, &length, sizeof(length)))
+		return false;
+	if (static_cast<uint32>(end - packedArguments) < length)
+		return false;
+
+	text = packedArguments;
+	packedArguments += length;
+	return true;
+}
+
+// ======================================================================
+/**
+ * Pack the arguments a printf-style format would consume.
+ *
+ * @return false if the format uses a conversion that can't be deferred
+ * (%n, wide strings), in which case the caller should format the text
+ * and pack it with packString() under a "%s" format instead.
+ */
+
+bool DeferredLogFormat::pack(char const *format, va_list args, std::vector<char> &packedArguments)
+{
+	packedArguments.clear();
+
+	for (char const *p = format; *p; )
+	{
+		if (*p != '%')
+		{
+			++p;
+			continue;
+		}
+		if (p[1] == '%')
+		{
+			p += 2;
+			continue;
+		}
+
+		Conversion conversion;
+		char const * const next = parseConversion(p + 1, conversion);
+		if (!next)
+			return false;
+
+		for (int i = 0; i < conversion.starCount; ++i)
+		{
+			int32 const value = va_arg(args, int);
+			packValue(AT_int32, &value, sizeof(value), packedArguments);
+		}
+
+		switch (conversion.conversion)
+		{
+		case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+			{
+				// only the bits matter, the conversion says how to read them back
+				if (conversion.length == LM_longLong || (conversion.length == LM_long && sizeof(long) == sizeof(int64)) || (conversion.length == LM_size && sizeof(size_t) == sizeof(int64)))
+				{
+					int64 const value = va_arg(args, int64);
+					packValue(AT_int64, &value, sizeof(value), packedArguments);
+				}
+				else
+				{
+					int32 const value = va_arg(args, int);
+					packValue(AT_int32, &value, sizeof(value), packedArguments);
+				}
+			}
+			break;
+
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			{
+				double const value = (conversion.length == LM_longDouble) ? static_cast<double>(va_arg(args, long double)) : va_arg(args, double);
+				packValue(AT_double, &value, sizeof(value), packedArguments);
+			}
+			break;
+
+		case 's':
+			{
+				char const * const value = va_arg(args, char const *);
+				packString(value ? value : "(null)", packedArguments);
+			}
+			break;
+
+		case 'p':
+			{
+				uint64 const value = static_cast<uint64>(reinterpret_cast<size_t>(va_arg(args, void *)));
+				packValue(AT_pointer, &value, sizeof(value), packedArguments);
+			}
+			break;
+
+		default:
+			return false;
+		}
+
+		p = next;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+void DeferredLogFormat::packString(char const *text, std::vector<char> &packedArguments)
+{
+	uint32 const length = static_cast<uint32>(strlen(text));
+	packValue(AT_string, &length, sizeof(length), packedArguments);
+	if (length)
+		packedArguments.insert(packedArguments.end(), text, text + length);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Produce the text for a format and the arguments pack() captured for it.
+ *
+ * @return false if the arguments don't match the format; result holds
+ * whatever could be formatted before the mismatch.
+ */
+
+bool DeferredLogFormat::format(char const *format, char const *packedArguments, int packedArgumentsLength, std::string &result)
+{
+	result.clear();
+
+	char const *arguments = packedArguments;
+	char const * const end = packedArguments + packedArgumentsLength;
+
+	std::string spec;
+	std::string stringArgument;
+	char buffer[1024];
+
+	for (char const *p = format; *p; )
+	{
+		if (*p != '%')
+		{
+			char const *literalEnd = strchr(p, '%');
+			if (!literalEnd)
+				literalEnd = p + strlen(p);
+			IGNORE_RETURN(result.append(p, literalEnd));
+			p = literalEnd;
+			continue;
+		}
+		if (p[1] == '%')
+		{
+			result += '%';
+			p += 2;
+			continue;
+		}
+
+		Conversion conversion;
+		char const * const next = parseConversion(p + 1, conversion);
+		if (!next)
+			return false;
+
+		// rebuild the specification with any '*' replaced by its packed value
+		spec = "%";
+		for (char const *s = conversion.specBegin; s != conversion.specEnd; ++s)
+		{
+			if (*s == '*')
+			{
+				int32 value = 0;
+				if (!readValue(AT_int32, arguments, end, &value, sizeof(value)))
+					return false;
+				IGNORE_RETURN(snprintf(buffer, sizeof(buffer), "%d", value));
+				spec += buffer;
+			}
+			else
+				spec += *s;
+		}
+
+		if (arguments == end)
+			return false;
+
+		switch (*arguments)
+		{
+		case AT_int32:
+			{
+				int32 value = 0;
+				if (!strchr("diouxXc", conversion.conversion) || !readValue(AT_int32, arguments, end, &value, sizeof(value)))
+					return false;
+				spec += conversion.conversion;
+				IGNORE_RETURN(snprintf(buffer, sizeof(buffer), spec.c_str(), value));
+				result += buffer;
+			}
+			break;
+
+		case AT_int64:
+			{
+				int64 value = 0;
+				if (!strchr("diouxX", conversion.conversion) || !readValue(AT_int64, arguments, end, &value, sizeof(value)))
+					return false;
+				spec += "ll";
+				spec += conversion.conversion;
+				IGNORE_RETURN(snprintf(buffer, sizeof(buffer), spec.c_str(), value));
+				result += buffer;
+			}
+			break;
+
+		case AT_double:
+			{
+				double value = 0.0;
+				if (!strchr("eEfFgGaA", conversion.conversion) || !readValue(AT_double, arguments, end, &value, sizeof(value)))
+					return false;
+				spec += conversion.conversion;
+				IGNORE_RETURN(snprintf(buffer, sizeof(buffer), spec.c_str(), value));
+				result += buffer;
+			}
+			break;
+
+		case AT_string:
+			{
+				char const *text = 0;
+				uint32 length = 0;
+				if (conversion.conversion != 's' || !readString(arguments, end, text, length))
+					return false;
+
+				// the common plain %s doesn't need to go through snprintf
+				if (spec.length() == 1)
+					IGNORE_RETURN(result.append(text, length));
+				else
+				{
+					stringArgument.assign(text, length);
+					spec += 's';
+					IGNORE_RETURN(snprintf(buffer, sizeof(buffer), spec.c_str(), stringArgument.c_str()));
+					result += buffer;
+				}
+			}
+			break;
+
+		case AT_pointer:
+			{
+				uint64 value = 0;
+				if (conversion.conversion != 'p' || !readValue(AT_pointer, arguments, end, &value, sizeof(value)))
+					return false;
+				IGNORE_RETURN(snprintf(buffer, sizeof(buffer), "0x%llx", value));
+				result += buffer;
+			}
+			break;
+
+		default:
+			return false;
+		}
+
+		p = next;
+	}
+
+	return arguments == end;
+}
+
+// ======================================================================
@@ -0,0 +1,71 @@
+// ======================================================================
+//
+// DeferredLogFormat.h
+//
+// Copyright 2002 Sony Online Entertainment
+//
+// ======================================================================
+
+#ifndef INCLUDED_DeferredLogFormat_H
+#define INCLUDED_DeferredLogFormat_H
+
+// ======================================================================
+
+#include <cstdarg>
+#include <string>
+#include <vector>
+
+// ======================================================================
+
+// Captures the arguments of a printf-style log call without formatting
+// them, so the text can be produced later (possibly in another process)
+// from the format string and the packed arguments.
+//
+// Packed arguments are a sequence of a one byte type followed by the
+// value in native byte order: 32 or 64 bit integers, doubles, pointers
+// as 64 bit values, and strings as a 32 bit length followed by the
+// characters.
+
+class DeferredLogFormat
+{
+public:
+
+	enum ArgumentType
+	{
+		AT_int32   = 'i',
+		AT_int64   = 'l',
+		AT_double  = 'd',
+		AT_string  = 's',
+		AT_pointer = 'p'
+	};
+
+	static bool pack(char const *format, va_list args, std::vector<char> &packedArguments);
+	static void packString(char const *text, std::vector<char> &packedArguments);
+	static bool format(char const *format, char const *packedArguments, int packedArgumentsLength, std::string &result);
+
+private:
+	DeferredLogFormat();
+	DeferredLogFormat(DeferredLogFormat const &);
+	DeferredLogFormat &operator=(DeferredLogFormat const &);
+};
+
+// ======================================================================
+
+// A log message as LogManager hands it to observers that support deferred
+// formatting.  Everything here is only valid for the duration of the call.
+
+struct DeferredLogMessage
+{
+	uint64                  timestamp;
+	std::string const *     procId;
+	std::string const *     channel;
+	char const *            format;
+	char const *            packedArguments;
+	int                     packedArgumentsLength;
+	Unicode::String const * unicodeAttach;
+};
+
+// ======================================================================
+
+#endif
+
@@ -79,32 +79,39 @@ FileLogObserver::~FileLogObserver()
 
 // ----------------------------------------------------------------------
 
-void FileLogObserver::log(LogMessage const &msg)
+void FileLogObserver::appendLine(LogMessage const &msg, std::string &buffer)
 {
-	prepareFile();
-	NOT_NULL(m_file);
-
-	uint64 timestamp           = msg.getTimestamp();
 	std::string const &procId  = msg.getProcId();
 	std::string const &channel = msg.getChannel();
 	std::string const &text    = msg.getText();
-	std::string uniAttach(Unicode::wideToNarrow(msg.getUnicodeAttach()));
-	char tsbuf[16]; // yyyymmddhhmmss (14)
-
-	IGNORE_RETURN( sprintf(tsbuf, UINT64_FORMAT_SPECIFIER, timestamp) );
-	IGNORE_RETURN( m_file->write(14, tsbuf) );
-	IGNORE_RETURN( m_file->write(1, ":") );
-	IGNORE_RETURN( m_file->write(static_cast<int>(procId.length()), procId.c_str()) );
-	IGNORE_RETURN( m_file->write(1, ":") );
-	IGNORE_RETURN( m_file->write(static_cast<int>(channel.length()), channel.c_str()) );
-	IGNORE_RETURN( m_file->write(1, ":") );
-	IGNORE_RETURN( m_file->write(static_cast<int>(text.length()), text.c_str()) );
-	if (uniAttach.length())
+	char tsbuf[32]; // yyyymmddhhmmss (14)
+
+	IGNORE_RETURN( snprintf(tsbuf, sizeof(tsbuf), UINT64_FORMAT_SPECIFIER, msg.getTimestamp()) );
+	IGNORE_RETURN( buffer.append(tsbuf, 14) );
+	buffer += ':';
+	buffer += procId;
+	buffer += ':';
+	buffer += channel;
+	buffer += ':';
+	buffer += text;
+	if (!msg.getUnicodeAttach().empty())
 	{
-		IGNORE_RETURN( m_file->write(1, ":") );
-		IGNORE_RETURN( m_file->write(static_cast<int>(uniAttach.length()), uniAttach.c_str()) );
+		buffer += ':';
+		buffer += Unicode::wideToNarrow(msg.getUnicodeAttach());
 	}
-	IGNORE_RETURN( m_file->write(1, "\n") );
+	buffer += '\n';
+}
+
+// ----------------------------------------------------------------------
+
+void FileLogObserver::log(LogMessage const &msg)
+{
+	prepareFile();
+	NOT_NULL(m_file);
+
+	m_lineBuffer.clear();
+	appendLine(msg, m_lineBuffer);
+	IGNORE_RETURN( m_file->write(static_cast<int>(m_lineBuffer.length()), m_lineBuffer.data()) );
 
 	if (LogManager::getFlushOnWrite())
 		m_file->flush();
@@ -112,6 +119,34 @@ void FileLogObserver::log(LogMessage const &msg)
 
 // ----------------------------------------------------------------------
 
+void FileLogObserver::logBatch(LogMessage const * const *messages, int count)
+{
+	m_lineBuffer.clear();
+	for (int i = 0; i < count; ++i)
+		if (!isFiltered(*messages[i]))
+			appendLine(*messages[i], m_lineBuffer);
+
+	if (m_lineBuffer.empty())
+		return;
+
+	prepareFile();
+	NOT_NULL(m_file);
+
+	IGNORE_RETURN( m_file->write(static_cast<int>(m_lineBuffer.length()), m_lineBuffer.data()) );
+
+	if (LogManager::getFlushOnWrite())
+		m_file->flush();
+}
+
+// ----------------------------------------------------------------------
+
+bool FileLogObserver::supportsAsynchronousLogging() const
+{
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
 void FileLogObserver::flush()
 {
 	if (m_file)
@@ -32,6 +32,8 @@ public:
 	virtual ~FileLogObserver();
 
 	virtual void log(LogMessage const &msg);
+	virtual void logBatch(LogMessage const * const *messages, int count);
+	virtual bool supportsAsynchronousLogging() const;
 	virtual void flush();
 
 private:
@@ -39,11 +41,13 @@ private:
 	FileLogObserver &operator=(FileLogObserver const &);
 
 	void prepareFile();
+	static void appendLine(LogMessage const &msg, std::string &buffer);
 
 private:
 	std::string m_filename;
 	AbstractFile *m_file;
 	int m_fileIndex;
+	std::string m_lineBuffer; // reused so each message or batch goes out in one write
 };
 
 // ======================================================================
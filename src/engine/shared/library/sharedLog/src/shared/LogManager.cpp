@@ -9,47 +9,103 @@
 #include "sharedLog/FirstSharedLog.h"
 #include "sharedFoundation/NetworkIdArchive.h"
 
+#include "sharedDebug/DebugFlags.h"
+#include "sharedDebug/PerformanceTimer.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/ConfigFile.h"
+#include "sharedFoundation/Os.h"
+#include "sharedLog/DeferredLogFormat.h"
 #include "sharedLog/LogManager.h"
 #include "sharedLog/LogObserver.h"
 #include "sharedLog/ConfigSharedLog.h"
 #include "sharedLog/StderrLogger.h"
 #include "sharedNetworkMessages/LogMessage.h"
+#include "sharedSynchronization/Mutex.h"
 #include "sharedSynchronization/RecursiveMutex.h"
+#include "sharedSynchronization/Semaphore.h"
+#include "sharedThread/RunThread.h"
+#include "sharedThread/ThreadHandle.h"
+#include <algorithm>
 #include <list>
 #include <map>
 #include <string>
 #include <cstdio>
 #include <time.h>
+#include <vector>
 
 // ======================================================================
 
 typedef std::list<LogObserver *> ObserverList;
 typedef std::map<std::string, LogObserverCreateFunc> ObserverCreateMap;
+typedef std::vector<LogMessage> LogMessageList;
+typedef std::vector<LogMessage const *> LogMessagePointerList;
 
 // ======================================================================
 
 namespace LogManagerNamespace
 {
 	void remove();
+	void runBenchmark();
+
+	bool ms_runBenchmark;
 
 	const int MaxLogMessageLen = 16384;
 
+	// Each record in the asynchronous ring buffer is a header followed by the
+	// process id, channel, text and unicode attachment, padded to 8 bytes.  A
+	// record never wraps: the tail of the buffer is skipped instead, marked by
+	// a header with AsyncWrapTextLength when there is room for one.
+	struct AsyncRecordHeader
+	{
+		uint64 timestamp;
+		uint32 size;                // bytes from this header to the next record
+		uint32 textLength;
+		uint32 unicodeAttachLength; // in characters
+		uint16 procIdLength;
+		uint16 channelLength;
+	};
+
+	const uint32 AsyncRecordAlignment = 8;
+	const uint32 AsyncWrapTextLength = 0xffffffff;
+	const int AsyncMaxBatchSize = 1024;
+	const unsigned int AsyncWriterIdleMs = 100;
+	const std::string AsyncDropChannel("LogManager");
+
 	struct LogManagerData
 	{
 		LogManagerData() :
 			mutex(),
+			mutexOwner(),
+			mutexDepth(0),
 			observers(),
 			observerCreateMap(),
 			channel(),
 			unicodeAttach(),
 			processIdentifier(),
 			flushOnWrite(true),
-			logging(0)
+			logging(0),
+			packedArguments(),
+			asynchronous(false),
+			asyncQueueMutex(),
+			asyncDeliveryMutex(),
+			asyncDeliveryThread(),
+			asyncDelivering(false),
+			asyncRecordsPending(),
+			asyncWriterThread(),
+			asyncWriterQuit(false),
+			asyncBuffer(),
+			asyncReadPosition(0),
+			asyncWritePosition(0),
+			asyncOverflowing(false),
+			asyncDroppedSinceReport(0),
+			asyncBatch(),
+			asyncBatchPointers()
 		{
+			memset(&asyncStatistics, 0, sizeof(asyncStatistics));
 		}
 		RecursiveMutex mutex;
+		Os::ThreadId mutexOwner; // valid while mutexDepth is non-zero
+		int volatile mutexDepth;
 		ObserverList observers;
 		ObserverCreateMap observerCreateMap;
 		std::string channel;
@@ -57,12 +113,56 @@ namespace LogManagerNamespace
 		std::string processIdentifier;
 		bool flushOnWrite;
 		int logging; // used for catching recursive log attempts from the same thread
+		std::vector<char> packedArguments;
+
+		// asynchronous logging.  Producers are already serialized by mutex, so only the
+		// read and write positions need asyncQueueMutex.  asyncDeliveryMutex is held
+		// whenever asynchronous observers are called or the observer list changes.
+		// The writer logs while delivering, so the lock order is asyncDeliveryMutex,
+		// then mutex; see enterObservers().
+		bool asynchronous;
+		Mutex asyncQueueMutex;
+		Mutex asyncDeliveryMutex;
+		Os::ThreadId asyncDeliveryThread; // valid while asyncDelivering
+		bool volatile asyncDelivering;
+		Semaphore asyncRecordsPending;
+		ThreadHandle asyncWriterThread;
+		bool volatile asyncWriterQuit;
+		std::vector<char> asyncBuffer; // size is a power of two
+		uint32 asyncReadPosition;      // positions count bytes ever queued, so they wrap with uint32
+		uint32 asyncWritePosition;
+		bool asyncOverflowing;
+		int asyncDroppedSinceReport;
+		LogManager::AsynchronousStatistics asyncStatistics;
+		LogMessageList asyncBatch;
+		LogMessagePointerList asyncBatchPointers;
 
 	private:
 		LogManagerData(LogManagerData const &);
 		LogManagerData &operator=(LogManagerData const &);
 	};
 	LogManagerData *s_data;
+
+	void deliverLogMessage(LogMessage const &msg, bool includeDeferredObservers);
+	uint64 getCurrentTimestamp();
+
+	void startAsyncWriter(int bufferSize);
+	void stopAsyncWriter();
+	void asyncWriterThreadRoutine();
+	void queueAsyncRecord(uint64 timestamp, char const *text);
+	void copyIntoAsyncBuffer(uint32 &position, void const *source, uint32 length);
+	int drainAsyncRecords();
+
+	void enterDelivery();
+	void leaveDelivery();
+	bool isDeliveringOnThisThread();
+
+	void enterLogMutex();
+	void leaveLogMutex();
+	bool holdsLogMutexOnThisThread();
+
+	bool enterObservers();
+	void leaveObservers(bool delivery);
 }
 using namespace LogManagerNamespace;
 
@@ -77,6 +177,9 @@ void LogManager::install(std::string const &procId, bool flushOnWrite)
 	ExitChain::add(LogManagerNamespace::remove, "LogManagerNamespace::remove");
 	if (ConfigSharedLog::getLogStderr())
 		StderrLogger::install();
+	if (ConfigSharedLog::getLogAsynchronous())
+		startAsyncWriter(ConfigSharedLog::getLogAsynchronousBufferSize() * 1024);
+	DebugFlags::registerFlag(ms_runBenchmark, "SharedLog", "benchmark", runBenchmark);
 }
 
 // ----------------------------------------------------------------------
@@ -89,8 +192,15 @@ void LogManager::update()
 	if (ConfigSharedLog::getLogStderr())
 		StderrLogger::update();
 
+	bool const delivery = enterObservers();
+
+	// without the delivery mutex the writer thread may be using the asynchronous observers
+	bool const skipAsynchronous = s_data->asynchronous && !delivery && !isDeliveringOnThisThread();
 	for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
-		(*i)->update();
+		if (!skipAsynchronous || !(*i)->supportsAsynchronousLogging())
+			(*i)->update();
+
+	leaveObservers(delivery);
 }
 
 // ----------------------------------------------------------------------
@@ -98,6 +208,10 @@ void LogManager::update()
 void LogManagerNamespace::remove()
 {
 	DEBUG_FATAL(!s_data, ("LogManager not installed"));
+	DebugFlags::unregisterFlag(ms_runBenchmark);
+	// deliver anything still queued before the observers go away
+	if (s_data->asynchronous)
+		stopAsyncWriter();
 	// we own any observers we have, so delete them
 	while (!s_data->observers.empty())
 	{
@@ -125,7 +239,7 @@ void LogManager::setArgs(std::string const &channel, Unicode::String const &unic
 	if (!s_data)
 		return;
 
-	s_data->mutex.enter(); // leave() called from log which should always follow setArgs
+	enterLogMutex(); // leaveLogMutex() called from log which should always follow setArgs
 	if (s_data->logging == 0)
 	{
 		++s_data->logging;
@@ -141,7 +255,7 @@ void LogManager::setArgs(std::string const &channel)
 	if (!s_data)
 		return;
 
-	s_data->mutex.enter(); // leave() called from log which should always follow setArgs
+	enterLogMutex(); // leaveLogMutex() called from log which should always follow setArgs
 	++s_data->logging;
 	if (s_data->logging == 1)
 	{
@@ -160,7 +274,30 @@ void LogManager::log(char const *format, ...)
 	if (s_data->observers.size() && s_data->logging == 1)
 	{
 		++s_data->logging;
+
+		// observers that support deferred formatting take the format and arguments as they
+		// are, so the text only needs formatting if some other observer is interested
+		bool textObservers = false;
+		bool deferredObservers = false;
+		for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
+		{
+			if ((*i)->supportsDeferredFormatting())
+				deferredObservers = true;
+			else
+				textObservers = true;
+		}
+
+		bool packed = false;
+		if (deferredObservers)
+		{
+			va_list ap;
+			va_start(ap, format); //lint !e746 !e1055
+			packed = DeferredLogFormat::pack(format, ap, s_data->packedArguments);
+			va_end(ap);
+		}
+
 		static char text[MaxLogMessageLen];
+		if (textObservers || !packed)
 		{
 			va_list ap;
 			va_start(ap, format); //lint !e746 !e1055
@@ -173,56 +310,94 @@ void LogManager::log(char const *format, ...)
 			va_end(ap);
 		}
 
-		uint64 timestamp;
+		uint64 const timestamp = getCurrentTimestamp();
+
+		if (deferredObservers)
 		{
-			// format current date/time gmt as yyyymmddhhmmss, in a uint64
-			time_t now;
-			tm t;
-
-			IGNORE_RETURN( time(&now) );
-			IGNORE_RETURN( gmtime_r(&now, &t) );
-			timestamp = t.tm_year+1900; //lint !e732 !e737 !e776
-			timestamp *= 100;
-			timestamp += t.tm_mon+1; //lint !e737 !e776
-			timestamp *= 100;
-			timestamp += static_cast<unsigned int>(t.tm_mday);
-			timestamp *= 100;
-			timestamp += static_cast<unsigned int>(t.tm_hour);
-			timestamp *= 100;
-			timestamp += static_cast<unsigned int>(t.tm_min);
-			timestamp *= 100;
-			timestamp += static_cast<unsigned int>(t.tm_sec);
+			// formats that can't be deferred go through as preformatted text
+			if (!packed)
+			{
+				s_data->packedArguments.clear();
+				DeferredLogFormat::packString(text, s_data->packedArguments);
+			}
+
+			DeferredLogMessage msg;
+			msg.timestamp = timestamp;
+			msg.procId = &s_data->processIdentifier;
+			msg.channel = &s_data->channel;
+			msg.format = packed ? format : "%s";
+			msg.packedArguments = s_data->packedArguments.empty() ? 0 : &s_data->packedArguments[0];
+			msg.packedArgumentsLength = static_cast<int>(s_data->packedArguments.size());
+			msg.unicodeAttach = &s_data->unicodeAttach;
+
+			for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
+				if ((*i)->supportsDeferredFormatting())
+					(*i)->logDeferred(msg);
 		}
 
-		observeLogMessage(LogMessage(timestamp, s_data->processIdentifier, s_data->channel, text, s_data->unicodeAttach));
+		if (textObservers && s_data->asynchronous)
+		{
+			// observers that can't run on the writer thread still get the message right away
+			bool queue = false;
+			bool observeNow = false;
+			for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
+			{
+				if ((*i)->supportsDeferredFormatting())
+					continue;
+				if ((*i)->supportsAsynchronousLogging())
+					queue = true;
+				else
+					observeNow = true;
+			}
+
+			if (observeNow)
+			{
+				LogMessage const msg(timestamp, s_data->processIdentifier, s_data->channel, text, s_data->unicodeAttach);
+				for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
+					if (!(*i)->supportsDeferredFormatting() && !(*i)->supportsAsynchronousLogging() && !(*i)->isFiltered(msg))
+						(*i)->log(msg);
+			}
+
+			if (queue)
+				queueAsyncRecord(timestamp, text);
+		}
+		else if (textObservers)
+			deliverLogMessage(LogMessage(timestamp, s_data->processIdentifier, s_data->channel, text, s_data->unicodeAttach), false);
 		--s_data->logging;
 	}
 
 	--s_data->logging;
-	s_data->mutex.leave(); // enter() called from setArgs which should always precede log
+	leaveLogMutex(); // enterLogMutex() called from setArgs which should always precede log
 }
 
 // ----------------------------------------------------------------------
 
 void LogManager::observeLogMessage(LogMessage const &msg)
 {
-	for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
-		if (!(*i)->isFiltered(msg))
-			(*i)->log(msg);
+	deliverLogMessage(msg, true);
 }
 
 // ----------------------------------------------------------------------
 
 void LogManager::addObserver(LogObserver *observer)
 {
+	// producers and the asynchronous writer both walk the observer list
+	bool const delivery = enterObservers();
 	s_data->observers.push_back(observer);
+	leaveObservers(delivery);
 }
 
 // ----------------------------------------------------------------------
 
 void LogManager::removeObserver(LogObserver const *observer)
 {
+	// messages queued while it was attached still go to it
+	if (s_data->asynchronous && !holdsLogMutexOnThisThread())
+		while (drainAsyncRecords() > 0)
+			{}
+
 	// we own any observers given to us, so delete it when it is removed
+	bool const delivery = enterObservers();
 	for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
 	{
 		if ((*i) == observer)
@@ -232,6 +407,7 @@ void LogManager::removeObserver(LogObserver const *observer)
 			break;
 		}
 	}
+	leaveObservers(delivery);
 }
 
 // ----------------------------------------------------------------------
@@ -331,8 +507,128 @@ bool LogManager::getFlushOnWrite()
 
 void LogManager::flush()
 {
+	// a fatal raised by an observer while this thread is delivering a batch (the writer
+	// thread, or a drain on behalf of flush or removeObserver) lands back here.  The
+	// delivery mutex is already held and the batch is being walked, so just flush.
+	bool const delivering = s_data->asynchronous && isDeliveringOnThisThread();
+
+	// write out everything queued so far before flushing the observers.  A thread inside
+	// log() (an observer that fatals) holds mutex and can't take the delivery mutex
+	// after it, so the queue is left to the writer.
+	if (s_data->asynchronous && !delivering && !holdsLogMutexOnThisThread())
+		while (drainAsyncRecords() > 0)
+			{}
+
+	bool const delivery = enterObservers();
+
+	// without the delivery mutex the writer thread may be using the asynchronous observers
+	bool const skipAsynchronous = s_data->asynchronous && !delivery && !delivering;
 	for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
-		(*i)->flush();
+		if (!skipAsynchronous || !(*i)->supportsAsynchronousLogging())
+			(*i)->flush();
+
+	leaveObservers(delivery);
+}
+
+// ----------------------------------------------------------------------
+
+bool LogManager::isAsynchronous()
+{
+	return s_data && s_data->asynchronous;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManager::getAsynchronousStatistics(AsynchronousStatistics &statistics)
+{
+	if (!s_data)
+	{
+		memset(&statistics, 0, sizeof(statistics));
+		return;
+	}
+
+	s_data->asyncQueueMutex.enter();
+	statistics = s_data->asyncStatistics;
+	s_data->asyncQueueMutex.leave();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Log a number of messages through the synchronous path and then through
+ * the asynchronous path, and report messages per second for each.  The
+ * asynchronous path is timed both until the last log() call returns and
+ * until everything queued has been written out.
+ */
+
+void LogManager::benchmark(int numberOfMessages)
+{
+	if (!s_data || numberOfMessages <= 0)
+		return;
+
+	std::string const channel("LogBenchmark");
+	bool const wasAsynchronous = s_data->asynchronous;
+
+	if (wasAsynchronous)
+		flush();
+	else
+		startAsyncWriter(ConfigSharedLog::getLogAsynchronousBufferSize() * 1024);
+
+	AsynchronousStatistics before;
+	getAsynchronousStatistics(before);
+
+	//-- synchronous path
+	PerformanceTimer synchronousTimer;
+	s_data->asynchronous = false;
+	synchronousTimer.start();
+	for (int i = 0; i < numberOfMessages; ++i)
+	{
+		setArgs(channel);
+		log("synchronous benchmark message %d of %d", i + 1, numberOfMessages);
+	}
+	flush();
+	synchronousTimer.stop();
+
+	//-- asynchronous path
+	PerformanceTimer producerTimer;
+	PerformanceTimer asynchronousTimer;
+	s_data->asynchronous = true;
+	producerTimer.start();
+	asynchronousTimer.start();
+	for (int j = 0; j < numberOfMessages; ++j)
+	{
+		setArgs(channel);
+		log("asynchronous benchmark message %d of %d", j + 1, numberOfMessages);
+	}
+	producerTimer.stop();
+	flush();
+	asynchronousTimer.stop();
+
+	AsynchronousStatistics after;
+	getAsynchronousStatistics(after);
+
+	if (!wasAsynchronous)
+		stopAsyncWriter();
+
+	float const synchronousTime = std::max(synchronousTimer.getElapsedTime(), 0.000001f);
+	float const producerTime = std::max(producerTimer.getElapsedTime(), 0.000001f);
+	float const asynchronousTime = std::max(asynchronousTimer.getElapsedTime(), 0.000001f);
+
+	REPORT_LOG(true, ("LogManager benchmark: %d messages\n", numberOfMessages));
+	REPORT_LOG(true, ("  synchronous:             %.0f messages/sec\n", numberOfMessages / synchronousTime));
+	REPORT_LOG(true, ("  asynchronous (producer): %.0f messages/sec\n", numberOfMessages / producerTime));
+	REPORT_LOG(true, ("  asynchronous (written):  %.0f messages/sec\n", numberOfMessages / asynchronousTime));
+	REPORT_LOG(true, ("  dropped %d, overflows %d, batches %d\n", after.messagesDropped - before.messagesDropped, after.overflows - before.overflows, after.batchesWritten - before.batchesWritten));
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Run once when the SharedLog benchmark debug flag is set.
+ */
+
+void LogManagerNamespace::runBenchmark()
+{
+	ms_runBenchmark = false;
+	LogManager::benchmark(ConfigSharedLog::getLogBenchmarkMessages());
 }
 
 // ----------------------------------------------------------------------
@@ -365,3 +661,368 @@ void LogManager::logLongText(std::string const & channel, std::string const & lo
 
 // ======================================================================
 
+void LogManagerNamespace::deliverLogMessage(LogMessage const &msg, bool includeDeferredObservers)
+{
+	// the writer thread may be using the asynchronous observers
+	bool const lock = s_data->asynchronous && !isDeliveringOnThisThread();
+	if (lock)
+		enterDelivery();
+
+	for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
+		if ((includeDeferredObservers || !(*i)->supportsDeferredFormatting()) && !(*i)->isFiltered(msg))
+			(*i)->log(msg);
+
+	if (lock)
+		leaveDelivery();
+}
+
+// ----------------------------------------------------------------------
+
+uint64 LogManagerNamespace::getCurrentTimestamp()
+{
+	// format current date/time gmt as yyyymmddhhmmss, in a uint64
+	time_t now;
+	tm t;
+
+	IGNORE_RETURN( time(&now) );
+	IGNORE_RETURN( gmtime_r(&now, &t) );
+	uint64 timestamp = t.tm_year+1900; //lint !e732 !e737 !e776
+	timestamp *= 100;
+	timestamp += t.tm_mon+1; //lint !e737 !e776
+	timestamp *= 100;
+	timestamp += static_cast<unsigned int>(t.tm_mday);
+	timestamp *= 100;
+	timestamp += static_cast<unsigned int>(t.tm_hour);
+	timestamp *= 100;
+	timestamp += static_cast<unsigned int>(t.tm_min);
+	timestamp *= 100;
+	timestamp += static_cast<unsigned int>(t.tm_sec);
+	return timestamp;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::startAsyncWriter(int bufferSize)
+{
+	DEBUG_FATAL(s_data->asynchronous, ("LogManager asynchronous writer already running"));
+
+	// round the buffer up to a power of two so positions can wrap freely
+	uint32 capacity = 64 * 1024;
+	while (capacity < static_cast<uint32>(bufferSize) && capacity < 0x40000000)
+		capacity <<= 1;
+
+	s_data->asyncBuffer.resize(capacity);
+	s_data->asyncReadPosition = 0;
+	s_data->asyncWritePosition = 0;
+	s_data->asyncOverflowing = false;
+	s_data->asyncDroppedSinceReport = 0;
+	s_data->asyncWriterQuit = false;
+	s_data->asyncWriterThread = runNamedThread("LogWriter", asyncWriterThreadRoutine);
+	s_data->asynchronous = true;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::stopAsyncWriter()
+{
+	s_data->asyncWriterQuit = true;
+	s_data->asyncRecordsPending.signal();
+	s_data->asyncWriterThread->wait();
+	s_data->asyncWriterThread = ThreadHandle();
+
+	// anything queued after the writer's last pass
+	while (drainAsyncRecords() > 0)
+		{}
+
+	s_data->asynchronous = false;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::asyncWriterThreadRoutine()
+{
+	while (!s_data->asyncWriterQuit)
+	{
+		s_data->asyncRecordsPending.wait(AsyncWriterIdleMs);
+		while (drainAsyncRecords() > 0)
+			{}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::copyIntoAsyncBuffer(uint32 &position, void const *source, uint32 length)
+{
+	uint32 const mask = static_cast<uint32>(s_data->asyncBuffer.size()) - 1;
+	memcpy(&s_data->asyncBuffer[position & mask], source, length);
+	position += length;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Copy a formatted message into the ring buffer.  Called with the log
+ * mutex held, so there is only ever one producer at a time.
+ */
+
+void LogManagerNamespace::queueAsyncRecord(uint64 timestamp, char const *text)
+{
+	AsyncRecordHeader header;
+	header.timestamp = timestamp;
+	header.textLength = static_cast<uint32>(strlen(text));
+	header.unicodeAttachLength = static_cast<uint32>(s_data->unicodeAttach.length());
+	header.procIdLength = static_cast<uint16>(std::min(s_data->processIdentifier.length(), static_cast<size_t>(0xffff)));
+	header.channelLength = static_cast<uint16>(std::min(s_data->channel.length(), static_cast<size_t>(0xffff)));
+
+	uint32 const unicodeAttachBytes = header.unicodeAttachLength * sizeof(Unicode::unicode_char_t);
+	uint32 const payloadSize = sizeof(header) + header.procIdLength + header.channelLength + header.textLength + unicodeAttachBytes;
+	header.size = (payloadSize + AsyncRecordAlignment - 1) & ~(AsyncRecordAlignment - 1);
+
+	uint32 const capacity = static_cast<uint32>(s_data->asyncBuffer.size());
+
+	s_data->asyncQueueMutex.enter();
+	uint32 const readPosition = s_data->asyncReadPosition;
+	s_data->asyncQueueMutex.leave();
+
+	// records don't wrap, so a record that doesn't fit before the end of the buffer skips the rest of it
+	uint32 writePosition = s_data->asyncWritePosition;
+	uint32 const bytesToEnd = capacity - (writePosition & (capacity - 1));
+	uint32 const skip = (bytesToEnd < header.size) ? bytesToEnd : 0;
+
+	if ((writePosition - readPosition) + skip + header.size > capacity)
+	{
+		s_data->asyncQueueMutex.enter();
+		++s_data->asyncStatistics.messagesDropped;
+		++s_data->asyncDroppedSinceReport;
+		if (!s_data->asyncOverflowing)
+			++s_data->asyncStatistics.overflows;
+		s_data->asyncQueueMutex.leave();
+
+		s_data->asyncOverflowing = true;
+		return;
+	}
+
+	s_data->asyncOverflowing = false;
+
+	if (skip)
+	{
+		if (skip >= sizeof(AsyncRecordHeader))
+		{
+			AsyncRecordHeader wrap;
+			memset(&wrap, 0, sizeof(wrap));
+			wrap.size = skip;
+			wrap.textLength = AsyncWrapTextLength;
+			uint32 wrapPosition = writePosition;
+			copyIntoAsyncBuffer(wrapPosition, &wrap, sizeof(wrap));
+		}
+		writePosition += skip;
+	}
+
+	uint32 position = writePosition;
+	copyIntoAsyncBuffer(position, &header, sizeof(header));
+	copyIntoAsyncBuffer(position, s_data->processIdentifier.data(), header.procIdLength);
+	copyIntoAsyncBuffer(position, s_data->channel.data(), header.channelLength);
+	copyIntoAsyncBuffer(position, text, header.textLength);
+	if (unicodeAttachBytes)
+		copyIntoAsyncBuffer(position, s_data->unicodeAttach.data(), unicodeAttachBytes);
+	writePosition += header.size;
+
+	s_data->asyncQueueMutex.enter();
+	bool const wasEmpty = (s_data->asyncWritePosition == s_data->asyncReadPosition);
+	s_data->asyncWritePosition = writePosition;
+	++s_data->asyncStatistics.messagesQueued;
+	s_data->asyncStatistics.bufferHighWater = std::max(s_data->asyncStatistics.bufferHighWater, static_cast<int>(writePosition - s_data->asyncReadPosition));
+	s_data->asyncQueueMutex.leave();
+
+	// the writer drains until the buffer is empty before it sleeps, so it only needs waking for the first record
+	if (wasEmpty)
+		s_data->asyncRecordsPending.signal();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Hand up to AsyncMaxBatchSize queued messages to the asynchronous
+ * observers.  Called by the writer thread, and by any thread that needs the
+ * queue written out (flush, shutdown).
+ *
+ * @return the number of messages delivered
+ */
+
+int LogManagerNamespace::drainAsyncRecords()
+{
+	// an observer called from here can end up back here through a fatal; the batch it
+	// is part of is still being delivered, so there is nothing more to do
+	if (isDeliveringOnThisThread())
+		return 0;
+
+	enterDelivery();
+
+	s_data->asyncQueueMutex.enter();
+	uint32 const writePosition = s_data->asyncWritePosition;
+	int const droppedMessages = s_data->asyncDroppedSinceReport;
+	s_data->asyncDroppedSinceReport = 0;
+	s_data->asyncQueueMutex.leave();
+
+	// only drainers move the read position, and they hold the delivery mutex
+	uint32 readPosition = s_data->asyncReadPosition;
+	uint32 const capacity = static_cast<uint32>(s_data->asyncBuffer.size());
+
+	LogMessageList &batch = s_data->asyncBatch;
+	batch.clear();
+
+	std::string procId;
+	std::string channel;
+	std::string text;
+	Unicode::String unicodeAttach;
+
+	while (readPosition != writePosition && static_cast<int>(batch.size()) < AsyncMaxBatchSize)
+	{
+		uint32 const offset = readPosition & (capacity - 1);
+		if (capacity - offset < sizeof(AsyncRecordHeader))
+		{
+			readPosition += capacity - offset;
+			continue;
+		}
+
+		AsyncRecordHeader header;
+		memcpy(&header, &s_data->asyncBuffer[offset], sizeof(header));
+		if (header.textLength != AsyncWrapTextLength)
+		{
+			char const *data = &s_data->asyncBuffer[offset + sizeof(header)];
+			procId.assign(data, header.procIdLength);
+			data += header.procIdLength;
+			channel.assign(data, header.channelLength);
+			data += header.channelLength;
+			text.assign(data, header.textLength);
+			data += header.textLength;
+			unicodeAttach.resize(header.unicodeAttachLength);
+			if (header.unicodeAttachLength)
+				memcpy(&unicodeAttach[0], data, header.unicodeAttachLength * sizeof(Unicode::unicode_char_t));
+
+			batch.push_back(LogMessage(header.timestamp, procId, channel, text, unicodeAttach));
+		}
+
+		readPosition += header.size;
+	}
+
+	// the messages are copied out, so producers can have the space back before the observers run
+	s_data->asyncQueueMutex.enter();
+	s_data->asyncReadPosition = readPosition;
+	s_data->asyncQueueMutex.leave();
+
+	if (droppedMessages)
+	{
+		char buffer[128];
+		IGNORE_RETURN( snprintf(buffer, sizeof(buffer), "dropped %d log messages, asynchronous log buffer full", droppedMessages) );
+		batch.push_back(LogMessage(getCurrentTimestamp(), s_data->processIdentifier, AsyncDropChannel, buffer, Unicode::String()));
+	}
+
+	int const count = static_cast<int>(batch.size());
+	if (count)
+	{
+		LogMessagePointerList &pointers = s_data->asyncBatchPointers;
+		pointers.clear();
+		for (LogMessageList::const_iterator m = batch.begin(); m != batch.end(); ++m)
+			pointers.push_back(&(*m));
+
+		for (ObserverList::iterator i = s_data->observers.begin(); i != s_data->observers.end(); ++i)
+			if ((*i)->supportsAsynchronousLogging())
+				(*i)->logBatch(&pointers[0], count);
+
+		s_data->asyncQueueMutex.enter();
+		++s_data->asyncStatistics.batchesWritten;
+		s_data->asyncStatistics.largestBatch = std::max(s_data->asyncStatistics.largestBatch, count);
+		s_data->asyncQueueMutex.leave();
+	}
+
+	leaveDelivery();
+	return count;
+}
+
+// ======================================================================
+
+void LogManagerNamespace::enterDelivery()
+{
+	s_data->asyncDeliveryMutex.enter();
+	s_data->asyncDeliveryThread = Os::getThreadId();
+	s_data->asyncDelivering = true;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::leaveDelivery()
+{
+	s_data->asyncDelivering = false;
+	s_data->asyncDeliveryMutex.leave();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Whether this thread holds the delivery mutex.  Only the holder sets the
+ * owner, so another thread can't see a stale match for itself.
+ */
+
+bool LogManagerNamespace::isDeliveringOnThisThread()
+{
+	return s_data->asyncDelivering && s_data->asyncDeliveryThread == Os::getThreadId();
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::enterLogMutex()
+{
+	s_data->mutex.enter();
+	if (s_data->mutexDepth == 0)
+		s_data->mutexOwner = Os::getThreadId();
+	++s_data->mutexDepth;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::leaveLogMutex()
+{
+	--s_data->mutexDepth;
+	s_data->mutex.leave();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Whether this thread holds mutex, e.g. an observer called from log().
+ * As with the delivery mutex, only the holder sets the owner.
+ */
+
+bool LogManagerNamespace::holdsLogMutexOnThisThread()
+{
+	return s_data->mutexDepth > 0 && s_data->mutexOwner == Os::getThreadId();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Lock the observer list for walking or changing it outside of log().
+ *
+ * The lock order is the delivery mutex, then mutex.  A thread that is
+ * already delivering has the delivery mutex, and a thread that already
+ * holds mutex can't take it without inverting that order, so neither
+ * takes it again.
+ *
+ * @return whether the delivery mutex was taken, for leaveObservers()
+ */
+
+bool LogManagerNamespace::enterObservers()
+{
+	bool const delivery = !isDeliveringOnThisThread() && !holdsLogMutexOnThisThread();
+	if (delivery)
+		enterDelivery();
+	enterLogMutex();
+	return delivery;
+}
+
+// ----------------------------------------------------------------------
+
+void LogManagerNamespace::leaveObservers(bool delivery)
+{
+	leaveLogMutex();
+	if (delivery)
+		leaveDelivery();
+}
+
+// ======================================================================
@@ -20,11 +20,32 @@ class LogObserver;
 // processes them from varArgs into straight ascii text, and passes the
 // processed string on to any observers, along with a timestamp,
 // process identifier, and any unicode text attached.
+//
+// With SharedLog/logAsynchronous set, messages for observers that
+// support it are copied into a ring buffer instead, and a writer thread
+// hands them to those observers in batches.  Messages that don't fit in
+// the buffer are dropped and counted.
+//
+// Observers that support deferred formatting are handed the format string
+// and packed arguments instead of text, and if every observer does, the
+// text is never formatted.
 
 typedef LogObserver *(*LogObserverCreateFunc)(std::string const &);
 
 class LogManager
 {
+public:
+
+	struct AsynchronousStatistics
+	{
+		int messagesQueued;
+		int messagesDropped;
+		int overflows;       // number of times the buffer filled up; each may drop many messages
+		int batchesWritten;
+		int largestBatch;
+		int bufferHighWater; // most bytes queued at once
+	};
+
 public:
 
 	static void install(std::string const &procId, bool flushOnWrite = true);
@@ -45,6 +66,10 @@ public:
 	static bool setupObserver(std::string const &desc);
 	static bool getFlushOnWrite();
 	static void flush();
+
+	static bool isAsynchronous();
+	static void getAsynchronousStatistics(AsynchronousStatistics &statistics);
+	static void benchmark(int numberOfMessages);
 	
 private:
 	LogManager();
@@ -9,7 +9,9 @@
 #include "sharedLog/FirstSharedLog.h"
 #include "sharedFoundation/NetworkIdArchive.h"
 #include "sharedLog/LogObserver.h"
+#include "sharedLog/DeferredLogFormat.h"
 #include "sharedNetworkMessages/LogMessage.h"
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -48,6 +50,13 @@ void LogObserver::setFilter(std::string const &filter)
 // ----------------------------------------------------------------------
 
 bool LogObserver::isFiltered(LogMessage const &msg) const
+{
+	return isFiltered(msg.getProcId(), msg.getChannel(), msg.getText().c_str());
+}
+
+// ----------------------------------------------------------------------
+
+bool LogObserver::isFiltered(std::string const &procId, std::string const &channel, char const *text) const
 {
 	bool filtered = false;
 	// run through the list of filters comparing them
@@ -55,14 +64,14 @@ bool LogObserver::isFiltered(LogMessage const &msg) const
 	for (i = m_filters->begin(); i != m_filters->end(); ++i)
 	{
 		std::string const &filter = (*i);
-		std::string const *source = 0;
+		char const *source = 0;
 		// source specifier (c or d - channel or data)
 		if (filter[0] == 'c')
-			source = &msg.getChannel();
+			source = channel.c_str();
 		else if (filter[0] == 'd')
-			source = &msg.getText();
+			source = text;
 		else if (filter[0] == 'p')
-			source = &msg.getProcId();
+			source = procId.c_str();
 		else
 			continue; // invalid source specifier, skip filter
 		// filter action (+ or -)
@@ -86,7 +95,7 @@ bool LogObserver::isFiltered(LogMessage const &msg) const
 		if (filter[filterPos] == '*')
 			match = true;
 		else
-			match = (source->find(filter.c_str()+filterPos) != std::string::npos);
+			match = (strstr(source, filter.c_str()+filterPos) != 0);
 		if (negateCompare)
 			match = !match;
 		if (match)
@@ -95,12 +104,62 @@ bool LogObserver::isFiltered(LogMessage const &msg) const
 	return filtered;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Receive a batch of messages from the asynchronous log writer.  Filtering
+ * is up to the observer; by default each unfiltered message goes to log().
+ */
+
+void LogObserver::logBatch(LogMessage const * const *messages, int count)
+{
+	for (int i = 0; i < count; ++i)
+		if (!isFiltered(*messages[i]))
+			log(*messages[i]);
+}
+
 // ----------------------------------------------------------------------
 
 void LogObserver::flush()
 {
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Observers returning true are fed by the asynchronous log writer thread
+ * when asynchronous logging is enabled, so their log(), logBatch(),
+ * flush() and update() must not touch anything owned by another thread.
+ */
+
+bool LogObserver::supportsAsynchronousLogging() const
+{
+	return false;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Receive a message whose text has not been formatted.  Observers only
+ * get these if they return true from supportsDeferredFormatting(), and
+ * must do their own filtering; data filters are matched against the
+ * format string.  By default the text is formatted and passed to log().
+ */
+
+void LogObserver::logDeferred(DeferredLogMessage const &msg)
+{
+	std::string text;
+	IGNORE_RETURN( DeferredLogFormat::format(msg.format, msg.packedArguments, msg.packedArgumentsLength, text) );
+
+	LogMessage const logMessage(msg.timestamp, *msg.procId, *msg.channel, text, *msg.unicodeAttach);
+	if (!isFiltered(logMessage))
+		log(logMessage);
+}
+
+// ----------------------------------------------------------------------
+
+bool LogObserver::supportsDeferredFormatting() const
+{
+	return false;
+}
+
 //------------------------------------------------------------------------------------------
 
 void LogObserver::update()
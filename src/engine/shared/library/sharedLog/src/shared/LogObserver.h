@@ -12,6 +12,7 @@
 // ======================================================================
 
 class LogMessage;
+struct DeferredLogMessage;
 
 // ======================================================================
 
@@ -27,10 +28,17 @@ public:
 	virtual ~LogObserver();
 
 	virtual void log(LogMessage const &msg) = 0;
+	virtual void logBatch(LogMessage const * const *messages, int count);
 	virtual void flush();
 
+	virtual bool supportsAsynchronousLogging() const;
+
+	virtual void logDeferred(DeferredLogMessage const &msg);
+	virtual bool supportsDeferredFormatting() const;
+
 	void setFilter(std::string const &filter);
 	bool isFiltered(LogMessage const &msg) const;
+	bool isFiltered(std::string const &procId, std::string const &channel, char const *text) const;
 
 	virtual void update();
 	
@@ -12,6 +12,7 @@
 
 #include "sharedDebug/InstallTimer.h"
 #include "sharedFoundation/ExitChain.h"
+#include "sharedLog/BinaryLogObserver.h"
 #include "sharedLog/ConfigSharedLog.h"
 #include "sharedLog/FileLogObserver.h"
 #include "sharedLog/NetLogObserver.h"
@@ -53,6 +54,8 @@ void SetupSharedLogNamespace::logReportWarning(char const *message)
 void SetupSharedLogNamespace::logReportFatal(char const *message)
 {
 	LOG(cms_reportFatalChannel, ("%s", message));
+	// the process is going down, so don't leave the fatal sitting in a queue or buffer
+	LogManager::flush();
 }
 
 // ======================================================================
@@ -67,6 +70,7 @@ void SetupSharedLog::install(std::string const &procId, bool flushOnWrite)
 	ConfigSharedLog::install();
 	LogManager::install(procId, flushOnWrite);
 	FileLogObserver::install();
+	BinaryLogObserver::install();
 	NetLogObserver::install();
 	TailFileLogObserver::install();
 
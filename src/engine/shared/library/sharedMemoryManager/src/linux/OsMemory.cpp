@@ -9,16 +9,34 @@
 #include "sharedMemoryManager/FirstSharedMemoryManager.h"
 #include "sharedMemoryManager/OsMemory.h"
 
+#include <pthread.h>
+
+// ======================================================================
+
+namespace OsMemoryNamespace
+{
+	bool          ms_threadDataKeyCreated;
+	pthread_key_t ms_threadDataKey;
+}
+using namespace OsMemoryNamespace;
+
 // ======================================================================
 
 void OsMemory::install()
 {
+	if (!ms_threadDataKeyCreated)
+		ms_threadDataKeyCreated = (pthread_key_create(&ms_threadDataKey, 0) == 0);
 }
 
 // ----------------------------------------------------------------------
 
 void OsMemory::remove()
 {
+	if (ms_threadDataKeyCreated)
+	{
+		IGNORE_RETURN(pthread_key_delete(ms_threadDataKey));
+		ms_threadDataKeyCreated = false;
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -37,4 +55,27 @@ bool OsMemory::free(void *addr, size_t)
 	return true;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Get the memory manager's per-thread data pointer for the calling thread.
+ *
+ * Returns NULL if no data has been set for this thread.
+ */
+
+void *OsMemory::getThreadData()
+{
+	if (!ms_threadDataKeyCreated)
+		return NULL;
+
+	return pthread_getspecific(ms_threadDataKey);
+}
+
+// ----------------------------------------------------------------------
+
+void OsMemory::setThreadData(void *data)
+{
+	if (ms_threadDataKeyCreated)
+		IGNORE_RETURN(pthread_setspecific(ms_threadDataKey, data));
+}
+
 // ======================================================================
@@ -20,6 +20,7 @@
 #include "sharedSynchronization/RecursiveMutex.h"
 #include "sharedDebug/RemoteDebug.h"
 
+#include <algorithm>
 #include <cstdio>
 
 #ifdef _WIN32
@@ -95,6 +96,9 @@
 	#define DO_TRACK 5
 #endif
 
+// small allocations are served from per-thread magazines of cached blocks so they don't have to take the global lock
+#define DO_THREAD_CACHES 1
+
 // ======================================================================
 
 namespace MemoryManagerNamespace
@@ -144,6 +148,9 @@ namespace MemoryManagerNamespace
 		bool    isFree() const;
 		void    setFree(bool free);
 
+		bool    isCached() const;
+		void    setCached(bool cached);
+
 		int     getSize() const;
 
 	private:
@@ -151,6 +158,7 @@ namespace MemoryManagerNamespace
 		Block *        m_previous;
 		Block *        m_next;
 		bool           m_free:1;
+		bool           m_cached:1;
 
 	protected:
 
@@ -222,6 +230,57 @@ namespace MemoryManagerNamespace
 	void logAllocationsNextFrame();
 #endif
 
+#if PRODUCTION == 0
+	// Allocation profile.  While it runs, one allocation in every sample rate is charged, scaled up
+	// by the rate, to the address operator new was called from.  The tables are static so recording
+	// never allocates, and they are only touched while holding ms_criticalSection.
+	int const cms_allocationProfileSize = 4096; // must be a power of two
+
+	struct AllocationProfileEntry
+	{
+		uint32 m_owner;
+		int    m_allocations;
+		int64  m_bytes;
+	};
+
+	struct AllocationProfile
+	{
+		AllocationProfileEntry m_entries[cms_allocationProfileSize];
+		int                    m_callsites;
+		int                    m_droppedSamples;
+		int                    m_frames;
+	};
+
+	struct SortAllocationProfileOrder
+	{
+		int64 const * m_keys;
+		bool operator()(int lhs, int rhs) const;
+	};
+
+	bool                           sampleAllocation(int & countdown);
+	void                           recordAllocationSample(uint32 owner, size_t size);
+	AllocationProfileEntry const * findAllocationProfileEntry(AllocationProfile const & profile, uint32 owner);
+	void                           reportAllocationProfile(AllocationProfile const & profile, AllocationProfile const * baseline, int count);
+	void                           profileAllocationsFrame();
+	void                           reportAllocationProfileNow();
+	void                           snapshotAllocationProfileNow();
+#endif
+
+	AllocatedBlock * allocateBlock(int allocSize);
+	void             releaseBlock(Block * block);
+
+#if DO_THREAD_CACHES
+	struct ThreadCache;
+
+	int          getThreadCacheClass(int blockSize);
+	ThreadCache *getThreadCache();
+	void         refillThreadCache(ThreadCache * threadCache, int classIndex, int allocSize);
+	void         drainThreadCache(ThreadCache * threadCache, int classIndex, int count);
+	void         cacheFreedBlock(ThreadCache * threadCache, AllocatedBlock * block);
+	void         flushThreadCacheCounters(ThreadCache * threadCache);
+	void         destroyThreadCache(ThreadCache * threadCache);
+#endif
+
 	int convertBytesToMegabytesForSystemAllocation(int bytes);
 	void allocateSystemMemory(int megabytes);
 
@@ -253,6 +312,45 @@ namespace MemoryManagerNamespace
 	int const cms_systemAllocationRoundSize = 4 * 1024 * 1024;
 	int const cms_systemAllocationMinimumSize = 4 * 1024 * 1024;
 
+#if DO_THREAD_CACHES
+	// blocks are cached by their exact size, in 16 byte steps up to the maximum
+	int const cms_threadCacheClassSize        = 16;
+	int const cms_threadCacheClasses          = 16;
+	int const cms_threadCacheMaximumBlockSize = cms_threadCacheClassSize * cms_threadCacheClasses;
+	int const cms_threadCacheCapacity         = 32;
+	int const cms_threadCacheBatchSize        = 16;
+
+	// Per-thread magazines.  Only the owning thread touches the magazines and the pending
+	// counters; everything else is only read or modified while holding ms_criticalSection.
+	struct ThreadCache
+	{
+		Block *         m_blocks[cms_threadCacheClasses][cms_threadCacheCapacity];
+		int             m_count[cms_threadCacheClasses];
+		ThreadCache *   m_next;
+
+		// allocation counters not yet folded into the global counters
+		int             m_allocations;
+		int             m_allocateCalls;
+		int             m_freeCalls;
+		long            m_bytesAllocated;
+		unsigned long   m_allocateBytesTotal;
+		long            m_bytesRequested;
+		long            m_bytesAllocatedNoLeakTest;
+
+		// allocations until the next allocation profile sample
+		int             m_allocationProfileCountdown;
+
+		// statistics
+		int             m_allocateHits;
+		int             m_refills;
+		int             m_freeHits;
+		int             m_drains;
+	};
+
+	// marks a thread whose cache has been removed so later allocations on it go straight to the free lists
+	ThreadCache * const   cms_threadCacheRemoved = reinterpret_cast<ThreadCache *>(1);
+#endif
+
 	bool                  ms_installed;
 	bool                  ms_limitSet;
 	bool                  ms_hardLimit;
@@ -283,6 +381,20 @@ namespace MemoryManagerNamespace
 	bool                  ms_debugLogAllocationsNextFrameStarted;
 #endif
 
+#if PRODUCTION == 0
+	bool                  ms_allocationProfileEnabled;
+	bool                  ms_debugReportAllocationProfile;
+	bool                  ms_debugSnapshotAllocationProfile;
+	int                   ms_allocationProfileSampleRate = 1;
+	int                   ms_allocationProfileCountdown;
+	int                   ms_allocationProfileSnapshots;
+	AllocationProfile     ms_allocationProfile;
+	AllocationProfile     ms_allocationProfileReport;
+	AllocationProfile     ms_allocationProfileSnapshot[2];
+	int                   ms_allocationProfileOrder[cms_allocationProfileSize];
+	int64                 ms_allocationProfileKeys[cms_allocationProfileSize];
+#endif
+
 	RecursiveMutex *      ms_criticalSection;
 
 	char                  ms_memoryManagerBuffer[sizeof(MemoryManager)];
@@ -314,6 +426,14 @@ namespace MemoryManagerNamespace
 #endif
 	unsigned long         ms_maxBytesAllocated;
 
+#if DO_THREAD_CACHES
+	ThreadCache *         ms_firstThreadCache;
+	int                   ms_threadCacheAllocateHits;
+	int                   ms_threadCacheRefills;
+	int                   ms_threadCacheFreeHits;
+	int                   ms_threadCacheDrains;
+#endif
+
 	bool                  ms_allowNameLookup = true;
 	int                   ms_logMessageFd = -1;
 	void                  (*LogMessage)(char const * message) = &outputDebugStringWrapper;
@@ -459,6 +579,24 @@ inline void Block::setFree(bool free)
 	m_free = free;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Cached blocks are allocated as far as the free lists are concerned, but
+ * are owned by a thread cache rather than by a user.
+ */
+
+inline bool Block::isCached() const
+{
+	return m_cached;
+}
+
+// ----------------------------------------------------------------------
+
+inline void Block::setCached(bool cached)
+{
+	m_cached = cached;
+}
+
 // ----------------------------------------------------------------------
 
 inline int Block::getSize() const
@@ -674,6 +812,13 @@ MemoryManager::~MemoryManager()
 
 	ms_criticalSection->enter();
 
+#if DO_THREAD_CACHES
+		// return every thread's cached blocks so they don't show up as leaks
+		OsMemory::setThreadData(cms_threadCacheRemoved);
+		while (ms_firstThreadCache)
+			destroyThreadCache(ms_firstThreadCache);
+#endif
+
 		DEBUG_REPORT_LOG_PRINT(true, ("MM::remove %lu/%lu=bytes %d/%d=allocs\n", getCurrentNumberOfBytesAllocated(), getMaximumNumberOfBytesAllocated(), getCurrentNumberOfAllocations(), getMaximumNumberOfAllocations()));
 		DEBUG_OUTPUT_CHANNEL("Foundation\\MemoryManager", ("MM::remove %lu/%lu=bytes %d/%d=allocs\n", getCurrentNumberOfBytesAllocated(), getMaximumNumberOfBytesAllocated(), getCurrentNumberOfAllocations(), getMaximumNumberOfAllocations()));
 
@@ -835,6 +980,13 @@ void MemoryManager::registerDebugFlags()
 	DebugFlags::registerFlag(ms_debugVerifyFreePatterns,               "SharedMemoryManager", "verifyFreePatterns");
 	DebugFlags::registerFlag(ms_debugProfileAllocate,                  "SharedMemoryManager", "profileAllocate");
 #endif
+
+#if PRODUCTION == 0
+	ms_allocationProfileSampleRate = std::max(1, ConfigSharedFoundation::getMemoryManagerAllocationProfileSampleRate());
+	DebugFlags::registerFlag(ms_allocationProfileEnabled,              "SharedMemoryManager", "profileAllocations",               profileAllocationsFrame);
+	DebugFlags::registerFlag(ms_debugReportAllocationProfile,          "SharedMemoryManager", "reportAllocationProfile",          reportAllocationProfileNow);
+	DebugFlags::registerFlag(ms_debugSnapshotAllocationProfile,        "SharedMemoryManager", "snapshotAllocationProfile",        snapshotAllocationProfileNow);
+#endif
 }
 
 // ----------------------------------------------------------------------
@@ -849,6 +1001,44 @@ void MemoryManager::debugReport()
 	DEBUG_REPORT_PRINT(ms_limitSet, ("MM: %9dmb (%s limit)\n", ms_limitMegabytes, ms_hardLimit ? "hard" : "soft"));
 	DEBUG_REPORT_PRINT(true,        ("MM: %9d/%9d/%9d  cur/max/tot allocs\n", ms_allocations, ms_maxAllocations, ms_allocateCalls));
 	DEBUG_REPORT_PRINT(true,        ("MM: %9lu/%9lu/%9lu  cur/max/tot bytes\n",  ms_currentBytesAllocated, ms_maxBytesAllocated, ms_allocateBytesTotal));
+
+#if DO_THREAD_CACHES
+	int threadCaches = 0;
+	int cachedBlocks = 0;
+	int allocateHits = 0;
+	int refills      = 0;
+	int freeHits     = 0;
+	int drains       = 0;
+
+	ms_criticalSection->enter();
+
+		allocateHits = ms_threadCacheAllocateHits;
+		refills      = ms_threadCacheRefills;
+		freeHits     = ms_threadCacheFreeHits;
+		drains       = ms_threadCacheDrains;
+
+		// the per-thread statistics are updated without the lock, so these are only a snapshot
+		for (ThreadCache const * threadCache = ms_firstThreadCache; threadCache; threadCache = threadCache->m_next)
+		{
+			++threadCaches;
+			for (int i = 0; i < cms_threadCacheClasses; ++i)
+				cachedBlocks += threadCache->m_count[i];
+
+			allocateHits += threadCache->m_allocateHits;
+			refills      += threadCache->m_refills;
+			freeHits     += threadCache->m_freeHits;
+			drains       += threadCache->m_drains;
+		}
+
+	ms_criticalSection->leave();
+
+	int const allocateAttempts = allocateHits + refills;
+	int const freeAttempts     = freeHits + drains;
+	DEBUG_REPORT_PRINT(true,        ("MM: %9d/%9d  thread caches/cached blocks\n", threadCaches, cachedBlocks));
+	DEBUG_REPORT_PRINT(true,        ("MM: %9d/%9d/%5.1f%%  thread cache alloc hits/refills/hit rate\n", allocateHits, refills, allocateAttempts ? (100.0f * allocateHits) / allocateAttempts : 0.0f));
+	DEBUG_REPORT_PRINT(true,        ("MM: %9d/%9d/%5.1f%%  thread cache free hits/drains/hit rate\n", freeHits, drains, freeAttempts ? (100.0f * freeHits) / freeAttempts : 0.0f));
+#endif
+
 #endif
 }
 
@@ -873,6 +1063,273 @@ void MemoryManagerNamespace::logAllocationsNextFrame()
 }
 #endif
 
+// ======================================================================
+
+#if PRODUCTION == 0
+
+inline bool SortAllocationProfileOrder::operator()(int lhs, int rhs) const
+{
+	return m_keys[lhs] > m_keys[rhs];
+}
+
+// ----------------------------------------------------------------------
+
+inline bool MemoryManagerNamespace::sampleAllocation(int & countdown)
+{
+	if (--countdown > 0)
+		return false;
+
+	countdown = ms_allocationProfileSampleRate;
+	return true;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Charge a sampled allocation to its callsite.
+ *
+ * The critical section must be held.
+ */
+
+void MemoryManagerNamespace::recordAllocationSample(uint32 owner, size_t size)
+{
+	// open addressing with linear probing; entries are never removed while the profile runs
+	uint32 const mask = static_cast<uint32>(cms_allocationProfileSize - 1);
+	uint32 index = ((owner >> 2) * 2654435761u) >> 20;
+	for (int probe = 0; probe < cms_allocationProfileSize; ++probe, ++index)
+	{
+		AllocationProfileEntry & entry = ms_allocationProfile.m_entries[index & mask];
+		if (entry.m_allocations == 0)
+		{
+			entry.m_owner = owner;
+			++ms_allocationProfile.m_callsites;
+		}
+		else if (entry.m_owner != owner)
+			continue;
+
+		entry.m_allocations += ms_allocationProfileSampleRate;
+		entry.m_bytes += static_cast<int64>(size) * ms_allocationProfileSampleRate;
+		return;
+	}
+
+	++ms_allocationProfile.m_droppedSamples;
+}
+
+// ----------------------------------------------------------------------
+
+MemoryManagerNamespace::AllocationProfileEntry const * MemoryManagerNamespace::findAllocationProfileEntry(AllocationProfile const & profile, uint32 owner)
+{
+	uint32 const mask = static_cast<uint32>(cms_allocationProfileSize - 1);
+	uint32 index = ((owner >> 2) * 2654435761u) >> 20;
+	for (int probe = 0; probe < cms_allocationProfileSize; ++probe, ++index)
+	{
+		AllocationProfileEntry const & entry = profile.m_entries[index & mask];
+		if (entry.m_allocations == 0)
+			return NULL;
+		if (entry.m_owner == owner)
+			return &entry;
+	}
+
+	return NULL;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Log the callsites that allocated the most bytes, or with a baseline, the
+ * callsites whose allocations grew the most since the baseline was taken.
+ */
+
+void MemoryManagerNamespace::reportAllocationProfile(AllocationProfile const & profile, AllocationProfile const * baseline, int count)
+{
+	int const frames = baseline ? profile.m_frames - baseline->m_frames : profile.m_frames;
+
+	char buffer[512];
+	sprintf(buffer, "MM: allocation profile%s over %d frames, 1 in %d sampled, %d callsites, %d samples dropped\n", baseline ? " change" : "", frames, ms_allocationProfileSampleRate, profile.m_callsites, profile.m_droppedSamples);
+	(*LogMessage)(buffer);
+	(*LogMessage)("         bytes  bytes/frame     allocs allocs/frame  callsite\n");
+
+	// sort the used entries by bytes, or by the bytes they gained since the baseline
+	int entries = 0;
+	for (int i = 0; i < cms_allocationProfileSize; ++i)
+	{
+		AllocationProfileEntry const & entry = profile.m_entries[i];
+		if (entry.m_allocations == 0)
+			continue;
+
+		int64 bytes = entry.m_bytes;
+		if (baseline)
+		{
+			AllocationProfileEntry const * const baselineEntry = findAllocationProfileEntry(*baseline, entry.m_owner);
+			if (baselineEntry)
+				bytes -= baselineEntry->m_bytes;
+		}
+
+		ms_allocationProfileKeys[i] = bytes;
+		ms_allocationProfileOrder[entries++] = i;
+	}
+
+	SortAllocationProfileOrder sortOrder;
+	sortOrder.m_keys = ms_allocationProfileKeys;
+	std::sort(ms_allocationProfileOrder, ms_allocationProfileOrder + entries, sortOrder);
+
+	float const frameDivisor = static_cast<float>(std::max(1, frames));
+	for (int j = 0; j < entries && j < count; ++j)
+	{
+		AllocationProfileEntry const & entry = profile.m_entries[ms_allocationProfileOrder[j]];
+		int64 const bytes = ms_allocationProfileKeys[ms_allocationProfileOrder[j]];
+		if (baseline && bytes <= 0)
+			break;
+
+		int allocations = entry.m_allocations;
+		if (baseline)
+		{
+			AllocationProfileEntry const * const baselineEntry = findAllocationProfileEntry(*baseline, entry.m_owner);
+			if (baselineEntry)
+				allocations -= baselineEntry->m_allocations;
+		}
+
+		char libName[256];
+		char fileName[256];
+		int  line = 0;
+		char callsite[300];
+		if (ms_allowNameLookup && DebugHelp::lookupAddress(entry.m_owner, libName, fileName, sizeof(fileName), line))
+		{
+			if (line >= 0)
+				sprintf(callsite, "%s(%d)", fileName, line);
+			else
+				sprintf(callsite, "%s", fileName);
+		}
+		else
+			sprintf(callsite, "unknown(0x%08X)", static_cast<unsigned int>(entry.m_owner));
+
+		sprintf(buffer, "%14.0f %12.1f %10d %12.1f  %s\n", static_cast<double>(bytes), static_cast<float>(bytes) / frameDivisor, allocations, static_cast<float>(allocations) / frameDivisor, callsite);
+		(*LogMessage)(buffer);
+	}
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManagerNamespace::profileAllocationsFrame()
+{
+	ms_criticalSection->enter();
+		++ms_allocationProfile.m_frames;
+	ms_criticalSection->leave();
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManagerNamespace::reportAllocationProfileNow()
+{
+	ms_debugReportAllocationProfile = false;
+	MemoryManager::reportAllocationProfile(ConfigSharedFoundation::getMemoryManagerAllocationProfileReportCount());
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManagerNamespace::snapshotAllocationProfileNow()
+{
+	ms_debugSnapshotAllocationProfile = false;
+	MemoryManager::snapshotAllocationProfile();
+	MemoryManager::reportAllocationProfileDifference(ConfigSharedFoundation::getMemoryManagerAllocationProfileReportCount());
+}
+
+#endif
+
+// ======================================================================
+/**
+ * Start charging allocations to the callsites that made them, clearing
+ * any earlier profile and snapshots.
+ *
+ * @param sampleRate  Only one allocation in this many is recorded
+ */
+
+void MemoryManager::startAllocationProfile(int sampleRate)
+{
+#if PRODUCTION == 0
+	DEBUG_FATAL(!ms_installed, ("not installed"));
+
+	ms_criticalSection->enter();
+
+		memset(&ms_allocationProfile, 0, sizeof(ms_allocationProfile));
+		ms_allocationProfileSnapshots = 0;
+		ms_allocationProfileSampleRate = std::max(1, sampleRate);
+		ms_allocationProfileCountdown = 0;
+		ms_allocationProfileEnabled = true;
+
+	ms_criticalSection->leave();
+#else
+	UNREF(sampleRate);
+#endif
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Stop recording allocations.  The profile is kept for reporting.
+ */
+
+void MemoryManager::stopAllocationProfile()
+{
+#if PRODUCTION == 0
+	ms_allocationProfileEnabled = false;
+#endif
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Log the callsites that allocated the most bytes since the profile started.
+ */
+
+void MemoryManager::reportAllocationProfile(int count)
+{
+#if PRODUCTION == 0
+	// report from a copy so the lock isn't held while names are looked up
+	ms_criticalSection->enter();
+		memcpy(&ms_allocationProfileReport, &ms_allocationProfile, sizeof(ms_allocationProfileReport));
+	ms_criticalSection->leave();
+
+	MemoryManagerNamespace::reportAllocationProfile(ms_allocationProfileReport, NULL, count);
+#else
+	UNREF(count);
+#endif
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Take a snapshot of the profile.  The two most recent snapshots are kept
+ * for reportAllocationProfileDifference().
+ */
+
+void MemoryManager::snapshotAllocationProfile()
+{
+#if PRODUCTION == 0
+	ms_criticalSection->enter();
+		memcpy(&ms_allocationProfileSnapshot[0], &ms_allocationProfileSnapshot[1], sizeof(ms_allocationProfileSnapshot[0]));
+		memcpy(&ms_allocationProfileSnapshot[1], &ms_allocationProfile, sizeof(ms_allocationProfileSnapshot[1]));
+		++ms_allocationProfileSnapshots;
+	ms_criticalSection->leave();
+#endif
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Log the callsites whose allocations grew the most between the last two
+ * snapshots, which is where the per-frame churn comes from.
+ */
+
+void MemoryManager::reportAllocationProfileDifference(int count)
+{
+#if PRODUCTION == 0
+	if (ms_allocationProfileSnapshots < 2)
+	{
+		(*LogMessage)("MM: allocation profile needs two snapshots to report a change\n");
+		return;
+	}
+
+	MemoryManagerNamespace::reportAllocationProfile(ms_allocationProfileSnapshot[1], &ms_allocationProfileSnapshot[0], count);
+#else
+	UNREF(count);
+#endif
+}
+
 // ----------------------------------------------------------------------
 
 void MemoryManagerNamespace::emitCharacters(char * & buffer, int blockSize, int & carryOverFree, int & carryOverUsed, int newFree, int newUsed, char const * const bufferOverrunAddress)
@@ -1179,6 +1636,350 @@ FreeBlock *MemoryManagerNamespace::searchFreeList(int blockSize)
 	return result;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Take a block of at least allocSize bytes off the free lists.
+ *
+ * The critical section must be held.  Returns NULL if the memory could
+ * not be found even after asking the OS for more.
+ *
+ * @param allocSize  Size of the block, including the header and guard bands
+ */
+
+AllocatedBlock * MemoryManagerNamespace::allocateBlock(int allocSize)
+{
+	FreeBlock * bestFreeBlock = NULL;
+	for (int tries = 0; !bestFreeBlock && tries < 2; ++tries)
+	{
+		bestFreeBlock = searchFreeList(allocSize);
+
+		// if the memory allocation failed, try to get some more memory
+		if (!bestFreeBlock)
+			allocateSystemMemory(convertBytesToMegabytesForSystemAllocation(cms_blockSize + cms_blockSize + allocSize + cms_blockSize));
+	}
+
+	if (!bestFreeBlock)
+		return NULL;
+
+	removeFromFreeList(bestFreeBlock);
+
+	// setup the allocation record
+	bestFreeBlock->setFree(false);
+	bestFreeBlock->setCached(false);
+
+	// check to see if we should subdivide this block
+	if (bestFreeBlock->getSize() > (allocSize + cms_allocatedBlockSize + cms_guardBandSize + 1 + cms_guardBandSize))
+	{
+		Block *block = reinterpret_cast<Block *>(reinterpret_cast<byte *>(bestFreeBlock) + allocSize);
+		block->setPrevious(bestFreeBlock);
+		block->setNext(bestFreeBlock->getNext());
+		block->setFree(true);
+
+		bestFreeBlock->getNext()->setPrevious(block);
+		bestFreeBlock->setNext(block);
+
+		addToFreeList(block);
+	}
+
+	return reinterpret_cast<AllocatedBlock *>(bestFreeBlock);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Return a block to the free lists, merging it with its free neighbors.
+ *
+ * The critical section must be held, and the block's memory must already
+ * have been wiped.
+ */
+
+void MemoryManagerNamespace::releaseBlock(Block * block)
+{
+	block->setFree(true);
+	block->setCached(false);
+
+	// recombine with the previous block
+	if (block->getPrevious()->isFree())
+	{
+		FreeBlock * const previous = static_cast<FreeBlock *>(block->getPrevious());
+		removeFromFreeList(previous);
+		previous->setNext(block->getNext());
+		block->getNext()->setPrevious(previous);
+
+#if DO_FREE_FILLS
+		memset(block, cms_freeFillPattern, cms_freeBlockSize);
+#endif
+		block = previous;
+	}
+
+	// recombine with the following block
+	if (block->getNext()->isFree())
+	{
+		FreeBlock * const next = static_cast<FreeBlock *>(block->getNext());
+		removeFromFreeList(next);
+		block->setNext(next->getNext());
+		next->getNext()->setPrevious(block);
+
+#if DO_FREE_FILLS
+		memset(next, cms_freeFillPattern, cms_freeBlockSize);
+#endif
+	}
+
+	addToFreeList(block);
+}
+
+// ======================================================================
+
+#if DO_THREAD_CACHES
+
+inline int MemoryManagerNamespace::getThreadCacheClass(int blockSize)
+{
+	DEBUG_FATAL(blockSize <= 0 || blockSize > cms_threadCacheMaximumBlockSize || (blockSize % cms_threadCacheClassSize) != 0, ("bad thread cache block size %d", blockSize));
+	return (blockSize / cms_threadCacheClassSize) - 1;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Get the calling thread's cache, creating it if necessary.
+ *
+ * Returns NULL if the thread should not use a cache.
+ */
+
+ThreadCache * MemoryManagerNamespace::getThreadCache()
+{
+#ifdef _DEBUG
+	// verification walks the blocks under the lock, so blocks may not change hands outside of it
+	if (ms_debugVerifyGuardPatterns || ms_debugVerifyFreePatterns)
+		return NULL;
+#endif
+
+	ThreadCache * threadCache = static_cast<ThreadCache *>(OsMemory::getThreadData());
+	if (threadCache == cms_threadCacheRemoved)
+		return NULL;
+
+	if (!threadCache)
+	{
+		ms_criticalSection->enter();
+
+			// the cache lives in a block of its own that is marked as cached so reports ignore it
+			AllocatedBlock * const block = allocateBlock((cms_allocatedBlockSize + static_cast<int>(sizeof(ThreadCache)) + 15) & ~15);
+			if (block)
+			{
+				block->setCached(true);
+
+				threadCache = reinterpret_cast<ThreadCache *>(reinterpret_cast<byte *>(block) + cms_allocatedBlockSize);
+				memset(threadCache, 0, sizeof(*threadCache));
+				threadCache->m_next = ms_firstThreadCache;
+				ms_firstThreadCache = threadCache;
+			}
+
+		ms_criticalSection->leave();
+
+		if (!threadCache)
+			return NULL;
+
+		OsMemory::setThreadData(threadCache);
+	}
+
+	return threadCache;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Fill an empty magazine with a batch of blocks from the free lists.
+ *
+ * The critical section must be held.
+ */
+
+void MemoryManagerNamespace::refillThreadCache(ThreadCache * threadCache, int classIndex, int allocSize)
+{
+	flushThreadCacheCounters(threadCache);
+	++threadCache->m_refills;
+
+	Block * * const blocks = threadCache->m_blocks[classIndex];
+	int & count = threadCache->m_count[classIndex];
+	while (count < cms_threadCacheBatchSize)
+	{
+		AllocatedBlock * const block = allocateBlock(allocSize);
+		if (!block)
+			break;
+
+		block->setCached(true);
+		blocks[count++] = block;
+	}
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Return the oldest blocks in a magazine to the free lists.
+ *
+ * The critical section must be held.
+ */
+
+void MemoryManagerNamespace::drainThreadCache(ThreadCache * threadCache, int classIndex, int count)
+{
+	flushThreadCacheCounters(threadCache);
+	++threadCache->m_drains;
+
+	Block * * const blocks = threadCache->m_blocks[classIndex];
+	int const remaining = threadCache->m_count[classIndex] - count;
+	DEBUG_FATAL(remaining < 0, ("draining more blocks than are cached"));
+
+	for (int i = 0; i < count; ++i)
+		releaseBlock(blocks[i]);
+
+	memmove(blocks, blocks + count, remaining * sizeof(Block *));
+	threadCache->m_count[classIndex] = remaining;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Put a block that is being freed into the calling thread's magazine.
+ *
+ * The user memory has already been wiped.  The critical section is only
+ * taken if the magazine is full and half of it needs to be drained.
+ */
+
+void MemoryManagerNamespace::cacheFreedBlock(ThreadCache * threadCache, AllocatedBlock * block)
+{
+	int const memorySize = block->getSize();
+
+#if DO_SCALAR
+	block->setAllocatedAsArray(false);
+#endif
+
+	--threadCache->m_allocations;
+	++threadCache->m_freeCalls;
+	threadCache->m_bytesAllocated -= memorySize;
+
+#if DO_TRACK
+	if (!block->checkForLeaks())
+		threadCache->m_bytesAllocatedNoLeakTest -= memorySize;
+	block->fillOwnerWithFreePattern();
+#endif
+
+#if DO_TRACK || DO_GUARDS
+	threadCache->m_bytesRequested -= block->getRequestedSize();
+	block->setRequestedSize(0);
+#endif
+
+	block->setCached(true);
+
+	int const classIndex = getThreadCacheClass(memorySize);
+	if (threadCache->m_count[classIndex] == cms_threadCacheCapacity)
+	{
+		ms_criticalSection->enter();
+			drainThreadCache(threadCache, classIndex, cms_threadCacheCapacity - cms_threadCacheBatchSize);
+		ms_criticalSection->leave();
+	}
+	else
+		++threadCache->m_freeHits;
+
+	threadCache->m_blocks[classIndex][threadCache->m_count[classIndex]++] = block;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Fold a thread's pending allocation counters into the global counters.
+ *
+ * The critical section must be held.
+ */
+
+void MemoryManagerNamespace::flushThreadCacheCounters(ThreadCache * threadCache)
+{
+	ms_allocations        += threadCache->m_allocations;
+	ms_allocateCalls      += threadCache->m_allocateCalls;
+	ms_freeCalls          += threadCache->m_freeCalls;
+	ms_allocateBytesTotal += threadCache->m_allocateBytesTotal;
+
+	// the deltas may be negative, so rely on unsigned wrap around
+	ms_currentBytesAllocated += static_cast<unsigned long>(threadCache->m_bytesAllocated);
+#if DO_TRACK || DO_GUARDS
+	ms_currentBytesRequested += static_cast<unsigned long>(threadCache->m_bytesRequested);
+#endif
+#if DO_TRACK
+	ms_currentBytesAllocatedNoLeakTest += static_cast<unsigned long>(threadCache->m_bytesAllocatedNoLeakTest);
+#endif
+
+	if (ms_allocations > ms_maxAllocations)
+		ms_maxAllocations = ms_allocations;
+	if (ms_currentBytesAllocated > ms_maxBytesAllocated)
+		ms_maxBytesAllocated = ms_currentBytesAllocated;
+
+	threadCache->m_allocations              = 0;
+	threadCache->m_allocateCalls            = 0;
+	threadCache->m_freeCalls                = 0;
+	threadCache->m_bytesAllocated           = 0;
+	threadCache->m_allocateBytesTotal       = 0;
+	threadCache->m_bytesRequested           = 0;
+	threadCache->m_bytesAllocatedNoLeakTest = 0;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Return all of a thread cache's blocks and the cache itself to the free lists.
+ *
+ * The critical section must be held, and the owning thread must not use the
+ * cache again.
+ */
+
+void MemoryManagerNamespace::destroyThreadCache(ThreadCache * threadCache)
+{
+	for (int i = 0; i < cms_threadCacheClasses; ++i)
+		if (threadCache->m_count[i])
+			drainThreadCache(threadCache, i, threadCache->m_count[i]);
+
+	flushThreadCacheCounters(threadCache);
+
+	ms_threadCacheAllocateHits += threadCache->m_allocateHits;
+	ms_threadCacheRefills      += threadCache->m_refills;
+	ms_threadCacheFreeHits     += threadCache->m_freeHits;
+	ms_threadCacheDrains       += threadCache->m_drains;
+
+	// unlink it
+	ThreadCache * * previous = &ms_firstThreadCache;
+	while (*previous != threadCache)
+	{
+		NOT_NULL(*previous);
+		previous = &(*previous)->m_next;
+	}
+	*previous = threadCache->m_next;
+
+	Block * const block = reinterpret_cast<Block *>(reinterpret_cast<byte *>(threadCache) - cms_allocatedBlockSize);
+#if DO_FREE_FILLS
+	imemset(threadCache, cms_freeFillPattern, block->getSize() - cms_allocatedBlockSize);
+#endif
+	releaseBlock(block);
+}
+
+#endif
+
+// ----------------------------------------------------------------------
+/**
+ * Release the calling thread's allocation cache.
+ *
+ * Threads should call this as they exit so the blocks cached for them are
+ * returned to the shared free lists.  Allocations made by the thread after
+ * this go straight to the shared free lists.
+ */
+
+void MemoryManager::removeThreadCache()
+{
+#if DO_THREAD_CACHES
+	if (!ms_installed)
+		return;
+
+	ThreadCache * const threadCache = static_cast<ThreadCache *>(OsMemory::getThreadData());
+	OsMemory::setThreadData(cms_threadCacheRemoved);
+
+	if (threadCache && threadCache != cms_threadCacheRemoved)
+	{
+		ms_criticalSection->enter();
+			destroyThreadCache(threadCache);
+		ms_criticalSection->leave();
+	}
+#endif
+}
+
 // ----------------------------------------------------------------------
 /**
  * Dynamically allocate memory.
@@ -1237,23 +2038,43 @@ void * MemoryManager::allocate(size_t size, uint32 owner, bool array, bool leakT
 	}
 #endif
 
-	ms_criticalSection->enter();
+	// get the size of the allocation
+	int allocSize = (cms_allocatedBlockSize + cms_guardBandSize + (size ? static_cast<int>(size) : 1) + cms_guardBandSize + 15) & ~15;
 
-		// get the size of the allocation
-		int allocSize = (cms_allocatedBlockSize + cms_guardBandSize + (size ? static_cast<int>(size) : 1) + cms_guardBandSize + 15) & ~15;
+	AllocatedBlock * best = NULL;
 
-		FreeBlock * bestFreeBlock = NULL;
-		for (int tries = 0; !bestFreeBlock && tries < 2; ++tries)
+#if DO_THREAD_CACHES
+	// try the calling thread's magazine first, which only needs the lock to refill it
+	ThreadCache * const threadCache = (allocSize <= cms_threadCacheMaximumBlockSize) ? getThreadCache() : NULL;
+	if (threadCache)
+	{
+		int const classIndex = getThreadCacheClass(allocSize);
+		if (threadCache->m_count[classIndex])
+			++threadCache->m_allocateHits;
+		else
 		{
-			bestFreeBlock = searchFreeList(allocSize);
+			ms_criticalSection->enter();
+				refillThreadCache(threadCache, classIndex, allocSize);
+			ms_criticalSection->leave();
+		}
 
-			// if the memory allocation failed, try to get some more memory
-			if (!bestFreeBlock)
-				allocateSystemMemory(convertBytesToMegabytesForSystemAllocation(cms_blockSize + cms_blockSize + allocSize + cms_blockSize));
+		if (threadCache->m_count[classIndex])
+		{
+			best = static_cast<AllocatedBlock *>(threadCache->m_blocks[classIndex][--threadCache->m_count[classIndex]]);
+			best->setCached(false);
 		}
+	}
+#endif
+
+	bool const locked = (best == NULL);
+	if (locked)
+	{
+		ms_criticalSection->enter();
+
+		best = allocateBlock(allocSize);
 
 		// make sure memory was available
-		if (!bestFreeBlock)
+		if (!best)
 		{
 			if (ConfigSharedFoundation::getMemoryManagerReportOnOutOfMemory())
 			{
@@ -1265,27 +2086,7 @@ void * MemoryManager::allocate(size_t size, uint32 owner, bool array, bool leakT
 			ms_criticalSection->leave();
 			FATAL(true, ("failed allocation attempt for %d (%d actual)", allocSize, size));
 		}
-
-		removeFromFreeList(bestFreeBlock);
-
-		// setup the allocation record
-		bestFreeBlock->setFree(false);
-
-		// check to see if we should subdivide this block
-		if (bestFreeBlock->getSize() > (allocSize + cms_allocatedBlockSize + cms_guardBandSize + 1 + cms_guardBandSize))
-		{
-			Block *block = reinterpret_cast<Block *>(reinterpret_cast<byte *>(bestFreeBlock) + allocSize);
-			block->setPrevious(bestFreeBlock);
-			block->setNext(bestFreeBlock->getNext());
-			block->setFree(true);
-
-			bestFreeBlock->getNext()->setPrevious(block);
-			bestFreeBlock->setNext(block);
-
-			addToFreeList(block);
-		}
-
-		AllocatedBlock * best = reinterpret_cast<AllocatedBlock *>(bestFreeBlock);
+	}
 
 #if DO_SCALAR
 		best->setAllocatedAsArray(array);
@@ -1329,27 +2130,70 @@ void * MemoryManager::allocate(size_t size, uint32 owner, bool array, bool leakT
 #endif
 #if DO_TRACK || DO_GUARDS
 		best->setRequestedSize(static_cast<int>(size));
-		ms_currentBytesRequested += size;
 		DEBUG_FATAL(best->getRequestedSize() != static_cast<int>(size), ("allocated more memory at once than the memory manager supports (%d)", (1 << Block::cms_requestedSizeBits) - 1));
 #endif
 
 		// update the size of the allocation because our block may not have been large enough to subdivide
 		allocSize = best->getSize();
 
-		// update the number of bytes allocated
-		++ms_allocateCalls;
-		ms_allocateBytesTotal += allocSize;
-		ms_currentBytesAllocated += allocSize;
+#if DO_THREAD_CACHES
+		if (!locked)
+		{
+			// the thread's counters get folded into the global ones the next time it takes the lock
+			++threadCache->m_allocations;
+			++threadCache->m_allocateCalls;
+			threadCache->m_allocateBytesTotal += allocSize;
+			threadCache->m_bytesAllocated += allocSize;
+#if DO_TRACK || DO_GUARDS
+			threadCache->m_bytesRequested += static_cast<long>(size);
+#endif
+#if DO_TRACK
+			if (!leakTest)
+				threadCache->m_bytesAllocatedNoLeakTest += allocSize;
+#endif
+		}
+		else
+#endif
+		{
+#if DO_TRACK || DO_GUARDS
+			ms_currentBytesRequested += size;
+#endif
+
+			// update the number of bytes allocated
+			++ms_allocateCalls;
+			ms_allocateBytesTotal += allocSize;
+			ms_currentBytesAllocated += allocSize;
 
 #if DO_TRACK
-		if (!leakTest)
-			ms_currentBytesAllocatedNoLeakTest += allocSize;
+			if (!leakTest)
+				ms_currentBytesAllocatedNoLeakTest += allocSize;
 #endif
 
-		if (++ms_allocations > ms_maxAllocations)
-			ms_maxAllocations = ms_allocations;
-		if (ms_currentBytesAllocated > ms_maxBytesAllocated)
-			ms_maxBytesAllocated = ms_currentBytesAllocated;
+			if (++ms_allocations > ms_maxAllocations)
+				ms_maxAllocations = ms_allocations;
+			if (ms_currentBytesAllocated > ms_maxBytesAllocated)
+				ms_maxBytesAllocated = ms_currentBytesAllocated;
+		}
+
+#if PRODUCTION == 0
+		if (ms_allocationProfileEnabled)
+		{
+#if DO_THREAD_CACHES
+			if (!locked)
+			{
+				if (sampleAllocation(threadCache->m_allocationProfileCountdown))
+				{
+					ms_criticalSection->enter();
+						recordAllocationSample(owner, size);
+					ms_criticalSection->leave();
+				}
+			}
+			else
+#endif
+			if (sampleAllocation(ms_allocationProfileCountdown))
+				recordAllocationSample(owner, size);
+		}
+#endif
 
 		// get another pointer to the memory we allocated so we can tinker with it
 		byte * memory = reinterpret_cast<byte *>(best) + cms_allocatedBlockSize + cms_guardBandSize;
@@ -1369,7 +2213,8 @@ void * MemoryManager::allocate(size_t size, uint32 owner, bool array, bool leakT
 		memset(memory+size, cms_guardFillPattern, cms_guardBandSize);
 #endif
 
-	ms_criticalSection->leave();
+	if (locked)
+		ms_criticalSection->leave();
 
 	DEBUG_REPORT_LOG_PRINT(ms_debugReportLogMemoryAllocFreePointers, ("MM::alloc %08x\n", reinterpret_cast<int>(memory)));
 
@@ -1472,14 +2317,24 @@ void MemoryManager::free(void * userPointer, bool array)
 
 	UNREF(array);
 
-	ms_criticalSection->enter();
+	AllocatedBlock * allocatedBlock = reinterpret_cast<AllocatedBlock *>(reinterpret_cast<byte *>(userPointer) - (cms_allocatedBlockSize + cms_guardBandSize));
+
+#if DO_THREAD_CACHES
+	// small blocks go back into the calling thread's magazine.  an allocated block's size can't change under us, so this is safe without the lock.
+	ThreadCache * const threadCache = (allocatedBlock->getSize() <= cms_threadCacheMaximumBlockSize) ? getThreadCache() : NULL;
+	bool const locked = (threadCache == NULL);
+#else
+	bool const locked = true;
+#endif
 
-		AllocatedBlock * allocatedBlock = reinterpret_cast<AllocatedBlock *>(reinterpret_cast<byte *>(userPointer) - (cms_allocatedBlockSize + cms_guardBandSize));
+	if (locked)
+		ms_criticalSection->enter();
 
 #if DEBUG_LEVEL == DEBUG_LEVEL_DEBUG
-		DEBUG_FATAL(allocatedBlock->getNext()->getPrevious() != allocatedBlock,                                      ("Bad free (1) %p", userPointer));
-		DEBUG_FATAL(allocatedBlock->getPrevious()->getNext() != allocatedBlock,                                      ("Bad free (2) %p", userPointer));
-		DEBUG_FATAL(allocatedBlock->isFree(),                                                                        ("Freeing already free block %p", userPointer));
+		// the neighbors may be changing on other threads unless we hold the lock
+		DEBUG_FATAL(locked && allocatedBlock->getNext()->getPrevious() != allocatedBlock,                            ("Bad free (1) %p", userPointer));
+		DEBUG_FATAL(locked && allocatedBlock->getPrevious()->getNext() != allocatedBlock,                            ("Bad free (2) %p", userPointer));
+		DEBUG_FATAL(allocatedBlock->isFree() || allocatedBlock->isCached(),                                          ("Freeing already free block %p", userPointer));
 #endif
 
 #if PRODUCTION == 0
@@ -1519,7 +2374,8 @@ void MemoryManager::free(void * userPointer, bool array)
 			if (corrupt)
 			{
 				MemoryManagerNamespace::report(allocatedBlock, false);
-				ms_criticalSection->leave();
+				if (locked)
+					ms_criticalSection->leave();
 				DEBUG_FATAL(true, ("corrupted guard pattern"));
 				return; //lint !e527 // Unreachable
 			}
@@ -1532,7 +2388,8 @@ void MemoryManager::free(void * userPointer, bool array)
 			MemoryManagerNamespace::report(allocatedBlock, false);
 			#ifdef _DEBUG
 			bool const blockArray = allocatedBlock->isAllocatedAsArray();
-			ms_criticalSection->leave();
+			if (locked)
+				ms_criticalSection->leave();
 			FATAL(true, ("allocated %s deleted %s", blockArray ? "array" : "scalar", array ? "array" : "scalar"));   //lint !e731 // Info -- Boolean argument to equal/not equal
 			#endif
 		}
@@ -1545,7 +2402,14 @@ void MemoryManager::free(void * userPointer, bool array)
 		imemset(reinterpret_cast<byte *>(allocatedBlock) + cms_allocatedBlockSize, cms_freeFillPattern, memorySize - cms_allocatedBlockSize);
 #endif
 
-		allocatedBlock->setFree(true);
+#if DO_THREAD_CACHES
+		if (!locked)
+		{
+			cacheFreedBlock(threadCache, allocatedBlock);
+			return;
+		}
+#endif
+
 #if DO_SCALAR
 		allocatedBlock->setAllocatedAsArray(false);
 #endif
@@ -1575,36 +2439,7 @@ void MemoryManager::free(void * userPointer, bool array)
 
 //		DEBUG_REPORT_LOG(ms_logEachAlloc, ("MemoryManager::free() requested_size=%d, alloc_size=%d, userPointer=%p, allocatedBlock=%p\n", requestedSize, memorySize, userPointer, allocatedBlock));
 
-		Block *block = allocatedBlock;
-
-		// recombine with the previous block
-		if (block->getPrevious()->isFree())
-		{
-			FreeBlock * const previous = static_cast<FreeBlock *>(block->getPrevious());
-			removeFromFreeList(previous);
-			previous->setNext(block->getNext());
-			block->getNext()->setPrevious(previous);
-
-#if DO_FREE_FILLS
-			memset(block, cms_freeFillPattern, cms_freeBlockSize);
-#endif
-			block = previous;
-		}
-
-		// recombine with the following block
-		if (block->getNext()->isFree())
-		{
-			FreeBlock * const next = static_cast<FreeBlock *>(block->getNext());
-			removeFromFreeList(next);
-			block->setNext(next->getNext());
-			next->getNext()->setPrevious(block);
-
-#if DO_FREE_FILLS
-			memset(next, cms_freeFillPattern, cms_freeBlockSize);
-#endif
-		}
-
-		addToFreeList(block);
+		releaseBlock(allocatedBlock);
 
 	ms_criticalSection->leave();
 #endif
@@ -1620,7 +2455,7 @@ int MemoryManagerNamespace::quickGuessIsValidPointerFromHeap(void const * userPo
 	ms_criticalSection->enter();
 		if (!result && allocatedBlock->getNext()->getPrevious() != allocatedBlock) result =  1;
 		if (!result && allocatedBlock->getPrevious()->getNext() != allocatedBlock) result =  2;
-		if (!result && allocatedBlock->isFree()) result =  3;
+		if (!result && (allocatedBlock->isFree() || allocatedBlock->isCached())) result =  3;
 	ms_criticalSection->leave();
 
 	return result;
@@ -1639,7 +2474,7 @@ int MemoryManagerNamespace::authoritativeIsValidPointerFromHeap(void const * use
 		result = 16;
 		for (SystemAllocation * systemAllocation = ms_firstSystemAllocation; systemAllocation; systemAllocation = systemAllocation->getNext())
 			for (Block * block = systemAllocation->getFirstMemoryBlock()->getNext(); result != 0 && block != systemAllocation->getLastMemoryBlock(); block = block->getNext())
-				if (!block->isFree())
+				if (!block->isFree() && !block->isCached())
 				{
 					byte const * memory = reinterpret_cast<byte const *>(block) + cms_allocatedBlockSize + cms_guardBandSize;
 					if (memory == userPointer)
@@ -1731,7 +2566,7 @@ void MemoryManager::verify(bool guardPatterns, bool freePatterns)
 #endif
 				}
 				else
-					if (guardPatterns)
+					if (guardPatterns && !block->isCached())
 					{
 #if DO_GUARDS
 						// verify the guard bands
@@ -1846,7 +2681,7 @@ int MemoryManagerNamespace::report(bool leak)
 		// search for the memory pointer
 		for (SystemAllocation * systemAllocation = ms_firstSystemAllocation; systemAllocation; systemAllocation = systemAllocation->getNext())
 			for (Block * block = systemAllocation->getFirstMemoryBlock()->getNext(); block != systemAllocation->getLastMemoryBlock(); block = block->getNext())
-				if (!block->isFree())
+				if (!block->isFree() && !block->isCached())
 				{
 #if DO_TRACK
 					if (!leak || static_cast<AllocatedBlock*>(block)->checkForLeaks())
@@ -2147,6 +2982,36 @@ void MemoryManager::report()
 
 // ----------------------------------------------------------------------
 
+void MemoryManager::startAllocationProfile(int)
+{
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManager::stopAllocationProfile()
+{
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManager::reportAllocationProfile(int)
+{
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManager::snapshotAllocationProfile()
+{
+}
+
+// ----------------------------------------------------------------------
+
+void MemoryManager::reportAllocationProfileDifference(int)
+{
+}
+
+// ----------------------------------------------------------------------
+
 void * MemoryManager::allocate(size_t size, uint32, bool, bool)
 {
 #ifdef _WIN32
@@ -22,7 +22,9 @@
 // ======================================================================
 // Memory manager class.
 //
-// This class API is multi-thread safe.
+// This class API is multi-thread safe.  Small allocations are served from
+// per-thread caches, so threads should call removeThreadCache() before they
+// exit.
 //
 // This class provides extensive debugging features for applications, including
 // overwrite guard bands, initialize pattern fills, free pattern fills, and 
@@ -60,10 +62,18 @@ public:
 	static DLLEXPORT void  own(void *pointer);
 	static void *          reallocate(void *userPointer, size_t newSize);
 
+	static void            removeThreadCache();
+
 	static void            verify(bool guardPatterns, bool freePatterns);
 	static void            setReportAllocations(bool reportAllocations);
 	static void            report();
 
+	static void            startAllocationProfile(int sampleRate);
+	static void            stopAllocationProfile();
+	static void            reportAllocationProfile(int count);
+	static void            snapshotAllocationProfile();
+	static void            reportAllocationProfileDifference(int count);
+
 private:
 
 	// disabled
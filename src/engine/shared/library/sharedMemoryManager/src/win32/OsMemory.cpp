@@ -11,14 +11,29 @@
 
 // ======================================================================
 
+namespace OsMemoryNamespace
+{
+	DWORD ms_threadDataSlot = TLS_OUT_OF_INDEXES;
+}
+using namespace OsMemoryNamespace;
+
+// ======================================================================
+
 void OsMemory::install()
 {
+	if (ms_threadDataSlot == TLS_OUT_OF_INDEXES)
+		ms_threadDataSlot = TlsAlloc();
 }
 
 // ----------------------------------------------------------------------
 
 void OsMemory::remove()
 {
+	if (ms_threadDataSlot != TLS_OUT_OF_INDEXES)
+	{
+		IGNORE_RETURN(TlsFree(ms_threadDataSlot));
+		ms_threadDataSlot = TLS_OUT_OF_INDEXES;
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -52,5 +67,28 @@ bool OsMemory::protect(void *addr, size_t bytes, bool allowAccess)
 	return result ? true : false;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Get the memory manager's per-thread data pointer for the calling thread.
+ *
+ * Returns NULL if no data has been set for this thread.
+ */
+
+void *OsMemory::getThreadData()
+{
+	if (ms_threadDataSlot == TLS_OUT_OF_INDEXES)
+		return NULL;
+
+	return TlsGetValue(ms_threadDataSlot);
+}
+
+// ----------------------------------------------------------------------
+
+void OsMemory::setThreadData(void *data)
+{
+	if (ms_threadDataSlot != TLS_OUT_OF_INDEXES)
+		IGNORE_RETURN(TlsSetValue(ms_threadDataSlot, data));
+}
+
 // ======================================================================
 
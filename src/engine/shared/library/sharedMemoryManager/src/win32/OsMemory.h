@@ -21,6 +21,9 @@ public:
 	static void * commit(void *addr, size_t bytes);
 	static bool   free(void *addr, size_t bytes);
 	static bool   protect(void *addr, size_t bytes, bool allowAccess);
+
+	static void * getThreadData();
+	static void   setThreadData(void *data);
 };
 
 // ======================================================================
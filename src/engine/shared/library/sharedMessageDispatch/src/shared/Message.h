@@ -10,6 +10,10 @@
 
 // ======================================================================
 
+#include "../../../../../../engine/shared/library/sharedFoundation/include/public/sharedFoundation/Crc.h"
+
+// ======================================================================
+
 namespace MessageDispatch
 {
 	/**
@@ -31,6 +35,7 @@ namespace MessageDispatch
 		static const unsigned long int makeMessageTypeFromString(const char * const id);
 		const unsigned long int        getType() const;
 		const bool                     isType(const char * const typeName) const;
+		const bool                     isType(const unsigned long int typeCrc) const;
 		void                           setType(const unsigned long int newType);
 		void                           setType(const char * const typeName);
 	private:
@@ -81,6 +86,18 @@ namespace MessageDispatch
 		return (makeMessageTypeFromString(typeName) == type);
 	}
 
+	//-----------------------------------------------------------------------
+	/**
+		@brief compare against an already hashed type name
+
+		Message handlers testing a literal name should pass
+		CRC_CONSTANT("name") here so the name is not hashed on every test.
+	*/
+	inline const bool MessageBase::isType(const unsigned long int typeCrc) const
+	{
+		return (typeCrc == type);
+	}
+
 	//-----------------------------------------------------------------------
 	/**
 		@brief set or reset the type identifier
@@ -7,24 +7,113 @@
 #include "sharedMessageDispatch/FirstSharedMessageDispatch.h"
 #include "sharedMessageDispatch/Transceiver.h"
 
+#include "sharedFoundation/Os.h"
+
 #include <map>
 
 namespace MessageDispatch {
 
 //-----------------------------------------------------------------------
 
+namespace TransceiverNamespace
+{
+	// messages posted by other threads, most recent first. Posting
+	// threads push with a compare-and-swap, and the main thread
+	// takes the whole list at once.
+	PostedMessage * volatile s_postedMessages = 0;
+
+	PostedMessage * compareExchangePostedMessages(PostedMessage * exchange, PostedMessage * compare);
+}
+
+using namespace TransceiverNamespace;
+
+//-----------------------------------------------------------------------
+
+PostedMessage * TransceiverNamespace::compareExchangePostedMessages(PostedMessage * exchange, PostedMessage * compare)
+{
+#if defined(PLATFORM_WIN32)
+	return static_cast<PostedMessage *>(InterlockedCompareExchangePointer(reinterpret_cast<void * volatile *>(&s_postedMessages), exchange, compare));
+#else
+	return __sync_val_compare_and_swap(&s_postedMessages, compare, exchange);
+#endif
+}
+
+//-----------------------------------------------------------------------
+
+TransceiverBase::ReceiverHandle::ReceiverHandle() :
+index(-1),
+generation(0)
+{
+}
+
+//-----------------------------------------------------------------------
+
+TransceiverBase::ReceiverTable::ReceiverTable() :
+slots(),
+freeSlots(),
+dispatchDepth(0)
+{
+}
+
+//-----------------------------------------------------------------------
+
+TransceiverBase::ReceiverHandle TransceiverBase::ReceiverTable::add(TransceiverBase * receiver)
+{
+	ReceiverHandle handle;
+
+	// a slot emptied before or during a dispatch may lie inside the
+	// range being dispatched, so only reuse slots between dispatches
+	if(dispatchDepth == 0 && !freeSlots.empty())
+	{
+		handle.index = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else
+	{
+		Slot slot;
+		slot.receiver = 0;
+		slot.generation = 0;
+
+		handle.index = static_cast<int>(slots.size());
+		slots.push_back(slot);
+	}
+
+	Slot & slot = slots[static_cast<size_t>(handle.index)];
+	slot.receiver = receiver;
+	handle.generation = slot.generation;
+	return handle;
+}
+
+//-----------------------------------------------------------------------
+
+void TransceiverBase::ReceiverTable::remove(const ReceiverHandle & handle)
+{
+	if(handle.index < 0 || handle.index >= static_cast<int>(slots.size()))
+		return;
+
+	Slot & slot = slots[static_cast<size_t>(handle.index)];
+	if(slot.receiver == 0 || slot.generation != handle.generation)
+		return;
+
+	slot.receiver = 0;
+	++slot.generation;
+	freeSlots.push_back(handle.index);
+}
+
+//-----------------------------------------------------------------------
+
 TransceiverBase::GlobalReceiverInfo::GlobalReceiverInfo() :
-receivers(),
-pendingAdds(),
-pendingRemoves(),
-locked(false)
+receivers()
 {
 }
 
 //-----------------------------------------------------------------------
 
 TransceiverBase::TransceiverBase() :
-locked(false)
+localReceivers(),
+globalReceiverInfo(0),
+sources(),
+globalHandle()
 {
 }
 
@@ -32,6 +121,31 @@ locked(false)
 
 TransceiverBase::~TransceiverBase()
 {
+	// advise anyone that this transceiver is connected to that
+	// they should NOT try to leave this transceiver's receiver
+	// table in their destructor because THIS transceiver is
+	// being destroyed
+	int const slotCount = localReceivers.getSlotCount();
+	for(int i = 0; i < slotCount; ++i)
+	{
+		TransceiverBase * const receiver = localReceivers.getReceiver(i);
+		if(receiver)
+			receiver->forgetSource(this);
+	}
+
+	// for every transceiver that this object receives messages
+	// from, empty this object's slot in their receiver table,
+	// so that they will not attempt to deliver messages to this
+	// object after it has been destroyed
+	std::vector<Connection>::const_iterator c;
+	for(c = sources.begin(); c != sources.end(); ++c)
+		c->source->localReceivers.remove(c->handle);
+
+	// remove this transceiver from the global receiver table
+	// to prevent anonymous distribution to this deleted
+	// transceiver
+	if(globalReceiverInfo)
+		globalReceiverInfo->receivers.remove(globalHandle);
 }
 
 //-----------------------------------------------------------------------
@@ -45,6 +159,128 @@ TransceiverBase::GlobalReceiverInfo & TransceiverBase::getGlobalReceiverInfo(con
 
 //-----------------------------------------------------------------------
 
+void TransceiverBase::addReceiver(TransceiverBase * target)
+{
+	// a receiver sits in a transceiver's table at most once. The
+	// target's source list is tiny (an OwnedTransceiver has one
+	// source), so this is cheaper than searching the table.
+	std::vector<Connection>::const_iterator c;
+	for(c = target->sources.begin(); c != target->sources.end(); ++c)
+	{
+		if(c->source == this)
+			return;
+	}
+
+	Connection connection;
+	connection.source = this;
+	connection.handle = localReceivers.add(target);
+	target->sources.push_back(connection);
+}
+
+//-----------------------------------------------------------------------
+
+void TransceiverBase::removeReceiver(TransceiverBase * target)
+{
+	std::vector<Connection>::iterator c;
+	for(c = target->sources.begin(); c != target->sources.end(); ++c)
+	{
+		if(c->source == this)
+		{
+			localReceivers.remove(c->handle);
+			target->sources.erase(c);
+			return;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void TransceiverBase::listenForAny()
+{
+	if(globalHandle.index < 0)
+		globalHandle = globalReceiverInfo->receivers.add(this);
+}
+
+//-----------------------------------------------------------------------
+
+void TransceiverBase::forgetSource(TransceiverBase * source)
+{
+	std::vector<Connection>::iterator c;
+	for(c = sources.begin(); c != sources.end(); ++c)
+	{
+		if(c->source == source)
+		{
+			sources.erase(c);
+			return;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------
+
+PostedMessage::PostedMessage() :
+next(0)
+{
+}
+
+//-----------------------------------------------------------------------
+
+PostedMessage::~PostedMessage()
+{
+}
+
+//-----------------------------------------------------------------------
+
+void queuePostedMessage(PostedMessage * message)
+{
+	PostedMessage * head;
+	do
+	{
+		head = s_postedMessages;
+		message->next = head;
+	}
+	while(compareExchangePostedMessages(message, head) != head);
+}
+
+//-----------------------------------------------------------------------
+
+void dispatchPostedMessages()
+{
+	DEBUG_FATAL(!Os::isMainThread(), ("dispatchPostedMessages called from a thread other than the main thread"));
+
+	// take everything posted so far. Messages posted while these
+	// are delivered wait for the next call.
+	PostedMessage * head;
+	do
+	{
+		head = s_postedMessages;
+		if(!head)
+			return;
+	}
+	while(compareExchangePostedMessages(0, head) != head);
+
+	// the list is most recent first, deliver in posting order
+	PostedMessage * ordered = 0;
+	while(head)
+	{
+		PostedMessage * const next = head->next;
+		head->next = ordered;
+		ordered = head;
+		head = next;
+	}
+
+	while(ordered)
+	{
+		PostedMessage * const message = ordered;
+		ordered = ordered->next;
+
+		message->dispatch();
+		delete message;
+	}
+}
+
+//-----------------------------------------------------------------------
+
 Callback::Callback() :
 receivers()
 {
@@ -66,4 +302,3 @@ Callback::~Callback()
 //-----------------------------------------------------------------------
 
 }//namespace MessageDispatch
-
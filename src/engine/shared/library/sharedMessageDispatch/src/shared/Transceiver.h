@@ -42,20 +42,27 @@
 	the address of a member function that is capable of receiving
 	the type of message emitted from another transceiver.
 
-	When the emitting transceiver dispatches a message, it looks
-	through a vector of receivers for direct message dispatch, then
-	delivers messages to each receiver in the list. It also maintains
-	a list of pending removes, and skips transceivers (really 
-	OwnedTransceiver objects) that have been deleted to prevent
-	dispatch to a destroyed object.
-
-	After direct dispatches are delievered, the transceiver finds
-	a "gobal" dispatch list that contains receivers that are connected
+	When the emitting transceiver dispatches a message, it walks
+	a table of receiver slots for direct message dispatch, and
+	delivers messages to each receiver in the table. A receiver
+	that is destroyed or disconnected (really OwnedTransceiver
+	objects) empties its slot, so a dispatch in progress skips it
+	rather than delivering to a destroyed object. Each receiver
+	remembers its slot and the slot's generation, which makes
+	connecting and disconnecting constant time.
+
+	After direct dispatches are delievered, the transceiver uses
+	a "gobal" receiver table that contains receivers that are connected
 	to the *type* of message this transceiver emits, rahter than this
 	transceiver specifically. The message is delivered to all recepients
-	in that global list. Like the local dispatch, the global dispatch also
-	checks for destroyed objects and skips delivery if they are no
-	longer valid.
+	in that global table, which is looked up once when the transceiver
+	is constructed. Like the local dispatch, the global dispatch also
+	skips receivers destroyed during the dispatch.
+
+	Other threads must not emit messages. They may instead post
+	a message by type with postMessage(), which is delivered like
+	the anonymous emitMessage() below when the main thread calls
+	dispatchPostedMessages().
 
 	Clients of dispatch code use to interfaces: Callback objects, which
 	are responsible for connecting object member functions to transceivers,
@@ -178,23 +185,114 @@ public:
 
 
 protected:
+	// identifies a receiver's slot in a ReceiverTable. The slot's
+	// generation advances whenever it is emptied, so a handle that
+	// outlived its receiver never matches whoever reuses the slot.
+	struct ReceiverHandle
+	{
+		ReceiverHandle();
+		int           index;
+		unsigned int  generation;
+	};
+
+	// receivers keep the slot they were given until they are removed,
+	// and removing a receiver only empties its slot. A dispatch walks
+	// the slots that existed when it started, so receivers may come
+	// and go while a message is being delivered without any pending
+	// lists: removed receivers are skipped, and receivers added during
+	// a dispatch are appended past the range being delivered to.
+	class ReceiverTable
+	{
+	public:
+		ReceiverTable();
+
+		ReceiverHandle     add(TransceiverBase * receiver);
+		void               remove(const ReceiverHandle & handle);
+
+		void               beginDispatch();
+		void               endDispatch();
+		int                getSlotCount() const;
+		TransceiverBase *  getReceiver(int index) const;
+
+	private:
+		struct Slot
+		{
+			TransceiverBase *  receiver;
+			unsigned int       generation;
+		};
+
+		std::vector<Slot>  slots;
+		std::vector<int>   freeSlots;
+		int                dispatchDepth;
+	};
+
 	struct GlobalReceiverInfo
 	{
 		GlobalReceiverInfo();
-		std::vector<TransceiverBase *>  receivers;
-		std::vector<TransceiverBase *>  pendingAdds;
-		std::vector<TransceiverBase *>  pendingRemoves;
+		ReceiverTable  receivers;
+	};
 
-		bool                            locked;
+	// a transceiver this one receives messages from, and where
+	// this one sits in that transceiver's receiver table
+	struct Connection
+	{
+		TransceiverBase *  source;
+		ReceiverHandle     handle;
 	};
 
 protected:
 	static GlobalReceiverInfo & getGlobalReceiverInfo(const type_info & typeId);
 
+	void addReceiver(TransceiverBase * target);
+	void removeReceiver(TransceiverBase * target);
+	void listenForAny();
+
 protected:
-	mutable bool locked;
+	// receivers connected directly to this transceiver
+	mutable ReceiverTable            localReceivers;
+
+	// receivers connected to any transceiver of this type, cached
+	// by the derived constructor so emits skip the type lookup
+	GlobalReceiverInfo *             globalReceiverInfo;
+
+private:
+	void forgetSource(TransceiverBase * source);
+
+private:
+	std::vector<Connection>          sources;
+	ReceiverHandle                   globalHandle;
 };
 
+//---------------------------------------------------------------------
+
+inline void TransceiverBase::ReceiverTable::beginDispatch()
+{
+	++dispatchDepth;
+}
+
+//---------------------------------------------------------------------
+
+inline void TransceiverBase::ReceiverTable::endDispatch()
+{
+	--dispatchDepth;
+}
+
+//---------------------------------------------------------------------
+
+inline int TransceiverBase::ReceiverTable::getSlotCount() const
+{
+	return static_cast<int>(slots.size());
+}
+
+//---------------------------------------------------------------------
+
+inline TransceiverBase * TransceiverBase::ReceiverTable::getReceiver(int index) const
+{
+	return slots[static_cast<size_t>(index)].receiver;
+}
+
+//---------------------------------------------------------------------
+
 template<typename MessageType, typename IdentifierType = void *>
 class Transceiver : public TransceiverBase
 {
@@ -204,7 +302,6 @@ public:
 	void emitMessage(MessageType source) const;
 protected:
 	friend class Callback;
-	void listenForAny();
 	//void listenTo(Transceiver<MessageType, IdentifierType> & source);
 	virtual void receiveMessage(MessageType) {};
 
@@ -212,28 +309,14 @@ private:
 	Transceiver(const Transceiver & source);
 	Transceiver & operator = (const Transceiver &  rhs);
 
-	void addReceiver(Transceiver * target);
-	void removeReceiver(Transceiver * target);
-
-private:
-	std::vector<Transceiver<MessageType, IdentifierType> *> localReceivers;
-	std::set<Transceiver<MessageType, IdentifierType> *> listenSet;
-
-	// bookkeeping containers and flags to permit safe usage during
-	// message emission
-	mutable std::vector<Transceiver<MessageType, IdentifierType> *> pendingAdds;
-	mutable std::vector<Transceiver<MessageType, IdentifierType> *> pendingRemoves;
+	static void dispatch(ReceiverTable & table, MessageType message);
 };
 
 //---------------------------------------------------------------------
 
 template<typename MessageType, typename IdentifierType>
 inline Transceiver<MessageType, IdentifierType>::Transceiver() :
-TransceiverBase(),
-localReceivers(),
-listenSet(),
-pendingAdds(),
-pendingRemoves()
+TransceiverBase()
 {
 	// ensure the global receiver for this type of transceiver
 	// is fully constructed before this object (which may be the
@@ -241,7 +324,7 @@ pendingRemoves()
 	// receiver info is a static with linkage in Transceiver.cpp,
 	// and should be destroyed only after ALL transceivers of this
 	// type have been destroyed.
-	getGlobalReceiverInfo(typeid(this));
+	globalReceiverInfo = &getGlobalReceiverInfo(typeid(this));
 }
 
 //---------------------------------------------------------------------
@@ -249,253 +332,44 @@ pendingRemoves()
 template<typename MessageType, typename IdentifierType>
 inline Transceiver<MessageType, IdentifierType>::~Transceiver()
 {
-	typename std::vector<Transceiver<MessageType, IdentifierType> *>::iterator i;
-	typename std::set<Transceiver<MessageType, IdentifierType> *>::iterator f;
-
-	// advise anyone that this transceiver is connected to that
-	// they should NOT call removeReceiver in their destructor
-	// because THIS transceiver is being destroyed
-	for(i = localReceivers.begin(); i != localReceivers.end(); ++i)
-	{
-		// find this receiver on the other transceiver's
-		// listen set
-		f = (*i)->listenSet.find(this);
-
-		// if it's found, remove this receiver from the listenSet
-		if(f != (*i)->listenSet.end())
-			(*i)->listenSet.erase(f);
-	}
-
-	// for every transceiver that this object receives messages
-	// from, remove thiis object from their distribution
-	// list, so that they will not attempt to deliver 
-	// messages to this object after it has been destroyed
-	for(f = listenSet.begin(); f != listenSet.end(); ++f)
-	{
-		(*f)->removeReceiver(this);
-	}
-	
-
-	// remove this transceiver from the global receiver list
-	// to prevent anonymous distribution to this delieted
-	// transceiver
-	GlobalReceiverInfo & info = getGlobalReceiverInfo(typeid(this));
-	std::vector<TransceiverBase *>::iterator g;
-	if(info.locked == false)
-	{
-		g = std::find(info.receivers.begin(), info.receivers.end(), this);
-		if(g != info.receivers.end())
-			info.receivers.erase(g);
-	}
-	else
-	{
-		// the global transceiver list is busy dispatching
-		// a message that this transceiver may receive, put
-		// it on the global pending remove list, which is
-		// checked during message dispatch
-		info.pendingRemoves.push_back(this);
-	}
-}
-
-//-----------------------------------------------------------------------
-
-template<typename MessageType, typename IdentifierType>
-inline void Transceiver<MessageType, IdentifierType>::addReceiver(Transceiver<MessageType, IdentifierType> * target)
-{
-	// do not add a transceiver to the receiver list if this transceiver
-	// is busy dispatching a message. 
-	if(locked)
-	{
-		pendingAdds.push_back(target);
-	}
-	else
-	{
-		typename std::vector<Transceiver<MessageType, IdentifierType> *>::const_iterator f = std::find(localReceivers.begin(), localReceivers.end(), target);
-		if(f == localReceivers.end())
-		{
-			localReceivers.push_back(target);
-			target->listenSet.insert(this);
-		}
-	}
+	// TransceiverBase disconnects this transceiver from its sources,
+	// its receivers and the global receiver list
 }
 
 //---------------------------------------------------------------------
 
 template<typename MessageType, typename IdentifierType>
-inline void Transceiver<MessageType, IdentifierType>::emitMessage(MessageType message) const
+inline void Transceiver<MessageType, IdentifierType>::dispatch(ReceiverTable & table, MessageType message)
 {
-	
-	//-----------------------------------------------------------------------
-	// set our status to locked so that adds to this receiver do not touch
-	// the localReceiverSet and put it in an undefined state.
-	// See Transceiver::addReceiver for information on the locked flag
-	locked = true;
-
-	// iterate through direct connections to this Transceiver
-	typename std::vector<Transceiver<MessageType, IdentifierType> *>::const_iterator i;
-
-	// which dispatch loop will we run?
-		// fast dispatch
-	for(i = localReceivers.begin(); i != localReceivers.end(); ++i)
-	{
-		// quick and easy check.
-		// if no removes have been posted as a result of the
-		// last dispatch, simply deliver the message
-		if(pendingRemoves.empty())
-		{
-			(*i)->receiveMessage(message);
-		}
-		else
-		{
-			// it might not be safe, because a transceiver requested a removal. This
-			// can happen when the owner object of the transceiver has
-			// deleted itself. Just skip this target and clean up the
-			// removal at the end of emitMessage.
-			if(std::find(pendingRemoves.begin(), pendingRemoves.end(), (*i)) != pendingRemoves.end())
-				continue;
-
-			(*i)->receiveMessage(message);
-		}
-	}
-	locked = false;
-	//-----------------------------------------------------------------------
-
-	
-	//-----------------------------------------------------------------------
-	// lock the global receiver set to prevent
-	// unsafe add/remove calls to it while dispatching this message.
-	GlobalReceiverInfo & info = getGlobalReceiverInfo(typeid(const_cast<Transceiver<MessageType, IdentifierType> *>(this)));
-	info.locked = true;
-	std::vector<TransceiverBase *>::iterator g;
-	for(g = info.receivers.begin(); g != info.receivers.end(); ++g)
-	{
-		// quick and easy check.
-		// if no removes have been posted as a result of the
-		// last dispatch, simply deliver the message
-		if(pendingRemoves.empty())
-		{
-			Transceiver<MessageType, IdentifierType> * t = static_cast<Transceiver<MessageType, IdentifierType> *>((*g));
-			t->receiveMessage(message);
-		}
-		else
-		{
-			// it might not be safe, because a transceiver requested a removal. This
-			// can happen when the owner object of the transceiver has
-			// deleted itself. Just skip this target and clean up the
-			// removal at the end of emitMessage.
-			if(std::find(info.pendingRemoves.begin(), info.pendingRemoves.end(), (*g)) != info.pendingRemoves.end())
-				continue;
-
-			Transceiver<MessageType, IdentifierType> * t = static_cast<Transceiver<MessageType, IdentifierType> *>((*g));
-			t->receiveMessage(message);
-		}
-	}
-	info.locked = false;
-	//-----------------------------------------------------------------------
-
-	// process local connections to this transceiver
-	if(! pendingAdds.empty())
-	{
-		for(i = pendingAdds.begin(); i != pendingAdds.end(); ++i)
-		{
-			// place the pending transceive ron the receiver list
-			const_cast<Transceiver<MessageType, IdentifierType> *>(this)->addReceiver(*i);
-		}
-		pendingAdds.clear();
-	}
-	
-	// a transceiver directly connected to this object was destroyed or
-	// disconnected during the message dispatch. Remove it from the
-	// list of receivers to ensure messages aren't delivered to the target
-	// and that it will not receive a notification during the destruction
-	// of THIS transceiver
-	if(! pendingRemoves.empty())
-	{
-		typename std::vector<Transceiver<MessageType, IdentifierType> *>::const_iterator a;;
-		for(a = pendingRemoves.begin(); a != pendingRemoves.end(); ++a)
-		{
-			const_cast<Transceiver<MessageType, IdentifierType> *>(this)->removeReceiver(*a);
-		}
-		pendingRemoves.clear();
+	// only the slots present now receive this message. The table
+	// is re-read every iteration because a receiver may remove
+	// itself or others, or add receivers (growing the table),
+	// from inside receiveMessage.
+	table.beginDispatch();
+
+	int const slotCount = table.getSlotCount();
+	for(int i = 0; i < slotCount; ++i)
+	{
+		TransceiverBase * const receiver = table.getReceiver(i);
+		if(receiver)
+			static_cast<Transceiver<MessageType, IdentifierType> *>(receiver)->receiveMessage(message);
 	}
 
-	// perform the same add/remove logic for the global receiver info
-	if(! info.pendingAdds.empty())
-	{
-		std::vector<TransceiverBase *>::const_iterator addIter;
-		for(addIter = info.pendingAdds.begin(); addIter != info.pendingAdds.end(); ++addIter)
-		{
-			Transceiver<MessageType, IdentifierType> * t = static_cast<Transceiver<MessageType, IdentifierType> *>((*addIter));
-			t->listenForAny();
-		}
-		info.pendingAdds.clear();
-	}
-
-	if(! info.pendingRemoves.empty())
-	{
-		std::vector<TransceiverBase *>::const_iterator removeIter;
-		for(removeIter = info.pendingRemoves.begin(); removeIter != info.pendingRemoves.end(); ++removeIter)
-		{
-			std::vector<TransceiverBase *>::iterator r = std::find(info.receivers.begin(), info.receivers.end(), *removeIter);
-			if(r != info.receivers.end())
-				info.receivers.erase(r);
-		}
-		info.pendingRemoves.clear();
-	}
+	table.endDispatch();
 }
 
 //---------------------------------------------------------------------
 
 template<typename MessageType, typename IdentifierType>
-inline void Transceiver<MessageType, IdentifierType>::listenForAny()
-{
-	GlobalReceiverInfo & info = getGlobalReceiverInfo(typeid(this));
-
-	// if the global receiver info is not locked, then it is not
-	// busy dispatching an anonymous message and it is safe to
-	// add this transceiver directly to the list of listeners
-	if(! info.locked)
-	{
-		std::vector<TransceiverBase *>::const_iterator f = std::find(info.receivers.begin(), info.receivers.end(), this);
-		if(f == info.receivers.end())
-			info.receivers.push_back(this);
-	}
-	else
-	{
-		// another transceiver of this type is performing
-		// operations on the global receiver set. Adds will
-		// be processed by that transceiver when it is done
-		// working with the global receiver list
-		info.pendingAdds.push_back(this);
-	}
-}
-
-//-----------------------------------------------------------------------
-
-template<typename MessageType, typename IdentifierType>
-inline void Transceiver<MessageType, IdentifierType>::removeReceiver(Transceiver<MessageType, IdentifierType> * target)
+inline void Transceiver<MessageType, IdentifierType>::emitMessage(MessageType message) const
 {
-	if(locked)
-	{
-		// this transceiver is busy dispatching messages. Do not invalidate 
-		// the receiver list by erasing a member while this object is 
-		// iterating through it to dispatch. The remove list, if it is
-		// not empty, will be checked to see if the target transceiver
-		// is listed, and messages will not be dispatched to it.
-		pendingRemoves.push_back(target);
-	}
-	else
-	{
-		// it is safe to directly remove the target transceiver from the 
-		// receiver list.
-		typename std::vector<Transceiver<MessageType, IdentifierType> *>::iterator f = std::find(localReceivers.begin(), localReceivers.end(), target);
-		if(f != localReceivers.end())
-			localReceivers.erase(f);
-	}
+	// deliver to direct connections to this transceiver first,
+	// then to everyone listening for this type of message
+	dispatch(localReceivers, message);
+	dispatch(globalReceiverInfo->receivers, message);
 }
 
 //---------------------------------------------------------------------
-
 /**
 	An OwnedTransceiver is a helper/interface class that links end-point
 	objects, Callback objects and transceivers. The abstraction is 
@@ -664,6 +538,89 @@ void emitMessage(MessageType m)
 	t.emitMessage(m);
 }
 
+//-----------------------------------------------------------------------
+
+/**
+	A message posted from another thread. Posted messages are kept
+	on a lock-free list until the main thread delivers them.
+*/
+class PostedMessage
+{
+public:
+	PostedMessage();
+	virtual ~PostedMessage();
+
+	virtual void dispatch() = 0;
+
+private:
+	PostedMessage(const PostedMessage &);
+	PostedMessage & operator = (const PostedMessage &);
+
+private:
+	friend void queuePostedMessage(PostedMessage * message);
+	friend void dispatchPostedMessages();
+	PostedMessage * next;
+};
+
+void queuePostedMessage(PostedMessage * message);
+void dispatchPostedMessages();
+
+//-----------------------------------------------------------------------
+
+// posted messages hold a copy of the message, since the poster's
+// reference is long gone by the time the main thread delivers it
+template<typename MessageType>
+struct PostedMessageStorage
+{
+	typedef MessageType Type;
+};
+
+template<typename MessageType>
+struct PostedMessageStorage<const MessageType &>
+{
+	typedef MessageType Type;
+};
+
+template<typename MessageType>
+struct PostedMessageStorage<MessageType &>
+{
+	typedef MessageType Type;
+};
+
+//-----------------------------------------------------------------------
+
+template<typename MessageType>
+class TypedPostedMessage : public PostedMessage
+{
+public:
+	explicit TypedPostedMessage(MessageType m) :
+	PostedMessage(),
+	message(m)
+	{
+	}
+
+	virtual void dispatch()
+	{
+		emitMessage<MessageType>(message);
+	}
+
+private:
+	typename PostedMessageStorage<MessageType>::Type message;
+};
+
+//-----------------------------------------------------------------------
+
+/**
+	Post a message from any thread for delivery on the main thread
+	to everyone listening for MessageType. Name MessageType explicitly
+	when receivers take a reference, e.g. postMessage<const Foo &>(foo).
+*/
+template<typename MessageType>
+void postMessage(MessageType m)
+{
+	queuePostedMessage(new TypedPostedMessage<MessageType>(m));
+}
+
 //-----------------------------------------------------------------------
 }//namespace MessageDispatch
 
@@ -9,6 +9,7 @@
 #include "sharedNetwork/FirstSharedNetwork.h"
 #include "UdpLibraryMT.h"
 #include "Events.h"
+#include "sharedDebug/Profiler.h"
 #include "sharedFoundation/Clock.h"
 #include "sharedFoundation/Os.h"
 #include "sharedLog/Log.h"
@@ -136,6 +137,8 @@ void UdpLibraryMT::mainThreadUpdate()
 void UdpLibraryMT::networkThreadUpdate()
 {
 	// update from network thread - process outgoing events, then give time to the UdpManagers
+	PROFILER_AUTO_BLOCK_DEFINE("UdpLibraryMT::networkThreadUpdate");
+
 #ifdef _DEBUG
 	unsigned long const lockStart = Clock::timeMs();
 #endif
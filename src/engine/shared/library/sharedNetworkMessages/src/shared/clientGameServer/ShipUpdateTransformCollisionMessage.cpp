@@ -14,7 +14,7 @@
 
 // ======================================================================
 
-static ConstCharCrcString s_shipUpdateTransformCollisionMessageName("ShipUpdateTransformCollisionMessage");
+static ConstCharCrcString s_shipUpdateTransformCollisionMessageName(CONST_CHAR_CRC_STRING("ShipUpdateTransformCollisionMessage"));
 
 // ======================================================================
 
@@ -12,7 +12,7 @@
 
 // ======================================================================
 
-static ConstCharCrcString s_shipUpdateTransformMessageName("ShipUpdateTransformMessage");
+static ConstCharCrcString s_shipUpdateTransformMessageName(CONST_CHAR_CRC_STRING("ShipUpdateTransformMessage"));
 
 // ======================================================================
 
@@ -517,7 +517,8 @@ AppearanceTemplate *AppearanceTemplateListNamespace::create(const char *const fi
 		if (iter == ms_redirectorMap.end())
 		{
 			//-- extract the real name from the apt
-			Iff iff(fileName);
+			Iff iff;
+			IGNORE_RETURN(iff.openReadOnly(fileName));
 			iff.enterForm(TAG_APT);
 				iff.enterForm(TAG_0000);
 					iff.enterChunk(TAG_NAME);
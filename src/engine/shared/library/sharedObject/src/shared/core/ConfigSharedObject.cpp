@@ -34,6 +34,8 @@ namespace ConfigSharedObjectNamespace
 	bool  ms_validateWorld;
 
 	int   ms_alterSchedulerNoAlterScheduleDelay;
+	bool  ms_alterSchedulerUseTimingWheel;
+	int   ms_alterSchedulerParallelAlterThreads;
 
 	bool  ms_logCustomizationDataIssues;
 
@@ -62,6 +64,8 @@ void ConfigSharedObject::install()
 	KEY_BOOL  ("SharedObject",                logCustomizationDataIssues,         false);
 
 	KEY_INT   ("SharedObject/AlterScheduler", alterSchedulerNoAlterScheduleDelay, 0);
+	KEY_BOOL  ("SharedObject/AlterScheduler", alterSchedulerUseTimingWheel,       false);
+	KEY_INT   ("SharedObject/AlterScheduler", alterSchedulerParallelAlterThreads, 0);
 
 	KEY_BOOL  ("SharedObject",                debugAlterChecking,                 false);
 
@@ -129,6 +133,29 @@ int ConfigSharedObject::getAlterSchedulerNoAlterScheduleDelay ()
 	return ms_alterSchedulerNoAlterScheduleDelay;
 }
 
+// ----------------------------------------------------------------------
+/**
+ * If true, the alter scheduler keeps future alters in a hierarchical
+ * timing wheel instead of a sorted map.  Read once at install time.
+ */
+
+bool ConfigSharedObject::getAlterSchedulerUseTimingWheel ()
+{
+	return ms_alterSchedulerUseTimingWheel;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * The number of worker threads the alter scheduler uses to alter objects
+ * flagged as safe to alter off the main thread.  Zero alters everything
+ * on the main thread.  Read once at install time.
+ */
+
+int ConfigSharedObject::getAlterSchedulerParallelAlterThreads ()
+{
+	return ms_alterSchedulerParallelAlterThreads;
+}
+
 // ----------------------------------------------------------------------
 
 bool ConfigSharedObject::getLogCustomizationDataIssues ()
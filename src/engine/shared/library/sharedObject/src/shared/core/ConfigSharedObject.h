@@ -26,6 +26,8 @@ public:
 	static bool  getValidateWorld ();
 
 	static int   getAlterSchedulerNoAlterScheduleDelay ();
+	static bool  getAlterSchedulerUseTimingWheel ();
+	static int   getAlterSchedulerParallelAlterThreads ();
 
 	static bool  getLogCustomizationDataIssues ();
 
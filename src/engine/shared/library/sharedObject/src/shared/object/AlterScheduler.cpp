@@ -10,15 +10,21 @@
 #include "sharedObject/AlterScheduler.h"
 
 #include "sharedDebug/DebugFlags.h"
+#include "sharedDebug/PerformanceTimer.h"
 #include "sharedDebug/Profiler.h"
 #include "sharedFoundation/CrashReportInformation.h"
 #include "sharedFoundation/ExitChain.h"
 #include "sharedFoundation/MemoryBlockManager.h"
 #include "sharedFoundation/MemoryBlockManagerMacros.h"
+#include "sharedFoundation/Os.h"
 #include "sharedObject/AlterResult.h"
 #include "sharedObject/ConfigSharedObject.h"
 #include "sharedObject/Object.h"
+#include "sharedSynchronization/InterlockedInteger.h"
 #include "sharedSynchronization/Mutex.h"
+#include "sharedSynchronization/Semaphore.h"
+#include "sharedThread/RunThread.h"
+#include "sharedThread/ThreadHandle.h"
 
 #include <algorithm>
 #include <list>
@@ -50,6 +56,9 @@ using std::type_info;
 #define OBJECT_SCHEDULE_TIME_MAP_ITERATOR(objectReference) \
 	*(static_cast<AlterScheduler::ScheduleTimeMap::iterator*>((objectReference).getScheduleTimeMapIterator()))
 
+#define OBJECT_TIMING_WHEEL_ENTRY(objectReference) \
+	*(static_cast<AlterScheduler::TimingWheelEntry*>((objectReference).getScheduleTimingWheelEntry()))
+
 #if AS_USE_HARDCORE_CONTAINER_VALIDATION
 #  define DO_ON_HARDCORE_VALIDATION(op) op
 #else
@@ -72,8 +81,9 @@ using std::type_info;
 
 namespace AlterSchedulerNamespace
 {
-	typedef AlterScheduler::ScheduleTime     ScheduleTime;
-	typedef AlterScheduler::ScheduleTimeMap  ScheduleTimeMap;
+	typedef AlterScheduler::ScheduleTime      ScheduleTime;
+	typedef AlterScheduler::ScheduleTimeMap   ScheduleTimeMap;
+	typedef AlterScheduler::TimingWheelEntry  TimingWheelEntry;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -108,6 +118,8 @@ namespace AlterSchedulerNamespace
 	typedef std::map<Object*, ObjectInfo*>  ObjectInfoMap;
 	typedef std::set<Object*>               ObjectSet;
 	typedef std::list<Object*>              ObjectList;
+	typedef AlterScheduler::ObjectVector    ObjectVector;
+	typedef std::vector<float>              FloatVector;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -115,6 +127,23 @@ namespace AlterSchedulerNamespace
 	float const  cs_secondsPerSchedulerTick = 1.0f / cs_schedulerTicksPerSecond;
 
 	uint32 const cs_freeFillPattern         = 0xEFEFEFEF; // this should match MemoryManager's free fill pattern.
+
+	// The timing wheel keeps one slot per tick for the current 256-tick block at level 0, and each
+	// higher level covers 256 times the span of the level below it.  Alters further out than the top
+	// level stay in s_scheduleMap until the wheel reaches them.  The extra slot at the end holds
+	// alters that are already due.
+	int const    cs_timingWheelSlotBits      = 8;
+	int const    cs_timingWheelSlotsPerLevel = 1 << cs_timingWheelSlotBits;
+	int const    cs_timingWheelLevelCount    = 4;
+	int const    cs_timingWheelDueSlot       = cs_timingWheelLevelCount * cs_timingWheelSlotsPerLevel;
+	int const    cs_timingWheelSlotCount     = cs_timingWheelDueSlot + 1;
+	int const    cs_timingWheelOverflowSlot  = -2;
+
+	// Objects flagged as alter-thread-safe are altered by the alter threads and the main thread
+	// together.  Each thread claims the next chunk of objects from a shared counter, so threads
+	// that finish early keep taking work until none is left.
+	int const    cs_maximumNumberOfAlterThreads = 8;
+	int const    cs_parallelAlterChunkSize      = 16;
 	
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -128,6 +157,7 @@ namespace AlterSchedulerNamespace
 	float                               s_schedulerElapsedTime;
 	int                                 s_objectsAltered;
 	int                                 s_objectsNotAltered;
+	int                                 s_objectsLeftSchedule;
 	bool                                s_report;
 	bool                                s_suspendExecution;
 	bool                                s_alwaysAlter;
@@ -162,6 +192,32 @@ namespace AlterSchedulerNamespace
 
 	ScheduleTimeMap                     s_scheduleMap;  // Sorted by next alter time for efficient scheduling.
 
+	bool                                s_useTimingWheel;
+	ScheduleTime                        s_timingWheelTime;  // Everything due at or before this time has been taken out of the wheel.
+	uint64                              s_timingWheelSequence;
+	Object                             *s_timingWheelSlots[cs_timingWheelSlotCount];
+	int                                 s_timingWheelLevelEntryCounts[cs_timingWheelLevelCount + 1];
+	ObjectVector                        s_timingWheelDueObjects;
+	ObjectVector                        s_timingWheelCascadeObjects;
+
+	int                                 s_numberOfAlterThreads;
+	ThreadHandle                        s_alterThreadHandles[cs_maximumNumberOfAlterThreads];
+	Semaphore                           s_alterThreadWorkPending;
+	Semaphore                           s_alterThreadWorkComplete;
+	InterlockedInteger                  s_parallelAlterNextChunk;
+	bool volatile                       s_alterThreadsQuit;
+	bool                                s_disableParallelAlter;
+	bool                                s_parallelAlterInProgress;
+	ObjectVector                        s_parallelAlterObjects;
+	FloatVector                         s_parallelAlterElapsedTimes;
+	FloatVector                         s_parallelAlterResults;
+
+	// Frame time breakdown for the most recent frame, in seconds.
+	int                                 s_objectsAlteredInParallel;
+	float                               s_serialAlterTime;
+	float                               s_parallelAlterTime;
+	float                               s_concludeTime;
+
 	AlterScheduler::PostAlterHookFunction s_postAlterHookFunction;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -188,6 +244,9 @@ namespace AlterSchedulerNamespace
 #endif
 
 	void  incrementSchedulerTimerByElapsedTime(float schedulerElapsedTime);
+
+	int   getTimingWheelSlotLevel(int slot);
+	int   getTimingWheelEntryCount();
 }
 
 using namespace AlterSchedulerNamespace;
@@ -237,6 +296,35 @@ char const *AlterSchedulerNamespace::ObjectInfo::getObjectTemplateName() const
 	return m_objectTemplateName;
 }
 
+// ======================================================================
+// class AlterScheduler::TimingWheelOrder
+// ======================================================================
+
+/**
+ * Orders objects taken from the timing wheel the same way the schedule
+ * map orders them: by schedule time, then by the order they were scheduled.
+ */
+
+class AlterScheduler::TimingWheelOrder
+{
+public:
+
+	bool operator()(Object *lhs, Object *rhs) const;
+};
+
+// ----------------------------------------------------------------------
+
+bool AlterScheduler::TimingWheelOrder::operator()(Object *lhs, Object *rhs) const
+{
+	TimingWheelEntry const &lhsEntry = getTimingWheelEntry(*lhs);
+	TimingWheelEntry const &rhsEntry = getTimingWheelEntry(*rhs);
+
+	if (lhsEntry.scheduleTime != rhsEntry.scheduleTime)
+		return lhsEntry.scheduleTime < rhsEntry.scheduleTime;
+
+	return lhsEntry.sequence < rhsEntry.sequence;
+}
+
 // ======================================================================
 // Namespace AlterSchedulerNamespace functions
 // ======================================================================
@@ -271,8 +359,18 @@ void AlterSchedulerNamespace::reportPrint()
 {
 	DEBUG_REPORT_PRINT(true, ("AlterScheduler: elapsed time:                  [%.3f]\n", s_schedulerElapsedTime));
 	DEBUG_REPORT_PRINT(true, ("AlterScheduler: internal time:                 [%d].\n", static_cast<int>(s_currentTime)));
-	DEBUG_REPORT_PRINT(true, ("AlterScheduler: scheduler map entry count:     [%d].\n", static_cast<int>(s_scheduleMap.size())));
+	DEBUG_REPORT_PRINT(true, ("AlterScheduler: scheduled object count:        [%d].\n", AlterScheduler::getNumberOfScheduledObjects()));
+	if (s_useTimingWheel)
+		DEBUG_REPORT_PRINT(true, ("AlterScheduler: timing wheel/overflow count:   [%d/%d].\n", getTimingWheelEntryCount(), static_cast<int>(s_scheduleMap.size())));
 	DEBUG_REPORT_PRINT(true, ("AlterScheduler: most recent frame alter count: [%d].\n", s_objectsAltered));
+	DEBUG_REPORT_PRINT(true, ("AlterScheduler: most recent frame wake count:  [%d].\n", s_objectsLeftSchedule));
+	if (s_numberOfAlterThreads > 0)
+	{
+		DEBUG_REPORT_PRINT(true, ("AlterScheduler: alter threads:                 [%d]%s.\n", s_numberOfAlterThreads, s_disableParallelAlter ? " (disabled)" : ""));
+		DEBUG_REPORT_PRINT(true, ("AlterScheduler: thread-safe objects:           [%d].\n", Object::getNumberOfAlterThreadSafeObjects()));
+		DEBUG_REPORT_PRINT(true, ("AlterScheduler: most recent frame parallel:    [%d].\n", s_objectsAlteredInParallel));
+	}
+	DEBUG_REPORT_PRINT(true, ("AlterScheduler: serial/parallel/conclude ms:   [%.3f/%.3f/%.3f].\n", s_serialAlterTime * 1000.0f, s_parallelAlterTime * 1000.0f, s_concludeTime * 1000.0f));
 }
 
 // ----------------------------------------------------------------------
@@ -544,6 +642,24 @@ void AlterSchedulerNamespace::incrementSchedulerTimerByElapsedTime(float schedul
 	}
 }
 
+// ----------------------------------------------------------------------
+
+int AlterSchedulerNamespace::getTimingWheelSlotLevel(int slot)
+{
+	return slot / cs_timingWheelSlotsPerLevel;
+}
+
+// ----------------------------------------------------------------------
+
+int AlterSchedulerNamespace::getTimingWheelEntryCount()
+{
+	int count = 0;
+	for (int level = 0; level <= cs_timingWheelLevelCount; ++level)
+		count += s_timingWheelLevelEntryCounts[level];
+
+	return count;
+}
+
 // ======================================================================
 // class AlterScheduler: PUBLIC STATIC
 // ======================================================================
@@ -557,6 +673,10 @@ void AlterScheduler::install()
 		
 	ObjectInfo::install();
 
+	//-- The schedule representation can't change once objects have been scheduled.
+	s_useTimingWheel = ConfigSharedObject::getAlterSchedulerUseTimingWheel();
+	s_timingWheelTime = s_currentTime;
+
 	for (int i = 0; i < AS_MAX_SCHEDULE_PHASE_COUNT; ++i)
 	{
 		s_alterNextFrameListFirst[i] = new Object;
@@ -583,6 +703,8 @@ void AlterScheduler::install()
 	DO_ON_DEBUG( DebugFlags::registerFlag(s_logAddRemove, "SharedObject/AlterScheduler", "logAddRemove") );
 
 	ExitChain::add(remove, "AlterScheduler");
+
+	installAlterThreads();
 }
 
 // ----------------------------------------------------------------------
@@ -623,6 +745,9 @@ bool AlterScheduler::removeObject(Object &object)
 	bool result = false;
 
 	PROFILER_AUTO_BLOCK_DEFINE("AlterScheduler::removeObject");
+
+	//-- Drop any alter result a worker thread produced for the object this phase.
+	object.clearParallelAlterResult();
 	
 	//-- Remove object from each of the alter scheduler lists.
 	if (object.isInAlterNowList())
@@ -643,13 +768,8 @@ bool AlterScheduler::removeObject(Object &object)
 		result = true;
 	}
 
-	ScheduleTimeMap::iterator &mapIt = OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object);
-	if (mapIt != s_scheduleMap.end())
-	{
-		s_scheduleMap.erase(mapIt);
-		mapIt = s_scheduleMap.end();
+	if (removeFromScheduleMap(object))
 		result = true;
-	}
 
 	DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(AlterScheduler::findObjectInScheduleTimeMap(&object), ("removeObject(): object shouldn't be in map but is: pointer=[%p],id=[%s],template=[%s].", &object, object.getNetworkId().getValueString().c_str(), object.getObjectTemplateName())) );
 
@@ -787,6 +907,14 @@ bool AlterScheduler::findObjectInScheduleTimeMap(Object const *object)
 		if (it->second == object)
 			return true;
 
+	if (s_useTimingWheel)
+	{
+		for (int slot = 0; slot < cs_timingWheelSlotCount; ++slot)
+			for (Object *searchObject = s_timingWheelSlots[slot]; searchObject != NULL; searchObject = getTimingWheelEntry(*searchObject).next)
+				if (searchObject == object)
+					return true;
+	}
+
 	return false;
 }
 
@@ -981,6 +1109,39 @@ void AlterScheduler::validateScheduleTimeMap()
 		}
 	}
 
+	if (s_useTimingWheel)
+	{
+		int levelEntryCounts[cs_timingWheelLevelCount + 1];
+		memset(levelEntryCounts, 0, sizeof(levelEntryCounts));
+
+		for (int slot = 0; slot < cs_timingWheelSlotCount; ++slot)
+		{
+			Object *previousObject = NULL;
+			for (Object *object = s_timingWheelSlots[slot]; object != NULL; object = getTimingWheelEntry(*object).next)
+			{
+				DO_ON_VALIDATE_OBJECTS(validateObject(object));
+
+				TimingWheelEntry const &entry = getTimingWheelEntry(*object);
+				DEBUG_FATAL(entry.slot != slot, ("validateScheduleTimeMap(): timing wheel object pointer=[%p] is in slot [%d] but its entry says [%d].", object, slot, entry.slot));
+				DEBUG_FATAL(entry.previous != previousObject, ("validateScheduleTimeMap(): timing wheel reverse linkage check failed for object pointer=[%p].", object));
+				DEBUG_FATAL(getTimingWheelSlot(entry.scheduleTime) != slot, ("validateScheduleTimeMap(): timing wheel object pointer=[%p] scheduled for [%d] is in slot [%d], expected [%d].", object, static_cast<int>(entry.scheduleTime), slot, getTimingWheelSlot(entry.scheduleTime)));
+
+				std::pair<ObjectSet::iterator, bool> result = objectSet.insert(object);
+				if (!result.second)
+				{
+					DEBUG_WARNING(true, ("validateAlterScheduleTimeMap(): failed, object appears multiple times: pointer=[%p], object id=[%s], object template=[%s].", object, object->getNetworkId().getValueString().c_str(), object->getObjectTemplateName()));
+					++duplicateCount;
+				}
+
+				++levelEntryCounts[getTimingWheelSlotLevel(slot)];
+				previousObject = object;
+			}
+		}
+
+		for (int level = 0; level <= cs_timingWheelLevelCount; ++level)
+			DEBUG_FATAL(levelEntryCounts[level] != s_timingWheelLevelEntryCounts[level], ("validateScheduleTimeMap(): timing wheel level [%d] holds [%d] objects but its count is [%d].", level, levelEntryCounts[level], s_timingWheelLevelEntryCounts[level]));
+	}
+
 	DEBUG_FATAL(duplicateCount > 0, ("validateScheduleTimeMap(): duplicates found, see warnings in output."));
 }
 
@@ -1003,12 +1164,50 @@ float AlterScheduler::getTimeSinceLastFrame()
 
 // ----------------------------------------------------------------------
 
+int AlterScheduler::getNumberOfObjectsAlteredLastFrame()
+{
+	return s_objectsAltered;
+}
+
+// ----------------------------------------------------------------------
+
+int AlterScheduler::getNumberOfScheduledObjects()
+{
+	int count = static_cast<int>(s_scheduleMap.size());
+	if (s_useTimingWheel)
+		count += getTimingWheelEntryCount();
+
+	return count;
+}
+
+// ----------------------------------------------------------------------
+
+bool AlterScheduler::isUsingTimingWheel()
+{
+	return s_useTimingWheel;
+}
+
+// ----------------------------------------------------------------------
+
 void AlterScheduler::setMostRecentAlterTime(Object &object)
 {
 	if (object.hasScheduleData())
 		object.setMostRecentAlterTime(s_currentTime);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Whether thread-safe objects are being altered on the alter threads right now.
+ *
+ * Anything an object does during that time that reaches beyond the object
+ * itself has to be put off until the main thread has them back.
+ */
+
+bool AlterScheduler::isParallelAlterInProgress()
+{
+	return s_parallelAlterInProgress;
+}
+
 // ----------------------------------------------------------------------
 
 #ifdef _DEBUG
@@ -1026,6 +1225,9 @@ bool AlterScheduler::reportObjectAlters()
 
 void AlterScheduler::countObjectAlter()
 {
+	if (!Os::isMainThread())
+		return;
+
 	++s_totalObjectAlterCalls;
 	++s_reportedObjectAlterCalls;
 }
@@ -1062,12 +1264,7 @@ void AlterScheduler::addToAlterNextFrameList(Object &object)
 	//-- Ensure it's not in the future schedule list.
 	//   Note it's okay if it's in the alter now list since the object may
 	//   get a submitForAlter() from a related object during alter processing.
-	ScheduleTimeMap::iterator &mapIt = OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object);
-	if (mapIt != s_scheduleMap.end())
-	{
-		s_scheduleMap.erase(mapIt);
-		mapIt = s_scheduleMap.end();
-	}
+	IGNORE_RETURN(removeFromScheduleMap(object));
 
 	DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(AlterScheduler::findObjectInScheduleTimeMap(&object), ("addToAlterNextFrameList(): object shouldn't be in map but is: pointer=[%p],id=[%s],template=[%s].", &object, object.getNetworkId().getValueString().c_str(), object.getObjectTemplateName())) );
 
@@ -1089,12 +1286,7 @@ void AlterScheduler::addToAlterNowList(Object &object)
 	if (object.isInAlterNextFrameList())
 		object.removeFromAlterNextFrameList();
 
-	ScheduleTimeMap::iterator &mapIt = OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object);
-	if (mapIt != s_scheduleMap.end())
-	{
-		s_scheduleMap.erase(mapIt);
-		mapIt = s_scheduleMap.end();
-	}
+	IGNORE_RETURN(removeFromScheduleMap(object));
 
 	DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(AlterScheduler::findObjectInScheduleTimeMap(&object), ("addToAlterNowList(): object shouldn't be in map but is: pointer=[%p],id=[%s],template=[%s].", &object, object.getNetworkId().getValueString().c_str(), object.getObjectTemplateName())) );
 
@@ -1111,14 +1303,57 @@ void AlterScheduler::addToScheduleMap(Object &object, ScheduleTime nextAlterTime
 	if (object.isInAlterNextFrameList())
 		object.removeFromAlterNextFrameList();
 
+	IGNORE_RETURN(removeFromScheduleMap(object));
+
+	//-- Add object to schedule map, or to the timing wheel when it is in use.
+	if (s_useTimingWheel)
+	{
+		TimingWheelEntry &entry = getTimingWheelEntry(object);
+		entry.scheduleTime = nextAlterTime;
+		entry.sequence     = ++s_timingWheelSequence;
+
+		linkIntoTimingWheel(object);
+	}
+	else
+		OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object) = s_scheduleMap.insert(ScheduleTimeMap::value_type(nextAlterTime, &object));
+
+	DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(!AlterScheduler::findObjectInScheduleTimeMap(&object), ("addToScheduleMap(): object should be in map but isn't: pointer=[%p],id=[%s],template=[%s].", &object, object.getNetworkId().getValueString().c_str(), object.getObjectTemplateName())) );
+}
+
+// ----------------------------------------------------------------------
+/**
+ * @return true if the object was scheduled for a future alter, false otherwise.
+ */
+
+bool AlterScheduler::removeFromScheduleMap(Object &object)
+{
+	bool result = false;
+
 	ScheduleTimeMap::iterator &mapIt = OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object);
 	if (mapIt != s_scheduleMap.end())
+	{
 		s_scheduleMap.erase(mapIt);
+		mapIt = s_scheduleMap.end();
+		result = true;
+	}
 
-	//-- Add object to schedule map.
-	mapIt = s_scheduleMap.insert(ScheduleTimeMap::value_type(nextAlterTime, &object));
+	if (s_useTimingWheel && (getTimingWheelEntry(object).slot >= 0))
+	{
+		unlinkFromTimingWheel(object);
+		result = true;
+	}
 
-	DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(!AlterScheduler::findObjectInScheduleTimeMap(&object), ("addToScheduleMap(): object should be in map but isn't: pointer=[%p],id=[%s],template=[%s].", &object, object.getNetworkId().getValueString().c_str(), object.getObjectTemplateName())) );
+	return result;
+}
+
+// ----------------------------------------------------------------------
+
+bool AlterScheduler::isInScheduleMap(Object &object)
+{
+	if (OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object) != s_scheduleMap.end())
+		return true;
+
+	return s_useTimingWheel && (getTimingWheelEntry(object).slot >= 0);
 }
 
 // ----------------------------------------------------------------------
@@ -1139,6 +1374,17 @@ void AlterScheduler::dumpScheduleMap()
 			REPORT_LOG(true, ("%d: object id [%s], ptr=[%p], last alter [%d], next alter [%d].\n", i+1, object->getNetworkId().getValueString().c_str(), object, static_cast<int>(object->getMostRecentAlterTime()), static_cast<int>(nextAlterTime)));
 		}
 	}
+
+	if (s_useTimingWheel)
+	{
+		REPORT_LOG(true, ("Dumping timing wheel: %d entries, wheel time [%d].\n", getTimingWheelEntryCount(), static_cast<int>(s_timingWheelTime)));
+
+		for (int slot = 0; slot < cs_timingWheelSlotCount; ++slot)
+		{
+			for (Object *object = s_timingWheelSlots[slot]; object != NULL; object = getTimingWheelEntry(*object).next, ++i)
+				REPORT_LOG(true, ("%d: slot [%d], object id [%s], ptr=[%p], last alter [%d], next alter [%d].\n", i+1, slot, object->getNetworkId().getValueString().c_str(), object, static_cast<int>(object->getMostRecentAlterTime()), static_cast<int>(getTimingWheelEntry(*object).scheduleTime)));
+		}
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -1146,6 +1392,30 @@ void AlterScheduler::dumpScheduleMap()
 void AlterScheduler::moveReadyObjectsFromSchedulerToNextFrameList()
 {
 	//-- Copy all expired alter scheduler entries into the "alter next frame" list.
+	if (s_useTimingWheel)
+	{
+		PROFILER_AUTO_BLOCK_DEFINE("update expired");
+
+		advanceTimingWheel(s_currentTime, s_timingWheelDueObjects);
+		if (s_alwaysAlter)
+			takeAllFromTimingWheel(s_timingWheelDueObjects);
+
+		//-- Hand the objects over in the order the schedule map would have.
+		std::sort(s_timingWheelDueObjects.begin(), s_timingWheelDueObjects.end(), TimingWheelOrder());
+
+		ObjectVector::iterator const endIt = s_timingWheelDueObjects.end();
+		for (ObjectVector::iterator it = s_timingWheelDueObjects.begin(); it != endIt; ++it)
+		{
+			Object *const object = *it;
+			DO_ON_VALIDATE_OBJECTS(validateObject(object));
+
+			addToAlterNextFrameList(*object);
+			++s_objectsLeftSchedule;
+		}
+
+		s_timingWheelDueObjects.clear();
+	}
+	else
 	{
 		PROFILER_AUTO_BLOCK_DEFINE("update expired");
 
@@ -1166,6 +1436,7 @@ void AlterScheduler::moveReadyObjectsFromSchedulerToNextFrameList()
 
 				//-- This function will remove the object from the schedule map.
 				addToAlterNextFrameList(*object);
+				++s_objectsLeftSchedule;
 
 				DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(findObjectInAlterNowList(object), ("found object in alter now list, unexpected.")) );
 				DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(findObjectInScheduleTimeMap(object), ("found object in time schedule map, unexpected.")) );
@@ -1180,7 +1451,6 @@ void AlterScheduler::moveReadyObjectsFromSchedulerToNextFrameList()
 void AlterScheduler::moveObjectsFromAlterNextFrameListToAlterNowList(int schedulePhaseIndex)
 {
 	//-- Copy all alter next frame entries into the alter now list.
-	s_objectsAltered = 0;
 	{
 		PROFILER_AUTO_BLOCK_DEFINE("copy next frame");
 
@@ -1194,7 +1464,6 @@ void AlterScheduler::moveObjectsFromAlterNextFrameListToAlterNowList(int schedul
 			Object *const nextObject = object->getNextFromAlterNextFrameList();
 
 			addToAlterNowList(*object);
-			++s_objectsAltered;
 
 			DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(findObjectInScheduleTimeMap(object), ("found object in time schedule map, unexpected.")) );
 			DO_ON_HARDCORE_VALIDATION( DEBUG_FATAL(findObjectInAlterNextFrameList(object), ("found object in alter next frame list, unexpected.")) );
@@ -1229,10 +1498,23 @@ void AlterScheduler::alterSingleObject(Object *object, ConcludeStyle concludeSty
 
 	float alterResult = AlterResult::cms_alterNextFrame;
 	bool  alreadyProcessed = (object->getMostRecentAlterTime() == s_currentTime);
-	if (!alreadyProcessed)
+	if (alreadyProcessed && object->takeParallelAlterResult(alterResult))
+	{
+		//-- The alter already ran on an alter thread this phase, only the scheduling remains.
+		alreadyProcessed = false;
+
+#if defined(_WIN32) && defined(_DEBUG)
+		if (typeName)
+			PROFILER_BLOCK_LEAVE(profilerBlock);
+#endif
+
+		DO_ON_DEBUG(s_currentlyAlteringObject = NULL);
+	}
+	else if (!alreadyProcessed)
 	{
 		//-- Update the most recent alter time for this object.
 		object->setMostRecentAlterTime(s_currentTime);
+		++s_objectsAltered;
 
 		//-- Perform the alter.
 		DO_ON_OBJECT_ALTER_FLAG_SUPPORTED(object->setIsAltering(true));
@@ -1268,7 +1550,7 @@ void AlterScheduler::alterSingleObject(Object *object, ConcludeStyle concludeSty
 	//-- Validate post-alter assertions.
 	// Ensure the object hasn't crept into the schedule map.  Only applicable if
 	// we haven't already processed this object prior to a loop restart (due to deleted object).
-	DEBUG_FATAL(OBJECT_SCHEDULE_TIME_MAP_ITERATOR(*object) != s_scheduleMap.end(), ("AlterScheduler: object pointer=[%p],id=[%s],template=[%s] was in schedule map immediately after alter, shouldn't happen.", object, object->getNetworkId().getValueString().c_str(), object->getObjectTemplateName()));
+	DEBUG_FATAL(isInScheduleMap(*object), ("AlterScheduler: object pointer=[%p],id=[%s],template=[%s] was in schedule map immediately after alter, shouldn't happen.", object, object->getNetworkId().getValueString().c_str(), object->getObjectTemplateName()));
 	DO_ON_DEBUG(doPerObjectAlterReportCollection(object, alterResult));
 
 	//-- We will move items into the conclude list IF the object is going to do a conclude all.
@@ -1381,6 +1663,13 @@ void AlterScheduler::doAlterAndConcludeForAllObjects(float schedulerElapsedTime,
 {
 	doPreAlterRecursionCheck();
 	incrementSchedulerTimerByElapsedTime(schedulerElapsedTime);
+
+	s_objectsAltered = 0;
+	s_objectsLeftSchedule = 0;
+	s_objectsAlteredInParallel = 0;
+	s_serialAlterTime = 0.0f;
+	s_parallelAlterTime = 0.0f;
+	s_concludeTime = 0.0f;
 	moveReadyObjectsFromSchedulerToNextFrameList();
 	
 //DEBUG_REPORT_LOG(true, ("[aitest] Altering objects at %lu\n", static_cast<unsigned long>(s_currentTime)));
@@ -1398,9 +1687,19 @@ void AlterScheduler::doAlterAndConcludeForAllObjects(float schedulerElapsedTime,
 
 			DO_ON_HARDCORE_VALIDATION(validateAllContainers());
 
+			//-- Alter the thread-safe objects up front; the loop below schedules them with the rest.
+			if ((s_numberOfAlterThreads > 0) && !s_disableParallelAlter && (Object::getNumberOfAlterThreadSafeObjects() > 0))
+				alterThreadSafeObjectsInParallel();
+
+			PerformanceTimer serialAlterTimer;
+			serialAlterTimer.start();
+
 			Object *nextObject;
 			for (Object *object = s_alterNowListFirst->getNextFromAlterNowList(); object != NULL; object = nextObject)
 				alterSingleObject(object, concludeStyle, nextObject);
+
+			serialAlterTimer.stop();
+			s_serialAlterTime += serialAlterTimer.getElapsedTime();
 		}
 
 		DO_ON_HARDCORE_VALIDATION(validateAllContainers());
@@ -1410,6 +1709,9 @@ void AlterScheduler::doAlterAndConcludeForAllObjects(float schedulerElapsedTime,
 	if (s_postAlterHookFunction)
 		s_postAlterHookFunction(schedulerElapsedTime);
 
+	PerformanceTimer concludeTimer;
+	concludeTimer.start();
+
 	if (concludeStyle == CS_all)
 	{
 		//-- Do a conclude on the conclude list.  We must do all frame alters before we do a conclude.
@@ -1427,9 +1729,390 @@ void AlterScheduler::doAlterAndConcludeForAllObjects(float schedulerElapsedTime,
 			objectToConclude->conclude();
 		}
 	}
+
+	concludeTimer.stop();
+	s_concludeTime = concludeTimer.getElapsedTime();
 	DO_ON_HARDCORE_VALIDATION(validateAllContainers());
 
 	doPostAlterRecursionCheck();
 }
 
+// ----------------------------------------------------------------------
+
+AlterScheduler::TimingWheelEntry &AlterScheduler::getTimingWheelEntry(Object &object)
+{
+	return OBJECT_TIMING_WHEEL_ENTRY(object);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Return the wheel slot an alter at scheduleTime belongs in, relative to the
+ * wheel's current time, or cs_timingWheelOverflowSlot if it is beyond the
+ * top level.
+ */
+
+int AlterScheduler::getTimingWheelSlot(ScheduleTime scheduleTime)
+{
+	if (scheduleTime <= s_timingWheelTime)
+		return cs_timingWheelDueSlot;
+
+	for (int level = 0; level < cs_timingWheelLevelCount; ++level)
+	{
+		int const blockShift = cs_timingWheelSlotBits * (level + 1);
+		if ((scheduleTime >> blockShift) == (s_timingWheelTime >> blockShift))
+			return (level * cs_timingWheelSlotsPerLevel) + static_cast<int>((scheduleTime >> (cs_timingWheelSlotBits * level)) & (cs_timingWheelSlotsPerLevel - 1));
+	}
+
+	return cs_timingWheelOverflowSlot;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Put the object in the wheel slot for its entry's schedule time, or in the
+ * schedule map if that time is beyond the top level.
+ */
+
+void AlterScheduler::linkIntoTimingWheel(Object &object)
+{
+	TimingWheelEntry &entry = getTimingWheelEntry(object);
+	DEBUG_FATAL(entry.slot >= 0, ("linkIntoTimingWheel(): object pointer=[%p] is already in the timing wheel.", &object));
+
+	int const slot = getTimingWheelSlot(entry.scheduleTime);
+	if (slot == cs_timingWheelOverflowSlot)
+	{
+		OBJECT_SCHEDULE_TIME_MAP_ITERATOR(object) = s_scheduleMap.insert(ScheduleTimeMap::value_type(entry.scheduleTime, &object));
+		return;
+	}
+
+	Object *const head = s_timingWheelSlots[slot];
+
+	entry.slot     = slot;
+	entry.previous = NULL;
+	entry.next     = head;
+
+	if (head)
+		getTimingWheelEntry(*head).previous = &object;
+
+	s_timingWheelSlots[slot] = &object;
+	++s_timingWheelLevelEntryCounts[getTimingWheelSlotLevel(slot)];
+}
+
+// ----------------------------------------------------------------------
+
+void AlterScheduler::unlinkFromTimingWheel(Object &object)
+{
+	TimingWheelEntry &entry = getTimingWheelEntry(object);
+	DEBUG_FATAL(entry.slot < 0, ("unlinkFromTimingWheel(): object pointer=[%p] is not in the timing wheel.", &object));
+
+	if (entry.previous)
+		getTimingWheelEntry(*entry.previous).next = entry.next;
+	else
+		s_timingWheelSlots[entry.slot] = entry.next;
+
+	if (entry.next)
+		getTimingWheelEntry(*entry.next).previous = entry.previous;
+
+	--s_timingWheelLevelEntryCounts[getTimingWheelSlotLevel(entry.slot)];
+
+	entry.next     = NULL;
+	entry.previous = NULL;
+	entry.slot     = -1;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Unlink every object in the slot and append it to objects.  The entries
+ * keep their schedule time and sequence for ordering.
+ */
+
+void AlterScheduler::takeTimingWheelSlot(int slot, ObjectVector &objects)
+{
+	int count = 0;
+
+	Object *nextObject;
+	for (Object *object = s_timingWheelSlots[slot]; object != NULL; object = nextObject)
+	{
+		TimingWheelEntry &entry = getTimingWheelEntry(*object);
+		nextObject = entry.next;
+
+		entry.next     = NULL;
+		entry.previous = NULL;
+		entry.slot     = -1;
+
+		objects.push_back(object);
+		++count;
+	}
+
+	s_timingWheelSlots[slot] = NULL;
+	s_timingWheelLevelEntryCounts[getTimingWheelSlotLevel(slot)] -= count;
+}
+
+// ----------------------------------------------------------------------
+
+void AlterScheduler::cascadeTimingWheelSlot(int slot)
+{
+	s_timingWheelCascadeObjects.clear();
+	takeTimingWheelSlot(slot, s_timingWheelCascadeObjects);
+
+	ObjectVector::iterator const endIt = s_timingWheelCascadeObjects.end();
+	for (ObjectVector::iterator it = s_timingWheelCascadeObjects.begin(); it != endIt; ++it)
+		linkIntoTimingWheel(**it);
+
+	s_timingWheelCascadeObjects.clear();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Move the wheel forward to time, appending every object due at or before
+ * time to dueObjects.  Runs of empty levels are skipped rather than stepped
+ * through a tick at a time.
+ */
+
+void AlterScheduler::advanceTimingWheel(ScheduleTime time, ObjectVector &dueObjects)
+{
+	int const          topShift = cs_timingWheelSlotBits * cs_timingWheelLevelCount;
+	ScheduleTime const slotMask = static_cast<ScheduleTime>(cs_timingWheelSlotsPerLevel - 1);
+
+	takeTimingWheelSlot(cs_timingWheelDueSlot, dueObjects);
+
+	while (s_timingWheelTime < time)
+	{
+		//-- Skip to the last tick before the lowest level that has anything in it.
+		int emptyLevelCount = 0;
+		while ((emptyLevelCount < cs_timingWheelLevelCount) && (s_timingWheelLevelEntryCounts[emptyLevelCount] == 0))
+			++emptyLevelCount;
+
+		if (emptyLevelCount > 0)
+		{
+			ScheduleTime skipTime;
+			if (emptyLevelCount < cs_timingWheelLevelCount)
+				skipTime = s_timingWheelTime | ((static_cast<ScheduleTime>(1) << (cs_timingWheelSlotBits * emptyLevelCount)) - 1);
+			else if (!s_scheduleMap.empty())
+				skipTime = std::max(s_timingWheelTime, ((s_scheduleMap.begin()->first >> topShift) << topShift) - 1);
+			else
+				skipTime = time;
+
+			if (skipTime >= time)
+			{
+				s_timingWheelTime = time;
+				break;
+			}
+
+			s_timingWheelTime = skipTime;
+		}
+
+		//-- Step one tick.  Crossing into a new block at any level redistributes that level's slot for the
+		//   new block to the levels below it, starting from the top.
+		ScheduleTime const tick = ++s_timingWheelTime;
+
+		if ((tick & slotMask) == 0)
+		{
+			if ((tick & ((static_cast<ScheduleTime>(1) << topShift) - 1)) == 0)
+			{
+				while (!s_scheduleMap.empty() && ((s_scheduleMap.begin()->first >> topShift) == (tick >> topShift)))
+				{
+					ScheduleTimeMap::iterator const it = s_scheduleMap.begin();
+					Object *const object = it->second;
+
+					OBJECT_SCHEDULE_TIME_MAP_ITERATOR(*object) = s_scheduleMap.end();
+					s_scheduleMap.erase(it);
+
+					linkIntoTimingWheel(*object);
+				}
+			}
+
+			for (int level = cs_timingWheelLevelCount - 1; level > 0; --level)
+			{
+				int const levelShift = cs_timingWheelSlotBits * level;
+				if ((tick & ((static_cast<ScheduleTime>(1) << levelShift) - 1)) == 0)
+					cascadeTimingWheelSlot((level * cs_timingWheelSlotsPerLevel) + static_cast<int>((tick >> levelShift) & slotMask));
+			}
+
+			//-- Anything redistributed that is due exactly at this tick landed in the due slot.
+			takeTimingWheelSlot(cs_timingWheelDueSlot, dueObjects);
+		}
+
+		takeTimingWheelSlot(static_cast<int>(tick & slotMask), dueObjects);
+	}
+}
+
+// ----------------------------------------------------------------------
+
+void AlterScheduler::takeAllFromTimingWheel(ObjectVector &objects)
+{
+	for (int slot = 0; slot < cs_timingWheelSlotCount; ++slot)
+		takeTimingWheelSlot(slot, objects);
+
+	ScheduleTimeMap::iterator const endIt = s_scheduleMap.end();
+	for (ScheduleTimeMap::iterator it = s_scheduleMap.begin(); it != endIt; ++it)
+	{
+		OBJECT_SCHEDULE_TIME_MAP_ITERATOR(*it->second) = endIt;
+		objects.push_back(it->second);
+	}
+
+	s_scheduleMap.clear();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Start the alter threads requested by the configuration.  With no alter
+ * threads, objects flagged as alter-thread-safe are altered serially like
+ * every other object.
+ */
+
+void AlterScheduler::installAlterThreads()
+{
+	s_numberOfAlterThreads = clamp(0, ConfigSharedObject::getAlterSchedulerParallelAlterThreads(), cs_maximumNumberOfAlterThreads);
+	if (s_numberOfAlterThreads == 0)
+		return;
+
+	s_alterThreadsQuit = false;
+
+	for (int i = 0; i < s_numberOfAlterThreads; ++i)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "Alter%d", i + 1);
+		s_alterThreadHandles[i] = runNamedThread(name, alterThreadRoutine);
+	}
+
+	DebugFlags::registerFlag(s_disableParallelAlter, "SharedObject/AlterScheduler", "disableParallelAlter");
+
+	ExitChain::add(removeAlterThreads, "AlterScheduler::removeAlterThreads");
+}
+
+// ----------------------------------------------------------------------
+
+void AlterScheduler::removeAlterThreads()
+{
+	DebugFlags::unregisterFlag(s_disableParallelAlter);
+
+	//-- Each thread exits the next time it wakes.
+	s_alterThreadsQuit = true;
+	s_alterThreadWorkPending.signal(s_numberOfAlterThreads);
+
+	for (int i = 0; i < s_numberOfAlterThreads; ++i)
+	{
+		s_alterThreadHandles[i]->wait();
+		s_alterThreadHandles[i] = ThreadHandle();
+	}
+
+	s_numberOfAlterThreads = 0;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Routine the alter threads run.  Each wake-up services one parallel alter
+ * request and is acknowledged with exactly one completion signal.
+ */
+
+void AlterScheduler::alterThreadRoutine()
+{
+	for (;;)
+	{
+		s_alterThreadWorkPending.wait();
+		if (s_alterThreadsQuit)
+			break;
+
+		alterParallelChunks();
+		s_alterThreadWorkComplete.signal();
+	}
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Alter chunks of s_parallelAlterObjects until every chunk has been claimed.
+ * Called concurrently from the main thread and the alter threads; each
+ * object's result is written only by the thread that claimed it.
+ */
+
+void AlterScheduler::alterParallelChunks()
+{
+	int const objectCount = static_cast<int>(s_parallelAlterObjects.size());
+
+	for (;;)
+	{
+		int const begin = (++s_parallelAlterNextChunk - 1) * cs_parallelAlterChunkSize;
+		if (begin >= objectCount)
+			break;
+
+		int const end = std::min(begin + cs_parallelAlterChunkSize, objectCount);
+		for (int i = begin; i < end; ++i)
+		{
+			Object * const object = s_parallelAlterObjects[static_cast<size_t>(i)];
+
+			DO_ON_OBJECT_ALTER_FLAG_SUPPORTED(object->setIsAltering(true));
+			s_parallelAlterResults[static_cast<size_t>(i)] = object->alter(s_parallelAlterElapsedTimes[static_cast<size_t>(i)]);
+			DO_ON_OBJECT_ALTER_FLAG_SUPPORTED(object->setIsAltering(false));
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Alter every alter-thread-safe object in the alter now list across the
+ * alter threads and the main thread.
+ *
+ * The objects stay in the alter now list with their results attached, and
+ * alterSingleObject() schedules (or kills) each one in list order, so all
+ * scheduler, world and conclude list changes remain on the main thread.
+ */
+
+void AlterScheduler::alterThreadSafeObjectsInParallel()
+{
+	PROFILER_AUTO_BLOCK_DEFINE("AlterScheduler::alterThreadSafeObjectsInParallel");
+
+	PerformanceTimer parallelAlterTimer;
+	parallelAlterTimer.start();
+
+	s_parallelAlterObjects.clear();
+	s_parallelAlterElapsedTimes.clear();
+
+	for (Object *object = s_alterNowListFirst->getNextFromAlterNowList(); object != NULL; object = object->getNextFromAlterNowList())
+	{
+		if (!object->getAlterIsThreadSafe() || (object->getMostRecentAlterTime() == s_currentTime))
+			continue;
+
+		DO_ON_VALIDATE_OBJECTS(validateObject(object));
+
+		s_parallelAlterObjects.push_back(object);
+		s_parallelAlterElapsedTimes.push_back(cs_secondsPerSchedulerTick * (s_currentTime - object->getMostRecentAlterTime()));
+		object->setMostRecentAlterTime(s_currentTime);
+	}
+
+	int const objectCount = static_cast<int>(s_parallelAlterObjects.size());
+	if (objectCount > 0)
+	{
+		s_parallelAlterResults.resize(static_cast<size_t>(objectCount));
+
+		//-- The main thread takes a chunk too, so only wake threads for the chunks beyond the first.
+		int const chunkCount  = (objectCount + cs_parallelAlterChunkSize - 1) / cs_parallelAlterChunkSize;
+		int const threadCount = std::min(s_numberOfAlterThreads, chunkCount - 1);
+
+		IGNORE_RETURN(s_parallelAlterNextChunk = 0);
+		s_parallelAlterInProgress = true;
+		if (threadCount > 0)
+			s_alterThreadWorkPending.signal(threadCount);
+
+		alterParallelChunks();
+
+		for (int i = 0; i < threadCount; ++i)
+			s_alterThreadWorkComplete.wait();
+		s_parallelAlterInProgress = false;
+
+		//-- Notifications for objects that moved were held back until now; see Object::deferTransformChange().
+		for (int j = 0; j < objectCount; ++j)
+		{
+			Object * const object = s_parallelAlterObjects[static_cast<size_t>(j)];
+			object->dispatchDeferredTransformChanges();
+			object->setParallelAlterResult(s_parallelAlterResults[static_cast<size_t>(j)]);
+		}
+
+		s_objectsAltered += objectCount;
+		s_objectsAlteredInParallel += objectCount;
+	}
+
+	parallelAlterTimer.stop();
+	s_parallelAlterTime += parallelAlterTimer.getElapsedTime();
+}
+
 // ======================================================================
@@ -38,6 +38,18 @@ public:
 
 	typedef uint64                                   ScheduleTime;
 	typedef stdmultimap<ScheduleTime, Object*>::fwd  ScheduleTimeMap;
+	typedef stdvector<Object*>::fwd                  ObjectVector;
+
+	// Per-object links for the timing wheel schedule.  slot is -1 when the
+	// object is not in the wheel.
+	struct TimingWheelEntry
+	{
+		Object       *next;
+		Object       *previous;
+		ScheduleTime  scheduleTime;
+		uint64        sequence;
+		int           slot;
+	};
 
 public:
 
@@ -71,8 +83,12 @@ public:
 	static void   validateAllContainers();
 
 	static float  getTimeSinceLastFrame();
+	static int    getNumberOfObjectsAlteredLastFrame();
+	static int    getNumberOfScheduledObjects();
+	static bool   isUsingTimingWheel();
 
 	static void   setMostRecentAlterTime(Object &object);
+	static bool   isParallelAlterInProgress();
 
 #ifdef _DEBUG
 
@@ -91,11 +107,25 @@ private:
 		CS_all
 	};
 
+	class TimingWheelOrder;
+	friend class TimingWheelOrder;
+
 private:
 
 	static void addToAlterNextFrameList(Object &object);
 	static void addToAlterNowList(Object &object);
 	static void addToScheduleMap(Object &object, ScheduleTime nextAlterTime);
+	static bool removeFromScheduleMap(Object &object);
+	static bool isInScheduleMap(Object &object);
+
+	static TimingWheelEntry &getTimingWheelEntry(Object &object);
+	static int               getTimingWheelSlot(ScheduleTime scheduleTime);
+	static void              linkIntoTimingWheel(Object &object);
+	static void              unlinkFromTimingWheel(Object &object);
+	static void              takeTimingWheelSlot(int slot, ObjectVector &objects);
+	static void              cascadeTimingWheelSlot(int slot);
+	static void              advanceTimingWheel(ScheduleTime time, ObjectVector &dueObjects);
+	static void              takeAllFromTimingWheel(ObjectVector &objects);
 
 	static void dumpScheduleMap();
 	static void moveReadyObjectsFromSchedulerToNextFrameList();
@@ -105,6 +135,12 @@ private:
 	static void concludeAndRemoveAllConcludeEntries();
 	static void doAlterAndConcludeForAllObjects(float schedulerElapsedTime, ConcludeStyle concludeStyle, Object *objectToConclude);
 
+	static void installAlterThreads();
+	static void removeAlterThreads();
+	static void alterThreadRoutine();
+	static void alterParallelChunks();
+	static void alterThreadSafeObjectsInParallel();
+
 };
 
 // ======================================================================
@@ -412,6 +412,7 @@ namespace ObjectNamespace
 	bool                                             ms_logObjectDelete;
 	bool                                             ms_validateObjectPosition;
 	bool                                             ms_objectsAlterChildrenAndContents;
+	int                                              ms_numberOfAlterThreadSafeObjects;
 
 	PropertySearchStatistics                         ms_propertySearchStatistics;
 	int                                              ms_propertySearchesPerFrame;
@@ -722,6 +723,10 @@ Object::Object():
 	m_collisionProperty(NULL),
 	m_spatialSubdivisionHandle (0),
 	m_useAlterScheduler(true),
+	m_alterIsThreadSafe(false),
+	m_positionChangeDeferred(false),
+	m_rotationChangeDeferred(false),
+	m_deferredOldPosition(),
 	m_scheduleData(NULL),
 	m_shouldBakeIntoMesh(true),
 	m_defaultAppearance(NULL),
@@ -766,6 +771,10 @@ Object::Object(const ObjectTemplate *objectTemplate, const NetworkId &networkId)
 	m_collisionProperty(NULL),
 	m_spatialSubdivisionHandle (0),
 	m_useAlterScheduler(true),
+	m_alterIsThreadSafe(false),
+	m_positionChangeDeferred(false),
+	m_rotationChangeDeferred(false),
+	m_deferredOldPosition(),
 	m_scheduleData(NULL),
 	m_shouldBakeIntoMesh(true),
 	m_defaultAppearance(NULL),
@@ -813,6 +822,10 @@ Object::Object(const ObjectTemplate *objectTemplate, InitializeFlag):
 	m_collisionProperty(NULL),
 	m_spatialSubdivisionHandle (0),
 	m_useAlterScheduler(true),
+	m_alterIsThreadSafe(false),
+	m_positionChangeDeferred(false),
+	m_rotationChangeDeferred(false),
+	m_deferredOldPosition(),
 	m_scheduleData(NULL),
 	m_shouldBakeIntoMesh(true),
 	m_defaultAppearance(NULL),
@@ -846,6 +859,9 @@ Object::~Object(void)
 	if (m_inWorld)
 		Object::removeFromWorld();
 
+	if (m_alterIsThreadSafe)
+		--ms_numberOfAlterThreadSafeObjects;
+
 	if (m_scheduleData)
 	{
 		bool const wasInAlterScheduler = AlterScheduler::removeObject(*this);
@@ -1208,6 +1224,9 @@ void Object::positionChanged(bool dueToParentChange, const Vector &oldPosition)
 
 	if (m_inWorld)
 	{
+		if (deferTransformChange(true, false, oldPosition))
+			return;
+
 		validatePosition(*this, getPosition_p());
 
 		m_notificationList->positionChanged(*this, dueToParentChange, oldPosition);
@@ -1234,6 +1253,9 @@ void Object::rotationChanged(bool dueToParentChange)
 
 	if (m_inWorld)
 	{
+		if (deferTransformChange(false, true, Vector::zero))
+			return;
+
 		m_notificationList->rotationChanged(*this, dueToParentChange);
 
 		if (m_attachedObjects && !m_attachedObjects->empty())
@@ -1258,6 +1280,9 @@ void  Object::positionAndRotationChanged(bool dueToParentChange, const Vector &o
 
 	if (m_inWorld)
 	{
+		if (deferTransformChange(true, true, oldPosition))
+			return;
+
 		validatePosition(*this, getPosition_p());
 
 		m_notificationList->positionAndRotationChanged(*this, dueToParentChange, oldPosition);
@@ -1273,6 +1298,34 @@ void  Object::positionAndRotationChanged(bool dueToParentChange, const Vector &o
 
 // ----------------------------------------------------------------------
 
+/**
+ * Hold back the notifications for a transform change made while the alter
+ * scheduler is altering objects on its worker threads.
+ *
+ * Notifications update shared state such as the collision and visibility
+ * databases, so they are delivered later on the main thread by
+ * dispatchDeferredTransformChanges().  Only the first old position is kept.
+ *
+ * @return  true if the change was deferred.
+ */
+
+bool Object::deferTransformChange(bool const position, bool const rotation, Vector const &oldPosition)
+{
+	if (!AlterScheduler::isParallelAlterInProgress())
+		return false;
+
+	if (position && !m_positionChangeDeferred)
+	{
+		m_positionChangeDeferred = true;
+		m_deferredOldPosition = oldPosition;
+	}
+
+	m_rotationChangeDeferred = m_rotationChangeDeferred || rotation;
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
 void Object::cellChanged(bool dueToParentChange)
 {
 	setObjectToWorldDirty(true);
@@ -2919,6 +2972,79 @@ void *Object::getScheduleTimeMapIterator()
 
 // ----------------------------------------------------------------------
 
+void *Object::getScheduleTimingWheelEntry()
+{
+	DEBUG_FATAL(!m_scheduleData, ("getScheduleTimingWheelEntry() called but this object doesn't have schedule data."));
+	return &m_scheduleData->getTimingWheelEntry();
+}
+
+// ----------------------------------------------------------------------
+
+void Object::setParallelAlterResult(float alterResult)
+{
+	DEBUG_FATAL(!m_scheduleData, ("setParallelAlterResult() called but this object doesn't have schedule data."));
+	m_scheduleData->setParallelAlterResult(alterResult);
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Retrieve and clear the result of an alter already run on a worker thread.
+ *
+ * @return  true if the object had a pending result, in which case alterResult is set.
+ */
+
+bool Object::takeParallelAlterResult(float &alterResult)
+{
+	DEBUG_FATAL(!m_scheduleData, ("takeParallelAlterResult() called but this object doesn't have schedule data."));
+	if (!m_scheduleData->hasParallelAlterResult())
+		return false;
+
+	alterResult = m_scheduleData->getParallelAlterResult();
+	m_scheduleData->clearParallelAlterResult();
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+void Object::clearParallelAlterResult()
+{
+	if (m_scheduleData)
+		m_scheduleData->clearParallelAlterResult();
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Deliver the transform notifications held back while this object and its
+ * attached objects were altered on a worker thread.
+ */
+
+void Object::dispatchDeferredTransformChanges()
+{
+	if (m_positionChangeDeferred || m_rotationChangeDeferred)
+	{
+		bool const position = m_positionChangeDeferred;
+		bool const rotation = m_rotationChangeDeferred;
+		m_positionChangeDeferred = false;
+		m_rotationChangeDeferred = false;
+
+		if (position && rotation)
+			positionAndRotationChanged(false, m_deferredOldPosition);
+		else if (position)
+			positionChanged(false, m_deferredOldPosition);
+		else
+			rotationChanged(false);
+	}
+
+	if (m_attachedObjects)
+	{
+		const AttachedObjects::iterator end = m_attachedObjects->end();
+		for (AttachedObjects::iterator i = m_attachedObjects->begin(); i != end; ++i)
+			(*i)->dispatchDeferredTransformChanges();
+	}
+}
+
+// ----------------------------------------------------------------------
+
 Object *Object::getNextFromAlterNowList()
 {
 	DEBUG_FATAL(!m_scheduleData, ("getNextFromAlterNowList() called but this object doesn't have schedule data."));
@@ -3124,6 +3250,43 @@ void Object::setUseAlterScheduler(bool const useAlterScheduler)
 
 // ----------------------------------------------------------------------
 
+bool Object::getAlterIsThreadSafe() const
+{
+	return m_alterIsThreadSafe;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Mark whether this object's alter() may run on an alter scheduler worker thread.
+ *
+ * Only set this when alter() for the object, its components and its child objects
+ * touches nothing but the object itself: no world, container, notification or
+ * scheduler changes, no object creation or deletion.  Such objects are altered
+ * together before the rest of their schedule phase, so they must not depend on
+ * other objects having already been altered this frame.
+ */
+
+void Object::setAlterIsThreadSafe(bool alterIsThreadSafe)
+{
+	if (alterIsThreadSafe != m_alterIsThreadSafe)
+		ms_numberOfAlterThreadSafeObjects += alterIsThreadSafe ? 1 : -1;
+
+	m_alterIsThreadSafe = alterIsThreadSafe;
+}
+
+// ----------------------------------------------------------------------
+/**
+ * The number of live objects marked alter-thread-safe.  The alter scheduler
+ * skips its parallel pass entirely when there are none.
+ */
+
+int Object::getNumberOfAlterThreadSafeObjects()
+{
+	return ms_numberOfAlterThreadSafeObjects;
+}
+
+// ----------------------------------------------------------------------
+
 void Object::setObjectToWorldDirty(bool const objectToWorldDirty) const
 {
 #if ENABLE_OBJECTTOWORLDDIRTY == 1
@@ -3250,6 +3413,7 @@ void Object::getObjectInfo(std::map<std::string, std::map<std::string, Unicode::
 //CollisionProperty        *m_collisionProperty;
 //SpatialSubdivisionHandle *m_spatialSubdivisionHandle;
 	DebugInfoManager::addProperty(propertyMap, ms_debugInfoSectionName, "UseAlterScheduler", m_useAlterScheduler);
+	DebugInfoManager::addProperty(propertyMap, ms_debugInfoSectionName, "AlterIsThreadSafe", m_alterIsThreadSafe);
 //ScheduleData             *m_scheduleData;
 
 	if(m_containedBy)
@@ -327,6 +327,10 @@ public:
 	bool getUseAlterScheduler() const;
 	void setUseAlterScheduler(bool const useAlterScheduler);
 
+	bool getAlterIsThreadSafe() const;
+	void setAlterIsThreadSafe(bool alterIsThreadSafe);
+	static int getNumberOfAlterThreadSafeObjects();
+
 	virtual void getObjectInfo(stdmap<std::string, stdmap<std::string, Unicode::String>::fwd >::fwd & propertyMap) const;
 
 	bool getShouldBakeIntoMesh() const;
@@ -364,6 +368,7 @@ private:
 
 	void  reorthonormalize();
 	void  cellChanged(bool dueToParentChange);
+	bool  deferTransformChange(bool position, bool rotation, Vector const &oldPosition);
 
 	void setObjectToWorldDirty(bool objectToWorldDirty) const;
 
@@ -396,6 +401,13 @@ private:
 	void  removeFromConcludeList();
 
 	void *getScheduleTimeMapIterator();
+	void *getScheduleTimingWheelEntry();
+
+	// Results of alters run on the alter scheduler's worker threads.
+	void  setParallelAlterResult(float alterResult);
+	bool  takeParallelAlterResult(float &alterResult);
+	void  clearParallelAlterResult();
+	void  dispatchDeferredTransformChanges();
 
 	// Container traversal.
 	Object *getNextFromAlterNowList();
@@ -465,6 +477,10 @@ private:
 	SpatialSubdivisionHandle *m_spatialSubdivisionHandle;
 
 	bool                      m_useAlterScheduler;
+	bool                      m_alterIsThreadSafe;
+	bool                      m_positionChangeDeferred;
+	bool                      m_rotationChangeDeferred;
+	Vector                    m_deferredOldPosition;
 	ScheduleData             *m_scheduleData;
 
 	bool					  m_shouldBakeIntoMesh;
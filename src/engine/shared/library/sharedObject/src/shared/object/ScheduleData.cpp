@@ -27,8 +27,16 @@ ScheduleData::ScheduleData(AlterScheduler::ScheduleTime initialMostRecentAlterTi
 	m_concludeNext(NULL),
 	m_concludePrevious(NULL),
 	m_scheduleTimeMapIterator(),
-	m_schedulePhase(0)
+	m_timingWheelEntry(),
+	m_schedulePhase(0),
+	m_parallelAlterResult(0.0f),
+	m_hasParallelAlterResult(false)
 {
+	m_timingWheelEntry.next         = NULL;
+	m_timingWheelEntry.previous     = NULL;
+	m_timingWheelEntry.scheduleTime = 0;
+	m_timingWheelEntry.sequence     = 0;
+	m_timingWheelEntry.slot         = -1;
 }
 
 // ----------------------------------------------------------------------
@@ -39,10 +47,12 @@ ScheduleData::~ScheduleData()
 	DEBUG_WARNING(m_alterNextFrameNext || m_alterNextFramePrevious, ("ScheduleData for owning object is still in the AlterScheduler AlterNextFrame list, improper object cleanup."));
 	DEBUG_WARNING(m_concludeNext || m_concludePrevious, ("ScheduleData for owning object is still in the AlterScheduler Conclude list, improper object cleanup."));
 	DEBUG_WARNING(AlterScheduler::isIteratorInScheduleTimeMap(&m_scheduleTimeMapIterator), ("ScheduleData for owning object is still in the AlterScheduler ScheduleTimeMap, improper object cleanup."));
+	DEBUG_WARNING(m_timingWheelEntry.slot >= 0, ("ScheduleData for owning object is still in the AlterScheduler timing wheel, improper object cleanup."));
 	DEBUG_FATAL(m_alterNowNext || m_alterNowPrevious 
 		|| m_alterNextFrameNext || m_alterNextFramePrevious 
 		|| m_concludeNext || m_concludePrevious
-		|| AlterScheduler::isIteratorInScheduleTimeMap(&m_scheduleTimeMapIterator), 
+		|| AlterScheduler::isIteratorInScheduleTimeMap(&m_scheduleTimeMapIterator)
+		|| (m_timingWheelEntry.slot >= 0), 
 		("ScheduleData not cleaned up properly, referring object not removed from alter scheduler."));
 	VALIDATE_RANGE_INCLUSIVE_EXCLUSIVE(0, m_schedulePhase, AS_MAX_SCHEDULE_PHASE_COUNT);
 }
@@ -48,10 +48,16 @@ public:
 	void                          setConcludePrevious(Object *object);
 
 	AlterScheduler::ScheduleTimeMap::iterator &getScheduleTimeMapIterator();
+	AlterScheduler::TimingWheelEntry          &getTimingWheelEntry();
 
 	int                           getSchedulePhase() const;
 	void                          setSchedulePhase(int schedulePhase);
 
+	bool                          hasParallelAlterResult() const;
+	float                         getParallelAlterResult() const;
+	void                          setParallelAlterResult(float alterResult);
+	void                          clearParallelAlterResult();
+
 private:
 
 	// Disabled.
@@ -73,9 +79,13 @@ private:
 	Object                                    *m_concludePrevious;
 
 	AlterScheduler::ScheduleTimeMap::iterator  m_scheduleTimeMapIterator;
+	AlterScheduler::TimingWheelEntry           m_timingWheelEntry;
 
 	int                                        m_schedulePhase;
 
+	float                                      m_parallelAlterResult;
+	bool                                       m_hasParallelAlterResult;
+
 };
 
 // ======================================================================
@@ -185,6 +195,13 @@ inline AlterScheduler::ScheduleTimeMap::iterator &ScheduleData::getScheduleTimeM
 
 // ----------------------------------------------------------------------
 
+inline AlterScheduler::TimingWheelEntry &ScheduleData::getTimingWheelEntry()
+{
+	return m_timingWheelEntry;
+}
+
+// ----------------------------------------------------------------------
+
 inline int ScheduleData::getSchedulePhase() const
 {
 	return m_schedulePhase;
@@ -198,6 +215,35 @@ inline void ScheduleData::setSchedulePhase(int schedulePhase)
 	m_schedulePhase = schedulePhase;
 }
 
+// ----------------------------------------------------------------------
+
+inline bool ScheduleData::hasParallelAlterResult() const
+{
+	return m_hasParallelAlterResult;
+}
+
+// ----------------------------------------------------------------------
+
+inline float ScheduleData::getParallelAlterResult() const
+{
+	return m_parallelAlterResult;
+}
+
+// ----------------------------------------------------------------------
+
+inline void ScheduleData::setParallelAlterResult(float alterResult)
+{
+	m_parallelAlterResult    = alterResult;
+	m_hasParallelAlterResult = true;
+}
+
+// ----------------------------------------------------------------------
+
+inline void ScheduleData::clearParallelAlterResult()
+{
+	m_hasParallelAlterResult = false;
+}
+
 // ======================================================================
 
 #endif
@@ -23,6 +23,8 @@
 #include "sharedObject/ObjectList.h"
 #include "sharedTerrain/TerrainObject.h"
 
+#include <algorithm>
+#include <hash_map>
 #include <string>
 #include <vector>
 
@@ -82,10 +84,480 @@ namespace WorldNamespace
 	ObjectSet ms_objectSet;
 
 	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	/**
+	 * Uniform grid over the x/z plane for one world object list.
+	 *
+	 * Each cell holds the objects whose query position falls inside it.  Cells
+	 * are hashed so only occupied cells cost anything.  The index also tracks
+	 * where each object lives in its ObjectList so membership tests, removal
+	 * and findNextObject don't have to scan the list.
+	 */
+	class ObjectIndex
+	{
+	public:
+
+		typedef std::vector<Object *> ObjectVector;
+
+	public:
+
+		ObjectIndex();
+
+		void  add(Object * object, int listPosition);
+		void  remove(Object const * object);
+		void  move(Object const * object);
+		void  clear();
+
+		int   getListPosition(Object const * object) const;
+		void  setListPosition(Object const * object, int listPosition);
+		bool  isInCorrectCell(Object const * object) const;
+
+		int   getNumberOfObjects() const;
+		int   getNumberOfCells() const;
+
+		void  findClosest(Vector const & position_w, int count, Object const * excludeObject, ObjectVector & closestObjects) const;
+		void  findInRange(Vector const & position_w, float range, ObjectVector & objects) const;
+
+	private:
+
+		struct Entry
+		{
+			int    m_listPosition;
+			uint32 m_cellKey;
+		};
+
+		struct PointerHash
+		{
+			size_t operator()(Object const * object) const
+			{
+				return reinterpret_cast<size_t>(object) >> 4;
+			}
+		};
+
+		typedef std::hash_map<Object const *, Entry, PointerHash> EntryMap;
+		typedef std::hash_map<uint32, ObjectVector>               CellMap;
+		typedef std::pair<float, Object *>                         Candidate;
+		typedef std::vector<Candidate>                             CandidateVector;
+
+	private:
+
+		static int     getCellCoordinate(float value);
+		static bool    isValidCellCoordinate(int value);
+		static uint32  getCellKey(int x, int z);
+		static uint32  getCellKey(Vector const & position_w);
+		static int     getCellX(uint32 cellKey);
+		static int     getCellZ(uint32 cellKey);
+
+		ObjectVector const * findCell(int x, int z) const;
+		Object *             removeFromCell(uint32 cellKey, Object const * object);
+
+		static void    addCandidates(ObjectVector const & cell, Vector const & position_w, int count, Object const * excludeObject, CandidateVector & candidates);
+		static void    addInRange(ObjectVector const & cell, Vector const & position_w, float rangeSquared, ObjectVector & objects);
+
+	private:
+
+		// Disabled.
+		ObjectIndex(ObjectIndex const &);
+		ObjectIndex & operator=(ObjectIndex const &);
+
+	private:
+
+		EntryMap m_entries;
+		CellMap  m_cells;
+	};
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	float const cms_cellSize              = 32.0f;
+	int const   cms_minimumCellCoordinate = -32768;
+	int const   cms_maximumCellCoordinate = 32767;
+
+	// lists this small are cheaper to scan than to walk the grid for
+	int const   cms_linearSearchLimit     = 64;
+
+	ObjectIndex * ms_objectIndex [WOL_Count];
+
+	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	Vector getQueryPosition(Object const & object)
+	{
+		return object.getAppearance() ? object.getAppearanceSphereCenter_w() : object.getPosition_w();
+	}
 }
 
 using namespace WorldNamespace;
 
+// ======================================================================
+// WorldNamespace::ObjectIndex
+// ======================================================================
+
+WorldNamespace::ObjectIndex::ObjectIndex() :
+	m_entries(),
+	m_cells()
+{
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::add(Object * const object, int const listPosition)
+{
+	NOT_NULL(object);
+	DEBUG_FATAL(m_entries.find(object) != m_entries.end(), ("ObjectIndex::add: object already indexed"));
+
+	Entry entry;
+	entry.m_listPosition = listPosition;
+	entry.m_cellKey = getCellKey(getQueryPosition(*object));
+	m_entries[object] = entry;
+
+	m_cells[entry.m_cellKey].push_back(object);
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::remove(Object const * const object)
+{
+	EntryMap::iterator const iter = m_entries.find(object);
+	if (iter == m_entries.end())
+		return;
+
+	IGNORE_RETURN(removeFromCell(iter->second.m_cellKey, object));
+	m_entries.erase(iter);
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::move(Object const * const object)
+{
+	EntryMap::iterator const iter = m_entries.find(object);
+	if (iter == m_entries.end())
+		return;
+
+	uint32 const cellKey = getCellKey(getQueryPosition(*object));
+	if (cellKey == iter->second.m_cellKey)
+		return;
+
+	Object * const mutableObject = removeFromCell(iter->second.m_cellKey, object);
+	NOT_NULL(mutableObject);
+
+	m_cells[cellKey].push_back(mutableObject);
+	iter->second.m_cellKey = cellKey;
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::clear()
+{
+	m_entries.clear();
+	m_cells.clear();
+}
+
+// ----------------------------------------------------------------------
+
+int WorldNamespace::ObjectIndex::getListPosition(Object const * const object) const
+{
+	EntryMap::const_iterator const iter = m_entries.find(object);
+	return iter != m_entries.end() ? iter->second.m_listPosition : -1;
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::setListPosition(Object const * const object, int const listPosition)
+{
+	EntryMap::iterator const iter = m_entries.find(object);
+	DEBUG_FATAL(iter == m_entries.end(), ("ObjectIndex::setListPosition: object not indexed"));
+	if (iter != m_entries.end())
+		iter->second.m_listPosition = listPosition;
+}
+
+// ----------------------------------------------------------------------
+
+bool WorldNamespace::ObjectIndex::isInCorrectCell(Object const * const object) const
+{
+	EntryMap::const_iterator const iter = m_entries.find(object);
+	return iter != m_entries.end() && iter->second.m_cellKey == getCellKey(getQueryPosition(*object));
+}
+
+// ----------------------------------------------------------------------
+
+int WorldNamespace::ObjectIndex::getNumberOfObjects() const
+{
+	return static_cast<int>(m_entries.size());
+}
+
+// ----------------------------------------------------------------------
+
+int WorldNamespace::ObjectIndex::getNumberOfCells() const
+{
+	return static_cast<int>(m_cells.size());
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Find the count objects closest to position_w, nearest first.
+ *
+ * Rings of cells are searched outward from the cell containing position_w
+ * until every unsearched cell is farther away than the current count-th
+ * closest candidate.  If the rings grow to cover more cells than are
+ * actually occupied, the remaining occupied cells are swept directly.
+ */
+
+void WorldNamespace::ObjectIndex::findClosest(Vector const & position_w, int const count, Object const * const excludeObject, ObjectVector & closestObjects) const
+{
+	closestObjects.clear();
+	if (count <= 0 || m_entries.empty())
+		return;
+
+	CandidateVector candidates;
+	candidates.reserve(static_cast<size_t>(std::min(count, getNumberOfObjects())));
+
+	if (getNumberOfObjects() <= cms_linearSearchLimit)
+	{
+		for (CellMap::const_iterator iter = m_cells.begin(); iter != m_cells.end(); ++iter)
+			addCandidates(iter->second, position_w, count, excludeObject, candidates);
+	}
+	else
+	{
+		int const centerX = getCellCoordinate(position_w.x);
+		int const centerZ = getCellCoordinate(position_w.z);
+		int const numberOfCells = getNumberOfCells();
+		int cellsSearched = 0;
+
+		for (int ring = 0; ; ++ring)
+		{
+			if (ring == 0)
+			{
+				ObjectVector const * const cell = findCell(centerX, centerZ);
+				if (cell)
+					addCandidates(*cell, position_w, count, excludeObject, candidates);
+
+				cellsSearched = 1;
+			}
+			else
+			{
+				for (int x = centerX - ring; x <= centerX + ring; ++x)
+				{
+					ObjectVector const * cell = findCell(x, centerZ - ring);
+					if (cell)
+						addCandidates(*cell, position_w, count, excludeObject, candidates);
+
+					cell = findCell(x, centerZ + ring);
+					if (cell)
+						addCandidates(*cell, position_w, count, excludeObject, candidates);
+				}
+
+				for (int z = centerZ - ring + 1; z < centerZ + ring; ++z)
+				{
+					ObjectVector const * cell = findCell(centerX - ring, z);
+					if (cell)
+						addCandidates(*cell, position_w, count, excludeObject, candidates);
+
+					cell = findCell(centerX + ring, z);
+					if (cell)
+						addCandidates(*cell, position_w, count, excludeObject, candidates);
+				}
+
+				cellsSearched += 8 * ring;
+			}
+
+			//-- every object outside the searched square is at least this far away
+			if (static_cast<int>(candidates.size()) == count)
+			{
+				float const minimumX = static_cast<float>(centerX - ring) * cms_cellSize;
+				float const maximumX = static_cast<float>(centerX + ring + 1) * cms_cellSize;
+				float const minimumZ = static_cast<float>(centerZ - ring) * cms_cellSize;
+				float const maximumZ = static_cast<float>(centerZ + ring + 1) * cms_cellSize;
+				float const boundary = std::min(std::min(position_w.x - minimumX, maximumX - position_w.x), std::min(position_w.z - minimumZ, maximumZ - position_w.z));
+
+				if (boundary >= 0.0f && candidates.front().first <= sqr(boundary))
+					break;
+			}
+
+			//-- the rings now cover more cells than are occupied, so sweep whatever is left
+			if (cellsSearched >= numberOfCells)
+			{
+				for (CellMap::const_iterator iter = m_cells.begin(); iter != m_cells.end(); ++iter)
+				{
+					int const distanceX = abs(getCellX(iter->first) - centerX);
+					int const distanceZ = abs(getCellZ(iter->first) - centerZ);
+					if (std::max(distanceX, distanceZ) > ring)
+						addCandidates(iter->second, position_w, count, excludeObject, candidates);
+				}
+
+				break;
+			}
+		}
+	}
+
+	std::sort_heap(candidates.begin(), candidates.end());
+
+	closestObjects.reserve(candidates.size());
+	for (CandidateVector::const_iterator iter = candidates.begin(); iter != candidates.end(); ++iter)
+		closestObjects.push_back(iter->second);
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::findInRange(Vector const & position_w, float const range, ObjectVector & objects) const
+{
+	objects.clear();
+	if (range < 0.0f || m_entries.empty())
+		return;
+
+	float const rangeSquared = sqr(range);
+
+	int const minimumX = getCellCoordinate(position_w.x - range);
+	int const maximumX = getCellCoordinate(position_w.x + range);
+	int const minimumZ = getCellCoordinate(position_w.z - range);
+	int const maximumZ = getCellCoordinate(position_w.z + range);
+
+	float const cellsInRange = static_cast<float>(maximumX - minimumX + 1) * static_cast<float>(maximumZ - minimumZ + 1);
+	if (getNumberOfObjects() <= cms_linearSearchLimit || cellsInRange > static_cast<float>(getNumberOfCells()))
+	{
+		for (CellMap::const_iterator iter = m_cells.begin(); iter != m_cells.end(); ++iter)
+			addInRange(iter->second, position_w, rangeSquared, objects);
+	}
+	else
+	{
+		for (int z = minimumZ; z <= maximumZ; ++z)
+			for (int x = minimumX; x <= maximumX; ++x)
+			{
+				ObjectVector const * const cell = findCell(x, z);
+				if (cell)
+					addInRange(*cell, position_w, rangeSquared, objects);
+			}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+int WorldNamespace::ObjectIndex::getCellCoordinate(float const value)
+{
+	float const cell = floorf(value / cms_cellSize);
+	if (cell <= static_cast<float>(cms_minimumCellCoordinate))
+		return cms_minimumCellCoordinate;
+
+	if (cell >= static_cast<float>(cms_maximumCellCoordinate))
+		return cms_maximumCellCoordinate;
+
+	return static_cast<int>(cell);
+}
+
+// ----------------------------------------------------------------------
+
+bool WorldNamespace::ObjectIndex::isValidCellCoordinate(int const value)
+{
+	return value >= cms_minimumCellCoordinate && value <= cms_maximumCellCoordinate;
+}
+
+// ----------------------------------------------------------------------
+
+uint32 WorldNamespace::ObjectIndex::getCellKey(int const x, int const z)
+{
+	return (static_cast<uint32>(static_cast<uint16>(x)) << 16) | static_cast<uint32>(static_cast<uint16>(z));
+}
+
+// ----------------------------------------------------------------------
+
+uint32 WorldNamespace::ObjectIndex::getCellKey(Vector const & position_w)
+{
+	return getCellKey(getCellCoordinate(position_w.x), getCellCoordinate(position_w.z));
+}
+
+// ----------------------------------------------------------------------
+
+int WorldNamespace::ObjectIndex::getCellX(uint32 const cellKey)
+{
+	return static_cast<int>(static_cast<int16>(static_cast<uint16>(cellKey >> 16)));
+}
+
+// ----------------------------------------------------------------------
+
+int WorldNamespace::ObjectIndex::getCellZ(uint32 const cellKey)
+{
+	return static_cast<int>(static_cast<int16>(static_cast<uint16>(cellKey & 0xffff)));
+}
+
+// ----------------------------------------------------------------------
+
+WorldNamespace::ObjectIndex::ObjectVector const * WorldNamespace::ObjectIndex::findCell(int const x, int const z) const
+{
+	//-- coordinates past the grid edge would wrap onto real cells
+	if (!isValidCellCoordinate(x) || !isValidCellCoordinate(z))
+		return 0;
+
+	CellMap::const_iterator const iter = m_cells.find(getCellKey(x, z));
+	return iter != m_cells.end() ? &iter->second : 0;
+}
+
+// ----------------------------------------------------------------------
+
+Object * WorldNamespace::ObjectIndex::removeFromCell(uint32 const cellKey, Object const * const object)
+{
+	CellMap::iterator const iter = m_cells.find(cellKey);
+	DEBUG_FATAL(iter == m_cells.end(), ("ObjectIndex::removeFromCell: cell not found"));
+	if (iter == m_cells.end())
+		return 0;
+
+	ObjectVector & cell = iter->second;
+	for (ObjectVector::iterator objectIter = cell.begin(); objectIter != cell.end(); ++objectIter)
+	{
+		if (*objectIter == object)
+		{
+			Object * const result = *objectIter;
+
+			*objectIter = cell.back();
+			cell.pop_back();
+
+			if (cell.empty())
+				m_cells.erase(iter);
+
+			return result;
+		}
+	}
+
+	DEBUG_FATAL(true, ("ObjectIndex::removeFromCell: object not found in its cell"));
+	return 0;
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::addCandidates(ObjectVector const & cell, Vector const & position_w, int const count, Object const * const excludeObject, CandidateVector & candidates)
+{
+	for (ObjectVector::const_iterator iter = cell.begin(); iter != cell.end(); ++iter)
+	{
+		Object * const object = *iter;
+		if (object == excludeObject)
+			continue;
+
+		float const distanceSquared = position_w.magnitudeBetweenSquared(getQueryPosition(*object));
+
+		//-- candidates is a max-heap on distance holding at most count entries
+		if (static_cast<int>(candidates.size()) < count)
+		{
+			candidates.push_back(Candidate(distanceSquared, object));
+			std::push_heap(candidates.begin(), candidates.end());
+		}
+		else if (distanceSquared < candidates.front().first)
+		{
+			std::pop_heap(candidates.begin(), candidates.end());
+			candidates.back() = Candidate(distanceSquared, object);
+			std::push_heap(candidates.begin(), candidates.end());
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+void WorldNamespace::ObjectIndex::addInRange(ObjectVector const & cell, Vector const & position_w, float const rangeSquared, ObjectVector & objects)
+{
+	for (ObjectVector::const_iterator iter = cell.begin(); iter != cell.end(); ++iter)
+	{
+		Object * const object = *iter;
+		if (position_w.magnitudeBetweenSquared(getQueryPosition(*object)) <= rangeSquared)
+			objects.push_back(object);
+	}
+}
+
 // ======================================================================
 // PUBLIC STATIC World
 // ======================================================================
@@ -165,7 +637,10 @@ void World::install ()
 	//-- create the object lists
 	int i;
 	for (i = 0; i < static_cast<int>(WOL_Count); i++)
+	{
 		ms_objectList [i] = new ObjectList (100);
+		ms_objectIndex [i] = new ObjectIndex;
+	}
 
 	ms_queuedObjectList = new ObjectList (100);
 
@@ -220,6 +695,7 @@ void World::remove ()
 				int const lastObjectIndex = objectList->getNumberOfObjects() - 1;
 				Object *const object = objectList->getObject(lastObjectIndex);
 				objectList->removeObjectByIndex(object, lastObjectIndex);
+				ms_objectIndex [i]->remove(object);
 
 				// do not delete contained objects, since their container will delete them
 				if (!object->getAttachedTo())
@@ -228,6 +704,9 @@ void World::remove ()
 
 			delete ms_objectList [i];
 			ms_objectList [i] = 0;
+
+			delete ms_objectIndex [i];
+			ms_objectIndex [i] = 0;
 		}
 	}
 
@@ -279,6 +758,7 @@ void World::addObject (Object* object, int listIndex)
 	DEBUG_FATAL (existsInWorld (object), ("object already in world"));
 
 	ms_objectSet.insert(object);
+	ms_objectIndex [listIndex]->add (object, ms_objectList [listIndex]->getNumberOfObjects ());
 	ms_objectList [listIndex]->addObject (object);
 
 	//-- notification of addition is guaranteed to occur AFTER the object is actually added
@@ -311,8 +791,7 @@ bool World::removeObject (const Object* object, int listIndex)
 	ms_objectSet.erase(object);
 
 	bool result;
-	int  index = 0;
-	if (ms_objectList [listIndex]->find (object, &index))
+	if (existsInList (object, listIndex))
 	{
 		const NetworkId id = object->getNetworkId();
 
@@ -321,7 +800,17 @@ bool World::removeObject (const Object* object, int listIndex)
 			ms_emitter.emitMessage(msg);
 		}
 
-		ms_objectList [listIndex]->removeObjectByIndex (object, index);
+		//-- the list fills the hole with its last object, so keep that object's index entry in step
+		ObjectList* const objectList  = ms_objectList [listIndex];
+		ObjectIndex* const objectIndex = ms_objectIndex [listIndex];
+		const int           index      = objectIndex->getListPosition (object);
+		const Object* const lastObject = objectList->getObject (objectList->getNumberOfObjects () - 1);
+
+		objectList->removeObjectByIndex (object, index);
+		objectIndex->remove (object);
+
+		if (lastObject != object)
+			objectIndex->setListPosition (lastObject, index);
 
 		{
 			Emitter::ObjectMessage const msg(Messages::OBJECT_REMOVED, std::make_pair(id, listIndex));
@@ -354,6 +843,21 @@ void World::queueObject  (Object* object)
 	ms_queuedObjectList->addObject (object);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Update the spatial index for an object in the given list after its
+ * position or extent has changed.  Objects not in the list are ignored.
+ */
+
+void World::moveObject (const Object* object, int listIndex)
+{
+	DEBUG_FATAL (!ms_installed, ("not installed"));
+	NOT_NULL (object);
+	VALIDATE_RANGE_INCLUSIVE_EXCLUSIVE (0, listIndex, static_cast<int>(WOL_Count));
+
+	ms_objectIndex [listIndex]->move (object);
+}
+
 // ----------------------------------------------------------------------
 
 int World::getNumberOfObjects (int listIndex)
@@ -426,14 +930,9 @@ const Object* World::findNextObject (const Object* object, int listIndex)
 	if (!object)
 		return ms_objectList [listIndex]->getObject (0);
 
-	//-- search for object in list
-	int i;
-	for (i = 0; i < ms_objectList [listIndex]->getNumberOfObjects (); i++)
-		if (ms_objectList [listIndex]->getObject (i) == object)
-			break;
-
 	//-- if object was not found in the list, return the first object
-	if (i == ms_objectList [listIndex]->getNumberOfObjects ())
+	int i = ms_objectIndex [listIndex]->getListPosition (object);
+	if (i < 0)
 		return ms_objectList [listIndex]->getObject (0);
 
 	//-- return the next object
@@ -466,28 +965,10 @@ Object* World::findClosestObjectTo (const Object* object, int listIndex)
 
 	NOT_NULL (object);
 
-	Object* closestObject    = 0;
-	float   shortestDistance = REAL_MAX;
-
-	int i;
-	for (i = 0; i < ms_objectList [listIndex]->getNumberOfObjects (); i++)
-	{
-		if (object != ms_objectList [listIndex]->getObject (i))
-		{
-			Object* const objectToCheck = ms_objectList [listIndex]->getObject (i);
-			const Vector  position1 = object->getAppearance () ? object->getAppearanceSphereCenter_w () : object->getPosition_w ();
-			const Vector  position2 = objectToCheck->getAppearance () ? objectToCheck->getAppearanceSphereCenter_w () : objectToCheck->getPosition_w ();
-			const float   magnitudeBetweenSquared = position1.magnitudeBetweenSquared (position2);
-
-			if (magnitudeBetweenSquared < shortestDistance)
-			{
-				shortestDistance = magnitudeBetweenSquared;
-				closestObject    = objectToCheck;
-			}
-		}
-	}
+	ObjectIndex::ObjectVector closestObjects;
+	ms_objectIndex [listIndex]->findClosest (getQueryPosition (*object), 1, object, closestObjects);
 
-	return closestObject;
+	return closestObjects.empty () ? 0 : closestObjects.front ();
 }
 
 // ----------------------------------------------------------------------
@@ -497,6 +978,41 @@ const Object* World::findClosestConstObjectTo (const Object* object, int listInd
 	return findClosestObjectTo (object, listIndex);
 }
 
+// ----------------------------------------------------------------------
+/**
+ * Find up to count objects in the list closest to position_w, nearest
+ * first.  Distances are measured to each object's appearance sphere center
+ * when it has an appearance, otherwise to its position.
+ *
+ * @return the number of objects found
+ */
+
+int World::findClosestObjects (const Vector& position_w, int listIndex, int count, ObjectVector& closestObjects, const Object* excludeObject)
+{
+	DEBUG_FATAL (!ms_installed, ("not installed"));
+	VALIDATE_RANGE_INCLUSIVE_EXCLUSIVE (0, listIndex, static_cast<int>(WOL_Count));
+
+	ms_objectIndex [listIndex]->findClosest (position_w, count, excludeObject, closestObjects);
+	return static_cast<int>(closestObjects.size ());
+}
+
+// ----------------------------------------------------------------------
+/**
+ * Find every object in the list within range of position_w, in no
+ * particular order.
+ *
+ * @return the number of objects found
+ */
+
+int World::findObjectsInRange (const Vector& position_w, float range, int listIndex, ObjectVector& objects)
+{
+	DEBUG_FATAL (!ms_installed, ("not installed"));
+	VALIDATE_RANGE_INCLUSIVE_EXCLUSIVE (0, listIndex, static_cast<int>(WOL_Count));
+
+	ms_objectIndex [listIndex]->findInRange (position_w, range, objects);
+	return static_cast<int>(objects.size ());
+}
+
 // ----------------------------------------------------------------------
 
 void World::validate ()
@@ -509,7 +1025,12 @@ void World::validate ()
 
 			if (!object->isInWorld ())
 				DEBUG_FATAL (true, ("World::validate - object [%s] in world object list %i wasn't in the world", object->getNetworkId ().getValueString ().c_str (), i));
+
+			DEBUG_FATAL (ms_objectIndex [i]->getListPosition (object) != j, ("World::validate - object [%s] in world object list %i has index position %i, expected %i", object->getNetworkId ().getValueString ().c_str (), i, ms_objectIndex [i]->getListPosition (object), j));
+			DEBUG_WARNING (!ms_objectIndex [i]->isInCorrectCell (object), ("World::validate - object [%s] in world object list %i moved without World::moveObject", object->getNetworkId ().getValueString ().c_str (), i));
 		}
+
+		DEBUG_FATAL (ms_objectIndex [i]->getNumberOfObjects () != getNumberOfObjects (i), ("World::validate - world object list %i has %i objects but its index has %i", i, getNumberOfObjects (i), ms_objectIndex [i]->getNumberOfObjects ()));
 	}
 }
 
@@ -550,8 +1071,7 @@ const MessageDispatch::Emitter& World::getEmitter ()
 
 bool World::existsInList (const Object* object, int listIndex)
 {
-	int index;
-	return ms_objectList [listIndex]->find (object, &index);
+	return ms_objectIndex [listIndex]->getListPosition (object) >= 0;
 }
 
 // ----------------------------------------------------------------------
@@ -572,7 +1092,7 @@ void World::debugReport ()
 
 	DEBUG_REPORT_PRINT (true, ("-- World\n"));
 	for (int i = 0; i < static_cast<int> (WOL_Count); i++)
-		DEBUG_REPORT_PRINT (true, ("[%s] %4i objects\n", cms_objectListNames [i], World::getNumberOfObjects (i)));
+		DEBUG_REPORT_PRINT (true, ("[%s] %4i objects %4i cells\n", cms_objectListNames [i], World::getNumberOfObjects (i), ms_objectIndex [i]->getNumberOfCells ()));
 }
 
 // ======================================================================
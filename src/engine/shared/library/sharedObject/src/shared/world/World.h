@@ -40,6 +40,7 @@ class LotManager;
 class Object;
 class ObjectList;
 class NetworkId;
+class Vector;
 
 namespace MessageDispatch
 {
@@ -73,6 +74,10 @@ public:
 
 	//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+	typedef stdvector<Object *>::fwd ObjectVector;
+
+	//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 public:
 
 	static int                  getFrameNumber ();
@@ -99,9 +104,12 @@ protected:
 	static void                 addObject    (Object* object, int listIndex);
 	static bool                 removeObject (const Object* object, int listIndex);
 	static void                 queueObject  (Object* object);
+	static void                 moveObject   (const Object* object, int listIndex);
 
 	static Object*              findClosestObjectTo (const Object* object, int listIndex);
 	static const Object*        findClosestConstObjectTo (const Object* object, int listIndex);
+	static int                  findClosestObjects (const Vector& position_w, int listIndex, int count, ObjectVector& closestObjects, const Object* excludeObject = 0);
+	static int                  findObjectsInRange (const Vector& position_w, float range, int listIndex, ObjectVector& objects);
 
 	static const Object*        findNextObject (const Object* object, int listIndex);
 
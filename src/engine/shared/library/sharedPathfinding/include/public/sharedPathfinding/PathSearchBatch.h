@@ -0,0 +1 @@
+#include "../../src/shared/PathSearchBatch.h"
@@ -22,6 +22,12 @@ bool  ConfigSharedPathfinding::ms_useCityRegions = true;
 bool  ConfigSharedPathfinding::ms_jitterCityWaypoints = false;
 bool  ConfigSharedPathfinding::ms_enableDirtyBoxes = false;
 bool  ConfigSharedPathfinding::ms_enablePathScrubber = false;
+int   ConfigSharedPathfinding::ms_pathSearchCacheSize = 64;
+int   ConfigSharedPathfinding::ms_hierarchicalSearchNodes = 0;
+float ConfigSharedPathfinding::ms_hierarchicalClusterSize = 64.0f;
+int   ConfigSharedPathfinding::ms_pathSearchThreads = 0;
+char const * ConfigSharedPathfinding::ms_benchmarkSearchGraph = "";
+int   ConfigSharedPathfinding::ms_benchmarkSearchCount = 1000;
 
 // ----------------------------------------------------------------------
 
@@ -32,6 +38,12 @@ void ConfigSharedPathfinding::install ()
 	KEY_BOOL(jitterCityWaypoints,false);
 	KEY_BOOL(enableDirtyBoxes,false);
 	KEY_BOOL(enablePathScrubber,false);
+	KEY_INT(pathSearchCacheSize,64);
+	KEY_INT(hierarchicalSearchNodes,0);      // graphs with at least this many nodes are searched through clusters, 0 disables
+	KEY_FLOAT(hierarchicalClusterSize,64.0f);
+	KEY_INT(pathSearchThreads,0);
+	KEY_STRING(benchmarkSearchGraph,"");
+	KEY_INT(benchmarkSearchCount,1000);
 }
 
 // ======================================================================
@@ -22,6 +22,12 @@ public:
 	static bool        getJitterCityWaypoints();
 	static bool        getEnableDirtyBoxes();
 	static bool        getEnablePathScrubber();
+	static int         getPathSearchCacheSize();
+	static int         getHierarchicalSearchNodes();
+	static float       getHierarchicalClusterSize();
+	static int         getPathSearchThreads();
+	static char const * getBenchmarkSearchGraph();
+	static int         getBenchmarkSearchCount();
 
 private:
 
@@ -30,6 +36,12 @@ private:
 	static bool        ms_jitterCityWaypoints;
 	static bool        ms_enableDirtyBoxes;
 	static bool        ms_enablePathScrubber;
+	static int         ms_pathSearchCacheSize;
+	static int         ms_hierarchicalSearchNodes;
+	static float       ms_hierarchicalClusterSize;
+	static int         ms_pathSearchThreads;
+	static char const * ms_benchmarkSearchGraph;
+	static int         ms_benchmarkSearchCount;
 };
 
 //--------------------------------------------------------------------
@@ -59,6 +71,36 @@ inline bool ConfigSharedPathfinding::getEnablePathScrubber()
 	return ms_enablePathScrubber;
 }
 
+inline int ConfigSharedPathfinding::getPathSearchCacheSize()
+{
+	return ms_pathSearchCacheSize;
+}
+
+inline int ConfigSharedPathfinding::getHierarchicalSearchNodes()
+{
+	return ms_hierarchicalSearchNodes;
+}
+
+inline float ConfigSharedPathfinding::getHierarchicalClusterSize()
+{
+	return ms_hierarchicalClusterSize;
+}
+
+inline int ConfigSharedPathfinding::getPathSearchThreads()
+{
+	return ms_pathSearchThreads;
+}
+
+inline char const * ConfigSharedPathfinding::getBenchmarkSearchGraph()
+{
+	return ms_benchmarkSearchGraph;
+}
+
+inline int ConfigSharedPathfinding::getBenchmarkSearchCount()
+{
+	return ms_benchmarkSearchCount;
+}
+
 // ======================================================================
 
 #endif
@@ -43,6 +43,9 @@ void DynamicPathGraph::clear ( void )
 	}
 
 	m_nodeList->clear();
+
+	markChanged();
+	nodesReplaced();
 }
 
 // ----------
@@ -146,6 +149,9 @@ int DynamicPathGraph::addNode ( DynamicPathNode * newNode )
 
 	m_liveNodeCount++;
 
+	markChanged();
+	nodeAdded(nodeIndex);
+
 	return nodeIndex;
 }
 
@@ -159,11 +165,15 @@ void DynamicPathGraph::removeNode ( int nodeIndex )
 	{
 		unlinkNode(nodeIndex);
 
+		nodeRemoved(nodeIndex);
+
 		m_nodeList->at(nodeIndex) = NULL;
 
 		delete node;
 
 		m_liveNodeCount--;
+
+		markChanged();
 	}
 }
 
@@ -177,6 +187,9 @@ void DynamicPathGraph::moveNode ( int nodeIndex, Vector const & newPosition )
 
 		m_dirtyNodes->push_back(nodeIndex);
 
+		markChanged();
+		nodeMoved(nodeIndex);
+
 		//@todo - HACK - force cleaning after move
 
 		clean();
@@ -191,6 +204,13 @@ void DynamicPathGraph::update ( void )
 	{
 		clean();
 	}
+
+	// keep the part tags current so searches can reject unreachable goals
+
+	if(m_partStamp != m_changeStamp)
+	{
+		setPartTags();
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -246,6 +266,8 @@ void DynamicPathGraph::unlinkNode ( int nodeIndex )
 	}
 
 	node->clearEdges();
+
+	markChanged();
 }
 
 // ----------------------------------------------------------------------
@@ -320,6 +342,8 @@ void DynamicPathGraph::relinkNode ( int nodeIndex )
 			neighborNode->removeMarkedEdges();
 		}
 	}
+
+	markChanged();
 }
 
 // ----------------------------------------------------------------------
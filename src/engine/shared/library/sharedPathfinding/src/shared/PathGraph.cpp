@@ -9,6 +9,7 @@
 #include "sharedPathfinding/PathGraph.h"
 
 #include "sharedPathfinding/PathNode.h"
+#include "sharedPathfinding/PathNodeGrid.h"
 #include "sharedPathfinding/PathEdge.h"
 
 #include <vector>
@@ -16,17 +17,50 @@
 
 typedef std::stack<PathNode *, std::vector<PathNode *> > PathNodeStack;
 
+namespace PathGraphNamespace
+{
+	int s_lastChangeStamp = 0;
+
+	// smaller graphs are quicker to search node by node
+
+	int const cs_minGridNodeCount = 32;
+
+	bool hasEdge ( PathGraph const & graph, int nodeIndex, int neighborIndex );
+}
+
+using namespace PathGraphNamespace;
+
+// ======================================================================
+
+bool PathGraphNamespace::hasEdge ( PathGraph const & graph, int nodeIndex, int neighborIndex )
+{
+	int edgeCount = graph.getEdgeCount(nodeIndex);
+
+	for(int i = 0; i < edgeCount; i++)
+	{
+		if(graph.getEdge(nodeIndex,i)->getIndexB() == neighborIndex) return true;
+	}
+
+	return false;
+}
+
 // ======================================================================
 
 PathGraph::PathGraph ( PathGraphType type )
 : m_type(type),
   m_partCount(-1),
+  m_partStamp(0),
+  m_partsSymmetric(false),
+  m_changeStamp(++s_lastChangeStamp),
+  m_nodeGrid(NULL),
   m_searchLock(false)
 {
 }
 
 PathGraph::~PathGraph()
 {
+	delete m_nodeGrid;
+	m_nodeGrid = NULL;
 }
 
 // ----------------------------------------------------------------------
@@ -110,6 +144,12 @@ int PathGraph::findEntrance ( int key ) const
 
 int PathGraph::findNearestNode ( Vector const & position_p ) const
 {
+	PathNodeGrid const * grid = getNodeGrid();
+
+	if(grid) return grid->findNearestNode(position_p,PNT_Invalid);
+
+	// ----------
+
 	int minNode = -1;
 	float minDist2 = REAL_MAX;
 
@@ -139,6 +179,12 @@ int PathGraph::findNearestNode ( Vector const & position_p ) const
 
 int PathGraph::findNearestNode ( PathNodeType searchType, Vector const & position_p ) const
 {
+	PathNodeGrid const * grid = getNodeGrid();
+
+	if(grid) return grid->findNearestNode(position_p,searchType);
+
+	// ----------
+
 	int minNode = -1;
 	float minDist2 = REAL_MAX;
 
@@ -172,6 +218,16 @@ int PathGraph::findNearestNode ( PathNodeType searchType, Vector const & positio
 
 void PathGraph::findNodesInRange ( Vector const & position_p, float range, PathNodeList & results ) const
 {
+	PathNodeGrid const * grid = getNodeGrid();
+
+	if(grid)
+	{
+		grid->findNodesInRange(position_p,range,results);
+		return;
+	}
+
+	// ----------
+
 	float range2 = range * range;
 
 	int nodeCount = getNodeCount();
@@ -226,10 +282,14 @@ void PathGraph::setPartTags ( void )
 
 	int nodeCount = getNodeCount();
 
+	m_partsSymmetric = true;
+
 	for(int i = 0; i < nodeCount; i++)
 	{
 		PathNode * node = getNode(i);
 
+		if(node == NULL) continue;
+
 		node->setPartId(-1);
 
 		// ignore nodes without edges unless they're the only node in the cell
@@ -239,6 +299,20 @@ void PathGraph::setPartTags ( void )
 		if(edgeCount > 0)
 		{
 			unprocessed.push(node);
+
+			if(m_partsSymmetric)
+			{
+				for(int j = 0; j < edgeCount; j++)
+				{
+					int neighborIndex = getEdge(i,j)->getIndexB();
+
+					if(!hasEdge(*this,neighborIndex,i))
+					{
+						m_partsSymmetric = false;
+						break;
+					}
+				}
+			}
 		}
 		else
 		{
@@ -281,7 +355,7 @@ void PathGraph::setPartTags ( void )
 
 				PathNode * neighborNode = getNode(neighborIndex);
 
-				processing.push(neighborNode);
+				if(neighborNode) processing.push(neighborNode);
 			}
 		}
 
@@ -289,6 +363,7 @@ void PathGraph::setPartTags ( void )
 	}
 
 	m_partCount = currentTag;
+	m_partStamp = m_changeStamp;
 }
 
 // ----------
@@ -298,4 +373,60 @@ int PathGraph::getPartCount ( void ) const
 	return m_partCount;
 }
 
+// ----------
+
+bool PathGraph::partsAreDisjoint ( void ) const
+{
+	return (m_partCount != -1) && (m_partStamp == m_changeStamp) && m_partsSymmetric;
+}
+
+// ----------------------------------------------------------------------
+
+void PathGraph::markChanged ( void )
+{
+	m_changeStamp = ++s_lastChangeStamp;
+}
+
+// ----------------------------------------------------------------------
+
+void PathGraph::nodeAdded ( int nodeIndex )
+{
+	if(m_nodeGrid) m_nodeGrid->addNode(nodeIndex);
+}
+
+void PathGraph::nodeMoved ( int nodeIndex )
+{
+	if(m_nodeGrid) m_nodeGrid->moveNode(nodeIndex);
+}
+
+void PathGraph::nodeRemoved ( int nodeIndex )
+{
+	if(m_nodeGrid) m_nodeGrid->removeNode(nodeIndex);
+}
+
+void PathGraph::nodesReplaced ( void )
+{
+	delete m_nodeGrid;
+	m_nodeGrid = NULL;
+}
+
+// ----------
+
+PathNodeGrid const * PathGraph::getNodeGrid ( void ) const
+{
+	if(m_nodeGrid == NULL)
+	{
+		if(getNodeCount() < cs_minGridNodeCount) return NULL;
+
+		m_nodeGrid = new PathNodeGrid(this);
+	}
+
+	if(!m_nodeGrid->isValid())
+	{
+		m_nodeGrid->build();
+	}
+
+	return m_nodeGrid;
+}
+
 // ======================================================================
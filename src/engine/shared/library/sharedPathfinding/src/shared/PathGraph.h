@@ -15,6 +15,7 @@
 class PathGraph;
 class PathEdge;
 class PathNode;
+class PathNodeGrid;
 class Iff;
 class DebugShapeRenderer;
 class Vector;
@@ -70,11 +71,40 @@ public:
 	virtual void             setPartTags     ( void );
 	virtual int              getPartCount    ( void ) const;
 
+	// Nodes in different parts can't reach each other if the part tags are
+	// up to date and every edge has a matching edge going the other way.
+
+	bool                     partsAreDisjoint ( void ) const;
+
+	// Every change to the nodes or edges gives the graph a new change stamp, so
+	// anything remembered about the graph (part tags, cached paths) can tell when
+	// it's out of date. Stamps are unique across all graphs.
+
+	int                      getChangeStamp  ( void ) const;
+
 protected:
 
+	void                     markChanged     ( void );
+
+	// Graphs that add, move or remove nodes call these to keep the node grid
+	// used by the find functions up to date.
+
+	void                     nodeAdded       ( int nodeIndex );
+	void                     nodeMoved       ( int nodeIndex );
+	void                     nodeRemoved     ( int nodeIndex );
+	void                     nodesReplaced   ( void );
+
+	PathNodeGrid const *     getNodeGrid     ( void ) const;
+
 	PathGraphType m_type;
 
 	int m_partCount;
+	int m_partStamp;
+	bool m_partsSymmetric;
+
+	int m_changeStamp;
+
+	mutable PathNodeGrid * m_nodeGrid;     // built by the first find on a large enough graph
 
 	mutable bool m_searchLock;
 };
@@ -95,6 +125,11 @@ inline void PathGraph::setType ( PathGraphType newType )
 	m_type = newType;
 }
 
+inline int PathGraph::getChangeStamp ( void ) const
+{
+	return m_changeStamp;
+}
+
 // ======================================================================
 
 #endif
@@ -0,0 +1,361 @@
+// ======================================================================
+//
+// PathNodeGrid.cpp
+// copyright (c) 2001 Sony Online Entertainment
+//
+// ======================================================================
+
+#include "sharedPathfinding/FirstSharedPathfinding.h"
+#include "sharedPathfinding/PathNodeGrid.h"
+
+#include "sharedPathfinding/PathGraph.h"
+#include "sharedPathfinding/PathNode.h"
+
+#include <vector>
+#include <algorithm>
+
+// ======================================================================
+
+namespace PathNodeGridNamespace
+{
+	float const cs_nodesPerCell = 2.0f;
+	float const cs_minCellSize = 1.0f;
+	int const cs_maxCellsPerSide = 128;
+
+	bool nodeIndexLess ( PathNode const * A, PathNode const * B );
+}
+
+using namespace PathNodeGridNamespace;
+
+// ----------------------------------------------------------------------
+
+bool PathNodeGridNamespace::nodeIndexLess ( PathNode const * A, PathNode const * B )
+{
+	return A->getIndex() < B->getIndex();
+}
+
+// ======================================================================
+
+PathNodeGrid::PathNodeGrid ( PathGraph const * graph )
+: m_graph(graph),
+  m_valid(false),
+  m_minX(0.0f),
+  m_minZ(0.0f),
+  m_cellSize(cs_minCellSize),
+  m_sizeX(0),
+  m_sizeZ(0),
+  m_cells( new CellList() ),
+  m_nodeCells( new IndexList() )
+{
+}
+
+PathNodeGrid::~PathNodeGrid()
+{
+	delete m_cells;
+	m_cells = NULL;
+
+	delete m_nodeCells;
+	m_nodeCells = NULL;
+
+	m_graph = NULL;
+}
+
+// ----------------------------------------------------------------------
+
+void PathNodeGrid::build ( void )
+{
+	m_cells->clear();
+	m_nodeCells->clear();
+
+	int nodeCount = m_graph->getNodeCount();
+
+	m_nodeCells->resize(nodeCount,-1);
+
+	float minX = REAL_MAX;
+	float minZ = REAL_MAX;
+	float maxX = -REAL_MAX;
+	float maxZ = -REAL_MAX;
+
+	int liveCount = 0;
+
+	int i;
+
+	for(i = 0; i < nodeCount; i++)
+	{
+		PathNode const * node = m_graph->getNode(i);
+
+		if(node == NULL) continue;
+
+		Vector const & position = node->getPosition_p();
+
+		minX = std::min(minX,position.x);
+		minZ = std::min(minZ,position.z);
+		maxX = std::max(maxX,position.x);
+		maxZ = std::max(maxZ,position.z);
+
+		liveCount++;
+	}
+
+	if(liveCount == 0)
+	{
+		minX = minZ = maxX = maxZ = 0.0f;
+	}
+
+	// ----------
+	// Size the cells so there are a couple of nodes in each, but don't let
+	// a long thin graph make the grid too big.
+
+	float extentX = maxX - minX;
+	float extentZ = maxZ - minZ;
+
+	float area = std::max(extentX,cs_minCellSize) * std::max(extentZ,cs_minCellSize);
+
+	m_cellSize = sqrt( (area * cs_nodesPerCell) / std::max(liveCount,1) );
+	m_cellSize = std::max(m_cellSize,cs_minCellSize);
+	m_cellSize = std::max(m_cellSize,std::max(extentX,extentZ) / (cs_maxCellsPerSide - 3));
+
+	// leave a cell of room around the nodes so small moves don't force a rebuild
+
+	m_minX = minX - m_cellSize;
+	m_minZ = minZ - m_cellSize;
+
+	m_sizeX = static_cast<int>(extentX / m_cellSize) + 3;
+	m_sizeZ = static_cast<int>(extentZ / m_cellSize) + 3;
+
+	m_cells->resize(m_sizeX * m_sizeZ);
+
+	for(i = 0; i < nodeCount; i++)
+	{
+		if(m_graph->getNode(i) != NULL)
+		{
+			IGNORE_RETURN(insertNode(i));
+		}
+	}
+
+	m_valid = true;
+}
+
+// ----------------------------------------------------------------------
+
+void PathNodeGrid::addNode ( int nodeIndex )
+{
+	if(!m_valid) return;
+
+	if(!insertNode(nodeIndex))
+	{
+		m_valid = false;
+	}
+}
+
+void PathNodeGrid::moveNode ( int nodeIndex )
+{
+	if(!m_valid) return;
+
+	eraseNode(nodeIndex);
+
+	if(!insertNode(nodeIndex))
+	{
+		m_valid = false;
+	}
+}
+
+void PathNodeGrid::removeNode ( int nodeIndex )
+{
+	if(!m_valid) return;
+
+	eraseNode(nodeIndex);
+}
+
+// ----------------------------------------------------------------------
+
+int PathNodeGrid::getCellX ( float x ) const
+{
+	int cellX = static_cast<int>(floor((x - m_minX) / m_cellSize));
+
+	return clamp(0,cellX,m_sizeX - 1);
+}
+
+int PathNodeGrid::getCellZ ( float z ) const
+{
+	int cellZ = static_cast<int>(floor((z - m_minZ) / m_cellSize));
+
+	return clamp(0,cellZ,m_sizeZ - 1);
+}
+
+// ----------------------------------------------------------------------
+// Returns false if the node is outside the grid.
+
+bool PathNodeGrid::insertNode ( int nodeIndex )
+{
+	PathNode const * node = m_graph->getNode(nodeIndex);
+
+	if(node == NULL) return true;
+
+	Vector const & position = node->getPosition_p();
+
+	float cellX = floor((position.x - m_minX) / m_cellSize);
+	float cellZ = floor((position.z - m_minZ) / m_cellSize);
+
+	if((cellX < 0.0f) || (cellX >= static_cast<float>(m_sizeX))) return false;
+	if((cellZ < 0.0f) || (cellZ >= static_cast<float>(m_sizeZ))) return false;
+
+	int cellIndex = static_cast<int>(cellZ) * m_sizeX + static_cast<int>(cellX);
+
+	if(nodeIndex >= static_cast<int>(m_nodeCells->size()))
+	{
+		m_nodeCells->resize(nodeIndex + 1,-1);
+	}
+
+	m_cells->at(cellIndex).push_back(nodeIndex);
+	m_nodeCells->at(nodeIndex) = cellIndex;
+
+	return true;
+}
+
+// ----------
+
+void PathNodeGrid::eraseNode ( int nodeIndex )
+{
+	if(nodeIndex < 0) return;
+	if(nodeIndex >= static_cast<int>(m_nodeCells->size())) return;
+
+	int cellIndex = m_nodeCells->at(nodeIndex);
+
+	if(cellIndex == -1) return;
+
+	IndexList & cell = m_cells->at(cellIndex);
+
+	IndexList::iterator it = std::find(cell.begin(),cell.end(),nodeIndex);
+
+	if(it != cell.end())
+	{
+		*it = cell.back();
+		cell.pop_back();
+	}
+
+	m_nodeCells->at(nodeIndex) = -1;
+}
+
+// ----------------------------------------------------------------------
+
+void PathNodeGrid::checkCell ( int cellX, int cellZ, Vector const & position_p, PathNodeType searchType, int & minNode, float & minDist2 ) const
+{
+	if((cellX < 0) || (cellX >= m_sizeX)) return;
+	if((cellZ < 0) || (cellZ >= m_sizeZ)) return;
+
+	IndexList const & cell = m_cells->at(cellZ * m_sizeX + cellX);
+
+	int nodeCount = cell.size();
+
+	for(int i = 0; i < nodeCount; i++)
+	{
+		int nodeIndex = cell[i];
+
+		PathNode const * node = m_graph->getNode(nodeIndex);
+
+		if(node == NULL) continue;
+
+		if(m_graph->getEdgeCount(nodeIndex) == 0) continue;
+
+		if((searchType != PNT_Invalid) && (node->getType() != searchType)) continue;
+
+		float dist2 = position_p.magnitudeBetweenSquared(node->getPosition_p());
+
+		// ties go to the lowest index, same as the linear search
+
+		if((dist2 < minDist2) || ((dist2 == minDist2) && (nodeIndex < minNode)))
+		{
+			minNode = nodeIndex;
+			minDist2 = dist2;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Look through rings of cells around the position until the nearest cells
+// left to look at are farther away than the nearest node found so far.
+// Pass PNT_Invalid to accept nodes of any type.
+
+int PathNodeGrid::findNearestNode ( Vector const & position_p, PathNodeType searchType ) const
+{
+	int minNode = -1;
+	float minDist2 = REAL_MAX;
+
+	int centerX = getCellX(position_p.x);
+	int centerZ = getCellZ(position_p.z);
+
+	int ringCount = std::max( std::max(centerX, m_sizeX - 1 - centerX), std::max(centerZ, m_sizeZ - 1 - centerZ) );
+
+	checkCell(centerX,centerZ,position_p,searchType,minNode,minDist2);
+
+	for(int ring = 1; ring <= ringCount; ring++)
+	{
+		// every cell in this ring is at least (ring - 1) cells from the position
+
+		float gap = (ring - 1) * m_cellSize;
+
+		if((minNode != -1) && (gap * gap > minDist2)) break;
+
+		for(int x = centerX - ring; x <= centerX + ring; x++)
+		{
+			checkCell(x,centerZ - ring,position_p,searchType,minNode,minDist2);
+			checkCell(x,centerZ + ring,position_p,searchType,minNode,minDist2);
+		}
+
+		for(int z = centerZ - ring + 1; z < centerZ + ring; z++)
+		{
+			checkCell(centerX - ring,z,position_p,searchType,minNode,minDist2);
+			checkCell(centerX + ring,z,position_p,searchType,minNode,minDist2);
+		}
+	}
+
+	return minNode;
+}
+
+// ----------------------------------------------------------------------
+
+void PathNodeGrid::findNodesInRange ( Vector const & position_p, float range, PathNodeList & results ) const
+{
+	float range2 = range * range;
+
+	int resultStart = results.size();
+
+	int minX = getCellX(position_p.x - range);
+	int maxX = getCellX(position_p.x + range);
+	int minZ = getCellZ(position_p.z - range);
+	int maxZ = getCellZ(position_p.z + range);
+
+	for(int z = minZ; z <= maxZ; z++)
+	{
+		for(int x = minX; x <= maxX; x++)
+		{
+			IndexList const & cell = m_cells->at(z * m_sizeX + x);
+
+			int nodeCount = cell.size();
+
+			for(int i = 0; i < nodeCount; i++)
+			{
+				int nodeIndex = cell[i];
+
+				PathNode const * node = m_graph->getNode(nodeIndex);
+
+				if(node == NULL) continue;
+
+				if(m_graph->getEdgeCount(nodeIndex) == 0) continue;
+
+				float dist2 = position_p.magnitudeBetweenSquared(node->getPosition_p());
+
+				if(dist2 < range2)
+				{
+					results.push_back( const_cast<PathNode*>(node) );
+				}
+			}
+		}
+	}
+
+	// the linear search returned the nodes in index order, so keep doing that
+
+	std::sort( results.begin() + resultStart, results.end(), nodeIndexLess );
+}
+
+// ======================================================================
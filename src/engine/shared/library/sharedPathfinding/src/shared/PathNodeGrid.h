@@ -0,0 +1,84 @@
+// ======================================================================
+//
+// PathNodeGrid.h
+// Copyright 2001 Sony Online Entertainment Inc.
+// All Rights Reserved.
+//
+// ======================================================================
+
+#ifndef	INCLUDED_PathNodeGrid_H
+#define	INCLUDED_PathNodeGrid_H
+
+#include "sharedPathfinding/PathfindingEnums.h"
+
+class PathGraph;
+class PathNode;
+class Vector;
+
+typedef stdvector<int>::fwd IndexList;
+typedef stdvector<PathNode *>::fwd PathNodeList;
+
+// ======================================================================
+// A uniform grid over the x-z positions of the nodes in a path graph, so
+// PathGraph can find the nodes near a point without looking at every node.
+// Each cell holds the indices of the nodes in it.  The grid only knows
+// about positions - the queries apply the same edge count and node type
+// checks as the linear versions in PathGraph, and give the same results.
+//
+// Adding or moving a node outside the area the grid covers invalidates
+// it, and PathGraph rebuilds it before the next query.
+
+class PathNodeGrid
+{
+public:
+
+	PathNodeGrid ( PathGraph const * graph );
+	~PathNodeGrid();
+
+	void  build            ( void );
+	bool  isValid          ( void ) const;
+
+	void  addNode          ( int nodeIndex );
+	void  moveNode         ( int nodeIndex );
+	void  removeNode       ( int nodeIndex );
+
+	int   findNearestNode  ( Vector const & position_p, PathNodeType searchType ) const;
+	void  findNodesInRange ( Vector const & position_p, float range, PathNodeList & results ) const;
+
+protected:
+
+	int   getCellX         ( float x ) const;
+	int   getCellZ         ( float z ) const;
+
+	bool  insertNode       ( int nodeIndex );
+	void  eraseNode        ( int nodeIndex );
+
+	void  checkCell        ( int cellX, int cellZ, Vector const & position_p, PathNodeType searchType, int & minNode, float & minDist2 ) const;
+
+	typedef stdvector<IndexList>::fwd CellList;
+
+	PathGraph const * m_graph;
+
+	bool        m_valid;
+
+	float       m_minX;
+	float       m_minZ;
+	float       m_cellSize;
+	int         m_sizeX;
+	int         m_sizeZ;
+
+	CellList *  m_cells;
+	IndexList * m_nodeCells;     // cell each node is in, or -1
+};
+
+// ----------
+
+inline bool PathNodeGrid::isValid ( void ) const
+{
+	return m_valid;
+}
+
+// ======================================================================
+
+#endif
+
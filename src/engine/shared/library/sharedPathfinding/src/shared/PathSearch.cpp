@@ -8,17 +8,17 @@
 #include "sharedPathfinding/FirstSharedPathfinding.h"
 #include "sharedPathfinding/PathSearch.h"
 
-#include "sharedFoundation/ExitChain.h"
-#include "sharedFoundation/MemoryBlockManager.h"
-#include "sharedFoundation/MemoryBlockManagerMacros.h"
-
 #include "sharedDebug/PerformanceTimer.h"
 
+#include "sharedPathfinding/ConfigSharedPathfinding.h"
 #include "sharedPathfinding/PathGraph.h"
 #include "sharedPathfinding/PathNode.h"
 #include "sharedPathfinding/PathEdge.h"
 
 #include <vector>
+#include <list>
+#include <map>
+#include <queue>
 #include <algorithm>
 
 const float BIG_HEURISTIC = 1000000000.0f;
@@ -34,11 +34,11 @@ size_t PathNodeHasher::operator() ( PathNode const * node ) const
 
 class PathSearchNode
 {
-	MEMORY_BLOCK_MANAGER_INTERFACE_WITH_INSTALL;
-
 public:
 
-	PathSearchNode( PathSearch * search, PathGraph const * graph, PathNode const * node );
+	PathSearchNode();
+
+	void reset ( PathSearch * search, PathGraph const * graph, PathNode const * node, int searchId );
 
 	int getNeighborCount ( void );
 
@@ -86,14 +86,19 @@ public:
 
 	// ----------
 
-	bool isQueued ( void )
+	bool isQueued ( void ) const
 	{
-		return m_queued;
+		return m_heapIndex != -1;
 	}
 
-	void setQueued ( bool queued )
+	int getHeapIndex ( void ) const
 	{
-		m_queued = queued;
+		return m_heapIndex;
+	}
+
+	void setHeapIndex ( int heapIndex )
+	{
+		m_heapIndex = heapIndex;
 	}
 
 	// ----------
@@ -108,10 +113,10 @@ public:
 		return m_pathIndex;
 	}
 
-	// ----------
-
-	PathSearchNode * getSearchNode    ( PathNode const * node );
-	PathSearchNode * createSearchNode ( PathNode const * node );
+	int getSearchId ( void ) const
+	{
+		return m_searchId;
+	}
 
 	// ----------
 
@@ -122,184 +127,967 @@ protected:
 	PathGraph const * m_graph;
 	PathNode const *  m_node;
 
-	bool   m_queued;
+	int    m_heapIndex;   // position in the open list, or -1 if not queued
 	
 	float  m_cost;
 	float  m_heuristic;
 	float  m_total;
 
 	int    m_pathIndex;
+	int    m_searchId;    // search this node was last set up for
+};
+
+// ----------
+
+PathSearchNode::PathSearchNode ( void )
+: m_search(NULL),
+  m_parent(NULL),
+  m_graph(NULL),
+  m_node(NULL),
+  m_heapIndex(-1),
+  m_cost(REAL_MAX),
+  m_heuristic(0.0f),
+  m_total(REAL_MAX),
+  m_pathIndex(-1),
+  m_searchId(0)
+{
+}
+
+// ----------
+
+void PathSearchNode::reset ( PathSearch * search, PathGraph const * graph, PathNode const * node, int searchId )
+{
+	m_search = search;
+	m_parent = NULL;
+	m_graph = graph;
+	m_node = node;
+	m_heapIndex = -1;
+	m_cost = REAL_MAX;
+	m_total = REAL_MAX;
+	m_pathIndex = -1;
+	m_searchId = searchId;
+
+	m_heuristic = m_search->calcHeuristic(m_node);
+}
+
+// ----------------------------------------------------------------------
+
+int PathSearchNode::getNeighborCount ( void )
+{
+	return m_graph->getEdgeCount( m_node->getIndex() );
+}
+
+// ----------
+
+PathSearchNode * PathSearchNode::getNeighbor ( int whichNeighbor )
+{
+	int neighborIndex = m_graph->getEdge( m_node->getIndex(), whichNeighbor )->getIndexB();
+
+	PathNode const * neighborNode = m_graph->getNode(neighborIndex);
+
+	if(neighborNode != NULL)
+	{
+		return m_search->getSearchNode(neighborNode);
+	}
+	else
+	{
+		return NULL;
+	}
+}
+
+// ======================================================================
+
+bool PathSearchGreater( PathSearchNode const * A, PathSearchNode const * B )
+{
+	return A->getTotal() > B->getTotal();
+}
+
+// ======================================================================
+// Search nodes for every path node in the graph, indexed by path node
+// index.  The array is kept from one search to the next and only grows,
+// and a node belongs to the current search only if its search id matches,
+// so starting a search doesn't have to touch or allocate any nodes.
+// Because nothing is written to the graph, several searches can run over
+// the same graph at once as long as each has its own PathSearch.
+
+class PathSearchScratch
+{
+public:
+
+	PathSearchScratch ( void )
+	: m_nodes(),
+	  m_searchId(0)
+	{
+	}
+
+	void begin ( int nodeCount )
+	{
+		if(static_cast<int>(m_nodes.size()) < nodeCount)
+		{
+			m_nodes.resize(nodeCount);
+		}
+
+		if(++m_searchId <= 0)
+		{
+			// the search id wrapped, so start the stamps over
+			for(uint i = 0; i < m_nodes.size(); i++)
+			{
+				m_nodes[i] = PathSearchNode();
+			}
+
+			m_searchId = 1;
+		}
+	}
+
+	PathSearchNode * getSearchNode ( PathSearch * search, PathGraph const * graph, PathNode const * node )
+	{
+		int nodeIndex = node->getIndex();
+
+		if(static_cast<uint>(nodeIndex) >= m_nodes.size())
+		{
+			DEBUG_WARNING(true,("PathSearchScratch::getSearchNode - node index %d is outside the %d nodes of the graph\n",nodeIndex,static_cast<int>(m_nodes.size())));
+			return NULL;
+		}
+
+		PathSearchNode * searchNode = &m_nodes[nodeIndex];
+
+		if(searchNode->getSearchId() != m_searchId)
+		{
+			searchNode->reset(search,graph,node,m_searchId);
+		}
+
+		return searchNode;
+	}
+
+protected:
+
+	std::vector<PathSearchNode> m_nodes;
+
+	int m_searchId;
+};
+
+// ======================================================================
+// Binary min-heap on the node totals.  Each node records its position in
+// the heap, so lowering the cost of a queued node only has to sift it up
+// from where it is instead of searching for it.
+
+class PathSearchQueue
+{
+public:
+
+	void push ( PathSearchNode * node )
+	{
+		m_nodes.push_back(node);
+
+		node->setHeapIndex( static_cast<int>(m_nodes.size()) - 1 );
+
+		siftUp( static_cast<int>(m_nodes.size()) - 1 );
+	}
+
+	PathSearchNode * pop ( void )
+	{
+		PathSearchNode * node = m_nodes.front();
+
+		PathSearchNode * last = m_nodes.back();
+		m_nodes.pop_back();
+
+		if(last != node)
+		{
+			m_nodes[0] = last;
+			last->setHeapIndex(0);
+
+			siftDown(0);
+		}
+
+		node->setHeapIndex(-1);
+
+		return node;
+	}
+
+	void update ( PathSearchNode * node )
+	{
+		if(node->isQueued())
+		{
+			// costs only ever go down, so the node can only move toward the top
+			siftUp( node->getHeapIndex() );
+		}
+		else
+		{
+			push(node);
+		}
+	}
+
+	void clear ( void )
+	{
+		for(uint i = 0; i < m_nodes.size(); i++)
+		{
+			m_nodes[i]->setHeapIndex(-1);
+		}
+
+		m_nodes.clear();
+	}
+
+	bool empty ( void )
+	{
+		return m_nodes.empty();
+	}
+
+	// ----------
+
+protected:
+
+	void siftUp ( int heapIndex )
+	{
+		PathSearchNode * node = m_nodes[heapIndex];
+
+		while(heapIndex > 0)
+		{
+			int parentIndex = (heapIndex - 1) / 2;
+
+			PathSearchNode * parent = m_nodes[parentIndex];
+
+			if(!PathSearchGreater(parent,node)) break;
+
+			m_nodes[heapIndex] = parent;
+			parent->setHeapIndex(heapIndex);
+
+			heapIndex = parentIndex;
+		}
+
+		m_nodes[heapIndex] = node;
+		node->setHeapIndex(heapIndex);
+	}
+
+	void siftDown ( int heapIndex )
+	{
+		int count = static_cast<int>(m_nodes.size());
+
+		PathSearchNode * node = m_nodes[heapIndex];
+
+		for(;;)
+		{
+			int childIndex = heapIndex * 2 + 1;
+
+			if(childIndex >= count) break;
+
+			if((childIndex + 1 < count) && PathSearchGreater(m_nodes[childIndex],m_nodes[childIndex + 1]))
+			{
+				childIndex++;
+			}
+
+			PathSearchNode * child = m_nodes[childIndex];
+
+			if(!PathSearchGreater(node,child)) break;
+
+			m_nodes[heapIndex] = child;
+			child->setHeapIndex(heapIndex);
+
+			heapIndex = childIndex;
+		}
+
+		m_nodes[heapIndex] = node;
+		node->setHeapIndex(heapIndex);
+	}
+
+	std::vector<PathSearchNode *> m_nodes;
 };
 
-MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITH_INSTALL(PathSearchNode, true, 0, 0, 0);
+// ======================================================================
+// The results of recent single goal searches, most recently used first.
+// An entry remembers the change stamp of the graph it was found on and
+// is thrown away on lookup once the graph has changed.
+
+class PathSearchCache
+{
+public:
+
+	PathSearchCache ( int capacity )
+	: m_capacity(capacity),
+	  m_entries(),
+	  m_index()
+	{
+	}
+
+	bool lookup ( PathGraph const * graph, int startIndex, int goalIndex, bool & found, IndexList & path )
+	{
+		Key key(graph,startIndex,goalIndex);
+
+		Index::iterator it = m_index.find(key);
+
+		if(it == m_index.end()) return false;
+
+		EntryList::iterator entry = it->second;
+
+		if(entry->m_changeStamp != graph->getChangeStamp())
+		{
+			m_entries.erase(entry);
+			m_index.erase(it);
+			return false;
+		}
+
+		m_entries.splice(m_entries.begin(),m_entries,entry);
+
+		found = entry->m_found;
+		path = entry->m_path;
+
+		return true;
+	}
+
+	void store ( PathGraph const * graph, int startIndex, int goalIndex, bool found, IndexList const & path )
+	{
+		if(m_capacity <= 0) return;
+
+		Key key(graph,startIndex,goalIndex);
+
+		Index::iterator it = m_index.find(key);
+
+		if(it != m_index.end())
+		{
+			m_entries.erase(it->second);
+			m_index.erase(it);
+		}
+		else if(static_cast<int>(m_index.size()) >= m_capacity)
+		{
+			Entry const & oldest = m_entries.back();
+
+			IGNORE_RETURN(m_index.erase(Key(oldest.m_graph,oldest.m_startIndex,oldest.m_goalIndex)));
+			m_entries.pop_back();
+		}
+
+		m_entries.push_front(Entry());
+
+		Entry & entry = m_entries.front();
+
+		entry.m_graph = graph;
+		entry.m_startIndex = startIndex;
+		entry.m_goalIndex = goalIndex;
+		entry.m_changeStamp = graph->getChangeStamp();
+		entry.m_found = found;
+		entry.m_path = path;
+
+		m_index[key] = m_entries.begin();
+	}
+
+protected:
+
+	struct Entry
+	{
+		PathGraph const * m_graph;
+		int               m_startIndex;
+		int               m_goalIndex;
+		int               m_changeStamp;
+		bool              m_found;
+		IndexList         m_path;
+	};
+
+	struct Key
+	{
+		Key ( PathGraph const * graph, int startIndex, int goalIndex )
+		: m_graph(graph),
+		  m_startIndex(startIndex),
+		  m_goalIndex(goalIndex)
+		{
+		}
+
+		bool operator < ( Key const & other ) const
+		{
+			if(m_graph != other.m_graph) return m_graph < other.m_graph;
+			if(m_startIndex != other.m_startIndex) return m_startIndex < other.m_startIndex;
+			return m_goalIndex < other.m_goalIndex;
+		}
+
+		PathGraph const * m_graph;
+		int               m_startIndex;
+		int               m_goalIndex;
+	};
+
+	typedef std::list<Entry> EntryList;
+	typedef std::map<Key, EntryList::iterator> Index;
+
+	int       m_capacity;
+	EntryList m_entries;
+	Index     m_index;
+};
+
+// ======================================================================
+// A two level abstraction of a large graph for HPA*-style searches.
+//
+// The nodes are split into square clusters by position.  A node with an
+// edge into another cluster is an entrance.  The entrances make up the
+// abstract graph, joined by the edges between clusters and by the cost of
+// the shortest path inside a cluster between each pair of its entrances.
+// A search links the start and goal to the entrances of their clusters,
+// searches the abstract graph and returns the entrances it passes through.
+//
+// Costs inside a cluster are measured from one end only, so the graph's
+// edges must all go both ways.  The abstraction is rebuilt when the
+// graph's change stamp moves on.
+
+class PathSearchClusters
+{
+public:
+
+	PathSearchClusters ( void )
+	: m_graph(NULL),
+	  m_changeStamp(0),
+	  m_clusters(),
+	  m_abstractNodes(),
+	  m_entrances(),
+	  m_links(),
+	  m_clusterEntrances(),
+	  m_distances(),
+	  m_touched(),
+	  m_costs(),
+	  m_parents()
+	{
+	}
+
+	bool isCurrent ( PathGraph const * graph ) const
+	{
+		return (m_graph == graph) && (m_changeStamp == graph->getChangeStamp());
+	}
+
+	int getCluster ( int nodeIndex ) const
+	{
+		if(static_cast<uint>(nodeIndex) >= m_clusters.size()) return -1;
+
+		return m_clusters[nodeIndex];
+	}
+
+	int getEntranceCount ( void ) const
+	{
+		return static_cast<int>(m_entrances.size());
+	}
+
+	void build ( PathGraph const * graph, float clusterSize );
+
+	bool search ( int startIndex, int goalIndex, IndexList & waypoints, int & expandedNodeCount );
+
+protected:
+
+	struct Link
+	{
+		Link ( int node, float cost )
+		: m_node(node),
+		  m_cost(cost)
+		{
+		}
+
+		int   m_node;     // abstract node
+		float m_cost;
+	};
+
+	typedef std::vector<Link> LinkList;
+
+	struct Crossing
+	{
+		Crossing ( int from, int to )
+		: m_from(from),
+		  m_to(to)
+		{
+		}
+
+		int m_from;   // path node in the lower cluster
+		int m_to;     // path node in the higher cluster
+	};
+
+	typedef std::vector<Crossing> CrossingList;
+
+	struct QueueEntry
+	{
+		QueueEntry ( float total, float cost, int node )
+		: m_total(total),
+		  m_cost(cost),
+		  m_node(node)
+		{
+		}
+
+		float m_total;
+		float m_cost;
+		int   m_node;
+	};
+
+	struct QueueEntryGreater
+	{
+		bool operator() ( QueueEntry const & A, QueueEntry const & B ) const
+		{
+			return A.m_total > B.m_total;
+		}
+	};
+
+	typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, QueueEntryGreater> Queue;
+
+	float distanceBetween ( int nodeIndexA, int nodeIndexB ) const;
+
+	int   addEntrance  ( int nodeIndex );
+	bool  areAdjacent  ( Crossing const & A, Crossing const & B ) const;
+	bool  areNeighbors ( int nodeIndexA, int nodeIndexB ) const;
+
+	void  measure   ( int sourceIndex, int & expandedNodeCount );
+	void  forget    ( void );
+	void  connect   ( int nodeIndex, LinkList & links, int & expandedNodeCount );
+
+	PathGraph const * m_graph;
+	int               m_changeStamp;
+
+	std::vector<int>      m_clusters;          // cluster of each path node, -1 for missing nodes
+	std::vector<int>      m_abstractNodes;     // abstract node of each path node, -1 if it isn't an entrance
+	std::vector<int>      m_entrances;         // path node of each abstract node
+	std::vector<LinkList> m_links;             // links out of each abstract node
+	std::vector<IndexList> m_clusterEntrances; // abstract nodes in each cluster
+
+	// scratch for the searches inside a cluster
+	std::vector<float>    m_distances;
+	IndexList             m_touched;
+
+	// scratch for the abstract search
+	std::vector<float>    m_costs;
+	IndexList             m_parents;
+};
+
+// ----------
+
+float PathSearchClusters::distanceBetween ( int nodeIndexA, int nodeIndexB ) const
+{
+	// the same cost PathSearch::costBetween gives outside of buildings
+
+	Vector posA = m_graph->getNode(nodeIndexA)->getPosition_p();
+	Vector posB = m_graph->getNode(nodeIndexB)->getPosition_p();
+
+	posA.y = 0;
+	posB.y = 0;
+
+	return posA.magnitudeBetween(posB);
+}
+
+// ----------
+
+int PathSearchClusters::addEntrance ( int nodeIndex )
+{
+	int abstractNode = m_abstractNodes[nodeIndex];
+
+	if(abstractNode == -1)
+	{
+		abstractNode = static_cast<int>(m_entrances.size());
+
+		m_abstractNodes[nodeIndex] = abstractNode;
+		m_clusterEntrances[ m_clusters[nodeIndex] ].push_back(abstractNode);
+		m_entrances.push_back(nodeIndex);
+		m_links.push_back( LinkList() );
+	}
+
+	return abstractNode;
+}
+
+// ----------
+// Two crossings are part of the same run if they share a node or their
+// nodes are joined by an edge on either side.
+
+bool PathSearchClusters::areAdjacent ( Crossing const & A, Crossing const & B ) const
+{
+	return areNeighbors(A.m_from,B.m_from) || areNeighbors(A.m_to,B.m_to);
+}
+
+// ----------
+
+bool PathSearchClusters::areNeighbors ( int nodeIndexA, int nodeIndexB ) const
+{
+	if(nodeIndexA == nodeIndexB) return true;
+
+	int edgeCount = m_graph->getEdgeCount(nodeIndexA);
+
+	for(int j = 0; j < edgeCount; j++)
+	{
+		if(m_graph->getEdge(nodeIndexA,j)->getIndexB() == nodeIndexB) return true;
+	}
+
+	return false;
+}
+
+// ----------
+
+void PathSearchClusters::build ( PathGraph const * graph, float clusterSize )
+{
+	m_graph = graph;
+	m_changeStamp = graph->getChangeStamp();
+
+	int nodeCount = graph->getNodeCount();
+
+	m_clusters.assign(nodeCount,-1);
+	m_abstractNodes.assign(nodeCount,-1);
+	m_entrances.clear();
+	m_links.clear();
+	m_clusterEntrances.clear();
+
+	m_distances.assign(nodeCount,REAL_MAX);
+	m_touched.clear();
+
+	if(clusterSize <= 0.0f) clusterSize = 64.0f;
+
+	// ----------
+	// assign every node to the cluster for the square it's in
+
+	typedef std::map<std::pair<int,int>, int> CellMap;
+
+	CellMap cells;
+
+	for(int i = 0; i < nodeCount; i++)
+	{
+		PathNode const * node = graph->getNode(i);
+
+		if(node == NULL) continue;
+
+		Vector const & position = node->getPosition_p();
+
+		std::pair<int,int> cell( static_cast<int>(floor(position.x / clusterSize)), static_cast<int>(floor(position.z / clusterSize)) );
+
+		CellMap::iterator it = cells.find(cell);
+
+		if(it == cells.end())
+		{
+			it = cells.insert( CellMap::value_type(cell, static_cast<int>(cells.size())) ).first;
+		}
+
+		m_clusters[i] = it->second;
+	}
+
+	m_clusterEntrances.resize(cells.size());
+
+	// ----------
+	// gather the edges between each pair of neighboring clusters
+
+	typedef std::map<std::pair<int,int>, CrossingList> CrossingMap;
+
+	CrossingMap crossings;
+
+	for(int i = 0; i < nodeCount; i++)
+	{
+		int cluster = m_clusters[i];
+
+		if(cluster == -1) continue;
+
+		int edgeCount = graph->getEdgeCount(i);
+
+		for(int j = 0; j < edgeCount; j++)
+		{
+			int neighborIndex = graph->getEdge(i,j)->getIndexB();
+			int neighborCluster = getCluster(neighborIndex);
+
+			// edges are symmetric, so each crossing is only gathered from the lower cluster
+
+			if((neighborCluster != -1) && (cluster < neighborCluster))
+			{
+				crossings[ std::make_pair(cluster,neighborCluster) ].push_back( Crossing(i,neighborIndex) );
+			}
+		}
+	}
+
+	// ----------
+	// each run of adjacent crossings becomes a single pair of entrances,
+	// one on either side of the crossing nearest the middle of the run
+
+	for(CrossingMap::iterator it = crossings.begin(); it != crossings.end(); ++it)
+	{
+		CrossingList const & list = it->second;
+
+		int crossingCount = static_cast<int>(list.size());
+
+		IndexList runs(crossingCount,-1);
+		IndexList stack;
+
+		for(int k = 0; k < crossingCount; k++)
+		{
+			if(runs[k] != -1) continue;
+
+			// gather the run containing this crossing
+
+			IndexList run;
+
+			runs[k] = k;
+			stack.push_back(k);
+
+			while(!stack.empty())
+			{
+				int current = stack.back();
+				stack.pop_back();
+
+				run.push_back(current);
+
+				for(int m = 0; m < crossingCount; m++)
+				{
+					if((runs[m] == -1) && areAdjacent(list[current],list[m]))
+					{
+						runs[m] = k;
+						stack.push_back(m);
+					}
+				}
+			}
+
+			// pick the crossing nearest the middle of the run
+
+			Vector center(0.0f,0.0f,0.0f);
+
+			for(uint m = 0; m < run.size(); m++)
+			{
+				center += graph->getNode(list[run[m]].m_from)->getPosition_p();
+			}
+
+			center /= static_cast<float>(run.size());
+
+			int best = run[0];
+			float bestDistance = REAL_MAX;
+
+			for(uint m = 0; m < run.size(); m++)
+			{
+				float distance = graph->getNode(list[run[m]].m_from)->getPosition_p().magnitudeBetweenSquared(center);
+
+				if(distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = run[m];
+				}
+			}
+
+			int from = list[best].m_from;
+			int to = list[best].m_to;
+
+			int a = addEntrance(from);
+			int b = addEntrance(to);
+
+			float cost = distanceBetween(from,to);
+
+			m_links[a].push_back( Link(b,cost) );
+			m_links[b].push_back( Link(a,cost) );
+		}
+	}
+
+	int entranceCount = static_cast<int>(m_entrances.size());
+
+	// ----------
+	// link the entrances inside each cluster by the shortest path between them
+
+	int expandedNodeCount = 0;
+
+	for(int a = 0; a < entranceCount; a++)
+	{
+		int nodeIndex = m_entrances[a];
+		int cluster = m_clusters[nodeIndex];
+
+		measure(nodeIndex,expandedNodeCount);
+
+		IndexList const & entrances = m_clusterEntrances[cluster];
+
+		for(uint k = 0; k < entrances.size(); k++)
+		{
+			int b = entrances[k];
+
+			float distance = m_distances[m_entrances[b]];
+
+			if((b != a) && (distance < REAL_MAX))
+			{
+				m_links[a].push_back( Link(b,distance) );
+			}
+		}
+
+		forget();
+	}
+}
+
+// ----------
+// Dijkstra's search out from a node, without leaving its cluster.
+
+void PathSearchClusters::measure ( int sourceIndex, int & expandedNodeCount )
+{
+	int cluster = m_clusters[sourceIndex];
+
+	Queue open;
+
+	m_distances[sourceIndex] = 0.0f;
+	m_touched.push_back(sourceIndex);
+
+	open.push( QueueEntry(0.0f,0.0f,sourceIndex) );
+
+	while(!open.empty())
+	{
+		QueueEntry entry = open.top();
+		open.pop();
+
+		int nodeIndex = entry.m_node;
+
+		if(entry.m_cost > m_distances[nodeIndex]) continue;
+
+		expandedNodeCount++;
+
+		int edgeCount = m_graph->getEdgeCount(nodeIndex);
+
+		for(int j = 0; j < edgeCount; j++)
+		{
+			int neighborIndex = m_graph->getEdge(nodeIndex,j)->getIndexB();
+
+			if(getCluster(neighborIndex) != cluster) continue;
 
-// ----------
+			float cost = entry.m_cost + distanceBetween(nodeIndex,neighborIndex);
 
-PathSearchNode::PathSearchNode ( PathSearch * search, PathGraph const * graph, PathNode const * node )
-: m_search(search),
-  m_parent(NULL),
-  m_graph(graph),
-  m_node(node),
-  m_queued(false),
-  m_cost(REAL_MAX),
-  m_heuristic(0.0f),
-  m_total(REAL_MAX),
-  m_pathIndex(-1)
-{
-	m_heuristic = m_search->calcHeuristic(m_node);
-}
+			if(cost < m_distances[neighborIndex])
+			{
+				if(m_distances[neighborIndex] == REAL_MAX)
+				{
+					m_touched.push_back(neighborIndex);
+				}
 
-// ----------------------------------------------------------------------
+				m_distances[neighborIndex] = cost;
 
-int PathSearchNode::getNeighborCount ( void )
-{
-	return m_graph->getEdgeCount( m_node->getIndex() );
+				open.push( QueueEntry(cost,cost,neighborIndex) );
+			}
+		}
+	}
 }
 
 // ----------
 
-PathSearchNode * PathSearchNode::getNeighbor ( int whichNeighbor )
+void PathSearchClusters::forget ( void )
 {
-	int neighborIndex = m_graph->getEdge( m_node->getIndex(), whichNeighbor )->getIndexB();
-
-	PathNode const * neighborNode = m_graph->getNode(neighborIndex);
-
-	if(neighborNode != NULL)
+	for(uint i = 0; i < m_touched.size(); i++)
 	{
-		return getSearchNode(neighborNode);
-	}
-	else
-	{
-		return NULL;
+		m_distances[m_touched[i]] = REAL_MAX;
 	}
+
+	m_touched.clear();
 }
 
-// ----------------------------------------------------------------------
+// ----------
+// Link a node to the entrances of its cluster that it can reach.
 
-PathSearchNode * PathSearchNode::createSearchNode( PathNode const * node )
+void PathSearchClusters::connect ( int nodeIndex, LinkList & links, int & expandedNodeCount )
 {
-	// doing bad voodoo with the node marks
-
-	PathSearchNode * oldNode = NULL;
+	links.clear();
 
-	int mark = node->getMark(3);
+	int cluster = getCluster(nodeIndex);
 
-	if(mark != -1)
-	{
-		oldNode = (PathSearchNode*)((void*)mark);
-	}
+	if(cluster == -1) return;
 
-	delete oldNode;
+	measure(nodeIndex,expandedNodeCount);
 
-	PathSearchNode * searchNode = new PathSearchNode(m_search,m_graph,node);
+	IndexList const & entrances = m_clusterEntrances[cluster];
 
-	node->setMark( 3, (int)((void*)searchNode) );
+	for(uint k = 0; k < entrances.size(); k++)
+	{
+		float distance = m_distances[m_entrances[entrances[k]]];
 
-	m_search->m_visitedNodes->push_back(node);
+		if(distance < REAL_MAX)
+		{
+			links.push_back( Link(entrances[k],distance) );
+		}
+	}
 
-	return searchNode;
+	forget();
 }
 
 // ----------
+// A* over the entrances.  The waypoints are the start, the entrances the
+// path goes through and the goal.  Consecutive waypoints are either
+// joined by an edge between clusters or are in the same cluster.
 
-PathSearchNode * PathSearchNode::getSearchNode( PathNode const * node )
+bool PathSearchClusters::search ( int startIndex, int goalIndex, IndexList & waypoints, int & expandedNodeCount )
 {
-	// doing bad voodoo with the node marks
+	waypoints.clear();
 
-	PathSearchNode * searchNode = NULL;
+	int entranceCount = static_cast<int>(m_entrances.size());
 
-	int mark = node->getMark(3);
+	int startNode = entranceCount;
+	int goalNode = entranceCount + 1;
 
-	if(mark != -1)
-	{
-		searchNode = (PathSearchNode*)((void*)mark);
-	}
+	LinkList startLinks;
+	LinkList goalLinks;
 
-	if(searchNode == NULL)
-	{
-		return createSearchNode(node);
-	}
-	else
-	{
-		return searchNode;
-	}
-}
+	connect(startIndex,startLinks,expandedNodeCount);
+	connect(goalIndex,goalLinks,expandedNodeCount);
 
-// ======================================================================
+	if(startLinks.empty() || goalLinks.empty()) return false;
 
-bool PathSearchGreater( PathSearchNode const * A, PathSearchNode const * B )
-{
-	return A->getTotal() > B->getTotal();
-}
+	m_costs.assign(entranceCount + 2,REAL_MAX);
+	m_parents.assign(entranceCount + 2,-1);
 
-// ======================================================================
+	Queue open;
 
-class PathSearchQueue
-{
-public:
+	m_costs[startNode] = 0.0f;
 
-	void push ( PathSearchNode * node )
+	open.push( QueueEntry(distanceBetween(startIndex,goalIndex),0.0f,startNode) );
+
+	while(!open.empty())
 	{
-		m_nodes.push_back(node);
+		QueueEntry entry = open.top();
+		open.pop();
 
-		std::push_heap(m_nodes.begin(),m_nodes.end(),PathSearchGreater);
+		int node = entry.m_node;
 
-		node->setQueued(true);
-	}
+		if(node == goalNode) break;
 
-	PathSearchNode * pop ( void )
-	{
-		PathSearchNode * node = m_nodes.front();
+		if(entry.m_cost > m_costs[node]) continue;
 
-		std::pop_heap(m_nodes.begin(),m_nodes.end(),PathSearchGreater);
-		m_nodes.pop_back();
+		expandedNodeCount++;
 
-		node->setQueued(false);
+		LinkList const & links = (node == startNode) ? startLinks : m_links[node];
 
-		return node;
-	}
+		for(uint i = 0; i < links.size(); i++)
+		{
+			int neighbor = links[i].m_node;
 
-	void update ( PathSearchNode * node )
-	{
-		if(node->isQueued())
+			float cost = entry.m_cost + links[i].m_cost;
+
+			if(cost < m_costs[neighbor])
+			{
+				m_costs[neighbor] = cost;
+				m_parents[neighbor] = node;
+
+				open.push( QueueEntry(cost + distanceBetween(m_entrances[neighbor],goalIndex) * 3.0f,cost,neighbor) );
+			}
+		}
+
+		// the goal is linked to from the entrances of its cluster
+
+		if(node != startNode)
 		{
-			for(uint i = 0; i < m_nodes.size(); i++)
+			for(uint i = 0; i < goalLinks.size(); i++)
 			{
-				if(m_nodes[i] == node)
+				if(goalLinks[i].m_node != node) continue;
+
+				float cost = entry.m_cost + goalLinks[i].m_cost;
+
+				if(cost < m_costs[goalNode])
 				{
-					std::push_heap( m_nodes.begin(), m_nodes.begin() + i + 1, PathSearchGreater );
-					return;
+					m_costs[goalNode] = cost;
+					m_parents[goalNode] = node;
+
+					open.push( QueueEntry(cost,cost,goalNode) );
 				}
 			}
 		}
-		else
-		{
-			push(node);
-		}
 	}
 
-	void clear ( void )
-	{
-		m_nodes.clear();
-	}
+	if(m_parents[goalNode] == -1) return false;
 
-	bool empty ( void )
+	for(int node = goalNode; node != -1; node = m_parents[node])
 	{
-		return m_nodes.empty();
-	}
+		int nodeIndex = (node == startNode) ? startIndex : (node == goalNode) ? goalIndex : m_entrances[node];
 
-	// ----------
+		// the start or goal may be an entrance itself
 
-protected:
+		if(waypoints.empty() || (waypoints.back() != nodeIndex))
+		{
+			waypoints.push_back(nodeIndex);
+		}
+	}
 
-	std::vector<PathSearchNode *> m_nodes;
-};
+	std::reverse(waypoints.begin(),waypoints.end());
+
+	return true;
+}
 
 // ======================================================================
 
 void PathSearch::install()
 {
-	PathSearchNode::install();
 }
 
 // ----------------------------------------------------------------------
@@ -312,10 +1100,16 @@ PathSearch::PathSearch ( void )
   m_goals(new NodeList()),
   m_queue(new PathSearchQueue()),
   m_path(new IndexList()),
-  m_visitedNodes(new NodeList())
+  m_scratch(new PathSearchScratch()),
+  m_cache(new PathSearchCache(ConfigSharedPathfinding::getPathSearchCacheSize())),
+  m_clusters(new PathSearchClusters()),
+  m_restrictCluster(-1),
+  m_expandedNodeCount(0),
+  m_cacheHitCount(0),
+  m_hierarchicalSearchCount(0),
+  m_trackSearchTime(true)
 {
 	m_path->reserve(20);
-	m_visitedNodes->reserve(20);
 }
 
 PathSearch::~PathSearch()
@@ -329,15 +1123,34 @@ PathSearch::~PathSearch()
 	delete m_path;
 	m_path = NULL;
 
-	delete m_visitedNodes;
-	m_visitedNodes = NULL;
+	delete m_scratch;
+	m_scratch = NULL;
+
+	delete m_cache;
+	m_cache = NULL;
+
+	delete m_clusters;
+	m_clusters = NULL;
+}
+
+// ----------------------------------------------------------------------
+
+PathSearchNode * PathSearch::getSearchNode ( PathNode const * node )
+{
+	return m_scratch->getSearchNode(this,m_graph,node);
 }
 
 // ----------------------------------------------------------------------
 
 PathSearchNode * PathSearch::search ( void )
 {
-	PathSearchNode * startNode = new PathSearchNode(this,m_graph,m_start);
+	m_scratch->begin( m_graph->getNodeCount() );
+
+	m_expandedNodeCount = 0;
+
+	PathSearchNode * startNode = getSearchNode(m_start);
+
+	if(startNode == NULL) return NULL;
 
 	startNode->setCost(0.0f);
 	startNode->setPathIndex(0);
@@ -348,6 +1161,8 @@ PathSearchNode * PathSearch::search ( void )
 	{
 		PathSearchNode * node = m_queue->pop();
 
+		m_expandedNodeCount++;
+
 		if(atGoal(node))
 		{
 			return node;
@@ -359,6 +1174,13 @@ PathSearchNode * PathSearch::search ( void )
 
 		for(int i = 0; i < neighborCount; i++)
 		{
+			if(m_restrictCluster != -1)
+			{
+				int neighborIndex = m_graph->getEdge( node->getPathNodeIndex(), i )->getIndexB();
+
+				if(m_clusters->getCluster(neighborIndex) != m_restrictCluster) continue;
+			}
+
 			PathSearchNode * neighbor = node->getNeighbor(i);
 
 			if(neighbor != NULL)
@@ -400,15 +1222,31 @@ bool PathSearch::search ( PathGraph const * graph, int startIndex, int goalIndex
 
 	m_path->clear();
 
-	PathSearchNode * endNode = search();
+	m_expandedNodeCount = 0;
 
-	bool buildOk = buildPath(endNode);
+	bool buildOk = false;
 
-	cleanup();
+	if(m_cache->lookup(graph,startIndex,goalIndex,buildOk,*m_path))
+	{
+		m_cacheHitCount++;
+	}
+	else
+	{
+		if(canReach(m_start,m_goal) && !searchClusters(buildOk))
+		{
+			PathSearchNode * endNode = search();
+
+			buildOk = buildPath(endNode);
+
+			cleanup();
+		}
+
+		m_cache->store(graph,startIndex,goalIndex,buildOk,*m_path);
+	}
 
 	timer.stop();
 
-	pathSearchTime += timer.getElapsedTime();
+	if(m_trackSearchTime) pathSearchTime += timer.getElapsedTime();
 
 	return buildOk;
 }
@@ -431,14 +1269,23 @@ bool PathSearch::search ( PathGraph const * graph, int startIndex, IndexList con
 	if(goalCount == 0) return false;
 	if(m_start == NULL)	return false;
 
-	m_goals->resize(goalCount);
+	m_goals->clear();
 
 	for(int i = 0; i < goalCount; i++)
 	{
-		m_goals->at(i) = graph->getNode(goalIndices[i]);
+		PathNode const * goal = graph->getNode(goalIndices[i]);
+
+		// goals that can't be reached would only mislead the heuristic
+
+		if(goal && canReach(m_start,goal))
+		{
+			m_goals->push_back(goal);
+		}
 	}
 
-	PathSearchNode * endNode = search();
+	m_expandedNodeCount = 0;
+
+	PathSearchNode * endNode = m_goals->empty() ? NULL : search();
 
 	bool buildOk = buildPath(endNode);
 
@@ -446,7 +1293,7 @@ bool PathSearch::search ( PathGraph const * graph, int startIndex, IndexList con
 
 	timer.stop();
 
-	pathSearchTime += timer.getElapsedTime();
+	if(m_trackSearchTime) pathSearchTime += timer.getElapsedTime();
 
 	return buildOk;
 }
@@ -487,27 +1334,10 @@ bool PathSearch::buildPath ( PathSearchNode * endNode )
 
 void PathSearch::cleanup ( void )
 {
-	int visitedCount = m_visitedNodes->size();
-
-	for(int i = 0; i < visitedCount; i++)
-	{
-		PathNode const * visitedNode = m_visitedNodes->at(i);
-
-		int mark = visitedNode->getMark(3);
-
-		if(mark != -1)
-		{
-			PathSearchNode * searchNode = (PathSearchNode*)((void*)mark);
-
-			delete searchNode;
-		}
-
-		visitedNode->clearMarks();
-	}
+	// the search nodes stay in the scratch array for the next search
 
 	m_queue->clear();
 	m_goals->clear();
-	m_visitedNodes->clear();
 
 	m_multiGoal = false;
 }
@@ -629,6 +1459,91 @@ IndexList const & PathSearch::getPath ( void ) const
 	return *m_path;
 }
 
+// ----------
+
+int PathSearch::getExpandedNodeCount ( void ) const
+{
+	return m_expandedNodeCount;
+}
+
+int PathSearch::getCacheHitCount ( void ) const
+{
+	return m_cacheHitCount;
+}
+
+int PathSearch::getHierarchicalSearchCount ( void ) const
+{
+	return m_hierarchicalSearchCount;
+}
+
+void PathSearch::setTrackSearchTime ( bool trackSearchTime )
+{
+	m_trackSearchTime = trackSearchTime;
+}
+
+// ----------------------------------------------------------------------
+// Search between pseudo-random pairs of nodes in the graph and report the
+// searches per second and the average number of nodes expanded.  The pairs
+// are the same from run to run so results can be compared.
+
+void PathSearch::benchmark ( PathGraph const * graph, int searchCount )
+{
+	if(graph == NULL) return;
+	if(searchCount <= 0) return;
+
+	int nodeCount = graph->getNodeCount();
+
+	if(nodeCount < 2) return;
+
+	PathSearch search;
+
+	int found = 0;
+	int expanded = 0;
+	int pathLength = 0;
+	uint32 seed = 12345;
+
+	PerformanceTimer timer;
+
+	timer.start();
+
+	for(int i = 0; i < searchCount; i++)
+	{
+		int startIndex = -1;
+		int goalIndex = -1;
+
+		// dynamic graphs can have holes, so keep picking until both ends exist
+
+		while((startIndex == -1) || (graph->getNode(startIndex) == NULL))
+		{
+			seed = seed * 1664525 + 1013904223;
+			startIndex = static_cast<int>((seed >> 8) % static_cast<uint32>(nodeCount));
+		}
+
+		while((goalIndex == -1) || (goalIndex == startIndex) || (graph->getNode(goalIndex) == NULL))
+		{
+			seed = seed * 1664525 + 1013904223;
+			goalIndex = static_cast<int>((seed >> 8) % static_cast<uint32>(nodeCount));
+		}
+
+		if(search.search(graph,startIndex,goalIndex))
+		{
+			found++;
+			pathLength += static_cast<int>(search.getPath().size());
+		}
+
+		expanded += search.getExpandedNodeCount();
+	}
+
+	timer.stop();
+
+	float elapsed = std::max(timer.getElapsedTime(), 0.000001f);
+
+	REPORT_LOG(true, ("PathSearch benchmark: %d searches over %d nodes\n", searchCount, nodeCount));
+	REPORT_LOG(true, ("  %.0f searches/sec, %.3f msec/search\n", searchCount / elapsed, (elapsed * 1000.0f) / searchCount));
+	REPORT_LOG(true, ("  %.1f nodes expanded/search, %d of %d found, %.1f nodes/path\n", static_cast<float>(expanded) / searchCount, found, searchCount, found ? static_cast<float>(pathLength) / found : 0.0f));
+	REPORT_LOG(true, ("  %d cache hits, parts %s, %d hierarchical searches\n", search.getCacheHitCount(), graph->partsAreDisjoint() ? "disjoint" : "not used", search.getHierarchicalSearchCount()));
+}
+
 // ----------------------------------------------------------------------
 
 bool PathSearch::atGoal ( PathSearchNode * searchNode ) const
@@ -650,3 +1565,126 @@ bool PathSearch::atGoal ( PathSearchNode * searchNode ) const
 }
 
 // ----------------------------------------------------------------------
+// Nodes in different parts of the graph can't reach each other, so there's
+// no need to search the whole part the start node is in to find that out.
+
+bool PathSearch::canReach ( PathNode const * A, PathNode const * B ) const
+{
+	if(A == B) return true;
+
+	if(!m_graph->partsAreDisjoint()) return true;
+
+	int partId = A->getPartId();
+
+	return (partId != -1) && (partId == B->getPartId());
+}
+
+// ----------------------------------------------------------------------
+// Search large outdoor graphs through the cluster abstraction, then fill
+// in the path inside each cluster with a search that can't leave it.
+// Returns false if the flat search should be used instead: it is disabled,
+// the graph is small, inside a building or has one-way edges, or the start
+// and goal share a cluster.  Paths found this way can be somewhat longer
+// than the flat search's, so it's only worth it on large obstructed graphs.
+
+bool PathSearch::searchClusters ( bool & found )
+{
+	int minimumNodeCount = ConfigSharedPathfinding::getHierarchicalSearchNodes();
+
+	if(minimumNodeCount <= 0) return false;
+	if(m_graph->getType() == PGT_Building) return false;
+	if(m_graph->getNodeCount() < minimumNodeCount) return false;
+	if(!m_graph->partsAreDisjoint()) return false;
+
+	if(!m_clusters->isCurrent(m_graph))
+	{
+		m_clusters->build( m_graph, ConfigSharedPathfinding::getHierarchicalClusterSize() );
+	}
+
+	int startIndex = m_start->getIndex();
+	int goalIndex = m_goal->getIndex();
+
+	int startCluster = m_clusters->getCluster(startIndex);
+
+	if((startCluster == -1) || (startCluster == m_clusters->getCluster(goalIndex))) return false;
+
+	int expandedNodeCount = 0;
+
+	IndexList waypoints;
+
+	bool ok = m_clusters->search(startIndex,goalIndex,waypoints,expandedNodeCount);
+
+	PathNode const * start = m_start;
+	PathNode const * goal = m_goal;
+
+	m_path->clear();
+	m_path->push_back(startIndex);
+
+	for(uint i = 1; ok && (i < waypoints.size()); i++)
+	{
+		int fromIndex = waypoints[i - 1];
+		int toIndex = waypoints[i];
+
+		int cluster = m_clusters->getCluster(fromIndex);
+
+		if(cluster != m_clusters->getCluster(toIndex))
+		{
+			// an edge between clusters
+
+			m_path->push_back(toIndex);
+		}
+		else
+		{
+			ok = appendClusterPath(cluster,fromIndex,toIndex);
+
+			expandedNodeCount += m_expandedNodeCount;
+		}
+	}
+
+	m_start = start;
+	m_goal = goal;
+	m_expandedNodeCount = expandedNodeCount;
+
+	if(!ok)
+	{
+		m_path->clear();
+		return false;
+	}
+
+	m_hierarchicalSearchCount++;
+
+	found = true;
+	return true;
+}
+
+// ----------
+
+bool PathSearch::appendClusterPath ( int cluster, int fromIndex, int toIndex )
+{
+	m_start = m_graph->getNode(fromIndex);
+	m_goal = m_graph->getNode(toIndex);
+
+	m_restrictCluster = cluster;
+
+	PathSearchNode * endNode = search();
+
+	m_restrictCluster = -1;
+
+	if(endNode != NULL)
+	{
+		int segmentStart = static_cast<int>(m_path->size());
+
+		for(PathSearchNode * cursor = endNode; cursor->getParent() != NULL; cursor = cursor->getParent())
+		{
+			m_path->push_back( cursor->getPathNodeIndex() );
+		}
+
+		std::reverse( m_path->begin() + segmentStart, m_path->end() );
+	}
+
+	m_queue->clear();
+
+	return endNode != NULL;
+}
+
+// ======================================================================
@@ -14,6 +14,9 @@ class PathNode;
 class PathSearch;
 class PathSearchNode;
 class PathSearchQueue;
+class PathSearchScratch;
+class PathSearchCache;
+class PathSearchClusters;
 
 
 struct PathNodeHasher
@@ -43,10 +46,23 @@ public:
 
 	IndexList const & getPath       ( void ) const;
 
+	int               getExpandedNodeCount ( void ) const;
+	int               getCacheHitCount ( void ) const;
+	int               getHierarchicalSearchCount ( void ) const;
+
+	// Searches add their time to the global path search time unless this is
+	// turned off, which searches run off the main thread must do.
+
+	void              setTrackSearchTime ( bool trackSearchTime );
+
+	static void       benchmark     ( PathGraph const * graph, int searchCount );
+
 protected:
 
 	PathSearchNode *  search        ( void );
 
+	PathSearchNode *  getSearchNode ( PathNode const * node );
+
 	float             costBetween   ( PathNode const * A, PathNode const * B ) const;
 	
 	float             calcHeuristic ( PathNode const * A ) const;
@@ -58,6 +74,11 @@ protected:
 
 	bool              atGoal        ( PathSearchNode * endNode ) const;
 
+	bool              canReach      ( PathNode const * A, PathNode const * B ) const;
+
+	bool              searchClusters    ( bool & found );
+	bool              appendClusterPath ( int cluster, int fromIndex, int toIndex );
+
 	// ----------
 
 	friend class PathSearchNode;
@@ -74,7 +95,18 @@ protected:
 
 	IndexList *       m_path;
 
-	NodeList *        m_visitedNodes;
+	PathSearchScratch * m_scratch;
+
+	PathSearchCache * m_cache;
+
+	PathSearchClusters * m_clusters;
+	int               m_restrictCluster;   // searches only expand nodes in this cluster, unless -1
+
+	int               m_expandedNodeCount;
+	int               m_cacheHitCount;
+	int               m_hierarchicalSearchCount;
+
+	bool              m_trackSearchTime;
 };
 
 // ======================================================================
@@ -0,0 +1,455 @@
+// ======================================================================
+//
+// PathSearchBatch.cpp
+// copyright (c) 2001 Sony Online Entertainment
+//
+// ======================================================================
+
+#include "sharedPathfinding/FirstSharedPathfinding.h"
+#include "sharedPathfinding/PathSearchBatch.h"
+
+#include "sharedDebug/PerformanceTimer.h"
+#include "sharedFoundation/ExitChain.h"
+#include "sharedPathfinding/ConfigSharedPathfinding.h"
+#include "sharedPathfinding/PathGraph.h"
+#include "sharedPathfinding/PathSearch.h"
+#include "sharedSynchronization/InterlockedInteger.h"
+#include "sharedSynchronization/Mutex.h"
+#include "sharedSynchronization/Semaphore.h"
+#include "sharedThread/RunThread.h"
+#include "sharedThread/ThreadHandle.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+// ======================================================================
+
+struct PathSearchBatchQuery
+{
+	PathSearchBatchQuery ( void )
+	: m_graph(NULL),
+	  m_startIndex(-1),
+	  m_goalIndex(-1),
+	  m_changeStamp(0),
+	  m_found(false),
+	  m_expandedNodeCount(0),
+	  m_path()
+	{
+	}
+
+	PathGraph const * m_graph;
+	int               m_startIndex;
+	int               m_goalIndex;
+	int               m_changeStamp;       // of the graph when the batch started
+
+	bool              m_found;
+	int               m_expandedNodeCount;
+	IndexList         m_path;
+};
+
+// ======================================================================
+
+namespace PathSearchBatchNamespace
+{
+	int const cs_maximumNumberOfThreads = 8;
+
+	// queries are handed to the threads a few at a time so a thread doesn't
+	// have to take the lock for every search
+
+	int const cs_chunkSize = 8;
+
+	struct Chunk
+	{
+		PathSearchBatch * m_batch;
+		int               m_begin;
+		int               m_end;
+	};
+
+	typedef std::deque<Chunk> ChunkQueue;
+
+	bool           s_installed = false;
+	int            s_numberOfThreads = 0;
+	ThreadHandle   s_threadHandles[cs_maximumNumberOfThreads];
+	Semaphore      s_workPending;
+	Mutex          s_chunkLock;
+	ChunkQueue     s_chunks;
+	bool volatile  s_quit = false;
+
+	PathSearch *   s_mainThreadSearch = NULL;
+}
+
+using namespace PathSearchBatchNamespace;
+
+// ======================================================================
+
+void PathSearchBatch::install ( void )
+{
+	DEBUG_FATAL(s_installed,("PathSearchBatch::install - already installed\n"));
+
+	s_mainThreadSearch = new PathSearch();
+
+	s_numberOfThreads = clamp(0, ConfigSharedPathfinding::getPathSearchThreads(), cs_maximumNumberOfThreads);
+	s_quit = false;
+
+	for(int i = 0; i < s_numberOfThreads; i++)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "PathSearch%d", i + 1);
+		s_threadHandles[i] = runNamedThread(name, threadRoutine);
+	}
+
+	s_installed = true;
+
+	ExitChain::add(remove, "PathSearchBatch::remove");
+}
+
+// ----------
+
+void PathSearchBatch::remove ( void )
+{
+	if(!s_installed) return;
+
+	DEBUG_WARNING(!s_chunks.empty(),("PathSearchBatch::remove - %d chunks of queries were never run\n",static_cast<int>(s_chunks.size())));
+
+	// each thread exits the next time it wakes
+
+	s_quit = true;
+	s_workPending.signal(s_numberOfThreads);
+
+	for(int i = 0; i < s_numberOfThreads; i++)
+	{
+		s_threadHandles[i]->wait();
+		s_threadHandles[i] = ThreadHandle();
+	}
+
+	s_numberOfThreads = 0;
+	s_chunks.clear();
+
+	delete s_mainThreadSearch;
+	s_mainThreadSearch = NULL;
+
+	s_installed = false;
+}
+
+// ----------------------------------------------------------------------
+// Each wake-up runs one chunk of queries. Searches off the main thread
+// don't add to the global path search time.
+
+void PathSearchBatch::threadRoutine ( void )
+{
+	PathSearch search;
+
+	search.setTrackSearchTime(false);
+
+	for(;;)
+	{
+		s_workPending.wait();
+
+		if(s_quit) break;
+
+		s_chunkLock.enter();
+
+		Chunk chunk = s_chunks.front();
+		s_chunks.pop_front();
+
+		s_chunkLock.leave();
+
+		chunk.m_batch->runQueries(search,chunk.m_begin,chunk.m_end);
+	}
+}
+
+// ======================================================================
+
+PathSearchBatch::PathSearchBatch ( void )
+: m_queries( new QueryList() ),
+  m_running(false),
+  m_remainingChunks( new InterlockedInteger(0) ),
+  m_complete( new Semaphore() ),
+  m_timer( new PerformanceTimer() ),
+  m_elapsedTime(0.0f)
+{
+}
+
+PathSearchBatch::~PathSearchBatch()
+{
+	wait();
+
+	delete m_queries;
+	m_queries = NULL;
+
+	delete m_remainingChunks;
+	m_remainingChunks = NULL;
+
+	delete m_complete;
+	m_complete = NULL;
+
+	delete m_timer;
+	m_timer = NULL;
+}
+
+// ----------------------------------------------------------------------
+
+int PathSearchBatch::addQuery ( PathGraph const * graph, int startIndex, int goalIndex )
+{
+	DEBUG_FATAL(m_running,("PathSearchBatch::addQuery - can't add queries while the batch is running\n"));
+
+	m_queries->push_back(PathSearchBatchQuery());
+
+	PathSearchBatchQuery & query = m_queries->back();
+
+	query.m_graph = graph;
+	query.m_startIndex = startIndex;
+	query.m_goalIndex = goalIndex;
+
+	return static_cast<int>(m_queries->size()) - 1;
+}
+
+// ----------
+
+void PathSearchBatch::clear ( void )
+{
+	DEBUG_FATAL(m_running,("PathSearchBatch::clear - can't clear the batch while it's running\n"));
+
+	m_queries->clear();
+	m_elapsedTime = 0.0f;
+}
+
+// ----------
+
+int PathSearchBatch::getQueryCount ( void ) const
+{
+	return static_cast<int>(m_queries->size());
+}
+
+// ----------------------------------------------------------------------
+
+void PathSearchBatch::start ( void )
+{
+	DEBUG_FATAL(!s_installed,("PathSearchBatch::start - not installed\n"));
+	DEBUG_FATAL(m_running,("PathSearchBatch::start - the batch is already running\n"));
+
+	int queryCount = getQueryCount();
+
+	for(int i = 0; i < queryCount; i++)
+	{
+		PathSearchBatchQuery & query = m_queries->at(i);
+
+		query.m_changeStamp = query.m_graph ? query.m_graph->getChangeStamp() : 0;
+	}
+
+	m_elapsedTime = 0.0f;
+	m_timer->start();
+
+	if(queryCount == 0)
+	{
+		m_timer->stop();
+		return;
+	}
+
+	m_running = true;
+
+	if(s_numberOfThreads == 0)
+	{
+		IGNORE_RETURN(*m_remainingChunks = 1);
+
+		runQueries(*s_mainThreadSearch,0,queryCount);
+
+		return;
+	}
+
+	int chunkCount = (queryCount + cs_chunkSize - 1) / cs_chunkSize;
+
+	IGNORE_RETURN(*m_remainingChunks = chunkCount);
+
+	s_chunkLock.enter();
+
+	for(int begin = 0; begin < queryCount; begin += cs_chunkSize)
+	{
+		Chunk chunk;
+
+		chunk.m_batch = this;
+		chunk.m_begin = begin;
+		chunk.m_end = std::min(begin + cs_chunkSize, queryCount);
+
+		s_chunks.push_back(chunk);
+	}
+
+	s_chunkLock.leave();
+
+	s_workPending.signal(chunkCount);
+}
+
+// ----------
+
+bool PathSearchBatch::isDone ( void )
+{
+	if(!m_running) return true;
+
+	if(*m_remainingChunks != 0) return false;
+
+	wait();
+
+	return true;
+}
+
+// ----------
+
+void PathSearchBatch::wait ( void )
+{
+	if(!m_running) return;
+
+	m_complete->wait();
+
+	m_running = false;
+
+	m_timer->stop();
+	m_elapsedTime = m_timer->getElapsedTime();
+
+#ifdef _DEBUG
+
+	int queryCount = getQueryCount();
+
+	for(int i = 0; i < queryCount; i++)
+	{
+		PathSearchBatchQuery const & query = m_queries->at(i);
+
+		DEBUG_WARNING(query.m_graph && (query.m_graph->getChangeStamp() != query.m_changeStamp),("PathSearchBatch::wait - the graph for query %d changed while the batch was running\n",i));
+	}
+
+#endif
+}
+
+// ----------------------------------------------------------------------
+// Run queries [begin,end) and signal the batch complete if they were the
+// last ones. Called from the path search threads.
+
+void PathSearchBatch::runQueries ( PathSearch & search, int begin, int end )
+{
+	for(int i = begin; i < end; i++)
+	{
+		PathSearchBatchQuery & query = m_queries->at(i);
+
+		if(query.m_graph == NULL)
+		{
+			query.m_found = false;
+			query.m_expandedNodeCount = 0;
+			query.m_path.clear();
+			continue;
+		}
+
+		query.m_found = search.search(query.m_graph,query.m_startIndex,query.m_goalIndex);
+		query.m_expandedNodeCount = search.getExpandedNodeCount();
+		query.m_path = search.getPath();
+	}
+
+	if(--(*m_remainingChunks) == 0)
+	{
+		m_complete->signal();
+	}
+}
+
+// ----------------------------------------------------------------------
+
+bool PathSearchBatch::getFound ( int queryIndex ) const
+{
+	DEBUG_FATAL(m_running,("PathSearchBatch::getFound - the batch is still running\n"));
+
+	return m_queries->at(queryIndex).m_found;
+}
+
+IndexList const & PathSearchBatch::getPath ( int queryIndex ) const
+{
+	DEBUG_FATAL(m_running,("PathSearchBatch::getPath - the batch is still running\n"));
+
+	return m_queries->at(queryIndex).m_path;
+}
+
+int PathSearchBatch::getExpandedNodeCount ( int queryIndex ) const
+{
+	DEBUG_FATAL(m_running,("PathSearchBatch::getExpandedNodeCount - the batch is still running\n"));
+
+	return m_queries->at(queryIndex).m_expandedNodeCount;
+}
+
+// ----------
+
+int PathSearchBatch::getTotalExpandedNodeCount ( void ) const
+{
+	DEBUG_FATAL(m_running,("PathSearchBatch::getTotalExpandedNodeCount - the batch is still running\n"));
+
+	int total = 0;
+
+	int queryCount = getQueryCount();
+
+	for(int i = 0; i < queryCount; i++)
+	{
+		total += m_queries->at(i).m_expandedNodeCount;
+	}
+
+	return total;
+}
+
+float PathSearchBatch::getElapsedTime ( void ) const
+{
+	return m_elapsedTime;
+}
+
+float PathSearchBatch::getQueriesPerSecond ( void ) const
+{
+	return getQueryCount() / std::max(m_elapsedTime, 0.000001f);
+}
+
+// ----------------------------------------------------------------------
+// Run the same pseudo-random searches as PathSearch::benchmark as one
+// batch, to compare with searching one at a time.
+
+void PathSearchBatch::benchmark ( PathGraph const * graph, int queryCount )
+{
+	if(graph == NULL) return;
+	if(queryCount <= 0) return;
+
+	int nodeCount = graph->getNodeCount();
+
+	if(nodeCount < 2) return;
+
+	PathSearchBatch batch;
+
+	uint32 seed = 12345;
+
+	for(int i = 0; i < queryCount; i++)
+	{
+		int startIndex = -1;
+		int goalIndex = -1;
+
+		while((startIndex == -1) || (graph->getNode(startIndex) == NULL))
+		{
+			seed = seed * 1664525 + 1013904223;
+			startIndex = static_cast<int>((seed >> 8) % static_cast<uint32>(nodeCount));
+		}
+
+		while((goalIndex == -1) || (goalIndex == startIndex) || (graph->getNode(goalIndex) == NULL))
+		{
+			seed = seed * 1664525 + 1013904223;
+			goalIndex = static_cast<int>((seed >> 8) % static_cast<uint32>(nodeCount));
+		}
+
+		IGNORE_RETURN(batch.addQuery(graph,startIndex,goalIndex));
+	}
+
+	batch.start();
+	batch.wait();
+
+	int found = 0;
+
+	for(int j = 0; j < queryCount; j++)
+	{
+		if(batch.getFound(j)) found++;
+	}
+
+	REPORT_LOG(true, ("PathSearchBatch benchmark: %d queries over %d nodes on %d threads\n", queryCount, nodeCount, s_numberOfThreads));
+	REPORT_LOG(true, ("  %.0f queries/sec, %.3f msec total\n", batch.getQueriesPerSecond(), batch.getElapsedTime() * 1000.0f));
+	REPORT_LOG(true, ("  %.1f nodes expanded/query, %d of %d found\n", static_cast<float>(batch.getTotalExpandedNodeCount()) / queryCount, found, queryCount));
+}
+
+// ======================================================================
@@ -0,0 +1,91 @@
+// ======================================================================
+//
+// PathSearchBatch.h
+// Copyright 2001 Sony Online Entertainment Inc.
+// All Rights Reserved.
+//
+// ======================================================================
+
+#ifndef	INCLUDED_PathSearchBatch_H
+#define	INCLUDED_PathSearchBatch_H
+
+class InterlockedInteger;
+class PathGraph;
+class PathSearch;
+class PerformanceTimer;
+class Semaphore;
+struct PathSearchBatchQuery;
+
+typedef stdvector<int>::fwd IndexList;
+
+// ======================================================================
+// A set of path searches that run together on the path search threads,
+// for when lots of agents want paths at once. Add the queries, call
+// start(), then poll isDone() or call wait() before reading the results.
+//
+// start() returns right away. With no path search threads configured
+// (SharedPathfinding/pathSearchThreads) the searches run inside start().
+//
+// Each thread has its own PathSearch and only reads the graphs, so the
+// graphs must not be changed or deleted until the batch is done.
+
+class PathSearchBatch
+{
+public:
+
+	static void       install        ( void );
+	static void       remove         ( void );
+
+	static void       benchmark      ( PathGraph const * graph, int queryCount );
+
+	// ----------
+
+	PathSearchBatch();
+	~PathSearchBatch();
+
+	int               addQuery       ( PathGraph const * graph, int startIndex, int goalIndex );
+	void              clear          ( void );
+	int               getQueryCount  ( void ) const;
+
+	void              start          ( void );
+	bool              isDone         ( void );
+	void              wait           ( void );
+
+	// ----------
+	// Results, once the batch is done
+
+	bool              getFound       ( int queryIndex ) const;
+	IndexList const & getPath        ( int queryIndex ) const;
+	int               getExpandedNodeCount ( int queryIndex ) const;
+
+	int               getTotalExpandedNodeCount ( void ) const;
+	float             getElapsedTime ( void ) const;            // from start() until the batch was seen to be done
+	float             getQueriesPerSecond ( void ) const;
+
+protected:
+
+	static void       threadRoutine  ( void );
+
+	void              runQueries     ( PathSearch & search, int begin, int end );
+
+	typedef stdvector<PathSearchBatchQuery>::fwd QueryList;
+
+	QueryList *          m_queries;
+
+	bool                 m_running;
+	InterlockedInteger * m_remainingChunks;
+	Semaphore *          m_complete;
+
+	PerformanceTimer *   m_timer;
+	float                m_elapsedTime;
+
+private:
+
+	PathSearchBatch ( PathSearchBatch const & );
+	PathSearchBatch & operator = ( PathSearchBatch const & );
+};
+
+// ======================================================================
+
+#endif
+
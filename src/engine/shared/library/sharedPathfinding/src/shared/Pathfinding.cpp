@@ -12,16 +12,30 @@
 #include "sharedCollision/FloorMesh.h"
 #include "sharedCollision/FloorManager.h"
 
+#include "sharedDebug/DebugFlags.h"
+
 #include "sharedFile/Iff.h"
 
+#include "sharedFoundation/ExitChain.h"
+
 #include "sharedObject/CellProperty.h"
 
+#include "sharedPathfinding/ConfigSharedPathfinding.h"
+#include "sharedPathfinding/PathGraph.h"
 #include "sharedPathfinding/PathSearch.h"
+#include "sharedPathfinding/PathSearchBatch.h"
 #include "sharedPathfinding/SimplePathGraph.h"
 
 const Tag TAG_PGRF = TAG(P,G,R,F);
 const Tag TAG_PNOD = TAG(P,N,O,D);
 
+namespace PathfindingNamespace
+{
+	bool ms_benchmarkSearch = false;
+}
+
+using namespace PathfindingNamespace;
+
 // ======================================================================
 
 void Pathfinding::install ( void )
@@ -31,12 +45,18 @@ void Pathfinding::install ( void )
 	FloorManager::setPathGraphRenderer( &Pathfinding::graphRenderer );
 
 	PathSearch::install();
+	PathSearchBatch::install();
+
+	DebugFlags::registerFlag(ms_benchmarkSearch, "SharedPathfinding", "benchmarkSearch", benchmarkSearchFromConfig);
+
+	ExitChain::add(Pathfinding::remove, "Pathfinding::remove");
 }
 
 // ----------
 
 void Pathfinding::remove ( void )
 {
+	DebugFlags::unregisterFlag(ms_benchmarkSearch);
 }
 
 // ----------
@@ -91,4 +111,56 @@ void Pathfinding::graphRenderer ( BaseClass const * baseGraph, DebugShapeRendere
 	graph->drawDebugShapes(renderer);
 }
 
+// ----------
+// Load a path graph file and run the PathSearch and PathSearchBatch
+// benchmarks over it.
+
+void Pathfinding::benchmarkSearch ( char const * graphFileName, int searchCount )
+{
+	Iff iff;
+
+	if(!iff.open(graphFileName,true))
+	{
+		WARNING(true,("Pathfinding::benchmarkSearch - Could not open %s\n",graphFileName));
+		return;
+	}
+
+	BaseClass * baseGraph = graphFactory(iff);
+
+	PathGraph const * graph = dynamic_cast<PathGraph const *>(baseGraph);
+
+	if(graph == NULL)
+	{
+		WARNING(true,("Pathfinding::benchmarkSearch - %s is not a path graph\n",graphFileName));
+	}
+	else
+	{
+		REPORT_LOG(true,("Pathfinding::benchmarkSearch - %s\n",graphFileName));
+
+		PathSearch::benchmark(graph,searchCount);
+		PathSearchBatch::benchmark(graph,searchCount);
+	}
+
+	delete baseGraph;
+}
+
+// ----------
+// Run once when the benchmarkSearch debug flag is set, over the graph named
+// by the benchmarkSearchGraph config option.
+
+void Pathfinding::benchmarkSearchFromConfig ( void )
+{
+	ms_benchmarkSearch = false;
+
+	char const * const graphFileName = ConfigSharedPathfinding::getBenchmarkSearchGraph();
+
+	if((graphFileName == NULL) || (*graphFileName == '\0'))
+	{
+		WARNING(true,("Pathfinding::benchmarkSearch - set [SharedPathfinding] benchmarkSearchGraph to a .pgr file to benchmark\n"));
+		return;
+	}
+
+	benchmarkSearch(graphFileName,ConfigSharedPathfinding::getBenchmarkSearchCount());
+}
+
 // ======================================================================
@@ -28,6 +28,12 @@ public:
 	static BaseClass * graphFactory  ( Iff & iff );
 	static void        graphWriter   ( BaseClass const * baseGraph, Iff & iff );
 	static void        graphRenderer ( BaseClass const * baseGraph, DebugShapeRenderer * renderer );
+
+	static void        benchmarkSearch ( char const * graphFileName, int searchCount );
+
+private:
+
+	static void        benchmarkSearchFromConfig ( void );
 };
 
 // ======================================================================
@@ -212,6 +212,9 @@ SimplePathGraph::~SimplePathGraph()
 
 void SimplePathGraph::clear ( void )
 {
+	markChanged();
+	nodesReplaced();
+
 	m_nodes->clear();
 	m_edges->clear();
 	m_edgeCounts->clear();
@@ -228,6 +231,9 @@ void SimplePathGraph::clear ( void )
 
 void SimplePathGraph::buildIndexTables ( void )
 {
+	markChanged();
+	nodesReplaced();
+
 	std::sort( m_edges->begin(), m_edges->end() );
 
 	m_edgeCounts->clear();
@@ -177,7 +177,7 @@ ArrayList<int>* SamplerProceduralTerrainAppearance::SamplerChunk::ms_indexList;
 
 //-------------------------------------------------------------------
 
-MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL (SamplerProceduralTerrainAppearance::SamplerChunk, false, 256, 4, 0);
+MEMORY_BLOCK_MANAGER_IMPLEMENTATION_WITHOUT_INSTALL_PER_THREAD (SamplerProceduralTerrainAppearance::SamplerChunk, 256, 4, 0);
 
 //-------------------------------------------------------------------
 
@@ -10,7 +10,9 @@
 #include "sharedFoundation/FirstSharedFoundation.h"
 #include "sharedThread/Thread.h"
 
+#include "sharedDebug/Profiler.h"
 #include "sharedFoundation/ExitChain.h"
+#include "sharedFoundation/MemoryBlockManager.h"
 #include "sharedFoundation/Os.h"
 #include "sharedFoundation/PerThreadData.h"
 #include <cstdio>
@@ -78,9 +80,17 @@ void * Thread::threadFunc(void * i)
 	pthread_setspecific(implindex,	impl);
 	pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, 0);
 	Os::setThreadName(impl->thread, impl->name.c_str());
+	Profiler::setThreadName(impl->name.c_str());
 	PerThreadData::threadInstall(true);
-	impl->run();
+	{
+		// short-lived threads show up whole in a trace capture
+		PROFILER_AUTO_BLOCK_DEFINE("Thread::run");
+		impl->run();
+	}
 	PerThreadData::threadRemove();
+	Profiler::removeThread();
+	MemoryManager::removeThreadCache();
+	MemoryBlockManager::releaseThreadShards();
 	impl->kill();
 	return 0;
 }
@@ -10,7 +10,9 @@
 #include "sharedThread/FirstSharedThread.h"
 #include "sharedThread/Thread.h"
 
+#include "sharedDebug/Profiler.h"
 #include "sharedFoundation/ExitChain.h"
+#include "sharedFoundation/MemoryBlockManager.h"
 #include "sharedSynchronization/Mutex.h"
 #include "sharedSynchronization/RecursiveMutex.h"
 #include "sharedFoundation/Os.h"
@@ -97,9 +99,17 @@ unsigned int Thread::threadFunc(void * i)
 	Thread * impl = static_cast<Thread *>(i);
 	TlsSetValue(implindex, impl);
 	Os::setThreadName(impl->id, impl->name->c_str());
+	Profiler::setThreadName(impl->name->c_str());
 	PerThreadData::threadInstall(true);
-	impl->run();
+	{
+		// short-lived threads show up whole in a trace capture
+		PROFILER_AUTO_BLOCK_DEFINE("Thread::run");
+		impl->run();
+	}
 	PerThreadData::threadRemove();
+	Profiler::removeThread();
+	MemoryManager::removeThreadCache();
+	MemoryBlockManager::releaseThreadShards();
 	impl->kill();
 	return 0;
 }
@@ -10,13 +10,122 @@
 #include "sharedUtility/DataTable.h"
 
 #include "sharedFile/Iff.h"
-#include "sharedUtility/DataTableCell.h"
+#include "sharedFoundation/Crc.h"
+#include "sharedFoundation/CrcString.h"
 
-#include <map>
 #include <hash_map>
 
 //----------------------------------------------------------------------------
 
+namespace DataTableNamespace
+{
+	// Search indexes are open addressing hash tables of row numbers, keyed by a 32 bit
+	// key per row.  Only the first row with each key is kept, which is the row a search
+	// has to return.
+
+	class IntKey
+	{
+	public:
+		explicit IntKey(std::vector<int> const &values) : m_values(values) {}
+		uint32 operator()(int row) const { return static_cast<uint32>(m_values[static_cast<size_t>(row)]); }
+	private:
+		IntKey &operator=(IntKey const &);
+		std::vector<int> const &m_values;
+	};
+
+	uint32 getFloatKey(float value);
+
+	class FloatKey
+	{
+	public:
+		explicit FloatKey(std::vector<float> const &values) : m_values(values) {}
+		uint32 operator()(int row) const { return getFloatKey(m_values[static_cast<size_t>(row)]); }
+	private:
+		FloatKey &operator=(FloatKey const &);
+		std::vector<float> const &m_values;
+	};
+
+	int    getIndexSize(int numberOfKeys);
+	uint32 hashKey(uint32 key);
+
+	template <typename KeyFunction>
+	void buildIndex(std::vector<int> &index, int numberOfRows, KeyFunction const &keyOf);
+
+	template <typename KeyFunction>
+	int findInIndex(std::vector<int> const &index, uint32 key, KeyFunction const &keyOf);
+}
+
+using namespace DataTableNamespace;
+
+//----------------------------------------------------------------------------
+
+uint32 DataTableNamespace::getFloatKey(float const value)
+{
+	// 0 and -0 compare equal, so they must share a key
+	if (value == 0.0f) //lint !e777 //ok to compare floats
+		return 0;
+
+	uint32 key;
+	memcpy(&key, &value, sizeof(key));
+	return key;
+}
+
+//----------------------------------------------------------------------------
+
+int DataTableNamespace::getIndexSize(int const numberOfKeys)
+{
+	// a power of two at least twice the number of keys
+	int size = 8;
+	while (size < numberOfKeys * 2)
+		size *= 2;
+	return size;
+}
+
+//----------------------------------------------------------------------------
+
+uint32 DataTableNamespace::hashKey(uint32 const key)
+{
+	return (key * 2654435761u) ^ (key >> 16);
+}
+
+//----------------------------------------------------------------------------
+
+template <typename KeyFunction>
+void DataTableNamespace::buildIndex(std::vector<int> &index, int const numberOfRows, KeyFunction const &keyOf)
+{
+	index.assign(static_cast<size_t>(getIndexSize(numberOfRows)), -1);
+	uint32 const mask = static_cast<uint32>(index.size() - 1);
+
+	for (int row = 0; row < numberOfRows; ++row)
+	{
+		uint32 const key = keyOf(row);
+		uint32 slot = hashKey(key) & mask;
+		while (index[slot] >= 0 && keyOf(index[slot]) != key)
+			slot = (slot + 1) & mask;
+
+		if (index[slot] < 0)
+			index[slot] = row;
+	}
+}
+
+//----------------------------------------------------------------------------
+
+template <typename KeyFunction>
+int DataTableNamespace::findInIndex(std::vector<int> const &index, uint32 const key, KeyFunction const &keyOf)
+{
+	if (index.empty())
+		return -1;
+
+	uint32 const mask = static_cast<uint32>(index.size() - 1);
+	for (uint32 slot = hashKey(key) & mask; index[slot] >= 0; slot = (slot + 1) & mask)
+		if (keyOf(index[slot]) == key)
+			return index[slot];
+
+	return -1;
+}
+
+//----------------------------------------------------------------------------
+
 const Tag DataTable::m_dataTableIffId = TAG(D,T,I,I);
 
 //----------------------------------------------------------------------------
@@ -24,9 +133,11 @@ const Tag DataTable::m_dataTableIffId = TAG(D,T,I,I);
 DataTable::DataTable() :
 m_numRows(0),
 m_numCols(0),
-m_cells(0),
+m_columnData(),
+m_stringPool(),
+m_stringIndex(),
+m_numStrings(0),
 m_columns(),
-m_index(),
 m_types(),
 m_columnIndexMap(new ColumnIndexMap(17)),
 m_name()
@@ -37,74 +148,6 @@ m_name()
 
 DataTable::~DataTable()
 {
-	std::vector<void *>::iterator k = m_index.begin();
-	int count = 0;
-	for (; k != m_index.end(); ++k, ++count)
-	{
-		DataTableColumnType::DataType dt = m_types[static_cast<size_t>(count)]->getBasicType();
-
-		switch (dt)
-		{
-			case DataTableColumnType::DT_Int:
-			{
-				if (*k)
-				{
-					delete static_cast<std::multimap<int, int> *>(*k);
-					*k = NULL;
-				}
-			}
-			break;
-			case DataTableColumnType::DT_Float:
-			{
-				if (*k)
-				{
-					delete static_cast<std::multimap<float, int> *>(*k);
-					*k = NULL;
-				}
-
-			}
-			break;
-			case DataTableColumnType::DT_String:
-			{
-				if (*k)
-				{
-					delete static_cast<std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > *>(*k);
-					*k = NULL;
-				}
-
-			}
-			break;
-			case DataTableColumnType::DT_HashString:
-			case DataTableColumnType::DT_Enum:
-			case DataTableColumnType::DT_Bool:
-			case DataTableColumnType::DT_BitVector:
-			case DataTableColumnType::DT_Unknown:
-			case DataTableColumnType::DT_Comment:
-			case DataTableColumnType::DT_PackedObjVars:
-			default:
-			{
-				WARNING_STRICT_FATAL((*k) != NULL, ("Bad column Index %d. Unsupported datatype.  This may leak memory.", count));
-			}
-			break;
-		}
-	}
-
-	if (m_cells)
-	{
-		for (int row=0;row<m_numRows;++row)
-		{
-			const DataTableCell *rowCells = m_cells + row * m_numCols;
-			for (int col=0;col<m_numCols;++col)
-			{
-				const DataTableCell &cell = rowCells[col];
-				cell.~DataTableCell();
-			}
-		}
-
-		free((void *)m_cells);
-		m_cells=0;
-	}
-
 	DataTableColumnTypeVector::iterator l = m_types.begin();
 	while(l != m_types.end())
 	{
@@ -191,18 +234,9 @@ int DataTable::getIntValue(int column, int row) const
 	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] getIntValue(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
 	
 	// we can return the value of an int column or the crc value of a string column
-	if (m_types[static_cast<size_t>(column)]->getBasicType() == DataTableColumnType::DT_Int)
-	{
-		const DataTableCell *cell = getDataTableCell(column, row);
-		DEBUG_FATAL(cell->getType()!=DataTableCell::CT_int, ("Could not convert row %d column %d to int value", row, column));
-		return cell->getIntValue();
-	}
-	else if (m_types[static_cast<size_t>(column)]->getBasicType() == DataTableColumnType::DT_String)
-	{
-		const DataTableCell *cell = getDataTableCell(column, row);
-		DEBUG_FATAL(cell->getType()!=DataTableCell::CT_string, ("Could not convert row %d column %d to string value", row, column));
-		return cell->getStringValueCrc();
-	}
+	Column const &columnData = m_columnData[static_cast<size_t>(column)];
+	if (columnData.m_type == DataTableColumnType::DT_Int || columnData.m_type == DataTableColumnType::DT_String)
+		return columnData.m_ints[static_cast<size_t>(row)];
 
 	DEBUG_FATAL(true, ("DataTable [%s] getIntValue(): Wrong data type [%d] for col [%d].\n", m_name.c_str(), m_types[static_cast<size_t>(column)]->getBasicType(), column));
 	return 0;
@@ -245,10 +279,7 @@ float DataTable::getFloatValue(int column, int row) const
 	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] getFloatValue(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
 	DEBUG_FATAL(m_types[static_cast<size_t>(column)]->getBasicType() != DataTableColumnType::DT_Float, ("Wrong data type for column %d.", column));
 
-	const DataTableCell *cell = getDataTableCell(column, row);
-	DEBUG_FATAL(cell->getType()!=DataTableCell::CT_float, ("Could not convert row %d column %d to float value", row, column));
-	return cell->getFloatValue();
-
+	return m_columnData[static_cast<size_t>(column)].m_floats[static_cast<size_t>(row)];
 }
 
 //----------------------------------------------------------------------------
@@ -288,10 +319,7 @@ const char *DataTable::getStringValue(int column, int row) const
 	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("Column [%d] is invalid.", column));
 	DEBUG_FATAL(m_types[static_cast<size_t>(column)]->getBasicType() != DataTableColumnType::DT_String, ("Wrong data type for column %s (%d). Current data type is %s", getColumnName(column).c_str(), column, getDataTypeForColumn(column).getTypeSpecString().c_str()));
 
-	const DataTableCell * const cell = getDataTableCell(column, row);
-	DEBUG_FATAL(cell->getType()!=DataTableCell::CT_string, ("Could not convert row %d column %d to string value", row, column));
-	return cell->getStringValue();
-
+	return &m_stringPool[static_cast<size_t>(m_columnData[static_cast<size_t>(column)].m_strings[static_cast<size_t>(row)])];
 }
 
 //----------------------------------------------------------------------------
@@ -317,6 +345,64 @@ std::string DataTable::getStringDefaultForColumn(int column) const
 
 //----------------------------------------------------------------------------
 
+DataTable::IntColumnView DataTable::getIntColumn(const std::string& column) const
+{
+	int const columnIndex = findColumnNumber(column);
+	DEBUG_FATAL(columnIndex < 0 || columnIndex >= getNumColumns(), ("DataTable Column [%s] is invalid", column.c_str()));
+	return getIntColumn(columnIndex);
+}
+
+//----------------------------------------------------------------------------
+
+/**
+ * Get the values of an int column, or the crcs of a string column, without copying them.
+ */
+
+DataTable::IntColumnView DataTable::getIntColumn(int column) const
+{
+	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] getIntColumn(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
+
+	Column const &columnData = m_columnData[static_cast<size_t>(column)];
+	if (columnData.m_type != DataTableColumnType::DT_Int && columnData.m_type != DataTableColumnType::DT_String)
+	{
+		DEBUG_FATAL(true, ("DataTable [%s] getIntColumn(): Wrong data type [%d] for col [%d].\n", m_name.c_str(), columnData.m_type, column));
+		return IntColumnView();
+	}
+
+	return columnData.m_ints.empty() ? IntColumnView() : IntColumnView(&columnData.m_ints[0], m_numRows);
+}
+
+//----------------------------------------------------------------------------
+
+DataTable::FloatColumnView DataTable::getFloatColumn(const std::string& column) const
+{
+	int const columnIndex = findColumnNumber(column);
+	DEBUG_FATAL(columnIndex < 0 || columnIndex >= getNumColumns(), ("DataTable Column [%s] is invalid", column.c_str()));
+	return getFloatColumn(columnIndex);
+}
+
+//----------------------------------------------------------------------------
+
+/**
+ * Get the values of a float column without copying them.
+ */
+
+DataTable::FloatColumnView DataTable::getFloatColumn(int column) const
+{
+	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] getFloatColumn(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
+
+	Column const &columnData = m_columnData[static_cast<size_t>(column)];
+	if (columnData.m_type != DataTableColumnType::DT_Float)
+	{
+		DEBUG_FATAL(true, ("Wrong data type for column %d.", column));
+		return FloatColumnView();
+	}
+
+	return columnData.m_floats.empty() ? FloatColumnView() : FloatColumnView(&columnData.m_floats[0], m_numRows);
+}
+
+//----------------------------------------------------------------------------
+
 void DataTable::getIntColumn(const std::string& column, std::vector<int>& returnVector) const
 {
 	int const columnIndex = findColumnNumber(column);
@@ -355,33 +441,24 @@ void DataTable::getStringColumn(const std::string& column, std::vector<const cha
 
 void DataTable::getIntColumn(int column, std::vector<int>& returnVector) const
 {
-	returnVector.clear();
-	for (int i = 0; i < getNumRows(); ++i)
-	{
-		returnVector.push_back(getIntValue(column, i));
-	}
+	IntColumnView const values = getIntColumn(column);
+	returnVector.assign(values.begin(), values.end());
 }
 
 //----------------------------------------------------------------------------
 
 void DataTable::getIntColumn(int column, std::vector<long>& returnVector) const
 {
-	returnVector.clear();
-	for (int i = 0; i < getNumRows(); ++i)
-	{
-		returnVector.push_back(getIntValue(column, i));
-	}
+	IntColumnView const values = getIntColumn(column);
+	returnVector.assign(values.begin(), values.end());
 }
 
 //----------------------------------------------------------------------------
 
 void DataTable::getFloatColumn(int column, std::vector<float>& returnVector) const
 {
-	returnVector.clear();
-	for (int i = 0; i < getNumRows(); ++i)
-	{
-		returnVector.push_back(getFloatValue(column, i));
-	}
+	FloatColumnView const values = getFloatColumn(column);
+	returnVector.assign(values.begin(), values.end());
 }
 
 //----------------------------------------------------------------------------
@@ -399,21 +476,17 @@ void DataTable::getStringColumn(int column, std::vector<const char *>& returnVec
 
 void DataTable::_readCell(Iff & iff, int column, int row)
 {
-	DataTableCell *cell = const_cast<DataTableCell *>(getDataTableCell(column, row));
-	const DataTableColumnType &typeCol = *m_types[static_cast<size_t>(column)];
-	switch (typeCol.getBasicType())
+	Column &columnData = m_columnData[static_cast<size_t>(column)];
+	switch (columnData.m_type)
 	{
 	case DataTableColumnType::DT_Int:
 	{
-		int tmp = iff.read_int32();
-		new (cell) DataTableCell(tmp);
-
+		columnData.m_ints[static_cast<size_t>(row)] = iff.read_int32();
 		break;
 	}
 	case DataTableColumnType::DT_Float:
 	{
-		float tmp = iff.read_float();
-		new (cell) DataTableCell(tmp);
+		columnData.m_floats[static_cast<size_t>(row)] = iff.read_float();
 		break;
 	}
 	case DataTableColumnType::DT_String:
@@ -423,7 +496,17 @@ void DataTable::_readCell(Iff & iff, int column, int row)
 		buffer[0]=0;
 		iff.read_string(buffer, maxLen-1);
 		buffer[maxLen-1]=0;
-		new (cell) DataTableCell(buffer);
+
+		columnData.m_strings[static_cast<size_t>(row)] = internString(buffer);
+
+		// normalizing never lengthens the string, so it can be done in place to get the crc
+		if (buffer[0])
+		{
+			CrcString::normalize(buffer, buffer);
+			columnData.m_ints[static_cast<size_t>(row)] = static_cast<int>(Crc::calculate(buffer));
+		}
+		else
+			columnData.m_ints[static_cast<size_t>(row)] = 0;
 		break;
 	}
 	case DataTableColumnType::DT_Unknown:
@@ -439,6 +522,73 @@ void DataTable::_readCell(Iff & iff, int column, int row)
 	}
 }
 
+//----------------------------------------------------------------------------
+/**
+ * Add a string to the string pool if it isn't there already.
+ *
+ * @return The offset of the string in the pool
+ */
+
+int DataTable::internString(const char *value)
+{
+	if (!*value)
+		return 0;
+
+	// keep the string index at most half full
+	if ((m_numStrings + 1) * 2 > static_cast<int>(m_stringIndex.size()))
+	{
+		std::vector<int> oldIndex;
+		oldIndex.swap(m_stringIndex);
+		m_stringIndex.resize(getIndexSize(m_numStrings + 1), -1);
+
+		uint32 const mask = static_cast<uint32>(m_stringIndex.size() - 1);
+		for (std::vector<int>::const_iterator i = oldIndex.begin(); i != oldIndex.end(); ++i)
+			if (*i >= 0)
+			{
+				uint32 slot = Crc::calculate(&m_stringPool[static_cast<size_t>(*i)]) & mask;
+				while (m_stringIndex[slot] >= 0)
+					slot = (slot + 1) & mask;
+				m_stringIndex[slot] = *i;
+			}
+	}
+
+	uint32 const mask = static_cast<uint32>(m_stringIndex.size() - 1);
+	uint32 slot = Crc::calculate(value) & mask;
+	for ( ; m_stringIndex[slot] >= 0; slot = (slot + 1) & mask)
+		if (strcmp(&m_stringPool[static_cast<size_t>(m_stringIndex[slot])], value) == 0)
+			return m_stringIndex[slot];
+
+	int const offset = static_cast<int>(m_stringPool.size());
+	m_stringPool.insert(m_stringPool.end(), value, value + strlen(value) + 1);
+	m_stringIndex[slot] = offset;
+	++m_numStrings;
+
+	return offset;
+}
+
+//----------------------------------------------------------------------------
+/**
+ * Find a string in the string pool.
+ *
+ * @return The offset of the string in the pool, or -1 if no cell holds it
+ */
+
+int DataTable::findString(const char *value) const
+{
+	if (!*value)
+		return 0;
+
+	if (m_stringIndex.empty())
+		return -1;
+
+	uint32 const mask = static_cast<uint32>(m_stringIndex.size() - 1);
+	for (uint32 slot = Crc::calculate(value) & mask; m_stringIndex[slot] >= 0; slot = (slot + 1) & mask)
+		if (strcmp(&m_stringPool[static_cast<size_t>(m_stringIndex[slot])], value) == 0)
+			return m_stringIndex[slot];
+
+	return -1;
+}
+
 //----------------------------------------------------------------------------
 
 void DataTable::load(Iff & iff)
@@ -460,13 +610,7 @@ void DataTable::load(Iff & iff)
 
 	iff.exitForm(m_dataTableIffId, false);
 
-	int count = getNumColumns();
-	for (int i = 0; i < count; ++i)
-	{
-		//initialize the table index used for searching.
-		m_index.push_back(NULL);
-	}
-
+	buildSearchIndexes();
 	buildColumnIndexMap();
 
 	if (NULL != iff.getFileName())
@@ -535,22 +679,8 @@ void DataTable::load_0000(Iff & iff)
 	}
 	iff.exitChunk(TAG(T,Y,P,E));
 
-	//load rows
-	iff.enterChunk(TAG(R,O,W,S));
-	m_numRows = iff.read_int32();
-
-	const size_t cellSize = m_numRows * m_numCols * sizeof(DataTableCell);
-	void *cellMemory = malloc(cellSize);
-	m_cells = (DataTableCell *)cellMemory;
-	for (i = 0; i < m_numRows; ++i)
-	{
-		for (int j = 0; j < m_numCols; ++j)
-		{
-			_readCell(iff, j, i);
-		}
-	}
+	loadRows(iff);
 
-	iff.exitChunk(TAG(R,O,W,S));
 	iff.exitForm(TAG_0000, false);
 }
 
@@ -583,23 +713,81 @@ void DataTable::load_0001(Iff & iff)
 	}
 	iff.exitChunk(TAG(T,Y,P,E));
 
-	//load rows
+	loadRows(iff);
+
+	iff.exitForm(TAG_0001, false);
+}
+
+//----------------------------------------------------------------------------
+
+void DataTable::loadRows(Iff & iff)
+{
 	iff.enterChunk(TAG(R,O,W,S));
 	m_numRows = iff.read_int32();
 
-	const size_t cellSize = m_numRows * m_numCols * sizeof(DataTableCell);
-	void *cellMemory = malloc(cellSize);
-	m_cells = (DataTableCell *)cellMemory;
-	for (i = 0; i < m_numRows; ++i)
+	// size the column storage up front so the cells can be read straight into place
+	m_columnData.resize(static_cast<size_t>(m_numCols));
+	for (int column = 0; column < m_numCols; ++column)
+	{
+		Column &columnData = m_columnData[static_cast<size_t>(column)];
+		columnData.m_type = m_types[static_cast<size_t>(column)]->getBasicType();
+
+		switch (columnData.m_type)
+		{
+		case DataTableColumnType::DT_Int:
+			columnData.m_ints.resize(static_cast<size_t>(m_numRows));
+			break;
+		case DataTableColumnType::DT_Float:
+			columnData.m_floats.resize(static_cast<size_t>(m_numRows));
+			break;
+		case DataTableColumnType::DT_String:
+			columnData.m_ints.resize(static_cast<size_t>(m_numRows));
+			columnData.m_strings.resize(static_cast<size_t>(m_numRows));
+			break;
+		default:
+			break;
+		}
+	}
+
+	// the empty string always lives at the start of the pool
+	m_stringPool.clear();
+	m_stringPool.push_back('\0');
+
+	for (int row = 0; row < m_numRows; ++row)
 	{
-		for (int j = 0; j < m_numCols; ++j)
+		for (int column = 0; column < m_numCols; ++column)
 		{
-			_readCell(iff, j, i);
+			_readCell(iff, column, row);
 		}
 	}
 
 	iff.exitChunk(TAG(R,O,W,S));
-	iff.exitForm(TAG_0001, false);
+}
+
+//----------------------------------------------------------------------------
+
+void DataTable::buildSearchIndexes()
+{
+	for (std::vector<Column>::iterator i = m_columnData.begin(); i != m_columnData.end(); ++i)
+	{
+		Column &columnData = *i;
+		switch (columnData.m_type)
+		{
+		case DataTableColumnType::DT_Int:
+			buildIndex(columnData.m_index, m_numRows, IntKey(columnData.m_ints));
+			break;
+		case DataTableColumnType::DT_Float:
+			buildIndex(columnData.m_index, m_numRows, FloatKey(columnData.m_floats));
+			break;
+		case DataTableColumnType::DT_String:
+			// interned strings are equal exactly when their offsets are
+			buildIndex(columnData.m_index, m_numRows, IntKey(columnData.m_strings));
+			buildIndex(columnData.m_crcIndex, m_numRows, IntKey(columnData.m_ints));
+			break;
+		default:
+			break;
+		}
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -608,37 +796,14 @@ int DataTable::searchColumnString( int column, const std::string & searchValue )
 {
 	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] searchColumnString(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
 
-	int retval = -1;
-
-	void * voidIndex = m_index[ static_cast<size_t>(column) ];
-	if (!voidIndex)
-	{
-		std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > * indexPair = new std::pair<std::multimap<const std::string, int>, std::multimap<int, int> >;
-		NOT_NULL(indexPair);
+	Column const &columnData = m_columnData[static_cast<size_t>(column)];
+	DEBUG_FATAL(columnData.m_type != DataTableColumnType::DT_String, ("Wrong data type for column %s (%d). Current data type is %s", getColumnName(column).c_str(), column, getDataTypeForColumn(column).getTypeSpecString().c_str()));
 
-		m_index[static_cast<size_t>(column)] = static_cast<void *>(indexPair);
+	int const offset = findString(searchValue.c_str());
+	if (offset < 0)
+		return -1;
 
-		//no index has been built yet for this column
-		int rowCount = getNumRows();
-		for (int i = 0; i < rowCount; ++i)
-		{
-			const std::string & valueString = getStringValue(column,i);
-			IGNORE_RETURN ( indexPair->first.insert(std::pair<const std::string, int>(valueString, i)) );
-			int valueCrc = getIntValue(column,i);
-			IGNORE_RETURN ( indexPair->second.insert(std::pair<int, int>(valueCrc, i)) );
-			if (retval == -1 && valueString == searchValue)
-				retval = i;
-		}
-	}
-	else
-	{
-		std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > * indexPair = static_cast<std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > *>(voidIndex);
-		std::multimap<const std::string, int>::iterator iter = indexPair->first.find(searchValue);
-		if (iter != indexPair->first.end())
-			retval = iter->second;	
-	}
-
-	return retval;
+	return findInIndex(columnData.m_index, static_cast<uint32>(offset), IntKey(columnData.m_strings));
 }
 
 // ----------
@@ -647,34 +812,10 @@ int DataTable::searchColumnFloat( int column, float searchValue ) const
 {
 	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] searchColumnFloat(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
 
-	int retval = -1;
-
-	void * voidIndex = m_index[ static_cast<size_t>(column) ];
-	if (!voidIndex)
-	{
-		std::multimap<float, int> * index = new std::multimap<float, int>;
-		NOT_NULL(index);
-
-		m_index[static_cast<size_t>(column)] = static_cast<void *>(index);
+	Column const &columnData = m_columnData[static_cast<size_t>(column)];
+	DEBUG_FATAL(columnData.m_type != DataTableColumnType::DT_Float, ("Wrong data type for column %d.", column));
 
-		//no index has been built yet for this column
-		for (int i = 0; i < getNumRows(); ++i)
-		{
-			float rowValue = getFloatValue(column,i);
-			IGNORE_RETURN ( index->insert(std::pair<float, int>(rowValue, i)) );
-			if (retval == -1 && rowValue == searchValue) //lint !e777 //ok to compare floats
-				retval = i;
-		}
-	}
-	else
-	{
-		std::multimap<float, int> * index = static_cast<std::multimap<float, int> *>(voidIndex);
-		std::multimap<float, int>::iterator iter = index->find(searchValue);
-		if (iter != index->end())
-			retval = iter->second;
-	}
-
-	return retval;
+	return findInIndex(columnData.m_index, getFloatKey(searchValue), FloatKey(columnData.m_floats));
 }
 
 // ----------
@@ -683,69 +824,14 @@ int DataTable::searchColumnInt( int column, int searchValue ) const
 {
 	DEBUG_FATAL(column < 0 || column >= getNumColumns(), ("DataTable [%s] searchColumnInt(): Invalid col number [%d].  Cols=[%d]\n", m_name.c_str(), column, getNumColumns()));
 
-	int retval = -1;
-	DataTableColumnType::DataType columnType = m_types[static_cast<size_t>(column)]->getBasicType();
-
-	void * voidIndex = m_index[ static_cast<size_t>(column) ];
-	if (!voidIndex)
-	{
-		if (columnType == DataTableColumnType::DT_Int)
-		{
-			std::multimap<int, int> * index = new std::multimap<int, int>;
-			NOT_NULL(index);
-
-			m_index[static_cast<size_t>(column)] = static_cast<void *>(index);
-
-			//no index has been built yet for this column
-			int rowCount = getNumRows();
-			for (int i = 0; i < rowCount; ++i)
-			{
-				int rowValue = getIntValue(column,i);
-				IGNORE_RETURN ( index->insert(std::pair<int, int>(rowValue, i)) );
-				if (retval == -1 && rowValue == searchValue)
-					retval = i;
-			}
-		}
-		else if (columnType == DataTableColumnType::DT_String)
-		{
-			std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > * indexPair = new std::pair<std::multimap<const std::string, int>, std::multimap<int, int> >;
-			NOT_NULL(indexPair);
-
-			m_index[static_cast<size_t>(column)] = static_cast<void *>(indexPair);
-
-			//no index has been built yet for this column
-			int rowCount = getNumRows();
-			for (int i = 0; i < rowCount; ++i)
-			{
-				const std::string & valueString = getStringValue(column,i);
-				IGNORE_RETURN ( indexPair->first.insert(std::pair<const std::string, int>(valueString, i)) );
-				int valueCrc = getIntValue(column,i);
-				IGNORE_RETURN ( indexPair->second.insert(std::pair<int, int>(valueCrc, i)) );
-				if (retval == -1 && valueCrc == searchValue)
-					retval = i;
-			}
-		}
-	}
-	else
-	{
-		if (columnType == DataTableColumnType::DT_Int)
-		{
-			std::multimap<int, int> * index = static_cast<std::multimap<int, int> *>(voidIndex);
-			std::multimap<int, int>::iterator iter = index->find(searchValue);
-			if (iter != index->end())
-				retval = iter->second;
-		}
-		else if (columnType == DataTableColumnType::DT_String)
-		{
-			std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > * indexPair = static_cast<std::pair<std::multimap<const std::string, int>, std::multimap<int, int> > *>(voidIndex);
-			std::multimap<int, int>::iterator iter = indexPair->second.find(searchValue);
-			if (iter != indexPair->second.end())
-				retval = iter->second;
-		}
-	}
-
-	return retval;
+	// string columns are searched by the crc of their values
+	Column const &columnData = m_columnData[static_cast<size_t>(column)];
+	if (columnData.m_type == DataTableColumnType::DT_Int)
+		return findInIndex(columnData.m_index, static_cast<uint32>(searchValue), IntKey(columnData.m_ints));
+	else if (columnData.m_type == DataTableColumnType::DT_String)
+		return findInIndex(columnData.m_crcIndex, static_cast<uint32>(searchValue), IntKey(columnData.m_ints));
 
+	return -1;
 }
 
 // ----------
@@ -760,4 +846,3 @@ void DataTable::buildColumnIndexMap()
 }
 
 //----------------------------------------------------------------------------
-
@@ -20,6 +20,38 @@ class Iff;
 
 class DataTable
 {
+public:
+
+	/**
+	 * A read-only view of the values of one column.
+	 *
+	 * The values are stored contiguously by the table, so a view is only valid
+	 * for as long as the table it came from.
+	 */
+
+	template <typename T>
+	class ColumnView
+	{
+	public:
+
+		ColumnView() : m_values(0), m_size(0) {}
+		ColumnView(T const *values, int size) : m_values(values), m_size(size) {}
+
+		T const *   begin() const { return m_values; }
+		T const *   end() const { return m_values + m_size; }
+		int         size() const { return m_size; }
+		bool        empty() const { return m_size == 0; }
+		T const &   operator[](int index) const { return m_values[index]; }
+
+	private:
+
+		T const *   m_values;
+		int         m_size;
+	};
+
+	typedef ColumnView<int>   IntColumnView;
+	typedef ColumnView<float> FloatColumnView;
+
 public:
 	DataTable();
 	virtual ~DataTable();
@@ -43,6 +75,11 @@ public:
 	std::string         getStringDefaultForColumn(const std::string & column) const;
 	std::string         getStringDefaultForColumn(int column) const;
 
+	IntColumnView       getIntColumn(const std::string& column) const;
+	IntColumnView       getIntColumn(int column) const;
+	FloatColumnView     getFloatColumn(const std::string& column) const;
+	FloatColumnView     getFloatColumn(int column) const;
+
 	void                getIntColumn(const std::string& column, std::vector<int>& returnVector) const;
 	void                getIntColumn(const std::string& column, std::vector<long>& returnVector) const;
 	void                getFloatColumn(const std::string& column, std::vector<float>& returnVector) const;
@@ -58,7 +95,7 @@ public:
 	void                load(Iff &);
 
 	// Search a column of the table for a given value and return the index of the first
-	// matching row. Warning - this is a linear search, so it can be slow.
+	// matching row, or -1 if there is none.  Every column is indexed when the table is loaded.
 
 	int                 searchColumnString(int column, const std::string & searchValue) const;
 	int                 searchColumnFloat(int column, float searchValue) const;
@@ -74,8 +111,29 @@ protected:
 
 private:
 
-	const DataTableCell * getDataTableCell(int column, int row) const;
+	// Values are stored by column.  Int columns keep their values in m_ints, float
+	// columns in m_floats, and string columns keep the offset of each value in the
+	// table's string pool in m_strings and its crc in m_ints.
+	//
+	// m_index is an open addressing hash table of row numbers holding the first row
+	// of each distinct value in the column.  String columns also have m_crcIndex,
+	// holding the first row of each distinct crc.  Empty slots are -1.
+
+	struct Column
+	{
+		DataTableColumnType::DataType m_type;
+		std::vector<int>              m_ints;
+		std::vector<float>            m_floats;
+		std::vector<int>              m_strings;
+		std::vector<int>              m_index;
+		std::vector<int>              m_crcIndex;
+	};
+
 	void _readCell(Iff & iff, int column, int row);
+	int  internString(const char *value);
+	int  findString(const char *value) const;
+	void loadRows(Iff &);
+	void buildSearchIndexes();
 
 	static DataTableColumnType getDataType(const std::string &type);
 	void                load_0000(Iff &);
@@ -87,9 +145,11 @@ private:
 
 	int                           m_numRows;
 	int                           m_numCols;
-	DataTableCell const *         m_cells;
+	std::vector<Column>           m_columnData;
+	std::vector<char>             m_stringPool;
+	std::vector<int>              m_stringIndex;
+	int                           m_numStrings;
 	std::vector<std::string>      m_columns;
-	mutable std::vector<void *>   m_index;
 	DataTableColumnTypeVector     m_types;
 	ColumnIndexMap *              m_columnIndexMap;
 	std::string                   m_name;
@@ -112,11 +172,6 @@ inline int DataTable::getNumRows() const
 	return m_numRows;
 }
 
-inline const DataTableCell * DataTable::getDataTableCell(int column, int row) const
-{
-	return m_cells + (row * m_numCols + column);
-}
-
 //----------------------------------------------------------------------
 
 inline std::string const & DataTable::getName() const
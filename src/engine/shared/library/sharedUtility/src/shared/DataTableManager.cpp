@@ -77,7 +77,8 @@ DataTable* DataTableManager::open(const std::string& table)
 		return 0;
 	}
 
-	Iff iff(table.c_str(), false);
+	Iff iff;
+	IGNORE_RETURN(iff.openReadOnly(table.c_str()));
 	retVal = new DataTable;
 	retVal->load(iff);
 
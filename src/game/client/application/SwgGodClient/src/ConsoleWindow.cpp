@@ -40,7 +40,7 @@ ConsoleWindow::~ConsoleWindow()
 void ConsoleWindow::receiveMessage(const MessageDispatch::Emitter & source, const MessageDispatch::MessageBase & message)
 {
 	UNREF(source);
-	if(message.isType("ConGenericMessage"))
+	if(message.isType(CRC_CONSTANT("ConGenericMessage")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 		ConGenericMessage cg(ri);
@@ -316,7 +316,7 @@ void GodClientData::receiveMessage(const MessageDispatch::Emitter& , const Messa
 	{
 		handleSceneChange();
 	}
-	if(message.isType("ConGenericMessage"))
+	if(message.isType(CRC_CONSTANT("ConGenericMessage")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage&>(message).getByteStream().begin();
 		ConGenericMessage cg(ri);
@@ -424,7 +424,7 @@ void GodClientData::receiveMessage(const MessageDispatch::Emitter& , const Messa
 		aip.m_nodes  = aipiMessage.getNodes();
 		m_AIPaths[aipiMessage.getObjectId()] = aip;
 	}
-	if(message.isType("GodClientSaveBuildoutArea"))
+	if(message.isType(CRC_CONSTANT("GodClientSaveBuildoutArea")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage&>(message).getByteStream().begin();
 
@@ -485,7 +485,7 @@ void ObjectEditor::receiveMessage(const MessageDispatch::Emitter &, const Messag
 	{
 		updateObjectData();
 	}
-	if(message.isType("ConGenericMessage"))
+	if(message.isType(CRC_CONSTANT("ConGenericMessage")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage&>(message).getByteStream().begin();
 		ConGenericMessage cg(ri);
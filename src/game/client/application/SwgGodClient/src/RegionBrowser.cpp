@@ -51,13 +51,13 @@ void RegionBrowser::receiveMessage(const MessageDispatch::Emitter & source, cons
 {
 	UNREF(source);
 
-	if (message.isType ("MessageRegionListCircleResponse"))
+	if (message.isType(CRC_CONSTANT("MessageRegionListCircleResponse")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const MessageRegionListCircleResponse circlersp(ri);
 		m_regionRenderer->updateCircleRegion(circlersp.getWorldX(), circlersp.getWorldZ(),  circlersp.getRadius(),  Unicode::wideToNarrow(circlersp.getName()), circlersp.getPlanet(), circlersp.getPvP(), circlersp.getBuildable(), circlersp.getSpawnable(), circlersp.getMunicipal(), circlersp.getGeographical(), circlersp.getMinDifficulty(), circlersp.getMaxDifficulty(), circlersp.getMission());
 	}
-	else if (message.isType ("MessageRegionListRectResponse"))
+	else if (message.isType(CRC_CONSTANT("MessageRegionListRectResponse")))
 	{
 		Archive::ReadIterator ri = NON_NULL (safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const MessageRegionListRectResponse rectrsp(ri);
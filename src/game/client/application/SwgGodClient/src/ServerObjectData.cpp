@@ -140,7 +140,7 @@ void ServerObjectData::receiveMessage(const MessageDispatch::Emitter &, const Me
 	}
 
 	//handle all messages that come in as regular text (yuck)
-	if(message.isType("ConGenericMessage"))
+	if(message.isType(CRC_CONSTANT("ConGenericMessage")))
 	{
 		NOT_NULL(m_outstandingRequests);
 
@@ -34,7 +34,7 @@ TriggerWindow::~TriggerWindow()
 
 void TriggerWindow::receiveMessage(const MessageDispatch::Emitter & , const MessageDispatch::MessageBase & message)
 {
-	if (message.isType("ConGenericMessage"))
+	if (message.isType(CRC_CONSTANT("ConGenericMessage")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 		ConGenericMessage cg(ri);
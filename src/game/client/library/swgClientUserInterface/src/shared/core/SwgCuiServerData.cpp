@@ -45,7 +45,7 @@ SwgCuiServerData::~SwgCuiServerData ()
 
 void  SwgCuiServerData::receiveMessage (const MessageDispatch::Emitter & , const MessageDispatch::MessageBase & message)
 {
-	if (message.isType ("ConGenericMessage"))
+	if (message.isType(CRC_CONSTANT("ConGenericMessage")))
 	{
 	}
 	
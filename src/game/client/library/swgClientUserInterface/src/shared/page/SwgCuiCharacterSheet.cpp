@@ -848,7 +848,7 @@ void SwgCuiCharacterSheet::receiveMessage(const MessageDispatch::Emitter &, cons
 		else
 			m_married->SetLocalText(spouseName);
 	}
-	else if(message.isType("CharacterSheetResponseResLoc"))
+	else if(message.isType(CRC_CONSTANT("CharacterSheetResponseResLoc")))
 	{
 		Archive::ReadIterator ri = NON_NULL(safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const GenericValueTypeMessage<std::pair<std::string, std::string> > msg(ri);
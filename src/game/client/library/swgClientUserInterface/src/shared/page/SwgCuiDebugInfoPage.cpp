@@ -517,7 +517,7 @@ void SwgCuiDebugInfoPage::updateBandwidth ()
 
 void SwgCuiDebugInfoPage::receiveMessage(const MessageDispatch::Emitter &, const MessageDispatch::MessageBase & message)
 {
-	if (message.isType("GalaxyLoopTimesResponse"))
+	if (message.isType(CRC_CONSTANT("GalaxyLoopTimesResponse")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 		const GalaxyLoopTimesResponse cg(ri);
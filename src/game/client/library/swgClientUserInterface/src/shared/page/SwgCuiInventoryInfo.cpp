@@ -609,7 +609,7 @@ void SwgCuiInventoryInfo::updatePlayerData()
 
 void SwgCuiInventoryInfo::receiveMessage(const MessageDispatch::Emitter &, const MessageDispatch::MessageBase & message)
 {
-	if(message.isType("GuildResponseMessage"))
+	if(message.isType(CRC_CONSTANT("GuildResponseMessage")))
 	{
 		Archive::ReadIterator ri = NON_NULL(safe_cast<const GameNetworkMessage *>(&message))->getByteStream().begin();
 		const GuildResponseMessage msg(ri);
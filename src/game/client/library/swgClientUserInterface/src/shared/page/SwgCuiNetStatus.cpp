@@ -194,7 +194,7 @@ void SwgCuiNetStatus::updateBandwidth()
 
 void SwgCuiNetStatus::receiveMessage(const MessageDispatch::Emitter &, const MessageDispatch::MessageBase & message)
 {
-	if (message.isType("GalaxyLoopTimesResponse"))
+	if (message.isType(CRC_CONSTANT("GalaxyLoopTimesResponse")))
 	{
 		Archive::ReadIterator ri = dynamic_cast<const GameNetworkMessage &>(message).getByteStream().begin();
 		const GalaxyLoopTimesResponse cg(ri);
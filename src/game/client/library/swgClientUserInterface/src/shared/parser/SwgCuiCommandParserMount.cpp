@@ -361,7 +361,7 @@ bool SwgCuiCommandParserMountNamespace::doMountCreature(StringVector const &argv
 		return false;
 	}
 
-	int const arrangementIndex = scProperty->getBestArrangementForSlot(SlotIdManager::findSlotId(ConstCharCrcString("rider")));
+	int const arrangementIndex = scProperty->getBestArrangementForSlot(SlotIdManager::findSlotId(CONST_CHAR_CRC_STRING("rider")));
 	if ((arrangementIndex < 0) || (arrangementIndex >= scProperty->getNumberOfArrangements()))
 	{
 		char buffer[512];
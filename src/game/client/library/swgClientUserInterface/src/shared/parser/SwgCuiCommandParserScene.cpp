@@ -3985,6 +3985,9 @@ bool SwgCuiCommandParserScene::performParsing (const NetworkId & , const StringV
 			rotationDynamics->setRotateAroundAppearanceCenter(true);
 			obj->setDynamics(rotationDynamics);
 
+			//-- a plain object with a static mesh that only spins itself can be altered on the alter threads
+			obj->setAlterIsThreadSafe(true);
+
 			RenderWorld::addObjectNotifications (*obj);
 			obj->addToWorld();
 
@@ -206,7 +206,7 @@ void GameConnection::onReceive(const Archive::ByteStream & data)
 	
 	ri = data.begin();
 
-	if(msg.isType("ClientPermissionsMessage"))
+	if(msg.isType(CRC_CONSTANT("ClientPermissionsMessage")))
 	{
 		REPORT_LOG(true, ("[%s] received ClientPermissionMessage : ", m_owner->getLoginId().c_str()));
 		ClientPermissionsMessage cpm(ri);
@@ -255,7 +255,7 @@ void GameConnection::onReceive(const Archive::ByteStream & data)
 			}
 		}
 	}
-	else if(msg.isType("ClientCreateCharacterSuccess"))
+	else if(msg.isType(CRC_CONSTANT("ClientCreateCharacterSuccess")))
 	{
 		REPORT_LOG(true, ("[%s] received ClientCreateCharacterSuccess message\n", m_owner->getLoginId().c_str()));
 		ClientCreateCharacterSuccess cccs(ri);
@@ -263,7 +263,7 @@ void GameConnection::onReceive(const Archive::ByteStream & data)
 		SelectCharacter s(m_characterObjectId);
 		send(s, true);
 	}
-	else if(msg.isType("CmdStartScene"))
+	else if(msg.isType(CRC_CONSTANT("CmdStartScene")))
 	{
 		REPORT_LOG(true, ("[%s] received CmdStartScene message : ", m_owner->getLoginId().c_str()));
 		CmdStartScene start(ri);
@@ -287,7 +287,7 @@ void GameConnection::onReceive(const Archive::ByteStream & data)
 		send(s, true);
 		chat(ConfigSwgLoadClient::getScriptSetupText());
 	}
-	else if(msg.isType("UpdateContainmentMessage"))
+	else if(msg.isType(CRC_CONSTANT("UpdateContainmentMessage")))
 	{
 		UpdateContainmentMessage o(ri);
 		if (o.getNetworkId() == m_characterObjectId)
@@ -296,7 +296,7 @@ void GameConnection::onReceive(const Archive::ByteStream & data)
 			m_characterInShip = o.getSlotArrangement() != -1;
 		}
 	}
-	else if(msg.isType("ObjControllerMessage"))
+	else if(msg.isType(CRC_CONSTANT("ObjControllerMessage")))
 	{
 		ObjControllerMessage c(ri);
 		if (   c.getNetworkId() == m_characterObjectId
@@ -63,12 +63,12 @@ void LoginConnection::onReceive(const Archive::ByteStream & data)
 
 	ri = data.begin();
 
-	if(base.isType("LoginClientToken"))
+	if(base.isType(CRC_CONSTANT("LoginClientToken")))
 	{
 		m_owner->setLoginClientToken(new LoginClientToken(ri));
 		REPORT_LOG(true, ("[%s] received LoginClientToken\n", m_loginId.c_str()));
 	}
-	else if(base.isType("LoginEnumCluster"))
+	else if(base.isType(CRC_CONSTANT("LoginEnumCluster")))
 	{
 		LoginEnumCluster ec(ri);
 
@@ -95,7 +95,7 @@ void LoginConnection::onReceive(const Archive::ByteStream & data)
 			SwgLoadClient::quit();
 		}
 	}
-	else if(base.isType("LoginClusterStatus"))
+	else if(base.isType(CRC_CONSTANT("LoginClusterStatus")))
 	{
 		REPORT_LOG(true, ("[%s] received LoginClusterStatus message\n", m_loginId.c_str()));
 
@@ -126,7 +126,7 @@ void LoginConnection::onReceive(const Archive::ByteStream & data)
 			REPORT_LOG(true, ("\n"));
 		}
 	}
-	else if(base.isType("EnumerateCharacterId"))
+	else if(base.isType(CRC_CONSTANT("EnumerateCharacterId")))
 	{
 		REPORT_LOG(true, ("[%s] received EnumerateCharacterId message\n", m_loginId.c_str()));
 		EnumerateCharacterId ec(ri);
@@ -155,7 +155,7 @@ void LoginConnection::onReceive(const Archive::ByteStream & data)
 			REPORT_LOG(true, ("\n"));
 		}
 	}
-	else if(base.isType("ErrorMessage"))
+	else if(base.isType(CRC_CONSTANT("ErrorMessage")))
 	{
 		ErrorMessage m(ri);
 		REPORT_LOG(true, ("[%s] received ErrorMessage %s : %s\nQUITTING\n", m_loginId.c_str(), m.getErrorName().c_str(), m.getDescription().c_str()));